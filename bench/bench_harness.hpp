@@ -0,0 +1,255 @@
+#pragma once
+
+#include "alloc_tracker.hpp"
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace jwt::bench {
+
+/// Keep a value alive so the optimizer cannot drop the computation producing it
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// Measurement settings shared by every benchmark in a run
+struct RunConfig {
+    std::chrono::milliseconds minTime{200};  // Total measured time per benchmark
+    int repetitions = 5;                     // Median is taken across repetitions
+    PerfCounters* counters = nullptr;        // Read hardware counters when set
+    bool normalize = false;                  // Time the calibration loop before each repetition
+};
+
+/// Result of one benchmark
+struct Result {
+    std::string name;
+    double nsPerOp = 0.0;
+    double normalized = 0.0;  // Fastest repetition / fastest calibration; 0 unless RunConfig::normalize
+    double allocsPerOp = 0.0;
+    double bytesPerOp = 0.0;
+    std::uint64_t iterations = 0;
+    CounterValues countersPerOp{};  // Empty unless counters were requested and available
+
+    [[nodiscard]] double opsPerSecond() const { return nsPerOp > 0 ? 1e9 / nsPerOp : 0.0; }
+};
+
+namespace detail {
+    using Clock = std::chrono::steady_clock;
+
+    inline double median(std::vector<double> v) {
+        std::sort(v.begin(), v.end());
+        return v[v.size() / 2];
+    }
+
+    template <typename F>
+    double timeBatch(F& body, std::uint64_t iterations) {
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            body();
+        }
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    /// Fixed workload that benchmark timings are normalized by. It mixes what
+    /// the benchmarks spend their time on (unpredictable branches, hashing,
+    /// small allocations, table lookups), so that load from other tenants of a
+    /// shared core slows it in the same proportion.
+    class CalibrationLoop {
+    public:
+        CalibrationLoop() {
+            std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+            auto next = [&state]() {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                return state;
+            };
+            values_.resize(512);
+            for (auto& value : values_) {
+                value = static_cast<std::uint32_t>(next());
+            }
+            keys_.resize(256);
+            for (auto& key : keys_) {
+                key = std::to_string(next());
+                index_.emplace(key, static_cast<std::uint32_t>(index_.size()));
+            }
+        }
+
+        void operator()() const {
+            std::vector<std::uint32_t> values = values_;
+            std::sort(values.begin(), values.end());
+            std::uint32_t acc = values[values.size() / 2];
+            for (const auto& key : keys_) {
+                acc += index_.find(key)->second;
+            }
+            doNotOptimize(acc);
+        }
+
+    private:
+        std::vector<std::uint32_t> values_;
+        std::vector<std::string> keys_;
+        std::unordered_map<std::string, std::uint32_t> index_;
+    };
+}
+
+/**
+ * Run a benchmark body repeatedly and report the median cost per call.
+ * The batch size is grown until one repetition takes minTime / repetitions;
+ * allocations (and hardware counters, if configured) are measured over
+ * separate batches on the calling thread.
+ */
+template <typename F>
+Result run(const std::string& name, F&& body, const RunConfig& cfg = RunConfig{}) {
+    using namespace detail;
+
+    const double target = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(cfg.minTime).count()) /
+        std::max(cfg.repetitions, 1);
+
+    // Warm up and size the batch
+    std::uint64_t batch = 1;
+    double elapsed = timeBatch(body, batch);
+    while (elapsed < target && batch < (1ULL << 32)) {
+        double scale = elapsed > 0 ? std::min(10.0, 1.2 * target / elapsed) : 10.0;
+        batch = std::max<std::uint64_t>(batch + 1, static_cast<std::uint64_t>(batch * scale));
+        elapsed = timeBatch(body, batch);
+    }
+
+    // With normalize, each repetition is preceded by an equally long run of the
+    // calibration loop. Load on a shared host only ever adds time, so the
+    // fastest sample on each side is the least disturbed one.
+    CalibrationLoop loop;
+    std::uint64_t loopBatch = 0;
+    if (cfg.normalize) {
+        double unit = timeBatch(loop, 16) / 16.0;
+        loopBatch = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(target / std::max(unit, 1.0)));
+    }
+
+    std::vector<double> samples;
+    samples.reserve(static_cast<std::size_t>(cfg.repetitions));
+    double fastest = 0.0;
+    double fastestCalibration = 0.0;
+    for (int r = 0; r < std::max(cfg.repetitions, 1); ++r) {
+        if (cfg.normalize) {
+            double calibrationNs = timeBatch(loop, loopBatch) / static_cast<double>(loopBatch);
+            fastestCalibration = r == 0 ? calibrationNs : std::min(fastestCalibration, calibrationNs);
+        }
+        samples.push_back(timeBatch(body, batch) / static_cast<double>(batch));
+        fastest = r == 0 ? samples.back() : std::min(fastest, samples.back());
+    }
+
+    auto allocs = jwt::testing::countAllocations([&]() { timeBatch(body, batch); });
+
+    Result result;
+    if (cfg.counters != nullptr && cfg.counters->available()) {
+        cfg.counters->start();
+        timeBatch(body, batch);
+        auto totals = cfg.counters->stop();
+        for (std::size_t i = 0; i < kCounterCount; ++i) {
+            if (totals[i]) {
+                result.countersPerOp[i] = *totals[i] / static_cast<double>(batch);
+            }
+        }
+    }
+
+    result.name = name;
+    result.nsPerOp = median(std::move(samples));
+    result.normalized = fastestCalibration > 0 ? fastest / fastestCalibration : 0.0;
+    result.allocsPerOp = static_cast<double>(allocs.count) / static_cast<double>(batch);
+    result.bytesPerOp = static_cast<double>(allocs.bytes) / static_cast<double>(batch);
+    result.iterations = batch * static_cast<std::uint64_t>(cfg.repetitions + 1);
+    if (cfg.counters != nullptr && cfg.counters->available()) {
+        result.iterations += batch;
+    }
+    return result;
+}
+
+/// Operations completed by a group of threads over a measured interval
+struct ThreadRun {
+    std::uint64_t operations = 0;
+    double seconds = 0.0;
+
+    [[nodiscard]] double opsPerSecond() const { return seconds > 0 ? static_cast<double>(operations) / seconds : 0.0; }
+};
+
+/**
+ * Run body in a loop on `threads` threads for roughly `duration` and count
+ * completed calls. All threads start together after one warm-up call each,
+ * so one-time setup does not skew the first thread count.
+ */
+template <typename F>
+ThreadRun runThreads(unsigned threads, std::chrono::milliseconds duration, F& body) {
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::vector<std::uint64_t> counts(threads, 0);
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            body();
+            ready.fetch_add(1, std::memory_order_acq_rel);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            std::uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                body();
+                ++n;
+            }
+            counts[t] = n;
+        });
+    }
+
+    while (ready.load(std::memory_order_acquire) < threads) {
+        std::this_thread::yield();
+    }
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    ThreadRun run;
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto n : counts) {
+        run.operations += n;
+    }
+    return run;
+}
+
+/**
+ * Time the calibration workload and return its median cost in ns.
+ * Dividing benchmark timings by this value gives machine-normalized scores
+ * that can be compared against a checked-in baseline.
+ */
+inline double calibrate(int repetitions = 9) {
+    using namespace detail;
+
+    CalibrationLoop workload;
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; ++r) {
+        samples.push_back(timeBatch(workload, 16) / 16.0);
+    }
+    return median(std::move(samples));
+}
+
+}
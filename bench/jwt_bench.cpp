@@ -0,0 +1,644 @@
+#include "bench_harness.hpp"
+#include "cmd_args.hpp"
+#include "jwt/jwt.hpp"
+#include "base64url.hpp"
+#include "jwt_utils.hpp"
+#include "key_cache.hpp"
+#include "nkey_codec.hpp"
+#include <nkeys/nkeys.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+using json = nlohmann::json;
+using namespace jwt::bench;
+
+namespace {
+
+/// A small Operator -> Account -> User hierarchy shared by all benchmarks
+struct Fixture {
+    std::unique_ptr<nkeys::KeyPair> operatorKp = nkeys::CreateOperator();
+    std::unique_ptr<nkeys::KeyPair> accountKp = nkeys::CreateAccount();
+    std::unique_ptr<nkeys::KeyPair> userKp = nkeys::CreateUser();
+    std::string operatorJwt;
+    std::string accountJwt;
+    std::string userJwt;
+    std::string userPayloadB64;
+    std::vector<std::uint8_t> userPayload;
+    std::string userSigningInput;
+    std::vector<std::uint8_t> userSignature;
+    std::vector<std::string> chain;
+
+    Fixture() {
+        jwt::OperatorClaims op(operatorKp->publicString());
+        op.setName("bench-operator");
+        operatorJwt = op.encode(operatorKp->seedString());
+
+        jwt::AccountClaims acc(accountKp->publicString());
+        acc.setIssuer(operatorKp->publicString());
+        acc.setName("bench-account");
+        accountJwt = acc.encode(operatorKp->seedString());
+
+        userJwt = makeUser()->encode(accountKp->seedString());
+        userPayloadB64 = userJwt.substr(userJwt.find('.') + 1);
+        userPayloadB64.resize(userPayloadB64.find('.'));
+        userPayload = jwt::internal::base64url_decode(userPayloadB64);
+        userSigningInput = userJwt.substr(0, userJwt.rfind('.'));
+        userSignature = jwt::internal::base64url_decode(userJwt.substr(userJwt.rfind('.') + 1));
+
+        chain = {operatorJwt, accountJwt, userJwt};
+    }
+
+    [[nodiscard]] std::shared_ptr<jwt::UserClaims> makeUser() const {
+        auto user = std::make_shared<jwt::UserClaims>(userKp->publicString());
+        user->setIssuer(accountKp->publicString());
+        user->setName("bench-user");
+        user->setExpires(jwt::internal::getCurrentTimestamp() + 3600);
+        return user;
+    }
+};
+
+/// Typical per-service permission set: literal, '*' and '>' patterns plus a few denies
+jwt::Permission makePermission(int patterns) {
+    jwt::Permission permission;
+    for (int i = 0; i < patterns; ++i) {
+        std::string id = std::to_string(i);
+        switch (i % 3) {
+            case 0: permission.allow.push_back("svc." + id + ".requests"); break;
+            case 1: permission.allow.push_back("app." + id + ".*.events"); break;
+            default: permission.allow.push_back("tenant." + id + ".>"); break;
+        }
+        if (i % 50 == 0) {
+            permission.deny.push_back("tenant." + id + ".admin.>");
+        }
+    }
+    return permission;
+}
+
+struct Benchmark {
+    std::string name;
+    std::function<void()> body;
+};
+
+std::vector<Benchmark> registerBenchmarks(const Fixture& fx) {
+    std::vector<Benchmark> benchmarks;
+
+    benchmarks.push_back({"base64url_decode", [&fx]() {
+        doNotOptimize(jwt::internal::base64url_decode(fx.userPayloadB64));
+    }});
+    benchmarks.push_back({"json_parse", [&fx]() {
+        doNotOptimize(json::parse(fx.userPayload));
+    }});
+    auto issuerKey = jwt::internal::preparePublicKey(fx.accountKp->publicString());
+    benchmarks.push_back({"ed25519_verify", [&fx, issuerKey]() {
+        std::span<const std::uint8_t> input(
+            reinterpret_cast<const std::uint8_t*>(fx.userSigningInput.data()), fx.userSigningInput.size());
+        doNotOptimize(issuerKey->verify(input, fx.userSignature));
+    }});
+    // Full nkey check (base32 + type + CRC16) versus the nkeys path it replaces
+    std::string accountKey = fx.accountKp->publicString();
+    benchmarks.push_back({"nkey_checksum", [accountKey]() {
+        jwt::internal::DecodedPublicKey decoded;
+        doNotOptimize(jwt::internal::decodePublicKey(accountKey, decoded));
+    }});
+    benchmarks.push_back({"nkeys_from_public_key", [accountKey]() {
+        doNotOptimize(accountKey[0] == 'A' && nkeys::FromPublicKey(accountKey) != nullptr);
+    }});
+    std::vector<std::string> signingKeys;
+    for (int i = 0; i < 16; ++i) {
+        signingKeys.push_back(nkeys::CreateAccount()->publicString());
+    }
+    benchmarks.push_back({"nkey_checksum_bulk16", [signingKeys]() {
+        std::array<std::string_view, 16> encoded;
+        std::copy(signingKeys.begin(), signingKeys.end(), encoded.begin());
+        std::array<jwt::internal::DecodedPublicKey, 16> decoded;
+        std::array<bool, 16> ok;
+        doNotOptimize(jwt::internal::decodePublicKeys(encoded, decoded, ok));
+    }});
+    benchmarks.push_back({"decode_user", [&fx]() {
+        doNotOptimize(jwt::decodeUserClaims(fx.userJwt));
+    }});
+    benchmarks.push_back({"decode_generic", [&fx]() {
+        doNotOptimize(jwt::decode(fx.userJwt));
+    }});
+    benchmarks.push_back({"verify", [&fx]() {
+        doNotOptimize(jwt::verify(fx.userJwt));
+    }});
+    benchmarks.push_back({"validate", [&fx]() {
+        doNotOptimize(jwt::validate(fx.userJwt));
+    }});
+    benchmarks.push_back({"validate_chain", [&fx]() {
+        doNotOptimize(jwt::validateChain(fx.chain, jwt::ValidationOptions::strict()));
+    }});
+    // Match cost should stay flat as the pattern count grows 100x
+    auto smallPermission = makePermission(100);
+    auto largePermission = makePermission(10000);
+    jwt::PermissionMatcher smallMatcher(smallPermission);
+    jwt::PermissionMatcher largeMatcher(largePermission);
+    benchmarks.push_back({"permission_match_100", [smallMatcher]() {
+        doNotOptimize(smallMatcher.allows("app.94.orders.events"));
+    }});
+    benchmarks.push_back({"permission_match_10k", [largeMatcher]() {
+        doNotOptimize(largeMatcher.allows("app.9394.orders.events"));
+    }});
+    benchmarks.push_back({"permission_compile_10k", [largePermission]() {
+        doNotOptimize(jwt::PermissionMatcher(largePermission));
+    }});
+    // Import resolution across 1000 accounts with 100 exports each
+    auto registry = std::make_shared<jwt::ExportRegistry>();
+    std::vector<std::string> exporters;
+    for (int a = 0; a < 1000; ++a) {
+        std::vector<jwt::Export> exports;
+        for (int e = 0; e < 100; ++e) {
+            exports.push_back({"", "svc." + std::to_string(e) + ".*.requests", jwt::ExportType::Service, false});
+        }
+        jwt::AccountClaims account(nkeys::CreateAccount()->publicString());
+        account.setExports(std::move(exports));
+        registry->update(account);
+        exporters.push_back(account.subject());
+    }
+    jwt::Import import{"", "svc.42.eu.requests", jwt::PublicKey(exporters[500]), "", "",
+                       jwt::ExportType::Service};
+    benchmarks.push_back({"import_resolve", [registry, import]() {
+        doNotOptimize(registry->resolve(import));
+    }});
+    // Import check against 10k cached activations
+    auto activations = std::make_shared<jwt::ActivationCache>();
+    jwt::AccountClaims exporterAccount(fx.accountKp->publicString());
+    std::vector<jwt::PublicKey> importers;
+    for (int i = 0; i < 10000; ++i) {
+        jwt::ActivationClaims activation(nkeys::CreateAccount()->publicString());
+        activation.setIssuer(exporterAccount.subject());
+        activation.setImportSubject("svc.requests");
+        activation.setImportType(jwt::ExportType::Service);
+        static_cast<void>(activations->add(activation.encode(fx.accountKp->seedString()), exporterAccount));
+        importers.push_back(activation.subjectKey());
+    }
+    jwt::Import activatedImport{"", "svc.requests", exporterAccount.subjectKey(), "", "", jwt::ExportType::Service};
+    jwt::PublicKey importer = importers[5000];
+    benchmarks.push_back({"activation_authorize", [activations, activatedImport, importer]() {
+        doNotOptimize(activations->authorizes(importer, activatedImport, 0));
+    }});
+    // Auth callout: fused responder vs. decode, verify and two seed-based encodes
+    auto serverKp = std::shared_ptr<nkeys::KeyPair>(nkeys::CreateServer());
+    jwt::AuthorizationRequest calloutBody;
+    calloutBody.server.id = serverKp->publicString();
+    calloutBody.userNkey = jwt::PublicKey(nkeys::CreateUser()->publicString());
+    calloutBody.connect.username = "alice";
+    jwt::AuthorizationRequestClaims calloutClaims(serverKp->publicString());
+    calloutClaims.setRequest(calloutBody);
+    std::string calloutRequest = calloutClaims.encode(serverKp->seedString());
+    auto responder = std::make_shared<jwt::AuthorizationResponder>(jwt::Signer(fx.accountKp->seedString()));
+    benchmarks.push_back({"auth_callout_fused", [responder, calloutRequest]() {
+        doNotOptimize(responder->respond(calloutRequest, [](const jwt::AuthorizationRequestClaims& request,
+                                                            jwt::UserClaims& user) {
+            user.setName(request.request().connect.username);
+        }));
+    }});
+    std::string calloutSeed = fx.accountKp->seedString();
+    std::string calloutAccount = fx.accountKp->publicString();
+    benchmarks.push_back({"auth_callout_naive", [calloutRequest, calloutSeed, calloutAccount]() {
+        auto request = jwt::decodeAuthorizationRequestClaims(calloutRequest);
+        if (!jwt::verify(calloutRequest)) {
+            return;
+        }
+        jwt::UserClaims user(request->request().userNkey.str());
+        user.setIssuer(calloutAccount);
+        user.setName(request->request().connect.username);
+        jwt::AuthorizationResponseClaims response(user.subject());
+        response.setIssuer(calloutAccount);
+        response.setAudience(request->request().server.id);
+        response.setJwt(user.encode(calloutSeed));
+        doNotOptimize(response.encode(calloutSeed));
+    }});
+    // Generic claims: span scan without a DOM, and a re-issue that rewrites one field
+    benchmarks.push_back({"generic_claims_decode", [&fx]() {
+        doNotOptimize(jwt::decodeGenericClaims(fx.userJwt));
+    }});
+    auto reissueSigner = std::make_shared<jwt::Signer>(fx.accountKp->seedString());
+    benchmarks.push_back({"generic_claims_reissue", [&fx, reissueSigner]() {
+        auto claims = jwt::decodeGenericClaims(fx.userJwt);
+        claims->setExpires(claims->issuedAt() + 3600);
+        doNotOptimize(claims->encode(*reissueSigner));
+    }});
+    // Connect check against a user with 500 source networks, windows and types
+    jwt::ConnectionRestrictions restrictions;
+    for (int i = 0; i < 500; ++i) {
+        restrictions.src.push_back("10." + std::to_string(i / 2) + "." + std::to_string((i % 2) * 128) + ".0/17");
+        restrictions.src.push_back("2001:db8:" + std::to_string(i) + "::/48");
+    }
+    restrictions.times = {{"06:00:00", "12:00:00"}, {"13:00:00", "22:00:00"}};
+    restrictions.connectionTypes = {"STANDARD", "WEBSOCKET"};
+    jwt::ConnectionPolicy connectPolicy(restrictions);
+    auto connectV4 = *jwt::IpAddress::parse("10.200.140.7");
+    auto connectV6 = *jwt::IpAddress::parse("2001:db8:499::7");
+    benchmarks.push_back({"connect_check_v4", [connectPolicy, connectV4]() {
+        doNotOptimize(connectPolicy.allows(connectV4, jwt::ConnectionType::Standard, 600));
+    }});
+    benchmarks.push_back({"connect_check_v6", [connectPolicy, connectV6]() {
+        doNotOptimize(connectPolicy.allows(connectV6, jwt::ConnectionType::Standard, 600));
+    }});
+    // Per-message mapping among 1000 sources, with a weighted wildcard rewrite
+    std::vector<jwt::SubjectMapping> mappings;
+    for (int i = 0; i < 1000; ++i) {
+        mappings.push_back({"svc." + std::to_string(i) + ".*.>",
+                            {{"svc.v2.{{wildcard(1)}}." + std::to_string(i) + ".>", 80, ""},
+                             {"svc.canary.{{partition(4,1)}}.>", 20, ""}}});
+    }
+    auto mapper = std::make_shared<jwt::SubjectMapper>(std::move(mappings));
+    auto mapped = std::make_shared<std::string>();
+    std::uint64_t mapRandom = 0;
+    benchmarks.push_back({"subject_map", [mapper, mapped, mapRandom]() mutable {
+        mapRandom += 0x9E3779B97F4A7C15;
+        doNotOptimize(mapper->map("svc.742.eu.orders.new", mapRandom, *mapped));
+    }});
+    // Replay check of a fresh one-shot JTI (compare with verify)
+    jwt::ReplayDetector::Options replayOptions;
+    replayOptions.buckets = 4;
+    replayOptions.capacityPerBucket = 1 << 20;
+    auto replays = std::make_shared<jwt::ReplayDetector>(replayOptions);
+    auto replayNow = jwt::internal::getCurrentTimestamp();
+    auto replayJtis = std::make_shared<std::vector<std::string>>();
+    for (int i = 0; i < 1 << 16; ++i) {
+        replayJtis->push_back(jwt::internal::generateJti());
+    }
+    std::size_t replayNext = 0;
+    benchmarks.push_back({"replay_check", [replays, replayJtis, replayNow, replayNext]() mutable {
+        const auto& jti = (*replayJtis)[replayNext++ & 0xffff];
+        doNotOptimize(replays->check(jti, replayNow + 60, replayNow));
+    }});
+    // Expiry scheduling with 100k live credentials over a day, then one
+    // second of wheel time per op with the fired entries scheduled again
+    auto expiries = std::make_shared<jwt::ExpiryScheduler>(replayNow);
+    for (std::uint64_t i = 0; i < 100000; ++i) {
+        expiries->schedule(i, replayNow + static_cast<std::int64_t>((i * 7919) % 86400));
+    }
+    std::uint64_t expiryNext = 0;
+    benchmarks.push_back({"expiry_schedule_cancel", [expiries, replayNow, expiryNext]() mutable {
+        ++expiryNext;
+        auto handle = expiries->schedule(expiryNext, replayNow + static_cast<std::int64_t>(expiryNext % 86400));
+        doNotOptimize(expiries->cancel(handle));
+    }});
+    std::int64_t expiryTime = replayNow;
+    benchmarks.push_back({"expiry_advance", [expiries, expiryTime]() mutable {
+        ++expiryTime;
+        for (const auto& entry : expiries->advance(expiryTime)) {
+            expiries->schedule(entry.id, expiryTime + 86400);
+        }
+    }});
+    // Connection gate check straight from cached claims
+    jwt::AccountClaims limitedAccount(fx.accountKp->publicString());
+    jwt::AccountLimits accountLimits;
+    accountLimits.conn = 1000;
+    accountLimits.nats.subs = 100000;
+    limitedAccount.setLimits(accountLimits);
+    std::shared_ptr<const jwt::FlatClaims> cachedAccount = jwt::FlatClaims::from(limitedAccount);
+    benchmarks.push_back({"limits_check", [cachedAccount]() {
+        jwt::AccountUsage usage{5000, 999, 0, 0, 0};
+        doNotOptimize(cachedAccount->accountLimits().exhausted(usage));
+    }});
+    // Routing-policy tag filter against a claim's tags
+    jwt::TagSet claimTags{"prod", "eu", "billing", "tier-1"};
+    jwt::TagSet requiredTags{"prod", "tier-1"};
+    benchmarks.push_back({"tags_has_all", [claimTags, requiredTags]() {
+        doNotOptimize(claimTags.hasAll(requiredTags));
+    }});
+    // Permissions of a user signed by a scoped key: shared precompiled vs. per-user template
+    jwt::Permission scopePermission = makePermission(100);
+    jwt::UserScope staticScope(jwt::PublicKey("ASCOPE"), "static", {{scopePermission, {}}, {}});
+    scopePermission.allow.push_back("users.{{name()}}.>");
+    jwt::UserScope templatedScope(jwt::PublicKey("ASCOPE"), "templated", {{scopePermission, {}}, {}});
+    auto scopedUser = fx.makeUser();
+    benchmarks.push_back({"scope_resolve_static", [staticScope, scopedUser]() {
+        doNotOptimize(staticScope.resolve(*scopedUser));
+    }});
+    benchmarks.push_back({"scope_resolve_templated", [templatedScope, scopedUser]() {
+        doNotOptimize(templatedScope.resolve(*scopedUser));
+    }});
+    auto user = fx.makeUser();
+    benchmarks.push_back({"encode_user", [&fx, user]() {
+        doNotOptimize(user->encode(fx.accountKp->seedString()));
+    }});
+
+    return benchmarks;
+}
+
+const Benchmark* findBenchmark(const std::vector<Benchmark>& benchmarks, const std::string& name) {
+    for (const auto& b : benchmarks) {
+        if (b.name == name) return &b;
+    }
+    return nullptr;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+void printResult(const Result& r) {
+    std::printf("%-24s %12.1f ns/op %14.0f ops/s %8.1f allocs/op %10.0f B/op\n",
+                r.name.c_str(), r.nsPerOp, r.opsPerSecond(), r.allocsPerOp, r.bytesPerOp);
+
+    const auto& c = r.countersPerOp;
+    bool any = false;
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+        if (!c[i]) continue;
+        std::printf("%s%s %.1f", any ? "  " : "    ", counterName(static_cast<Counter>(i)), *c[i]);
+        any = true;
+    }
+    auto cycles = c[static_cast<std::size_t>(Counter::Cycles)];
+    auto instructions = c[static_cast<std::size_t>(Counter::Instructions)];
+    if (cycles && instructions && *cycles > 0) {
+        std::printf("  ipc %.2f", *instructions / *cycles);
+    }
+    if (any) {
+        std::printf("  (per op)\n");
+    }
+}
+
+json resultToJson(const Result& r, double calibrationNs) {
+    json out{
+        {"ns_per_op", r.nsPerOp},
+        {"ops_per_second", r.opsPerSecond()},
+        {"normalized", r.nsPerOp / calibrationNs},
+        {"allocs_per_op", r.allocsPerOp},
+        {"bytes_per_op", r.bytesPerOp},
+        {"iterations", r.iterations}
+    };
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+        if (r.countersPerOp[i]) {
+            out["counters_per_op"][counterName(static_cast<Counter>(i))] = *r.countersPerOp[i];
+        }
+    }
+    return out;
+}
+
+/**
+ * Measurement settings for the gate and for re-baselining: many short
+ * repetitions, each next to a calibration run, so that the fastest sample on
+ * each side comes from a quiet stretch of a shared host
+ */
+RunConfig gateConfig(RunConfig cfg) {
+    cfg.normalize = true;
+    cfg.repetitions = 20;
+    cfg.minTime = std::max(cfg.minTime, std::chrono::milliseconds(400));
+    return cfg;
+}
+
+/**
+ * Compare the benchmarks listed in a baseline file against the current build.
+ * Timings are divided by the calibration loop, run alongside each repetition,
+ * so the stored numbers transfer between machines; a benchmark fails when its
+ * normalized cost exceeds baseline * (1 + tolerance) or when it allocates more
+ * per operation.
+ */
+int runGate(const std::vector<Benchmark>& benchmarks, const std::string& baselinePath,
+            const RunConfig& runCfg) {
+    json baseline = json::parse(readFile(baselinePath));
+    double defaultTolerance = baseline.value("default_tolerance", 0.5);
+    RunConfig cfg = gateConfig(runCfg);
+
+    std::printf("%-24s %12s %12s %12s %10s %10s  %s\n",
+                "benchmark", "ops/s", "normalized", "baseline", "allocs/op", "baseline", "status");
+
+    int failures = 0;
+    for (const auto& [name, entry] : baseline.at("benchmarks").items()) {
+        const Benchmark* bench = findBenchmark(benchmarks, name);
+        if (bench == nullptr) {
+            std::printf("%-24s missing from this build\n", name.c_str());
+            ++failures;
+            continue;
+        }
+
+        Result r = run(name, bench->body, cfg);
+        double normalized = r.normalized;
+        double tolerance = entry.value("tolerance", defaultTolerance);
+        double baseNormalized = entry.at("normalized").get<double>();
+        double baseAllocs = entry.at("allocs_per_op").get<double>();
+
+        bool slow = normalized > baseNormalized * (1.0 + tolerance);
+        bool allocs = r.allocsPerOp > baseAllocs + 0.5;
+        const char* status = slow ? (allocs ? "FAIL (time, allocs)" : "FAIL (time)")
+                                  : (allocs ? "FAIL (allocs)" : "ok");
+        if (slow || allocs) ++failures;
+
+        std::printf("%-24s %12.0f %12.3f %12.3f %10.1f %10.1f  %s\n",
+                    name.c_str(), r.opsPerSecond(), normalized, baseNormalized,
+                    r.allocsPerOp, baseAllocs, status);
+    }
+
+    std::printf("\n%s: %d regression(s)\n", failures ? "FAILED" : "PASSED", failures);
+    return failures ? 1 : 0;
+}
+
+/**
+ * Re-measure the benchmarks listed in a baseline file (all, if it is empty) and
+ * rewrite it. Samples as long as the gate's but three times as many, so the
+ * stored minimum is less likely to come from a loaded stretch.
+ */
+int updateBaseline(const std::vector<Benchmark>& benchmarks, const std::string& baselinePath,
+                   const RunConfig& runCfg) {
+    json baseline = json::object();
+    try {
+        baseline = json::parse(readFile(baselinePath));
+    } catch (const std::exception&) {
+        baseline["default_tolerance"] = 0.5;
+    }
+
+    RunConfig cfg = gateConfig(runCfg);
+    cfg.repetitions *= 3;
+    cfg.minTime *= 3;
+    json& entries = baseline["benchmarks"];
+    for (const auto& bench : benchmarks) {
+        if (!entries.empty() && !entries.contains(bench.name)) continue;
+        Result r = run(bench.name, bench.body, cfg);
+        printResult(r);
+        json& entry = entries[bench.name];
+        entry["normalized"] = r.normalized;
+        entry["allocs_per_op"] = std::round(r.allocsPerOp);
+    }
+
+    std::ofstream out(baselinePath);
+    if (!out) {
+        throw std::runtime_error("Cannot write to file: " + baselinePath);
+    }
+    out << baseline.dump(2) << "\n";
+    std::cerr << "Baseline written to: " << baselinePath << "\n";
+    return 0;
+}
+
+/// 1, 2, 4, ... up to and including maxThreads
+std::vector<unsigned> threadCounts(unsigned maxThreads) {
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+/**
+ * Run verify, validate and validateChain on 1..maxThreads threads with the
+ * key cache enabled and disabled. Efficiency is throughput relative to
+ * perfect linear scaling of the single-thread run; the lock columns show
+ * how often internal locks were contended during each run.
+ */
+int runScalability(const std::vector<Benchmark>& benchmarks, unsigned maxThreads,
+                   const RunConfig& cfg, const std::optional<std::string>& jsonPath) {
+    json report = json::array();
+    std::printf("%-16s %-6s %8s %14s %14s %10s  %s\n",
+                "benchmark", "cache", "threads", "ops/s", "ops/s/thread", "efficiency", "locks (contended/acquired, wait)");
+
+    for (const char* name : {"verify", "validate", "validate_chain"}) {
+        const Benchmark* bench = findBenchmark(benchmarks, name);
+        if (bench == nullptr) continue;
+
+        for (bool cached : {true, false}) {
+            jwt::setKeyCacheCapacity(cached ? jwt::DEFAULT_KEY_CACHE_CAPACITY : 0);
+            jwt::clearKeyCache();
+
+            double singleThread = 0.0;
+            for (unsigned threads : threadCounts(maxThreads)) {
+                jwt::resetLockStats();
+                ThreadRun run = runThreads(threads, cfg.minTime, bench->body);
+                auto locks = jwt::lockStats();
+
+                double throughput = run.opsPerSecond();
+                if (threads == 1) singleThread = throughput;
+                double efficiency = singleThread > 0 ? throughput / (singleThread * threads) : 0.0;
+
+                std::string lockSummary;
+                json lockJson = json::object();
+                for (const auto& lock : locks) {
+                    if (lock.acquisitions == 0) continue;
+                    char buf[160];
+                    std::snprintf(buf, sizeof(buf), "%s%s %llu/%llu %.2fms", lockSummary.empty() ? "" : ", ",
+                                  lock.name.c_str(), static_cast<unsigned long long>(lock.contended),
+                                  static_cast<unsigned long long>(lock.acquisitions), lock.waitNanos / 1e6);
+                    lockSummary += buf;
+                    lockJson[lock.name] = {{"acquisitions", lock.acquisitions},
+                                           {"contended", lock.contended},
+                                           {"wait_ns", lock.waitNanos}};
+                }
+
+                std::printf("%-16s %-6s %8u %14.0f %14.0f %9.0f%%  %s\n",
+                            name, cached ? "on" : "off", threads, throughput,
+                            throughput / threads, efficiency * 100.0, lockSummary.c_str());
+                report.push_back({{"benchmark", name}, {"cache", cached}, {"threads", threads},
+                                  {"ops_per_second", throughput},
+                                  {"ops_per_second_per_thread", throughput / threads},
+                                  {"efficiency", efficiency}, {"locks", lockJson}});
+            }
+        }
+    }
+    jwt::setKeyCacheCapacity(jwt::DEFAULT_KEY_CACHE_CAPACITY);
+
+    if (jsonPath) {
+        std::ofstream out(*jsonPath);
+        if (!out) {
+            throw std::runtime_error("Cannot write to file: " + *jsonPath);
+        }
+        out << json{{"scalability", report}}.dump(2) << "\n";
+    }
+    return 0;
+}
+
+void printUsage() {
+    std::cerr << R"(jwt_bench - jwt-cpp micro benchmarks
+
+Usage: jwt_bench [options]
+
+Options:
+    --filter <text>             Only run benchmarks whose name contains <text>
+    --min-time <ms>             Measured time per benchmark (default: 200)
+    --json <file>               Also write results as JSON
+    --counters                  Report hardware counters per op (Linux perf_event_open)
+    --scalability               Run verify/validate/validate_chain on 1..N threads,
+                                with and without the key cache, and report lock contention
+    --threads <n>               Maximum threads for --scalability (default: all cores)
+    --gate <baseline.json>      Compare against a baseline; exit 1 on regression
+    --update-baseline <file>    Re-measure and rewrite a baseline file
+)";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        auto args = cmd_args::parse(argc, argv);
+        if (args.get("help").has_value() || args.get("h").has_value()) {
+            printUsage();
+            return 0;
+        }
+
+        RunConfig cfg;
+        if (auto ms = args.get("min-time")) {
+            cfg.minTime = std::chrono::milliseconds(std::stol(*ms));
+        }
+
+        std::unique_ptr<PerfCounters> counters;
+        if (args.get("counters").has_value()) {
+            counters = std::make_unique<PerfCounters>();
+            if (!counters->available()) {
+                std::cerr << "Hardware counters unavailable (" << counters->error()
+                          << "); reporting timings only\n";
+            } else if (!counters->error().empty()) {
+                std::cerr << "Some hardware counters unavailable (" << counters->error() << ")\n";
+            }
+            cfg.counters = counters.get();
+        }
+
+        Fixture fixture;
+        auto benchmarks = registerBenchmarks(fixture);
+
+        if (auto path = args.get("gate")) {
+            return runGate(benchmarks, *path, cfg);
+        }
+        if (auto path = args.get("update-baseline")) {
+            return updateBaseline(benchmarks, *path, cfg);
+        }
+        if (args.get("scalability").has_value()) {
+            unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+            if (auto n = args.get("threads")) {
+                maxThreads = static_cast<unsigned>(std::max(1L, std::stol(*n)));
+            }
+            return runScalability(benchmarks, maxThreads, cfg, args.get("json"));
+        }
+
+        auto filter = args.get("filter").value_or("");
+        double calibrationNs = calibrate();
+        json report = {{"calibration_ns", calibrationNs}, {"benchmarks", json::object()}};
+
+        for (const auto& bench : benchmarks) {
+            if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+            Result r = run(bench.name, bench.body, cfg);
+            printResult(r);
+            report["benchmarks"][bench.name] = resultToJson(r, calibrationNs);
+        }
+
+        if (auto path = args.get("json")) {
+            std::ofstream out(*path);
+            if (!out) {
+                throw std::runtime_error("Cannot write to file: " + *path);
+            }
+            out << report.dump(2) << "\n";
+        }
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace jwt::bench {
+
+/// Hardware events read around each benchmark
+enum class Counter : std::size_t {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1DMisses,
+    LLCMisses,
+    Count
+};
+
+inline constexpr std::size_t kCounterCount = static_cast<std::size_t>(Counter::Count);
+
+inline const char* counterName(Counter counter) {
+    switch (counter) {
+        case Counter::Cycles: return "cycles";
+        case Counter::Instructions: return "instructions";
+        case Counter::BranchMisses: return "branch_misses";
+        case Counter::L1DMisses: return "l1d_misses";
+        case Counter::LLCMisses: return "llc_misses";
+        default: return "unknown";
+    }
+}
+
+/// One reading per counter; empty where the counter could not be opened
+using CounterValues = std::array<std::optional<double>, kCounterCount>;
+
+/**
+ * User-space hardware counters for the calling thread via perf_event_open.
+ * Each event is opened on its own so a host that lacks one (common in VMs)
+ * still reports the others; if none open, available() is false and reads
+ * return empty values. Readings are scaled for multiplexing.
+ */
+class PerfCounters {
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        for (std::size_t i = 0; i < kCounterCount; ++i) {
+            fds_[i] = open(static_cast<Counter>(i));
+            if (fds_[i] >= 0) {
+                ++opened_;
+            } else if (error_.empty()) {
+                error_ = std::string(counterName(static_cast<Counter>(i))) + ": " + std::strerror(errno);
+            }
+        }
+#else
+        error_ = "perf_event_open is only available on Linux";
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /// True if at least one counter is usable
+    [[nodiscard]] bool available() const { return opened_ > 0; }
+
+    /// Why the first unavailable counter failed to open (empty if all opened)
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+    /// Reset and enable all open counters
+    void start() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /// Disable the counters and return the values counted since start()
+    CounterValues stop() {
+        CounterValues values{};
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (std::size_t i = 0; i < kCounterCount; ++i) {
+            if (fds_[i] < 0) continue;
+            std::uint64_t data[3] = {};  // value, time enabled, time running
+            if (::read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) {
+                continue;
+            }
+            values[i] = static_cast<double>(data[0]) *
+                        (static_cast<double>(data[1]) / static_cast<double>(data[2]));
+        }
+#endif
+        return values;
+    }
+
+private:
+#if defined(__linux__)
+    static int open(Counter counter) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        auto cacheMiss = [](std::uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+
+        switch (counter) {
+            case Counter::Cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case Counter::Instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case Counter::BranchMisses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case Counter::L1DMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cacheMiss(PERF_COUNT_HW_CACHE_L1D);
+                break;
+            case Counter::LLCMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cacheMiss(PERF_COUNT_HW_CACHE_LL);
+                break;
+            default:
+                errno = EINVAL;
+                return -1;
+        }
+
+        // pid 0, cpu -1: this thread on any CPU
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    std::array<int, kCounterCount> fds_ = [] {
+        std::array<int, kCounterCount> fds{};
+        fds.fill(-1);
+        return fds;
+    }();
+#endif
+    std::size_t opened_ = 0;
+    std::string error_;
+};
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "alloc_tracker.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+namespace jwt::fuzz {
+
+/**
+ * Linear cost budget: an input of n bytes may take at most
+ * fixedNanos + nanosPerByte * n and allocate at most
+ * fixedBytes + bytesPerByte * n. The time defaults allow about 6 ms for a
+ * 4 KB input: linear paths stay under 200 ns/byte (the worst are deeply
+ * nested JSON and tens of KB of revocations), while a quadratic scan at 1 ns
+ * per byte pair already takes 16 ms at that size. ASan slows every path by
+ * up to 10x, so its builds scale both time terms by ASAN_SLOWDOWN. Override
+ * with JWT_FUZZ_NS_PER_BYTE, JWT_FUZZ_FIXED_NS, JWT_FUZZ_BYTES_PER_BYTE and
+ * JWT_FUZZ_FIXED_BYTES.
+ */
+struct LinearBudget {
+    static constexpr double ASAN_SLOWDOWN = 10.0;
+#if defined(__SANITIZE_ADDRESS__)
+    static constexpr double slowdown = ASAN_SLOWDOWN;
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+    static constexpr double slowdown = ASAN_SLOWDOWN;
+#else
+    static constexpr double slowdown = 1.0;
+#endif
+#else
+    static constexpr double slowdown = 1.0;
+#endif
+
+    double nanosPerByte = 1000.0 * slowdown;
+    double fixedNanos = 2e6 * slowdown;
+    double bytesPerByte = 128.0;
+    double fixedBytes = 256.0 * 1024;
+
+    [[nodiscard]] double nanosFor(std::size_t size) const {
+        return fixedNanos + nanosPerByte * static_cast<double>(size);
+    }
+    [[nodiscard]] double bytesFor(std::size_t size) const {
+        return fixedBytes + bytesPerByte * static_cast<double>(size);
+    }
+};
+
+namespace detail {
+    inline double envOr(const char* name, double fallback) {
+        const char* value = std::getenv(name);
+        if (value == nullptr || *value == '\0') return fallback;
+        char* end = nullptr;
+        double parsed = std::strtod(value, &end);
+        return end != value ? parsed : fallback;
+    }
+}
+
+/// Budget from the defaults and any JWT_FUZZ_* environment overrides (read once)
+inline const LinearBudget& budget() {
+    static const LinearBudget instance = [] {
+        LinearBudget b;
+        b.nanosPerByte = detail::envOr("JWT_FUZZ_NS_PER_BYTE", b.nanosPerByte);
+        b.fixedNanos = detail::envOr("JWT_FUZZ_FIXED_NS", b.fixedNanos);
+        b.bytesPerByte = detail::envOr("JWT_FUZZ_BYTES_PER_BYTE", b.bytesPerByte);
+        b.fixedBytes = detail::envOr("JWT_FUZZ_FIXED_BYTES", b.fixedBytes);
+        return b;
+    }();
+    return instance;
+}
+
+/**
+ * Run body once over an input of `size` bytes and abort (so the fuzzer saves
+ * the input) if it exceeds the linear budget. Time is process CPU time, so a
+ * run that is descheduled part way through is not charged for the wait.
+ */
+template <typename F>
+void checkLinear(const char* target, std::size_t size, F&& body) {
+    const auto& b = budget();
+
+    std::clock_t start = 0;
+    std::clock_t end = 0;
+    auto allocs = jwt::testing::countAllocations([&]() {
+        start = std::clock();
+        body();
+        end = std::clock();
+    });
+    double nanos = static_cast<double>(end - start) * 1e9 / CLOCKS_PER_SEC;
+
+    bool slow = nanos > b.nanosFor(size);
+    bool heavy = static_cast<double>(allocs.bytes) > b.bytesFor(size);
+    if (slow || heavy) {
+        std::fprintf(stderr,
+                     "==jwt-fuzz== %s: superlinear cost for %zu input bytes: "
+                     "%.0f ns (budget %.0f, %.1f ns/byte), "
+                     "%llu bytes in %llu allocations (budget %.0f, %.1f bytes/byte)\n",
+                     target, size, nanos, b.nanosFor(size),
+                     size ? nanos / static_cast<double>(size) : 0.0,
+                     static_cast<unsigned long long>(allocs.bytes),
+                     static_cast<unsigned long long>(allocs.count), b.bytesFor(size),
+                     size ? static_cast<double>(allocs.bytes) / static_cast<double>(size) : 0.0);
+        std::abort();
+    }
+}
+
+/// Fuzzer bytes as a string (the library API takes std::string)
+inline std::string toString(const std::uint8_t* data, std::size_t size) {
+    return std::string(reinterpret_cast<const char*>(data), size);
+}
+
+}
@@ -0,0 +1,29 @@
+// libFuzzer target: jwt::validateChain over newline-separated tokens must stay linear
+#include "jwt/jwt.hpp"
+#include "fuzz_budget.hpp"
+#include <vector>
+
+namespace {
+    // Longer chains only repeat work per link; capping keeps the input space dense
+    constexpr std::size_t kMaxChainLength = 8;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    std::string input = jwt::fuzz::toString(data, size);
+
+    jwt::fuzz::checkLinear("validate_chain", size, [&]() {
+        std::vector<std::string> chain;
+        std::size_t start = 0;
+        while (start <= input.size() && chain.size() < kMaxChainLength) {
+            auto end = input.find('\n', start);
+            if (end == std::string::npos) end = input.size();
+            chain.push_back(input.substr(start, end - start));
+            start = end + 1;
+        }
+
+        jwt::ValidationOptions opts;
+        opts.checkIssuerChain = true;
+        (void)jwt::validateChain(chain, opts);
+    });
+    return 0;
+}
@@ -0,0 +1,16 @@
+// libFuzzer target: jwt::verify must reject or accept any input in linear time and memory
+#include "jwt/jwt.hpp"
+#include "fuzz_budget.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    std::string input = jwt::fuzz::toString(data, size);
+
+    jwt::fuzz::checkLinear("verify", size, [&]() {
+        try {
+            (void)jwt::verify(input);
+        } catch (const std::exception&) {
+            // Rejection is fine; only crashes and superlinear cost are findings
+        }
+    });
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Replays corpus files through a fuzz target when libFuzzer is unavailable
+// (e.g. GCC builds), so the seed corpus still runs as a regression test.
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+namespace {
+    namespace fs = std::filesystem;
+
+    bool runFile(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Cannot open file: %s\n", path.string().c_str());
+            return false;
+        }
+        std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t inputs = 0;
+    for (int i = 1; i < argc; ++i) {
+        fs::path path(argv[i]);
+        if (!path.empty() && path.string()[0] == '-') {
+            continue;  // libFuzzer flags such as -runs=0 are accepted and ignored
+        }
+        if (fs::is_directory(path)) {
+            for (const auto& entry : fs::recursive_directory_iterator(path)) {
+                if (!entry.is_regular_file()) continue;
+                if (!runFile(entry.path())) return 1;
+                ++inputs;
+            }
+        } else {
+            if (!runFile(path)) return 1;
+            ++inputs;
+        }
+    }
+    std::printf("Replayed %zu input(s)\n", inputs);
+    return 0;
+}
@@ -1,31 +1,107 @@
 #pragma once
 #include "jwt/claims.hpp"
+#include "jwt/exports.hpp"
+#include "jwt/subject_mapping.hpp"
+#include "jwt/limits.hpp"
+#include "jwt/signer.hpp"
+#include "jwt/user_scope.hpp"
+#include <map>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace jwt {
 
+class UserClaims;
+
 /// Account-level claims (middle of trust hierarchy)
 class AccountClaims : public Claims {
 public:
     /// Create account claims with the given public key
-    explicit AccountClaims(const std::string& accountPublicKey);
+    explicit AccountClaims(std::string_view accountPublicKey);
     ~AccountClaims() override;
 
+    /// Copies are deep; a moved-from object may only be assigned to or destroyed
+    AccountClaims(const AccountClaims& other);
+    AccountClaims(AccountClaims&& other) noexcept;
+    AccountClaims& operator=(const AccountClaims& other);
+    AccountClaims& operator=(AccountClaims&& other) noexcept;
+
     // Claims interface
     [[nodiscard]] std::string subject() const override;
     [[nodiscard]] std::string issuer() const override;
+    [[nodiscard]] const PublicKey& subjectKey() const override;
+    [[nodiscard]] const PublicKey& issuerKey() const override;
     [[nodiscard]] std::optional<std::string> name() const override;
     [[nodiscard]] std::int64_t issuedAt() const override;
     [[nodiscard]] std::int64_t expires() const override;
+    [[nodiscard]] const TagSet& tags() const override;
     [[nodiscard]] std::string encode(const std::string& seed) const override;
     void validate() const override;
 
+    /// Encode with a pre-decoded signing key (see Signer)
+    [[nodiscard]] std::string encode(const Signer& signer) const;
+
     // Account-specific
-    void setName(const std::string& name);
+    void setName(std::string name);
     void setExpires(std::int64_t exp);
-    void setIssuer(const std::string& issuerKey);
-    void addSigningKey(const std::string& publicKey);
+    void setTags(TagSet tags);
+    void addTag(std::string_view tag);  // Trimmed and lower-cased; blank tags are ignored
+    void setIssuer(std::string_view issuerKey);
+    void addSigningKey(std::string_view publicKey);
+    void addSigningKey(PublicKey publicKey);
+    void setSigningKeys(std::vector<std::string>&& publicKeys);  // Replaces all keys and scopes, interned as one batch
+    void setSigningKeys(std::vector<PublicKey> publicKeys);       // Replaces all keys and scopes
     [[nodiscard]] const std::vector<std::string>& signingKeys() const;
+    [[nodiscard]] const std::vector<PublicKey>& signingKeyHandles() const;  // Same keys, interned
+
+    /// Add a signing key whose users get the scope's permissions and limits
+    void addScopedSigningKey(UserScope scope);
+
+    /// Scope of a signing key (nullptr for unscoped keys and unknown keys)
+    [[nodiscard]] const UserScope* scopeFor(const PublicKey& signingKey) const;
+
+    /**
+     * Compiled permissions in effect for a user of this account: the scope's
+     * if the user was signed by a scoped key, otherwise the user's own.
+     * Returned by value: the matchers are shared handles, so this allocates nothing.
+     * @throws std::invalid_argument if the scope's template cannot be filled for the user
+     */
+    [[nodiscard]] ResolvedPermissions userPermissions(const UserClaims& user) const;
+
+    /// Revoke user JWTs for the key issued at or before timestamp ("*" = all users)
+    void addRevocation(std::string_view publicKey, std::int64_t timestamp);
+    [[nodiscard]] const std::map<std::string, std::int64_t>& revocations() const;
+    [[nodiscard]] const std::unordered_map<PublicKey, std::int64_t>& revocationKeys() const;  // Same entries, interned
+
+    /// True if a user JWT for the key issued at issuedAt has been revoked
+    [[nodiscard]] bool isRevoked(const PublicKey& publicKey, std::int64_t issuedAt) const;
+    [[nodiscard]] bool isRevoked(std::string_view publicKey, std::int64_t issuedAt) const;
+
+    /**
+     * Set exports and build their subject index
+     * @throws std::invalid_argument if an export subject is malformed
+     */
+    void setExports(std::vector<Export> exports);
+    [[nodiscard]] const std::vector<Export>& exports() const;
+    [[nodiscard]] const ExportIndex& exportIndex() const;  // Built once when exports are set or decoded
+
+    void setImports(std::vector<Import> imports);
+    [[nodiscard]] const std::vector<Import>& imports() const;
+    [[nodiscard]] std::shared_ptr<const std::vector<Import>> sharedImports() const;  // Null if none
+
+    /**
+     * Set subject mappings and compile them (for no particular cluster)
+     * @throws std::invalid_argument if a mapping is malformed
+     */
+    void setMappings(std::vector<SubjectMapping> mappings);
+    [[nodiscard]] const std::vector<SubjectMapping>& mappings() const;
+    [[nodiscard]] const SubjectMapper& subjectMapper() const;  // Built once when mappings are set or decoded
+
+    /// Account limits (NATS "limits"; everything unlimited and JetStream off by default)
+    void setLimits(const AccountLimits& limits);
+    [[nodiscard]] const AccountLimits& limits() const;
 
 private:
     friend std::unique_ptr<AccountClaims> decodeAccountClaims(const std::string&);
@@ -0,0 +1,92 @@
+#pragma once
+#include "jwt/exports.hpp"
+#include "jwt/public_key.hpp"
+#include "jwt/validation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace jwt {
+
+class AccountClaims;
+
+/// Import grant taken from a verified activation token
+struct Activation {
+    PublicKey exporter;
+    ExportType type = ExportType::Stream;
+    std::int64_t expires = 0;  // Unix seconds, 0 = never
+
+    friend bool operator==(const Activation&, const Activation&) = default;
+};
+
+/**
+ * Thread-safe cache of verified activation tokens, keyed by
+ * (importing account, exporting account, activated subject).
+ *
+ * Tokens are decoded and their signatures verified once, in add(); after
+ * that an import check is a single hash lookup plus an expiry compare, with
+ * no allocation. Entries stay until they expire (see purgeExpired()) or are
+ * replaced by a newer activation for the same key.
+ */
+class ActivationCache {
+public:
+    ActivationCache();
+    ~ActivationCache();
+
+    ActivationCache(const ActivationCache&) = delete;
+    ActivationCache& operator=(const ActivationCache&) = delete;
+
+    /**
+     * Verify an activation token and cache it
+     * @param token Activation JWT
+     * @param exporter Account whose export is activated; the token must be
+     *        issued by it or by one of its signing keys
+     * @param opts Timing options (signature is always checked)
+     * @return Failure if the token is malformed, badly signed, expired or
+     *         not issued by the exporter
+     */
+    ValidationResult add(const std::string& token, const AccountClaims& exporter,
+                         const ValidationOptions& opts = ValidationOptions{});
+
+    /**
+     * Cached activation of a subject for an importer
+     * @param importer Importing account
+     * @param exporter Exporting account that issued the activation
+     * @param subject Subject exactly as activated (the import's subject)
+     * @param now Unix seconds; expired entries are not returned
+     */
+    [[nodiscard]] std::optional<Activation> find(const PublicKey& importer, const PublicKey& exporter,
+                                                 std::string_view subject, std::int64_t now) const;
+
+    /**
+     * Check an import against the cache: a live activation for the import's
+     * subject, from the import's exporting account, for the same export type
+     * @param importer Importing account
+     * @param import Import to authorize
+     * @param now Unix seconds
+     */
+    [[nodiscard]] bool authorizes(const PublicKey& importer, const Import& import, std::int64_t now) const;
+
+    /// authorizes() at the current time
+    [[nodiscard]] bool authorizes(const PublicKey& importer, const Import& import) const;
+
+    /// Forget an activation
+    /// @return true if it was cached
+    bool remove(const PublicKey& importer, const PublicKey& exporter, std::string_view subject);
+
+    /// Drop entries that expired before now
+    /// @return Number of entries dropped
+    std::size_t purgeExpired(std::int64_t now);
+
+    /// Number of cached activations (including expired ones not yet purged)
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
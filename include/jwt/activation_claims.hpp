@@ -0,0 +1,73 @@
+#pragma once
+#include "jwt/claims.hpp"
+#include "jwt/exports.hpp"
+#include "jwt/signer.hpp"
+#include <string_view>
+#include <optional>
+
+namespace jwt {
+
+/**
+ * Activation claims: an exporting account's grant that lets one importing
+ * account import a token-required export. The subject is the importing
+ * account; the issuer is the exporting account or one of its signing keys
+ * (then issuer_account names the exporting account).
+ */
+class ActivationClaims : public Claims {
+public:
+    /// Create activation claims for the given importing account
+    explicit ActivationClaims(std::string_view importerPublicKey);
+    ~ActivationClaims() override;
+
+    /// Copies are deep; a moved-from object may only be assigned to or destroyed
+    ActivationClaims(const ActivationClaims& other);
+    ActivationClaims(ActivationClaims&& other) noexcept;
+    ActivationClaims& operator=(const ActivationClaims& other);
+    ActivationClaims& operator=(ActivationClaims&& other) noexcept;
+
+    // Claims interface
+    [[nodiscard]] std::string subject() const override;
+    [[nodiscard]] std::string issuer() const override;
+    [[nodiscard]] const PublicKey& subjectKey() const override;
+    [[nodiscard]] const PublicKey& issuerKey() const override;
+    [[nodiscard]] std::optional<std::string> name() const override;
+    [[nodiscard]] std::int64_t issuedAt() const override;
+    [[nodiscard]] std::int64_t expires() const override;
+    [[nodiscard]] const TagSet& tags() const override;
+    [[nodiscard]] std::string encode(const std::string& seed) const override;
+    void validate() const override;
+
+    /// Encode with a pre-decoded signing key (see Signer)
+    [[nodiscard]] std::string encode(const Signer& signer) const;
+
+    // Activation-specific
+    void setName(std::string name);
+    void setExpires(std::int64_t exp);
+    void setTags(TagSet tags);
+    void addTag(std::string_view tag);  // Trimmed and lower-cased; blank tags are ignored
+    void setIssuer(std::string_view issuerKey);
+    void setIssuerAccount(std::string_view accountPublicKey);
+    [[nodiscard]] std::optional<std::string> issuerAccount() const;
+    [[nodiscard]] const PublicKey& issuerAccountKey() const;  // Empty if not set
+
+    /// Exporting account: issuer_account if set, otherwise the issuer
+    [[nodiscard]] const PublicKey& exporterKey() const;
+
+    /// Subject being activated, in the exporting account (may contain wildcards)
+    void setImportSubject(std::string subject);
+    [[nodiscard]] const std::string& importSubject() const;
+
+    /// Kind of export being activated (NATS "kind")
+    void setImportType(ExportType type);
+    [[nodiscard]] ExportType importType() const;
+
+private:
+    friend std::unique_ptr<ActivationClaims> decodeActivationClaims(const std::string&);
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Decode an activation JWT
+[[nodiscard]] std::unique_ptr<ActivationClaims> decodeActivationClaims(const std::string& jwt);
+
+}
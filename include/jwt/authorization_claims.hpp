@@ -0,0 +1,222 @@
+#pragma once
+#include "jwt/claims.hpp"
+#include "jwt/signer.hpp"
+#include "jwt/user_claims.hpp"
+#include "jwt/validation.hpp"
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <optional>
+#include <vector>
+
+namespace jwt {
+
+/// Audience of every authorization request
+inline constexpr const char* AUTH_REQUEST_AUDIENCE = "nats-authorization-request";
+
+/// Server that sent an authorization request (NATS "server_id")
+struct ServerId {
+    std::string name;
+    std::string host;
+    std::string id;  // Server public key
+    std::string version;
+    std::string cluster;
+    std::vector<std::string> tags;
+    std::string xkey;
+
+    friend bool operator==(const ServerId&, const ServerId&) = default;
+};
+
+/// Connecting client as seen by the server (NATS "client_info")
+struct ClientInformation {
+    std::string host;
+    std::uint64_t id = 0;
+    std::string user;
+    std::string name;
+    std::vector<std::string> tags;
+    std::string nameTag;
+    std::string kind;
+    std::string type;
+    std::string mqttId;
+    std::string nonce;
+
+    friend bool operator==(const ClientInformation&, const ClientInformation&) = default;
+};
+
+/// Credentials and options from the client's CONNECT (NATS "connect_opts")
+struct ConnectOptions {
+    std::string jwt;
+    std::string nkey;
+    std::string signedNonce;  // "sig"
+    std::string token;        // "auth_token"
+    std::string username;     // "user"
+    std::string password;     // "pass"
+    std::string name;
+    std::string lang;
+    std::string version;
+    int protocol = 0;
+
+    friend bool operator==(const ConnectOptions&, const ConnectOptions&) = default;
+};
+
+/// Body of an authorization request
+struct AuthorizationRequest {
+    ServerId server;
+    PublicKey userNkey;  // Key the server assigned to the connection
+    ClientInformation client;
+    ConnectOptions connect;
+    std::string requestNonce;
+
+    friend bool operator==(const AuthorizationRequest&, const AuthorizationRequest&) = default;
+};
+
+class AuthorizationRequestClaims;
+
+namespace internal {
+    struct JwtParts;
+    std::unique_ptr<AuthorizationRequestClaims> decodeAuthorizationRequest(const JwtParts& parts);
+}
+
+/**
+ * Authorization request claims, sent by a server (subject and issuer are the
+ * server's key) to an auth callout service for each connecting client
+ */
+class AuthorizationRequestClaims : public Claims {
+public:
+    /// Create request claims for the given server key (self-signed)
+    explicit AuthorizationRequestClaims(std::string_view serverPublicKey);
+    ~AuthorizationRequestClaims() override;
+
+    /// Copies are deep; a moved-from object may only be assigned to or destroyed
+    AuthorizationRequestClaims(const AuthorizationRequestClaims& other);
+    AuthorizationRequestClaims(AuthorizationRequestClaims&& other) noexcept;
+    AuthorizationRequestClaims& operator=(const AuthorizationRequestClaims& other);
+    AuthorizationRequestClaims& operator=(AuthorizationRequestClaims&& other) noexcept;
+
+    // Claims interface
+    [[nodiscard]] std::string subject() const override;
+    [[nodiscard]] std::string issuer() const override;
+    [[nodiscard]] const PublicKey& subjectKey() const override;
+    [[nodiscard]] const PublicKey& issuerKey() const override;
+    [[nodiscard]] std::optional<std::string> name() const override;
+    [[nodiscard]] std::int64_t issuedAt() const override;
+    [[nodiscard]] std::int64_t expires() const override;
+    [[nodiscard]] const TagSet& tags() const override;
+    [[nodiscard]] std::string encode(const std::string& seed) const override;
+    void validate() const override;
+
+    /// Encode with a pre-decoded signing key (see Signer)
+    [[nodiscard]] std::string encode(const Signer& signer) const;
+
+    // Request-specific
+    void setName(std::string name);
+    void setExpires(std::int64_t exp);
+    void setTags(TagSet tags);
+    void setRequest(AuthorizationRequest request);
+    [[nodiscard]] const AuthorizationRequest& request() const;
+
+private:
+    friend std::unique_ptr<AuthorizationRequestClaims> internal::decodeAuthorizationRequest(const internal::JwtParts&);
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * Authorization response claims, returned by the callout service: subject is
+ * the connection's user nkey, audience the requesting server, and the body
+ * either a user JWT or an error
+ */
+class AuthorizationResponseClaims : public Claims {
+public:
+    /// Create response claims for the given user nkey
+    explicit AuthorizationResponseClaims(std::string_view userNkey);
+    ~AuthorizationResponseClaims() override;
+
+    /// Copies are deep; a moved-from object may only be assigned to or destroyed
+    AuthorizationResponseClaims(const AuthorizationResponseClaims& other);
+    AuthorizationResponseClaims(AuthorizationResponseClaims&& other) noexcept;
+    AuthorizationResponseClaims& operator=(const AuthorizationResponseClaims& other);
+    AuthorizationResponseClaims& operator=(AuthorizationResponseClaims&& other) noexcept;
+
+    // Claims interface
+    [[nodiscard]] std::string subject() const override;
+    [[nodiscard]] std::string issuer() const override;
+    [[nodiscard]] const PublicKey& subjectKey() const override;
+    [[nodiscard]] const PublicKey& issuerKey() const override;
+    [[nodiscard]] std::optional<std::string> name() const override;
+    [[nodiscard]] std::int64_t issuedAt() const override;
+    [[nodiscard]] std::int64_t expires() const override;
+    [[nodiscard]] const TagSet& tags() const override;
+    [[nodiscard]] std::string encode(const std::string& seed) const override;
+    void validate() const override;
+
+    /// Encode with a pre-decoded signing key (see Signer)
+    [[nodiscard]] std::string encode(const Signer& signer) const;
+
+    // Response-specific
+    void setExpires(std::int64_t exp);
+    void setIssuer(std::string_view issuerKey);
+    void setIssuerAccount(std::string_view accountPublicKey);
+    [[nodiscard]] const PublicKey& issuerAccountKey() const;  // Empty if not set
+    void setAudience(std::string audience);                   // Server ID the response is for
+    [[nodiscard]] const std::string& audience() const;
+    void setJwt(std::string userJwt);
+    [[nodiscard]] const std::string& jwt() const;             // Empty if denied
+    void setError(std::string error);
+    [[nodiscard]] const std::string& error() const;           // Empty if allowed
+
+private:
+    friend std::unique_ptr<AuthorizationResponseClaims> decodeAuthorizationResponseClaims(const std::string&);
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Decode an authorization request JWT
+[[nodiscard]] std::unique_ptr<AuthorizationRequestClaims> decodeAuthorizationRequestClaims(const std::string& jwt);
+
+/// Decode an authorization response JWT
+[[nodiscard]] std::unique_ptr<AuthorizationResponseClaims> decodeAuthorizationResponseClaims(const std::string& jwt);
+
+/**
+ * Auth callout responder: turns an authorization request JWT into a signed
+ * response JWT in one pass.
+ *
+ * The request is split and parsed once, and that parse is used both for the
+ * signature check and for the claims handed to the authorizer. The user JWT
+ * and the response are signed with a Signer decoded when the responder is
+ * built, so each call costs one verify and two signs, with no seed decoding
+ * and no re-parsing. Safe to share between threads if the authorizer is.
+ */
+class AuthorizationResponder {
+public:
+    /**
+     * Fill in the user to admit; throw to deny (the exception's message
+     * becomes the response error). Subject, issuer and issuer account are
+     * set by the responder.
+     */
+    using Authorizer = std::function<void(const AuthorizationRequestClaims& request, UserClaims& user)>;
+
+    /**
+     * @param signer Callout account key, or one of its signing keys
+     * @param issuerAccount Callout account, when signer is a signing key
+     * @throws std::invalid_argument if the signer is not an account key
+     */
+    explicit AuthorizationResponder(Signer signer, std::string_view issuerAccount = {});
+
+    /**
+     * Verify a request, mint the user and sign the response
+     * @param requestJwt Authorization request from the server
+     * @param authorize Policy deciding what the user may do
+     * @param opts Timing options for the request (its signature is always checked)
+     * @return Response JWT carrying the user JWT, or the authorizer's error
+     * @throws std::invalid_argument if the request is malformed, badly signed or expired
+     */
+    [[nodiscard]] std::string respond(const std::string& requestJwt, const Authorizer& authorize,
+                                      const ValidationOptions& opts = ValidationOptions{}) const;
+
+private:
+    Signer signer_;
+    PublicKey issuerAccount_;
+};
+
+}
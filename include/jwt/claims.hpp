@@ -1,6 +1,9 @@
 #pragma once
+#include "jwt/public_key.hpp"
+#include "jwt/tags.hpp"
 #include <string>
 #include <memory>
+#include <mutex>
 #include <cstdint>
 #include <optional>
 
@@ -17,6 +20,13 @@ public:
     /// Get the issuer (public key of the signer)
     [[nodiscard]] virtual std::string issuer() const = 0;
 
+    /// Get the interned subject key (O(1) comparison and hashing).
+    /// The built-in claim types store it; the default interns subject().
+    [[nodiscard]] virtual const PublicKey& subjectKey() const;
+
+    /// Get the interned issuer key (the default interns issuer())
+    [[nodiscard]] virtual const PublicKey& issuerKey() const;
+
     /// Get the claim name
     [[nodiscard]] virtual std::optional<std::string> name() const = 0;
 
@@ -26,11 +36,27 @@ public:
     /// Get the expiration timestamp (Unix seconds, 0 = no expiration)
     [[nodiscard]] virtual std::int64_t expires() const = 0;
 
+    /// Get the tags as a bitset of interned tag IDs
+    [[nodiscard]] virtual const TagSet& tags() const = 0;
+
     /// Encode the claims to a JWT string signed with the given keypair
     [[nodiscard]] virtual std::string encode(const std::string& seed) const = 0;
 
     /// Validate the claims structure
     virtual void validate() const = 0;
+
+private:
+    /// Keys interned by the default subjectKey()/issuerKey(); copies start empty
+    struct KeyCache {
+        KeyCache() = default;
+        KeyCache(const KeyCache&) noexcept {}
+        KeyCache& operator=(const KeyCache&) noexcept { return *this; }
+
+        std::mutex mutex;
+        PublicKey subject;
+        PublicKey issuer;
+    };
+    mutable KeyCache keyCache_;
 };
 
 /// Decode a JWT string into claims
@@ -0,0 +1,97 @@
+#pragma once
+#include "jwt/flat_claims.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace jwt {
+
+/**
+ * Immutable decoded claims plus the token they came from, shared between
+ * threads through an intrusive atomic reference count.
+ *
+ * Nothing can change after creation, so any number of threads may read a
+ * snapshot concurrently without locking; copying a Ptr costs one atomic
+ * increment. Meant to be what claim caches and trust structures hand out.
+ */
+class ClaimsSnapshot {
+public:
+    /// Intrusive shared pointer to a snapshot
+    class Ptr {
+    public:
+        Ptr() noexcept = default;
+        Ptr(const Ptr& other) noexcept : snapshot_(other.snapshot_) {
+            if (snapshot_) snapshot_->refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+        Ptr(Ptr&& other) noexcept : snapshot_(std::exchange(other.snapshot_, nullptr)) {}
+        Ptr& operator=(Ptr other) noexcept {
+            std::swap(snapshot_, other.snapshot_);
+            return *this;
+        }
+        ~Ptr() {
+            if (snapshot_ && snapshot_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                destroy(snapshot_);
+            }
+        }
+
+        [[nodiscard]] const ClaimsSnapshot* get() const noexcept { return snapshot_; }
+        const ClaimsSnapshot& operator*() const noexcept { return *snapshot_; }
+        const ClaimsSnapshot* operator->() const noexcept { return snapshot_; }
+        explicit operator bool() const noexcept { return snapshot_ != nullptr; }
+
+        /// Current number of Ptrs sharing the snapshot (0 if empty)
+        [[nodiscard]] std::uint32_t useCount() const noexcept {
+            return snapshot_ ? snapshot_->refs_.load(std::memory_order_relaxed) : 0;
+        }
+
+        friend bool operator==(const Ptr& a, const Ptr& b) noexcept { return a.snapshot_ == b.snapshot_; }
+
+    private:
+        friend class ClaimsSnapshot;
+        explicit Ptr(ClaimsSnapshot* snapshot) noexcept : snapshot_(snapshot) {}
+
+        ClaimsSnapshot* snapshot_ = nullptr;
+    };
+
+    /**
+     * Snapshot claims together with their token
+     * @param claims Any claims jwt::decode() returns
+     * @param token The encoded JWT the claims were decoded from
+     */
+    [[nodiscard]] static Ptr create(const Claims& claims, std::string_view token);
+
+    ClaimsSnapshot(const ClaimsSnapshot&) = delete;
+    ClaimsSnapshot& operator=(const ClaimsSnapshot&) = delete;
+
+    /// Decoded claims
+    [[nodiscard]] const FlatClaims& claims() const { return *claims_; }
+
+    /// Original token bytes
+    [[nodiscard]] std::string_view token() const {
+        return {reinterpret_cast<const char*>(this + 1), tokenSize_};
+    }
+
+private:
+    ClaimsSnapshot(FlatClaims::Ptr claims, std::size_t tokenSize)
+        : claims_(std::move(claims)), tokenSize_(tokenSize) {}
+    ~ClaimsSnapshot() = default;
+
+    static void destroy(ClaimsSnapshot* snapshot) noexcept;
+
+    FlatClaims::Ptr claims_;
+    std::size_t tokenSize_;
+    mutable std::atomic<std::uint32_t> refs_{1};
+};
+
+/**
+ * Decode a JWT of any type into a shareable snapshot (does not verify the signature)
+ * @param jwt Encoded JWT
+ * @return Snapshot holding the claims and a copy of the token
+ * @throws std::invalid_argument if the JWT is malformed
+ */
+[[nodiscard]] ClaimsSnapshot::Ptr decodeSnapshot(const std::string& jwt);
+
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwt {
+
+/// Client connection kinds (NATS "allowed_connection_types")
+enum class ConnectionType : std::uint8_t {
+    Standard,
+    Websocket,
+    Leafnode,
+    LeafnodeWebsocket,
+    Mqtt,
+    MqttWebsocket,
+    InProcess,
+};
+
+/// NATS name of a connection type ("STANDARD", "WEBSOCKET", ...)
+[[nodiscard]] std::string_view connectionTypeName(ConnectionType type);
+
+/// Connection type for a NATS name (case-sensitive); nullopt if unknown
+[[nodiscard]] std::optional<ConnectionType> parseConnectionType(std::string_view name);
+
+/// A daily time window, "HH:MM:SS" start and end (end before start wraps past midnight)
+struct TimeRange {
+    std::string start;
+    std::string end;
+
+    friend bool operator==(const TimeRange&, const TimeRange&) = default;
+};
+
+/// Where and when a user may connect (NATS "src", "times", "times_location",
+/// "allowed_connection_types"). Every empty list means "no restriction".
+struct ConnectionRestrictions {
+    std::vector<std::string> src;              // Allowed client networks, CIDR or single address
+    std::vector<TimeRange> times;              // Allowed time-of-day windows
+    std::string timesLocation;                 // IANA zone of times; empty = UTC
+    std::vector<std::string> connectionTypes;  // NATS names; unknown names allow nothing
+
+    [[nodiscard]] bool empty() const {
+        return src.empty() && times.empty() && timesLocation.empty() && connectionTypes.empty();
+    }
+    friend bool operator==(const ConnectionRestrictions&, const ConnectionRestrictions&) = default;
+};
+
+/// An IPv4 or IPv6 address in network byte order (IPv4 uses the first 4 bytes)
+struct IpAddress {
+    std::array<std::uint8_t, 16> bytes{};
+    bool v6 = false;
+
+    /**
+     * Parse dotted-quad IPv4 or RFC 4291 IPv6 text (no zone index).
+     * IPv4-mapped IPv6 addresses (::ffff:a.b.c.d) become IPv4.
+     */
+    [[nodiscard]] static std::optional<IpAddress> parse(std::string_view text);
+
+    friend bool operator==(const IpAddress&, const IpAddress&) = default;
+};
+
+/**
+ * A set of IPv4 and IPv6 networks compiled into multibit tries.
+ *
+ * Each trie consumes 4 address bits per level, and every node is one
+ * 64-byte array of 16 slots, so contains() reads at most 8 nodes for IPv4
+ * and 32 for IPv6 however many networks the set holds. Networks are
+ * inserted shortest first: a slot covered by a shorter prefix is marked
+ * full and never grows a subtree. Immutable once built.
+ */
+class CidrSet {
+public:
+    /// Empty set (contains nothing)
+    CidrSet() = default;
+
+    /**
+     * Compile networks
+     * @param networks "addr/len" or bare addresses (a single host)
+     * @throws std::invalid_argument if an entry is not a valid address or prefix length
+     */
+    explicit CidrSet(const std::vector<std::string>& networks);
+
+    [[nodiscard]] bool contains(const IpAddress& address) const;
+
+    /// @return false if address does not parse
+    [[nodiscard]] bool contains(std::string_view address) const;
+
+    [[nodiscard]] bool empty() const;
+
+    /// Trie nodes across both families (memory is nodeCount() * 64 bytes)
+    [[nodiscard]] std::size_t nodeCount() const;
+
+    /// One trie level: a slot is 0 (no match), FULL, or a child node index
+    struct alignas(64) Node {
+        std::array<std::uint32_t, 16> slots{};
+    };
+    static constexpr std::uint32_t FULL = UINT32_MAX;
+
+private:
+    std::vector<Node> v4_;  // Node 0 is the root, if any
+    std::vector<Node> v6_;
+};
+
+/// A half-open range of minutes since midnight, [begin, end)
+struct MinuteInterval {
+    std::uint16_t begin = 0;
+    std::uint16_t end = 0;
+
+    friend bool operator==(const MinuteInterval&, const MinuteInterval&) = default;
+};
+
+/// Minutes per day; minute-of-day values are in [0, MINUTES_PER_DAY)
+inline constexpr int MINUTES_PER_DAY = 24 * 60;
+
+/**
+ * Minute of day for a Unix time
+ * @param unixSeconds Seconds since the epoch
+ * @param utcOffsetSeconds Offset of the restrictions' timesLocation at that time
+ */
+[[nodiscard]] int minuteOfDay(std::int64_t unixSeconds, std::int32_t utcOffsetSeconds = 0);
+
+/**
+ * ConnectionRestrictions compiled for connect-time checks.
+ *
+ * Networks become a CidrSet; time windows become merged minute-of-day
+ * intervals plus a 1440-bit minute bitmap (a window's start is rounded up and
+ * its end down to whole minutes, so a minute is allowed only if all of it
+ * is); connection types become a bitmask. Each check is a few memory reads
+ * and writes nothing, so checks on a shared policy need no lock.
+ */
+class ConnectionPolicy {
+public:
+    /// Policy that allows every connection
+    ConnectionPolicy() = default;
+
+    /**
+     * Compile restrictions
+     * @throws std::invalid_argument if a network or time is malformed
+     */
+    explicit ConnectionPolicy(const ConnectionRestrictions& restrictions);
+
+    [[nodiscard]] bool allowsAddress(const IpAddress& address) const;
+    [[nodiscard]] bool allowsAddress(std::string_view address) const;  // false if it does not parse
+    [[nodiscard]] bool allowsMinute(int minuteOfDay) const;
+    [[nodiscard]] bool allowsType(ConnectionType type) const;
+
+    /// All three checks at once
+    [[nodiscard]] bool allows(const IpAddress& address, ConnectionType type, int minuteOfDay) const;
+
+    /// Allowed windows, sorted and merged (empty = any time)
+    [[nodiscard]] const std::vector<MinuteInterval>& timeWindows() const;
+
+    /// Bit (1 << ConnectionType) per allowed type (all bits if unrestricted)
+    [[nodiscard]] std::uint32_t typeMask() const;
+
+    /// Zone the minute-of-day passed to the checks must be taken in (empty = UTC)
+    [[nodiscard]] const std::string& timesLocation() const;
+
+private:
+    class Impl;
+    std::shared_ptr<const Impl> impl_;
+};
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "jwt/public_key.hpp"
+#include "jwt/validation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace jwt {
+
+class AccountClaims;
+
+/**
+ * Schedules the expiry of live credentials (e.g., one entry per client
+ * connection) so a server learns when to disconnect without polling every
+ * connection's expires().
+ *
+ * Entries live in a hierarchical timer wheel of one-second ticks: four
+ * levels of 256 slots, each slot an intrusive list, so schedule(), cancel()
+ * and rescheduling are O(1) and advance() costs O(1) per elapsed tick plus
+ * O(1) per entry it moves or fires. An entry fires once its effective
+ * expiry has passed (now > expiresAt, as validation decides it).
+ *
+ * An entry may depend on an account. Its effective expiry is the earlier of
+ * its own expiry and the account's, set with updateAccount(); a new account
+ * JWT therefore moves every dependent entry in one call. To let a renewed
+ * account extend its users, schedule them with the user JWT's own expiry
+ * (validate(user).expiresAt); a validateChain() result already includes the
+ * account's exp and can only be shortened.
+ *
+ * All methods are thread-safe. Callbacks run after the scheduler's lock is
+ * released, so they may schedule or cancel entries.
+ */
+class ExpiryScheduler {
+public:
+    using Id = std::uint64_t;      // Caller's tag for an entry (e.g., a connection ID)
+    using Handle = std::uint64_t;  // 0 = no entry
+
+    struct Expired {
+        Id id;
+        std::int64_t expiresAt;  // Effective expiry that fired
+    };
+
+    using Callback = std::function<void(const Expired&)>;
+
+    /// @param now Unix seconds the wheel starts at
+    explicit ExpiryScheduler(std::int64_t now);
+
+    /// Starts at the current time
+    ExpiryScheduler();
+    ~ExpiryScheduler();
+
+    ExpiryScheduler(const ExpiryScheduler&) = delete;
+    ExpiryScheduler& operator=(const ExpiryScheduler&) = delete;
+
+    /**
+     * Schedule an entry
+     * @param id Reported when the entry fires
+     * @param expiresAt Unix seconds (0 = never, unless the account expires)
+     * @param account Account the credential depends on (empty = none)
+     * @return Handle for cancel() and reschedule(); an entry already due
+     *         fires on the next advance()
+     */
+    Handle schedule(Id id, std::int64_t expiresAt, const PublicKey& account = PublicKey{});
+
+    /// Schedule a validated credential at result.expiresAt
+    /// @throws std::invalid_argument if the result is a failure
+    Handle schedule(Id id, const ValidationResult& result, const PublicKey& account = PublicKey{});
+
+    /// Change an entry's own expiry
+    /// @return false if the handle is not scheduled (fired or cancelled)
+    bool reschedule(Handle handle, std::int64_t expiresAt);
+
+    /// Remove an entry without firing it
+    /// @return false if the handle is not scheduled
+    bool cancel(Handle handle);
+
+    /**
+     * Set an account's expiry and move all its dependent entries
+     * @param account Account key
+     * @param expiresAt The account JWT's exp (0 = never)
+     * @return Number of entries whose effective expiry changed
+     */
+    std::size_t updateAccount(const PublicKey& account, std::int64_t expiresAt);
+
+    /// updateAccount() with an account JWT's subject and exp
+    std::size_t updateAccount(const AccountClaims& account);
+
+    /**
+     * Advance the wheel and invoke the callback for each entry that expired
+     * by now, earliest tick first
+     * @return Number of entries fired
+     */
+    std::size_t advance(std::int64_t now, const Callback& callback);
+
+    /// Advance the wheel and return the entries that expired by now
+    std::vector<Expired> advance(std::int64_t now);
+
+    /// Effective expiry of a scheduled entry (0 = never, or not scheduled)
+    [[nodiscard]] std::int64_t expiresAt(Handle handle) const;
+
+    /// Scheduled entries, including those that never expire
+    [[nodiscard]] std::size_t size() const;
+
+    /// Time the wheel has been advanced to
+    [[nodiscard]] std::int64_t now() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
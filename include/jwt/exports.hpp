@@ -0,0 +1,127 @@
+#pragma once
+#include "jwt/public_key.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwt {
+
+class AccountClaims;
+
+/// Kind of cross-account traffic an export or import carries
+enum class ExportType : std::uint8_t {
+    Stream,
+    Service
+};
+
+/// Subjects an account makes available to other accounts (NATS "exports")
+struct Export {
+    std::string name;
+    std::string subject;  // May contain '*' and a trailing '>'
+    ExportType type = ExportType::Stream;
+    bool tokenRequired = false;  // Importers must present an activation token
+
+    friend bool operator==(const Export&, const Export&) = default;
+};
+
+/// Subjects an account takes from another account's exports (NATS "imports")
+struct Import {
+    std::string name;
+    std::string subject;       // Subject in the exporting account
+    PublicKey account;         // Exporting account
+    std::string token;         // Activation token, if the export requires one
+    std::string localSubject;  // Where the import appears locally (empty = same subject)
+    ExportType type = ExportType::Stream;
+
+    friend bool operator==(const Import&, const Import&) = default;
+};
+
+/**
+ * An account's exports indexed by a subject trie.
+ *
+ * find() walks the trie token by token, so its cost depends on the subject's
+ * length rather than on how many exports the account has. find() only
+ * reads the trie, so concurrent lookups need no lock; copies share it.
+ */
+class ExportIndex {
+public:
+    /// Index with no exports
+    ExportIndex() = default;
+
+    /**
+     * Build the index
+     * @param exports Exports to index
+     * @throws std::invalid_argument if an export subject is malformed
+     */
+    explicit ExportIndex(std::vector<Export> exports);
+
+    /// Indexed exports, in their original order
+    [[nodiscard]] const std::vector<Export>& exports() const;
+
+    /**
+     * Find the export covering a subject. The subject may itself contain
+     * wildcards, in which case the export must cover every subject they
+     * match (e.g., "orders.>" covers "orders.*.eu"). When several exports
+     * match, literal tokens win over '*', and '*' over '>'.
+     * @param subject Subject to resolve
+     * @param type Export type to look for
+     * @return Matching export (valid while this index or a copy lives), or nullptr
+     */
+    [[nodiscard]] const Export* find(std::string_view subject, ExportType type) const;
+
+private:
+    class Impl;
+    std::shared_ptr<const Impl> impl_;
+};
+
+/// Result of resolving an import: the export plus the index that keeps it alive
+struct ExportMatch {
+    ExportIndex index;
+    const Export* exportClaim = nullptr;
+
+    explicit operator bool() const { return exportClaim != nullptr; }
+    const Export* operator->() const { return exportClaim; }
+};
+
+/**
+ * Thread-safe map from account key to that account's ExportIndex, used to
+ * resolve imports across all known accounts: one hash lookup to find the
+ * exporter, then a trie walk over the import subject.
+ */
+class ExportRegistry {
+public:
+    ExportRegistry();
+    ~ExportRegistry();
+
+    ExportRegistry(const ExportRegistry&) = delete;
+    ExportRegistry& operator=(const ExportRegistry&) = delete;
+
+    /// Add an account's exports, replacing any previous version of the account
+    void update(const AccountClaims& account);
+
+    /// Forget an account
+    /// @return true if the account was known
+    bool remove(const PublicKey& account);
+
+    /// Exports of an account (empty index if unknown)
+    [[nodiscard]] ExportIndex exportsOf(const PublicKey& account) const;
+
+    /**
+     * Resolve an import to the export that serves it. Does not check
+     * activation tokens; see Export::tokenRequired.
+     * @return Match, or an empty match if the exporter or subject is unknown
+     */
+    [[nodiscard]] ExportMatch resolve(const Import& import) const;
+
+    /// Number of accounts in the registry
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
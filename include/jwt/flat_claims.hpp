@@ -0,0 +1,169 @@
+#pragma once
+#include "jwt/claims.hpp"
+#include "jwt/connection_policy.hpp"
+#include "jwt/exports.hpp"
+#include "jwt/limits.hpp"
+#include "jwt/permissions.hpp"
+#include "jwt/public_key.hpp"
+#include "jwt/subject_mapping.hpp"
+#include "jwt/tags.hpp"
+#include "jwt/user_scope.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace jwt {
+
+class OperatorClaims;
+class AccountClaims;
+class UserClaims;
+class ActivationClaims;
+class AuthorizationRequestClaims;
+class AuthorizationResponseClaims;
+
+/// Which kind of token a claim came from
+enum class ClaimType : std::uint8_t {
+    Operator,
+    Account,
+    User,
+    Activation,
+    AuthorizationRequest,
+    AuthorizationResponse,
+};
+
+/// One entry of an account's revocation list
+struct FlatRevocation {
+    PublicKey key;
+    std::int64_t timestamp = 0;
+};
+
+/**
+ * Read-only claims stored in a single contiguous allocation.
+ *
+ * Fixed fields (type, timestamps, NATS limits and the interned subject,
+ * issuer and issuer-account keys) live inline; account limits, signing
+ * keys, revocations, signing-key scopes (as UserScope handles) and the name
+ * are packed into a buffer directly behind the object. Intended for large
+ * in-memory claim caches, where the pimpl classes' scattered strings and
+ * vectors cost locality and per-entry overhead. Create with from().
+ *
+ * Compiled checks are shared with the source claims by handle, not rebuilt,
+ * so an entry answers them the same way: user permission matchers and
+ * connection policy, and the account export index, imports and subject
+ * mapper. Raw permission, restriction and mapping lists are not kept; read
+ * them from the compiled objects (e.g. subjectMapper().mappings()) or the
+ * source claims. Tags
+ * are copied (a TagSet owns two short sorted arrays), so they sit outside
+ * the single allocation.
+ */
+class FlatClaims {
+public:
+    struct Deleter {
+        void operator()(FlatClaims* claims) const noexcept;
+    };
+    using Ptr = std::unique_ptr<FlatClaims, Deleter>;
+
+    /**
+     * Flatten decoded or constructed claims (one allocation)
+     * @param claims Any claims jwt::decode() returns; activation and
+     *        authorization claims keep only the common fields and issuer account
+     * @throws std::invalid_argument for any other Claims subclass
+     */
+    [[nodiscard]] static Ptr from(const Claims& claims);
+    [[nodiscard]] static Ptr from(const OperatorClaims& claims);
+    [[nodiscard]] static Ptr from(const AccountClaims& claims);
+    [[nodiscard]] static Ptr from(const UserClaims& claims);
+    [[nodiscard]] static Ptr from(const ActivationClaims& claims);
+    [[nodiscard]] static Ptr from(const AuthorizationRequestClaims& claims);
+    [[nodiscard]] static Ptr from(const AuthorizationResponseClaims& claims);
+
+    FlatClaims(const FlatClaims&) = delete;
+    FlatClaims& operator=(const FlatClaims&) = delete;
+
+    [[nodiscard]] ClaimType type() const { return type_; }
+    [[nodiscard]] const PublicKey& subject() const { return subject_; }
+    [[nodiscard]] const PublicKey& issuer() const { return issuer_; }
+    [[nodiscard]] const PublicKey& issuerAccount() const { return issuerAccount_; }  // Empty if unset
+    [[nodiscard]] std::optional<std::string_view> name() const;
+    [[nodiscard]] std::int64_t issuedAt() const { return issuedAt_; }
+    [[nodiscard]] std::int64_t expires() const { return expires_; }
+    [[nodiscard]] std::span<const PublicKey> signingKeys() const;
+    [[nodiscard]] std::span<const FlatRevocation> revocations() const;
+
+    /// Subscription/data/payload limits of an account or user
+    [[nodiscard]] const NatsLimits& natsLimits() const { return natsLimits_; }
+
+    /// Full account limits (accounts only; unlimited defaults otherwise)
+    [[nodiscard]] const AccountLimits& accountLimits() const;
+
+    /// True if a user JWT for the key issued at issuedAt has been revoked (accounts only)
+    [[nodiscard]] bool isRevoked(const PublicKey& publicKey, std::int64_t issuedAt) const;
+
+    [[nodiscard]] const TagSet& tags() const { return tags_; }
+
+    /// User publish/subscribe permissions (allow everything for other types)
+    [[nodiscard]] const PermissionMatcher& publishMatcher() const { return publish_; }
+    [[nodiscard]] const PermissionMatcher& subscribeMatcher() const { return subscribe_; }
+    [[nodiscard]] bool canPublish(std::string_view subject) const { return publish_.allows(subject); }
+    [[nodiscard]] bool canSubscribe(std::string_view subject) const { return subscribe_.allows(subject); }
+
+    /// User connect restrictions (allow everything for other types)
+    [[nodiscard]] const ConnectionPolicy& connectionPolicy() const { return connectionPolicy_; }
+    [[nodiscard]] bool canConnect(const IpAddress& address, ConnectionType type, int minuteOfDay) const {
+        return connectionPolicy_.allows(address, type, minuteOfDay);
+    }
+
+    /// Account exports, imports and subject mappings (empty for other types)
+    [[nodiscard]] const ExportIndex& exportIndex() const { return exportIndex_; }
+    [[nodiscard]] std::span<const Import> imports() const;
+    [[nodiscard]] const SubjectMapper& subjectMapper() const { return subjectMapper_; }
+
+    /// Scope of an account signing key (nullptr for unscoped and unknown keys)
+    [[nodiscard]] const UserScope* scopeFor(const PublicKey& signingKey) const;
+
+    /// Total bytes of the single allocation backing this object (tags excluded)
+    [[nodiscard]] std::size_t allocationSize() const;
+
+private:
+    FlatClaims() = default;
+    ~FlatClaims();
+
+    /// Allocate header and trailing buffer in one block, with empty keys and
+    /// revocations; scopes are constructed by the caller
+    static Ptr allocate(ClaimType type, const Claims& claims, std::size_t signingKeyCount,
+                        std::size_t revocationCount, std::size_t scopeCount = 0);
+
+    [[nodiscard]] AccountLimits* accountLimitsData();
+    [[nodiscard]] PublicKey* signingKeyData();
+    [[nodiscard]] FlatRevocation* revocationData();
+    [[nodiscard]] UserScope* scopeData();
+    [[nodiscard]] char* nameData();
+
+    [[nodiscard]] std::byte* trailing() { return reinterpret_cast<std::byte*>(this + 1); }
+    [[nodiscard]] const std::byte* trailing() const { return reinterpret_cast<const std::byte*>(this + 1); }
+
+    PublicKey subject_;
+    PublicKey issuer_;
+    PublicKey issuerAccount_;
+    std::int64_t issuedAt_ = 0;
+    std::int64_t expires_ = 0;
+    NatsLimits natsLimits_;
+    TagSet tags_;
+    PermissionMatcher publish_;
+    PermissionMatcher subscribe_;
+    ConnectionPolicy connectionPolicy_;
+    ExportIndex exportIndex_;
+    std::shared_ptr<const std::vector<Import>> imports_;
+    SubjectMapper subjectMapper_;
+    std::uint32_t signingKeyCount_ = 0;
+    std::uint32_t revocationCount_ = 0;
+    std::uint32_t scopeCount_ = 0;
+    std::uint32_t nameSize_ = 0;
+    ClaimType type_ = ClaimType::User;
+    bool hasName_ = false;
+};
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "jwt/claims.hpp"
+#include "jwt/signer.hpp"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwt {
+
+/**
+ * Claims of any type, decoded without building a JSON DOM.
+ *
+ * The payload is scanned once: every top-level member (and every member of
+ * "nats") is kept as a raw span of its JSON text, in the original order, and
+ * only the standard fields (iss, sub, name, iat, exp, nats.type, nats.tags)
+ * are interpreted. encode() splices the members back verbatim, so a token
+ * passed through unchanged keeps its payload byte for byte, and rewriting a
+ * few fields touches only those fields.
+ *
+ * Views returned by fields(), field() and natsField() point into this
+ * object and stay valid until it is modified or destroyed. Movable but not
+ * copyable.
+ */
+class GenericClaims : public Claims {
+public:
+    /// A payload member: its name and the raw JSON text of its value
+    struct Field {
+        std::string_view name;
+        std::string_view json;
+    };
+
+    ~GenericClaims() override;
+    GenericClaims(GenericClaims&& other) noexcept;
+    GenericClaims& operator=(GenericClaims&& other) noexcept;
+    GenericClaims(const GenericClaims&) = delete;
+    GenericClaims& operator=(const GenericClaims&) = delete;
+
+    // Claims interface
+    [[nodiscard]] std::string subject() const override;
+    [[nodiscard]] std::string issuer() const override;
+    [[nodiscard]] const PublicKey& subjectKey() const override;
+    [[nodiscard]] const PublicKey& issuerKey() const override;
+    [[nodiscard]] std::optional<std::string> name() const override;
+    [[nodiscard]] std::int64_t issuedAt() const override;
+    [[nodiscard]] std::int64_t expires() const override;
+    [[nodiscard]] const TagSet& tags() const override;
+    [[nodiscard]] std::string encode(const std::string& seed) const override;
+    void validate() const override;
+
+    /// Encode with a pre-decoded signing key (see Signer)
+    [[nodiscard]] std::string encode(const Signer& signer) const;
+
+    /// Claim type from nats.type ("user", "account", ...; empty if absent)
+    [[nodiscard]] std::string_view type() const;
+
+    /// The token this was decoded from
+    [[nodiscard]] const std::string& token() const;
+
+    /// All top-level payload members, in order
+    [[nodiscard]] std::vector<Field> fields() const;
+
+    /// Raw JSON of a top-level member, if present
+    [[nodiscard]] std::optional<std::string_view> field(std::string_view name) const;
+
+    /// Raw JSON of a member of the "nats" object, if present
+    [[nodiscard]] std::optional<std::string_view> natsField(std::string_view name) const;
+
+    /**
+     * Replace a top-level member, or append it if absent
+     * @param name Member name
+     * @param json Raw JSON text of exactly one value
+     * @throws std::invalid_argument if json is not a single JSON value, or
+     *         a standard field gets a value of the wrong type
+     */
+    void setField(std::string_view name, std::string json);
+
+    /// Remove a top-level member
+    /// @return true if it was present
+    bool removeField(std::string_view name);
+
+    // Convenience setters for standard fields (via setField)
+    void setIssuer(std::string_view issuerKey);
+    void setName(std::string_view name);
+    void setExpires(std::int64_t exp);
+
+    /// Payload JSON that encode() signs (members spliced verbatim)
+    [[nodiscard]] std::string payload() const;
+
+private:
+    GenericClaims();
+    friend std::unique_ptr<GenericClaims> decodeGenericClaims(const std::string&);
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * Decode a JWT of any type into a GenericClaims view
+ * @throws std::invalid_argument if the token or its payload is malformed
+ */
+[[nodiscard]] std::unique_ptr<GenericClaims> decodeGenericClaims(const std::string& jwt);
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jwt {
+
+/**
+ * Shape of a synthetic Operator -> Account -> User hierarchy.
+ *
+ * Keys, names, expiries and revocations are derived from `seed` alone, so the
+ * same spec always yields the same identities regardless of thread count.
+ * Users are issued at `now`; only the per-token jti and the operator and
+ * account iat differ between runs with the same `now`.
+ */
+struct HierarchySpec {
+    std::size_t operators = 1;
+    std::size_t accountsPerOperator = 1;
+    std::size_t signingKeysPerAccount = 0;
+    std::size_t revocationsPerAccount = 0;  // Revokes the last users of each account
+    std::size_t usersPerAccount = 1;
+
+    double expiringUserFraction = 0.5;      // Users expiring 1 hour to 30 days after `now`
+    bool signUsersWithSigningKeys = false;  // Round-robin over the account signing keys
+
+    std::uint64_t seed = 1;
+    std::int64_t now = 0;   // Reference time for expiries and revocations (0 = current time)
+    unsigned threads = 0;   // 0 = std::thread::hardware_concurrency()
+};
+
+/// A generated nkey
+struct GeneratedKey {
+    std::string publicKey;
+    std::string seed;
+};
+
+struct GeneratedUser {
+    std::string name;
+    GeneratedKey key;
+    std::string jwt;
+    std::int64_t expires = 0;  // 0 = never
+    bool revoked = false;
+};
+
+struct GeneratedAccount {
+    std::string name;
+    GeneratedKey key;
+    std::string jwt;
+    std::vector<GeneratedKey> signingKeys;
+    std::vector<GeneratedUser> users;
+};
+
+struct GeneratedOperator {
+    std::string name;
+    GeneratedKey key;
+    std::string jwt;
+    std::vector<GeneratedAccount> accounts;
+};
+
+/// A complete generated hierarchy
+struct TrustHierarchy {
+    std::vector<GeneratedOperator> operators;
+
+    [[nodiscard]] std::size_t accountCount() const;
+    [[nodiscard]] std::size_t userCount() const;
+};
+
+/**
+ * Generate a hierarchy in memory, signing tokens in parallel
+ * @throws std::invalid_argument if the spec is inconsistent
+ */
+[[nodiscard]] TrustHierarchy generateHierarchy(const HierarchySpec& spec);
+
+/**
+ * Generate a hierarchy directly into a directory without keeping users in memory.
+ * Layout: <op>/<op>.{jwt,seed}, <op>/accounts/<acct>/<acct>.{jwt,seed},
+ * <op>/accounts/<acct>/signing-key-<n>.seed and
+ * <op>/accounts/<acct>/users/<user>.{jwt,seed,creds}
+ * @throws std::invalid_argument if the spec is inconsistent
+ * @throws std::runtime_error if a file cannot be written
+ */
+void generateHierarchy(const HierarchySpec& spec, const std::string& directory);
+
+/**
+ * Write an in-memory hierarchy using the same layout as generateHierarchy(spec, directory)
+ * @throws std::runtime_error if a file cannot be written
+ */
+void writeHierarchy(const TrustHierarchy& hierarchy, const std::string& directory);
+
+}
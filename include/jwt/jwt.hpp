@@ -2,10 +2,31 @@
 
 // Main public API - include all headers
 #include "jwt/jwt_constants.hpp"
+#include "jwt/public_key.hpp"
+#include "jwt/limits.hpp"
+#include "jwt/tags.hpp"
+#include "jwt/signer.hpp"
 #include "jwt/claims.hpp"
+#include "jwt/permissions.hpp"
+#include "jwt/connection_policy.hpp"
+#include "jwt/exports.hpp"
+#include "jwt/subject_mapping.hpp"
+#include "jwt/user_scope.hpp"
 #include "jwt/operator_claims.hpp"
 #include "jwt/account_claims.hpp"
 #include "jwt/user_claims.hpp"
+#include "jwt/activation_claims.hpp"
+#include "jwt/flat_claims.hpp"
+#include "jwt/claims_snapshot.hpp"
 #include "jwt/validation.hpp"
+#include "jwt/activation_cache.hpp"
+#include "jwt/authorization_claims.hpp"
+#include "jwt/generic_claims.hpp"
+#include "jwt/replay_detector.hpp"
+#include "jwt/expiry_scheduler.hpp"
+#include "jwt/key_cache.hpp"
+#include "jwt/lock_stats.hpp"
+#include "jwt/metrics.hpp"
+#include "jwt/hierarchy_generator.hpp"
 
 namespace jwt {}
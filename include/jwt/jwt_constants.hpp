@@ -11,4 +11,7 @@ inline constexpr const char* JWT_TYPE = "JWT";
 
 inline constexpr std::size_t MAX_JWT_SIZE = 10 * 1024 * 1024;
 
+/// Revocation key that applies to every user of an account
+inline constexpr const char* ALL_USERS_REVOCATION = "*";
+
 }
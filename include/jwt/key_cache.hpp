@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jwt {
+
+/**
+ * Statistics for the process-wide cache of prepared issuer public keys
+ * used by signature verification
+ */
+struct KeyCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::size_t size = 0;
+    std::size_t capacity = 0;
+};
+
+/// Default number of issuer keys kept prepared
+inline constexpr std::size_t DEFAULT_KEY_CACHE_CAPACITY = 1024;
+
+/**
+ * Set the maximum number of prepared issuer keys to keep
+ * @param capacity Maximum entries; 0 disables caching and clears the cache
+ */
+void setKeyCacheCapacity(std::size_t capacity);
+
+/**
+ * Get key cache statistics
+ * @return Hit/miss/eviction counters and current size
+ */
+KeyCacheStats keyCacheStats();
+
+/**
+ * Drop all cached keys and reset the counters
+ */
+void clearKeyCache();
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+namespace jwt {
+
+/// Limit value meaning "unlimited"
+inline constexpr std::int64_t NO_LIMIT = -1;
+
+/**
+ * True if a counter may grow by one more (current < limit, any current for NO_LIMIT).
+ * Compares as unsigned so NO_LIMIT becomes the largest value: no branch on it.
+ */
+[[nodiscard]] constexpr bool belowLimit(std::int64_t limit, std::int64_t current) noexcept {
+    return static_cast<std::uint64_t>(current) < static_cast<std::uint64_t>(limit);
+}
+
+/// True if a size fits a limit (size <= limit, any size for NO_LIMIT)
+[[nodiscard]] constexpr bool withinLimit(std::int64_t limit, std::int64_t size) noexcept {
+    return static_cast<std::uint64_t>(size) <= static_cast<std::uint64_t>(limit);
+}
+
+/// Limits shared by accounts and users (NATS "subs", "data", "payload")
+struct NatsLimits {
+    std::int64_t subs = NO_LIMIT;     // Max subscriptions
+    std::int64_t data = NO_LIMIT;     // Max bytes in flight
+    std::int64_t payload = NO_LIMIT;  // Max message payload bytes
+
+    [[nodiscard]] constexpr bool canSubscribe(std::int64_t subscriptions) const noexcept {
+        return belowLimit(subs, subscriptions);
+    }
+    [[nodiscard]] constexpr bool canPublish(std::int64_t payloadSize) const noexcept {
+        return withinLimit(payload, payloadSize);
+    }
+
+    friend constexpr bool operator==(const NatsLimits&, const NatsLimits&) = default;
+};
+
+/// JetStream resource limits of an account (0 storage = JetStream disabled)
+struct JetStreamLimits {
+    std::int64_t memoryStorage = 0;
+    std::int64_t diskStorage = 0;
+    std::int64_t streams = NO_LIMIT;
+    std::int64_t consumers = NO_LIMIT;
+    std::int64_t maxAckPending = NO_LIMIT;
+    std::int64_t memoryMaxStreamBytes = 0;  // 0 = no per-stream cap
+    std::int64_t diskMaxStreamBytes = 0;
+    bool maxBytesRequired = false;
+
+    [[nodiscard]] constexpr bool enabled() const noexcept { return memoryStorage != 0 || diskStorage != 0; }
+
+    friend constexpr bool operator==(const JetStreamLimits&, const JetStreamLimits&) = default;
+};
+
+/// Live per-account counters checked against AccountLimits
+struct AccountUsage {
+    std::int64_t subs = 0;
+    std::int64_t conn = 0;
+    std::int64_t leaf = 0;
+    std::int64_t imports = 0;
+    std::int64_t exports = 0;
+};
+
+/// Bits of AccountLimits::exhausted()
+enum class LimitKind : std::uint32_t {
+    Subs = 1 << 0,
+    Conn = 1 << 1,
+    Leaf = 1 << 2,
+    Imports = 1 << 3,
+    Exports = 1 << 4,
+};
+
+/// True if mask (from AccountLimits::exhausted()) contains kind
+[[nodiscard]] constexpr bool hasLimit(std::uint32_t mask, LimitKind kind) noexcept {
+    return (mask & static_cast<std::uint32_t>(kind)) != 0;
+}
+
+/**
+ * An account's "limits" claim. Plain fixed-layout data: decoding fills it
+ * in place without allocating, and it can be copied or cached by value.
+ */
+struct AccountLimits {
+    NatsLimits nats;
+    std::int64_t imports = NO_LIMIT;  // Max imports
+    std::int64_t exports = NO_LIMIT;  // Max exports
+    std::int64_t conn = NO_LIMIT;     // Max client connections
+    std::int64_t leaf = NO_LIMIT;     // Max leaf node connections
+    bool wildcardExports = true;      // Exports may contain wildcards
+    JetStreamLimits jetstream;
+
+    [[nodiscard]] constexpr bool canConnect(std::int64_t connections) const noexcept {
+        return belowLimit(conn, connections);
+    }
+    [[nodiscard]] constexpr bool canConnectLeaf(std::int64_t leafConnections) const noexcept {
+        return belowLimit(leaf, leafConnections);
+    }
+
+    /**
+     * Every counter that is already at its limit, evaluated without branches
+     * @param usage Live counters
+     * @return Mask of LimitKind bits (0 = everything may still grow)
+     */
+    [[nodiscard]] constexpr std::uint32_t exhausted(const AccountUsage& usage) const noexcept {
+        auto bit = [](bool full, LimitKind kind) {
+            return static_cast<std::uint32_t>(full) * static_cast<std::uint32_t>(kind);
+        };
+        return bit(!belowLimit(nats.subs, usage.subs), LimitKind::Subs) |
+               bit(!belowLimit(conn, usage.conn), LimitKind::Conn) |
+               bit(!belowLimit(leaf, usage.leaf), LimitKind::Leaf) |
+               bit(!belowLimit(imports, usage.imports), LimitKind::Imports) |
+               bit(!belowLimit(exports, usage.exports), LimitKind::Exports);
+    }
+
+    friend constexpr bool operator==(const AccountLimits&, const AccountLimits&) = default;
+};
+
+static_assert(std::is_trivially_copyable_v<AccountLimits> && std::is_standard_layout_v<AccountLimits>);
+static_assert(std::is_trivially_copyable_v<NatsLimits> && std::is_standard_layout_v<NatsLimits>);
+
+}
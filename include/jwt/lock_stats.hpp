@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jwt {
+
+/**
+ * Contention counters for one of the library's internal locks
+ * (e.g. the prepared key cache)
+ */
+struct LockStats {
+    std::string name;
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0;   // Acquisitions that had to wait for another thread
+    std::uint64_t waitNanos = 0;   // Total time spent waiting in contended acquisitions
+
+    [[nodiscard]] double contentionRate() const {
+        return acquisitions ? static_cast<double>(contended) / static_cast<double>(acquisitions) : 0.0;
+    }
+};
+
+/**
+ * Get counters for every internal lock created so far
+ * @return One entry per lock name (shards of one lock are summed), in creation order
+ */
+[[nodiscard]] std::vector<LockStats> lockStats();
+
+/**
+ * Zero the counters of all internal locks
+ */
+void resetLockStats();
+
+}
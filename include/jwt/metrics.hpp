@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jwt::metrics {
+
+/// Pipeline stages the library reports timings for
+enum class Stage : std::uint8_t {
+    Split,            // Splitting "header.payload.signature"
+    HeaderDecode,     // Base64 URL decode + parse of the header
+    PayloadDecode,    // Base64 URL decode of the payload
+    Parse,            // JSON parse of the payload
+    KeyPreparation,   // Turning an issuer public key into a verifier
+    SignatureVerify,  // Ed25519 signature check
+    Timing,           // exp / iat checks
+    Hierarchy,        // Issuer chain and key hierarchy checks
+    KeyCache,         // Prepared key cache lookups (outcome only)
+    Count
+};
+
+/// Outcome of a stage
+enum class Outcome : std::uint8_t {
+    Success,
+    Failure,
+    CacheHit,
+    CacheMiss,
+    Count
+};
+
+inline constexpr std::size_t kStageCount = static_cast<std::size_t>(Stage::Count);
+inline constexpr std::size_t kOutcomeCount = static_cast<std::size_t>(Outcome::Count);
+
+/// Number of log-linear histogram buckets (8 sub-buckets per power of two)
+inline constexpr std::size_t kBucketCount = 496;
+
+/// True when the library was built with JWT_ENABLE_METRICS
+constexpr bool enabled() {
+#if defined(JWT_ENABLE_METRICS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// Stable lower-case name of a stage (used as a metric label)
+const char* stageName(Stage stage);
+
+/// Stable lower-case name of an outcome (used as a metric label)
+const char* outcomeName(Outcome outcome);
+
+/// Smallest duration (ns) that falls into the given histogram bucket
+std::uint64_t bucketLowerBound(std::size_t bucket);
+
+/// Aggregated statistics for one stage
+struct StageStats {
+    std::array<std::uint64_t, kOutcomeCount> outcomes{};
+    std::uint64_t count = 0;        // Timed samples
+    std::uint64_t totalNanos = 0;
+    std::uint64_t maxNanos = 0;
+    std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(kBucketCount, 0);
+
+    [[nodiscard]] std::uint64_t outcome(Outcome o) const { return outcomes[static_cast<std::size_t>(o)]; }
+    [[nodiscard]] double meanNanos() const { return count ? static_cast<double>(totalNanos) / static_cast<double>(count) : 0.0; }
+
+    /// Upper bound of the bucket holding the q-th quantile (0 <= q <= 1)
+    [[nodiscard]] std::uint64_t percentileNanos(double q) const;
+};
+
+/// Point-in-time view of all stages, summed over every thread
+struct Snapshot {
+    std::array<StageStats, kStageCount> stages;
+
+    [[nodiscard]] const StageStats& operator[](Stage stage) const {
+        return stages[static_cast<std::size_t>(stage)];
+    }
+};
+
+/**
+ * Receives every recorded stage event. Called synchronously on the thread
+ * doing the work, so implementations must be cheap and thread-safe.
+ */
+class Observer {
+public:
+    virtual ~Observer() = default;
+    virtual void onStage(Stage stage, Outcome outcome, std::uint64_t nanos) noexcept = 0;
+};
+
+/// Install (or clear, with nullptr) the observer; the caller keeps ownership
+void setObserver(Observer* observer);
+
+/// Sum the per-thread histograms (empty when metrics are compiled out)
+[[nodiscard]] Snapshot snapshot();
+
+/// Zero all counters; increments racing with the reset may survive it
+void reset();
+
+/// Render a snapshot in the Prometheus text exposition format
+[[nodiscard]] std::string exportPrometheus(const Snapshot& snap);
+
+}
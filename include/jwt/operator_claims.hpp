@@ -1,5 +1,7 @@
 #pragma once
 #include "jwt/claims.hpp"
+#include "jwt/signer.hpp"
+#include <string_view>
 #include <vector>
 
 namespace jwt {
@@ -8,23 +10,41 @@ namespace jwt {
 class OperatorClaims : public Claims {
 public:
     /// Create operator claims with the given public key
-    explicit OperatorClaims(const std::string& operatorPublicKey);
+    explicit OperatorClaims(std::string_view operatorPublicKey);
     ~OperatorClaims() override;
 
+    /// Copies are deep; a moved-from object may only be assigned to or destroyed
+    OperatorClaims(const OperatorClaims& other);
+    OperatorClaims(OperatorClaims&& other) noexcept;
+    OperatorClaims& operator=(const OperatorClaims& other);
+    OperatorClaims& operator=(OperatorClaims&& other) noexcept;
+
     // Claims interface
     [[nodiscard]] std::string subject() const override;
     [[nodiscard]] std::string issuer() const override;
+    [[nodiscard]] const PublicKey& subjectKey() const override;
+    [[nodiscard]] const PublicKey& issuerKey() const override;
     [[nodiscard]] std::optional<std::string> name() const override;
     [[nodiscard]] std::int64_t issuedAt() const override;
     [[nodiscard]] std::int64_t expires() const override;
+    [[nodiscard]] const TagSet& tags() const override;
     [[nodiscard]] std::string encode(const std::string& seed) const override;
     void validate() const override;
 
+    /// Encode with a pre-decoded signing key (see Signer)
+    [[nodiscard]] std::string encode(const Signer& signer) const;
+
     // Operator-specific
-    void setName(const std::string& name);
+    void setName(std::string name);
     void setExpires(std::int64_t exp);
-    void addSigningKey(const std::string& publicKey);
+    void setTags(TagSet tags);
+    void addTag(std::string_view tag);  // Trimmed and lower-cased; blank tags are ignored
+    void addSigningKey(std::string_view publicKey);
+    void addSigningKey(PublicKey publicKey);
+    void setSigningKeys(std::vector<std::string>&& publicKeys);  // Replaces all keys, interned as one batch
+    void setSigningKeys(std::vector<PublicKey> publicKeys);
     [[nodiscard]] const std::vector<std::string>& signingKeys() const;
+    [[nodiscard]] const std::vector<PublicKey>& signingKeyHandles() const;  // Same keys, interned
 
 private:
     friend std::unique_ptr<OperatorClaims> decodeOperatorClaims(const std::string&);
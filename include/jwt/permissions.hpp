@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwt {
+
+/**
+ * Allow/deny subject patterns for one direction (NATS "pub" or "sub").
+ * Patterns are dot-separated tokens where '*' matches one token and a
+ * trailing '>' matches one or more.
+ */
+struct Permission {
+    std::vector<std::string> allow;  // Empty = everything not denied is allowed
+    std::vector<std::string> deny;   // Takes precedence over allow
+
+    [[nodiscard]] bool empty() const { return allow.empty() && deny.empty(); }
+    friend bool operator==(const Permission&, const Permission&) = default;
+};
+
+/// Publish and subscribe permissions of a user
+struct Permissions {
+    Permission pub;
+    Permission sub;
+
+    [[nodiscard]] bool empty() const { return pub.empty() && sub.empty(); }
+    friend bool operator==(const Permissions&, const Permissions&) = default;
+};
+
+/**
+ * A Permission compiled into a token trie with '*' edges.
+ *
+ * Compilation also determinizes the trie while that stays linear in its
+ * size, in which case allows() does one hash lookup per subject token
+ * regardless of how many patterns there are. Overlapping '*' patterns can
+ * need exponentially many states; for those allows() walks the trie instead,
+ * which costs at most subject tokens times trie width. The walk keeps its
+ * state in thread-local buffers, so a shared matcher needs no lock.
+ */
+class PermissionMatcher {
+public:
+    /// Matcher that allows every subject
+    PermissionMatcher() = default;
+
+    /**
+     * Compile allow/deny patterns
+     * @param permission Patterns to compile
+     * @throws std::invalid_argument if a pattern is malformed (empty token, '>' not last)
+     */
+    explicit PermissionMatcher(const Permission& permission);
+
+    /**
+     * Check a subject against the compiled patterns (deny wins over allow).
+     * A '*' or '>' token in the subject (e.g., a wildcard subscription) is
+     * only covered by a pattern with the same or a broader wildcard there.
+     * @param subject Dot-separated subject
+     * @return true if allowed; false if denied, not allowed, or malformed
+     */
+    [[nodiscard]] bool allows(std::string_view subject) const;
+
+    /// Number of automaton states (0 for the allow-all matcher or a trie walk)
+    [[nodiscard]] std::size_t stateCount() const;
+
+    /// True unless the patterns were too costly to determinize
+    [[nodiscard]] bool isDeterministic() const;
+
+    /// Determinization steps allowed per trie node (small sets get 4096 nodes' worth)
+    static constexpr std::size_t DETERMINIZE_BUDGET = 16;
+
+private:
+    class Impl;
+    std::shared_ptr<const Impl> impl_;
+};
+
+}
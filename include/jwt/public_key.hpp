@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace jwt {
+
+namespace detail {
+    /// Shared, immutable state of one interned key (owned by the intern pool)
+    struct PublicKeyEntry {
+        std::string encoded;
+        std::array<std::uint8_t, 32> bytes{};
+        std::size_t hash = 0;
+        std::atomic<std::uint32_t> refs{0};
+        std::uint8_t prefixByte = 0;
+        std::uint8_t shard = 0;
+        bool valid = false;
+    };
+
+    void releasePublicKey(PublicKeyEntry* entry) noexcept;
+}
+
+/**
+ * Interned handle to an encoded nkey public key (e.g., "UABC...").
+ *
+ * Every distinct key string maps to one shared entry in a process-wide,
+ * concurrent intern pool holding the decoded 32-byte key, its prefix and a
+ * precomputed hash, so equality is a pointer comparison and hashing is a
+ * load. Copies are reference counted; the entry is dropped when the last
+ * handle goes away. Strings that are not well-formed nkeys are interned
+ * verbatim with valid() false, so claims can still carry and report them.
+ */
+class PublicKey {
+public:
+    /// Empty handle (no key)
+    PublicKey() noexcept = default;
+
+    /**
+     * Intern an encoded public key
+     * @param encoded Encoded key; an empty string yields an empty handle
+     */
+    explicit PublicKey(std::string_view encoded);
+
+    /**
+     * Intern many keys at once (e.g., all signing keys of an account).
+     * Keys not yet in the pool are decoded and checksummed as one batch.
+     * @param encoded Encoded keys
+     * @return One handle per input, in order
+     */
+    [[nodiscard]] static std::vector<PublicKey> internAll(std::span<const std::string_view> encoded);
+
+    PublicKey(const PublicKey& other) noexcept : entry_(other.entry_) {
+        if (entry_) entry_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    PublicKey(PublicKey&& other) noexcept : entry_(other.entry_) { other.entry_ = nullptr; }
+    PublicKey& operator=(const PublicKey& other) noexcept {
+        PublicKey copy(other);
+        std::swap(entry_, copy.entry_);
+        return *this;
+    }
+    PublicKey& operator=(PublicKey&& other) noexcept {
+        std::swap(entry_, other.entry_);
+        return *this;
+    }
+    ~PublicKey() {
+        if (entry_) detail::releasePublicKey(entry_);
+    }
+
+    /// True if the handle holds no key
+    [[nodiscard]] bool empty() const noexcept { return entry_ == nullptr; }
+
+    /// True if the key is a well-formed nkey public key with a valid checksum
+    [[nodiscard]] bool valid() const noexcept { return entry_ && entry_->valid; }
+
+    /// Leading type character of the encoded key ('O', 'A', 'U', ...), or '\0' if empty
+    [[nodiscard]] char prefix() const noexcept {
+        return entry_ && !entry_->encoded.empty() ? entry_->encoded[0] : '\0';
+    }
+
+    /// Decoded 32-byte Ed25519 key (all zero unless valid())
+    [[nodiscard]] const std::array<std::uint8_t, 32>& bytes() const noexcept {
+        return entry_ ? entry_->bytes : emptyEntry().bytes;
+    }
+
+    /// Encoded key string (empty if the handle is empty)
+    [[nodiscard]] const std::string& str() const noexcept {
+        return entry_ ? entry_->encoded : emptyEntry().encoded;
+    }
+
+    /// Precomputed hash of the encoded key
+    [[nodiscard]] std::size_t hash() const noexcept { return entry_ ? entry_->hash : 0; }
+
+    friend bool operator==(const PublicKey& a, const PublicKey& b) noexcept { return a.entry_ == b.entry_; }
+    friend bool operator==(const PublicKey& a, std::string_view b) noexcept { return a.str() == b; }
+
+private:
+    static const detail::PublicKeyEntry& emptyEntry() noexcept;
+
+    detail::PublicKeyEntry* entry_ = nullptr;
+};
+
+/// Write the encoded key
+std::ostream& operator<<(std::ostream& os, const PublicKey& key);
+
+/**
+ * Get the number of distinct keys currently interned
+ * @return Live entries in the intern pool
+ */
+[[nodiscard]] std::size_t internedPublicKeyCount();
+
+}
+
+template <>
+struct std::hash<jwt::PublicKey> {
+    std::size_t operator()(const jwt::PublicKey& key) const noexcept { return key.hash(); }
+};
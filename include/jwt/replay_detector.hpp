@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace jwt {
+
+/// Outcome of ReplayDetector::check()
+enum class ReplayCheck : std::uint8_t {
+    Fresh,     // First sighting; now recorded
+    Replayed,  // Seen before within the window
+    Expired,   // Token already expired; not recorded
+    Overflow,  // The token's bucket is full; not recorded
+};
+
+/**
+ * Detects reuse of one-shot tokens by their "jti".
+ *
+ * A JTI is reduced to a 64-bit fingerprint (the 16 bytes of a hex JTI from
+ * generateJti(), or a hash of any other string) and recorded in the bucket
+ * of its token's expiry. Buckets cover Options::granularity seconds each and
+ * form a ring of Options::buckets, so a bucket is reused, and everything in
+ * it dropped at once, only after all its tokens have expired. Each bucket is
+ * a fixed open-addressing table of atomic slots: memory is bounded by
+ * memoryBytes(), lookups take no lock, and inserts take one only to reclaim
+ * an expired bucket.
+ *
+ * Tokens that never expire, or expire beyond the window
+ * (buckets * granularity), are kept for the window only; their checks scan
+ * every bucket. Size the window to the longest lifetime that needs replay
+ * protection. Fingerprints can collide with probability about n / 2^64 for
+ * n recorded tokens, which reports a fresh token as replayed.
+ */
+class ReplayDetector {
+public:
+    struct Options {
+        std::int64_t granularity = 60;           // Seconds per bucket
+        std::size_t buckets = 64;                // Window = buckets * granularity
+        std::size_t capacityPerBucket = 1 << 14;  // Rounded up to a power of two; 3/4 may be filled
+    };
+
+    /// @throws std::invalid_argument if an option is zero or negative
+    explicit ReplayDetector(Options options);
+    ReplayDetector();
+    ~ReplayDetector();
+
+    ReplayDetector(const ReplayDetector&) = delete;
+    ReplayDetector& operator=(const ReplayDetector&) = delete;
+
+    /**
+     * Check a JTI and record it if fresh. Safe to call from any number of
+     * threads; of several concurrent checks of one JTI exactly one is Fresh.
+     * @param jti Token ID
+     * @param expires Token expiry, Unix seconds (0 = never)
+     * @param now Unix seconds
+     */
+    ReplayCheck check(std::string_view jti, std::int64_t expires, std::int64_t now);
+
+    /// check() at the current time
+    ReplayCheck check(std::string_view jti, std::int64_t expires);
+
+    /**
+     * check() with the "jti" and "exp" of a token's payload (the token is
+     * not verified; verify it first or after, as the caller prefers)
+     * @throws std::invalid_argument if the token is malformed or has no jti
+     */
+    ReplayCheck checkToken(const std::string& token, std::int64_t now);
+
+    /// True if the JTI is recorded; takes no lock and records nothing
+    [[nodiscard]] bool seen(std::string_view jti, std::int64_t expires, std::int64_t now) const;
+
+    /// Bytes allocated for all buckets
+    [[nodiscard]] std::size_t memoryBytes() const;
+
+    /// Recorded JTIs across live buckets (approximate under concurrent checks)
+    [[nodiscard]] std::size_t size(std::int64_t now) const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "jwt/public_key.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace nkeys {
+class KeyPair;
+}
+
+namespace jwt {
+
+/**
+ * Signing key decoded once from an nkey seed.
+ *
+ * encode(seed) decodes the seed and derives the key pair on every call;
+ * services that sign many tokens with the same key should build a Signer
+ * once and pass it to encode(const Signer&) instead. Signing only reads the
+ * decoded key, so one Signer can be shared by every encoding thread.
+ */
+class Signer {
+public:
+    /**
+     * Decode a seed
+     * @param seed Encoded nkey seed (e.g., "SA...")
+     * @throws std::invalid_argument if the seed is malformed
+     */
+    explicit Signer(const std::string& seed);
+
+    /// Public key matching the seed
+    [[nodiscard]] const PublicKey& publicKey() const;
+
+    /// Ed25519 signature (64 bytes) over data
+    [[nodiscard]] std::vector<std::uint8_t> sign(std::span<const std::uint8_t> data) const;
+
+private:
+    std::shared_ptr<const nkeys::KeyPair> keyPair_;
+    PublicKey publicKey_;
+};
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwt {
+
+/**
+ * One destination of a subject mapping (an entry of NATS "mappings").
+ *
+ * The destination is a subject whose tokens are either literals or one
+ * mapping function: {{wildcard(n)}} (or $n), {{partition(count,n...)}},
+ * {{split(n,delim)}}, {{splitFromLeft(n,pos)}}, {{splitFromRight(n,pos)}},
+ * {{sliceFromLeft(n,size)}} or {{sliceFromRight(n,size)}}, where n is the
+ * 1-based index of a '*' in the source. A trailing '>' takes the tokens the
+ * source's '>' matched.
+ */
+struct WeightedMapping {
+    std::string subject;
+    std::uint8_t weight = 0;  // Percent of messages; 0 means 100
+    std::string cluster;      // Only used in this cluster (empty = any)
+
+    friend bool operator==(const WeightedMapping&, const WeightedMapping&) = default;
+};
+
+/// Destinations for messages published to a source subject
+struct SubjectMapping {
+    std::string source;  // Subject or pattern with '*' / trailing '>'
+    std::vector<WeightedMapping> destinations;
+
+    friend bool operator==(const SubjectMapping&, const SubjectMapping&) = default;
+};
+
+/**
+ * Subject mappings compiled for per-message use.
+ *
+ * Sources go into a subject trie (literal tokens win over '*', and '*' over
+ * '>'). Each destination template is parsed once into a list of ops, and
+ * each source's weights into an alias table (Vose), so map() walks the trie,
+ * picks a destination with one multiply and one compare, and appends tokens;
+ * it parses no strings. If a source's weights add up to less than 100, the
+ * rest of its messages keep their subject. map() writes only to the
+ * caller's buffer, so one mapper can serve every connection thread.
+ */
+class SubjectMapper {
+public:
+    /// Mapper with no mappings
+    SubjectMapper() = default;
+
+    /**
+     * Compile mappings
+     * @param mappings Mappings to compile
+     * @param cluster Local cluster; destinations for it replace the cluster-less ones
+     * @throws std::invalid_argument if a subject or template is malformed,
+     *         or a source's weights exceed 100
+     */
+    explicit SubjectMapper(std::vector<SubjectMapping> mappings, std::string_view cluster = {});
+
+    /// Compiled mappings, in their original order
+    [[nodiscard]] const std::vector<SubjectMapping>& mappings() const;
+
+    [[nodiscard]] bool empty() const;
+
+    /**
+     * Map a published subject
+     * @param subject Literal subject
+     * @param random Uniform random value that picks the weighted destination
+     * @param out Receives the mapped subject (its capacity is reused)
+     * @return false if no mapping matches (out is then untouched)
+     */
+    bool map(std::string_view subject, std::uint64_t random, std::string& out) const;
+
+    /// map() with a per-thread random source; nullopt if no mapping matches
+    [[nodiscard]] std::optional<std::string> map(std::string_view subject) const;
+
+private:
+    class Impl;
+    std::shared_ptr<const Impl> impl_;
+};
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwt {
+
+/// Small integer standing for one tag in the process-wide tag dictionary
+using TagId = std::uint32_t;
+
+/// Most tags the process-wide dictionary will hold
+constexpr std::size_t MAX_INTERNED_TAGS = 1 << 16;
+
+/**
+ * Intern a tag, assigning it the next free ID on first use.
+ * Tags are trimmed and lower-cased first, so "Prod " and "prod" share an ID.
+ * @throws std::invalid_argument if the tag is blank or the dictionary is full
+ */
+[[nodiscard]] TagId internTag(std::string_view tag);
+
+/// ID of an already interned tag (after the same normalization), without interning it
+[[nodiscard]] std::optional<TagId> findTag(std::string_view tag);
+
+/// Normalized name of an interned tag
+/// @throws std::out_of_range for an unknown ID
+[[nodiscard]] std::string tagName(TagId id);
+
+/// Number of distinct tags interned so far
+[[nodiscard]] std::size_t internedTagCount();
+
+/**
+ * Set of tags stored as sorted interned tag IDs.
+ *
+ * A claim has a few tags, so hasAll()/hasAny() merge two short sorted
+ * arrays. Tags read from tokens are not interned (addUninterned()): one the
+ * dictionary does not know yet is kept by name in the set itself, so
+ * decoding unverified tokens cannot grow the dictionary.
+ */
+class TagSet {
+public:
+    TagSet() = default;
+
+    /// Intern and add each tag (blank tags are skipped)
+    TagSet(std::initializer_list<std::string_view> tags);
+    explicit TagSet(const std::vector<std::string>& tags);
+
+    void add(TagId id);
+    void add(std::string_view tag);  // Interns (by name once the dictionary is full); blank tags are skipped
+
+    /// Add a tag by its ID if already interned, else by name; blank tags are skipped
+    void addUninterned(std::string_view tag);
+
+    [[nodiscard]] bool contains(TagId id) const;
+    [[nodiscard]] bool contains(std::string_view tag) const;  // Never interns
+
+    /// True if every tag in required is in this set (true for an empty required set)
+    [[nodiscard]] bool hasAll(const TagSet& required) const;
+
+    /// True if at least one tag in wanted is in this set
+    [[nodiscard]] bool hasAny(const TagSet& wanted) const;
+
+    [[nodiscard]] bool empty() const { return ids_.empty() && names_.empty(); }
+    [[nodiscard]] std::size_t size() const { return ids_.size() + names_.size(); }
+
+    /// IDs of the tags held by ID, in ascending order
+    [[nodiscard]] std::vector<TagId> ids() const { return ids_; }
+
+    /// Tag names: those held by ID in ID order, then those held by name
+    [[nodiscard]] std::vector<std::string> names() const;
+
+    friend bool operator==(const TagSet& a, const TagSet& b);
+
+private:
+    [[nodiscard]] bool containsName(const std::string& normalized) const;
+
+    std::vector<TagId> ids_;          // Sorted
+    std::vector<std::string> names_;  // Sorted normalized names not interned when added
+};
+
+}
@@ -1,5 +1,10 @@
 #pragma once
 #include "jwt/claims.hpp"
+#include "jwt/connection_policy.hpp"
+#include "jwt/limits.hpp"
+#include "jwt/permissions.hpp"
+#include "jwt/signer.hpp"
+#include <string_view>
 #include <optional>
 
 namespace jwt {
@@ -8,24 +13,72 @@ namespace jwt {
 class UserClaims : public Claims {
 public:
     /// Create user claims with the given public key
-    explicit UserClaims(const std::string& userPublicKey);
+    explicit UserClaims(std::string_view userPublicKey);
     ~UserClaims() override;
 
+    /// Copies are deep; a moved-from object may only be assigned to or destroyed
+    UserClaims(const UserClaims& other);
+    UserClaims(UserClaims&& other) noexcept;
+    UserClaims& operator=(const UserClaims& other);
+    UserClaims& operator=(UserClaims&& other) noexcept;
+
     // Claims interface
     [[nodiscard]] std::string subject() const override;
     [[nodiscard]] std::string issuer() const override;
+    [[nodiscard]] const PublicKey& subjectKey() const override;
+    [[nodiscard]] const PublicKey& issuerKey() const override;
     [[nodiscard]] std::optional<std::string> name() const override;
     [[nodiscard]] std::int64_t issuedAt() const override;
     [[nodiscard]] std::int64_t expires() const override;
+    [[nodiscard]] const TagSet& tags() const override;
     [[nodiscard]] std::string encode(const std::string& seed) const override;
     void validate() const override;
 
+    /// Encode with a pre-decoded signing key (see Signer)
+    [[nodiscard]] std::string encode(const Signer& signer) const;
+
     // User-specific
-    void setName(const std::string& name);
+    void setName(std::string name);
     void setExpires(std::int64_t exp);
-    void setIssuer(const std::string& issuerKey);
-    void setIssuerAccount(const std::string& accountPublicKey);
+    void setIssuedAt(std::int64_t iat);  // 0 = the time of encode()
+    void setTags(TagSet tags);
+    void addTag(std::string_view tag);  // Trimmed and lower-cased; blank tags are ignored
+    void setIssuer(std::string_view issuerKey);
+    void setIssuerAccount(std::string_view accountPublicKey);
     [[nodiscard]] std::optional<std::string> issuerAccount() const;
+    [[nodiscard]] const PublicKey& issuerAccountKey() const;  // Empty if not set
+
+    /**
+     * Set publish/subscribe permissions and compile their matchers
+     * @throws std::invalid_argument if a subject pattern is malformed
+     */
+    void setPermissions(Permissions permissions);
+    [[nodiscard]] const Permissions& permissions() const;
+
+    /// Compiled matchers, built once when the permissions are set or decoded
+    [[nodiscard]] const PermissionMatcher& publishMatcher() const;
+    [[nodiscard]] const PermissionMatcher& subscribeMatcher() const;
+
+    /// Check a subject against the compiled publish/subscribe permissions
+    [[nodiscard]] bool canPublish(std::string_view subject) const;
+    [[nodiscard]] bool canSubscribe(std::string_view subject) const;
+
+    /// Per-connection limits (NATS "subs", "data", "payload"; unlimited by default)
+    void setLimits(const NatsLimits& limits);
+    [[nodiscard]] const NatsLimits& limits() const;
+
+    /**
+     * Set source network, time-of-day and connection type restrictions and compile them
+     * @throws std::invalid_argument if a network or time is malformed
+     */
+    void setConnectionRestrictions(ConnectionRestrictions restrictions);
+    [[nodiscard]] const ConnectionRestrictions& connectionRestrictions() const;
+
+    /// Compiled restrictions, built once when they are set or decoded
+    [[nodiscard]] const ConnectionPolicy& connectionPolicy() const;
+
+    /// Check a connecting client (minuteOfDay is taken in connectionRestrictions().timesLocation)
+    [[nodiscard]] bool canConnect(const IpAddress& address, ConnectionType type, int minuteOfDay) const;
 
 private:
     friend std::unique_ptr<UserClaims> decodeUserClaims(const std::string&);
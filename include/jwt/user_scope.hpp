@@ -0,0 +1,84 @@
+#pragma once
+#include "jwt/limits.hpp"
+#include "jwt/permissions.hpp"
+#include "jwt/public_key.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace jwt {
+
+class UserClaims;
+
+/// Permissions and limits a scoped signing key imposes on every user it signs
+struct ScopeTemplate {
+    Permissions permissions;  // Subjects may use {{name()}}, {{subject()}} and {{tag(<name>)}}
+    NatsLimits limits;
+
+    friend bool operator==(const ScopeTemplate&, const ScopeTemplate&) = default;
+};
+
+/// Compiled permissions and limits in effect for one user
+struct ResolvedPermissions {
+    PermissionMatcher pub;
+    PermissionMatcher sub;
+    NatsLimits limits;
+
+    [[nodiscard]] bool canPublish(std::string_view subject) const { return pub.allows(subject); }
+    [[nodiscard]] bool canSubscribe(std::string_view subject) const { return sub.allows(subject); }
+};
+
+/**
+ * Scope attached to an account signing key (NATS "user_scope").
+ *
+ * Templates are parsed when the scope is created, i.e. once per account
+ * decode. A template without placeholders is also compiled then, and
+ * resolve() hands every user the same shared matchers; otherwise resolve()
+ * substitutes the user's values into the pre-split patterns, compiles the
+ * result, and caches it under the values it used, so later calls for the
+ * same name, subject and tags are a hash lookup. Copies of a scope share the
+ * cache, which holds up to MAX_CACHED_USERS entries and starts over when full.
+ *
+ * Placeholders: {{name()}} is the user's name, {{subject()}} its public key,
+ * and {{tag(x)}} the value of each user tag "x:value" (one subject per value).
+ */
+class UserScope {
+public:
+    /// Resolved permissions a templated scope keeps before its cache is cleared
+    static constexpr std::size_t MAX_CACHED_USERS = 4096;
+
+    /**
+     * Create and precompile a scope
+     * @throws std::invalid_argument for an unknown or unterminated placeholder,
+     *         or a malformed subject in a template without placeholders
+     */
+    UserScope(PublicKey key, std::string role, ScopeTemplate scopeTemplate, std::string description = {});
+
+    [[nodiscard]] const PublicKey& key() const;
+    [[nodiscard]] const std::string& role() const;
+    [[nodiscard]] const std::string& description() const;
+    [[nodiscard]] const ScopeTemplate& scopeTemplate() const;
+
+    /// True if any subject uses a placeholder
+    [[nodiscard]] bool isTemplated() const;
+
+    /**
+     * Permissions in effect for a user signed by this key
+     * @param user The user (its name, subject and tags fill the placeholders)
+     * @return Shared compiled permissions (the same object for every user if not
+     *         templated, and for repeated calls with the same user values)
+     * @throws std::invalid_argument if a placeholder cannot be filled (no name, missing tag),
+     *         a value is not a single token ('.', '*', '>' or whitespace), or the
+     *         result is a malformed subject
+     */
+    [[nodiscard]] std::shared_ptr<const ResolvedPermissions> resolve(const UserClaims& user) const;
+
+    friend bool operator==(const UserScope& a, const UserScope& b);
+
+private:
+    class Impl;
+    std::shared_ptr<const Impl> impl_;
+};
+
+}
@@ -14,15 +14,16 @@ namespace jwt {
 struct ValidationResult {
     bool valid;
     std::optional<std::string> error;
+    std::int64_t expiresAt = 0;  // Earliest "exp" of the validated token(s), 0 = never
 
     explicit operator bool() const { return valid; }
 
-    static ValidationResult success() {
-        return ValidationResult{true, std::nullopt};
+    static ValidationResult success(std::int64_t expiresAt = 0) {
+        return ValidationResult{true, std::nullopt, expiresAt};
     }
 
     static ValidationResult failure(const std::string& msg) {
-        return ValidationResult{false, msg};
+        return ValidationResult{false, msg, 0};
     }
 };
 
@@ -41,12 +42,16 @@ struct ValidationOptions {
     // Chain validation
     bool checkIssuerChain = false;      // Verify issuer chain (parent signed child)
 
+    // Key validation
+    bool checkKeys = false;             // Require well-formed nkeys (type and checksum)
+
     static ValidationOptions strict() {
         ValidationOptions opts;
         opts.checkExpiration = true;
         opts.checkNotBefore = true;
         opts.checkSignature = true;
         opts.checkIssuerChain = true;
+        opts.checkKeys = true;
         opts.clockSkewSeconds = 0;
         return opts;
     }
@@ -57,6 +62,7 @@ struct ValidationOptions {
         opts.checkNotBefore = false;
         opts.checkSignature = false;
         opts.checkIssuerChain = false;
+        opts.checkKeys = false;
         opts.clockSkewSeconds = 300;  // 5 minutes
         return opts;
     }
@@ -89,6 +95,7 @@ ValidationResult validateTiming(const Claims& claims, const ValidationOptions& o
 
 /**
  * Validate the issuer chain - verify that the child's issuer matches the parent's subject
+ * (or, for an account parent, one of its signing keys)
  * @param child The child claims (signed by parent)
  * @param parent The parent claims (issuer)
  * @return ValidationResult indicating if the chain is valid
@@ -103,6 +110,15 @@ ValidationResult validateIssuerChain(const Claims& child, const Claims& parent);
  */
 ValidationResult validateKeyHierarchy(const Claims& child, const Claims& parent);
 
+/**
+ * Check that every key in the claims (subject, issuer, issuer account and
+ * signing keys) is a well-formed nkey with a valid checksum. Keys are decoded
+ * once when interned, so this reads a flag per key.
+ * @param claims The claims to validate
+ * @return ValidationResult naming the first malformed key
+ */
+ValidationResult validateKeys(const Claims& claims);
+
 /**
  * Perform comprehensive validation on a JWT string
  * @param jwt The JWT string to validate
@@ -123,7 +139,8 @@ ValidationResult validate(const Claims& claims, const ValidationOptions& opts =
  * Validate a complete trust chain (Operator -> Account -> User)
  * @param jwts Vector of JWT strings in hierarchy order [operator, account, user]
  * @param opts Validation options
- * @return ValidationResult with details of any failures
+ * @return ValidationResult with details of any failures; on success expiresAt
+ *         is the earliest expiry across the chain, when its credentials lapse
  */
 ValidationResult validateChain(const std::vector<std::string>& jwts, const ValidationOptions& opts = ValidationOptions{});
 
@@ -1,49 +1,256 @@
 #include "jwt/account_claims.hpp"
+#include "jwt/user_claims.hpp"
 #include "jwt/jwt_constants.hpp"
 #include "base64url.hpp"
 #include "jwt_utils.hpp"
+#include "probes.hpp"
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <stdexcept>
 
 namespace jwt {
 
 class AccountClaims::Impl {
 public:
-    std::string subject_;
-    std::string issuer_;
+    PublicKey subject_;
+    PublicKey issuer_;
     std::optional<std::string> name_;
     std::int64_t issuedAt_ = 0;
     std::int64_t expires_ = 0;
-    std::vector<std::string> signingKeys_;
+    TagSet tags_;
+    std::vector<PublicKey> signingKeys_;
+    std::unordered_map<PublicKey, std::int64_t> revocations_;
+    internal::LazyValue<std::vector<std::string>> signingKeyStrings_;
+    internal::LazyValue<std::map<std::string, std::int64_t>> revocationStrings_;
+    ExportIndex exports_;
+    std::shared_ptr<const std::vector<Import>> imports_;  // Null if none; shared with FlatClaims
+    SubjectMapper mappings_;
+    AccountLimits limits_;
+    std::unordered_map<PublicKey, UserScope> scopes_;
 };
 
-AccountClaims::AccountClaims(const std::string& accountPublicKey)
+namespace {
+    nlohmann::json encodeLimits(const AccountLimits& limits) {
+        nlohmann::json out = nlohmann::json::object();
+        internal::writeNatsLimits(limits.nats, out);
+        out["imports"] = limits.imports;
+        out["exports"] = limits.exports;
+        out["wildcards"] = limits.wildcardExports;
+        out["conn"] = limits.conn;
+        out["leaf"] = limits.leaf;
+        const auto& js = limits.jetstream;
+        out["mem_storage"] = js.memoryStorage;
+        out["disk_storage"] = js.diskStorage;
+        out["streams"] = js.streams;
+        out["consumer"] = js.consumers;
+        out["max_ack_pending"] = js.maxAckPending;
+        out["mem_max_stream_bytes"] = js.memoryMaxStreamBytes;
+        out["disk_max_stream_bytes"] = js.diskMaxStreamBytes;
+        out["max_bytes_required"] = js.maxBytesRequired;
+        return out;
+    }
+
+    /// Fill limits in place; fields missing from the claim keep their defaults
+    void decodeLimits(const nlohmann::json& object, AccountLimits& limits) {
+        using internal::readLimit;
+        internal::readNatsLimits(object, limits.nats);
+        readLimit(object, "imports", limits.imports);
+        readLimit(object, "exports", limits.exports);
+        readLimit(object, "conn", limits.conn);
+        readLimit(object, "leaf", limits.leaf);
+        if (auto it = object.find("wildcards"); it != object.end()) {
+            limits.wildcardExports = it->get<bool>();
+        }
+        auto& js = limits.jetstream;
+        readLimit(object, "mem_storage", js.memoryStorage);
+        readLimit(object, "disk_storage", js.diskStorage);
+        readLimit(object, "streams", js.streams);
+        readLimit(object, "consumer", js.consumers);
+        readLimit(object, "max_ack_pending", js.maxAckPending);
+        readLimit(object, "mem_max_stream_bytes", js.memoryMaxStreamBytes);
+        readLimit(object, "disk_max_stream_bytes", js.diskMaxStreamBytes);
+        if (auto it = object.find("max_bytes_required"); it != object.end()) {
+            js.maxBytesRequired = it->get<bool>();
+        }
+    }
+
+    constexpr const char* USER_SCOPE_KIND = "user_scope";
+
+    nlohmann::json encodeScope(const UserScope& scope) {
+        nlohmann::json scopeTemplate = nlohmann::json::object();
+        internal::writePermissions(scope.scopeTemplate().permissions, scopeTemplate);
+        internal::writeNatsLimits(scope.scopeTemplate().limits, scopeTemplate);
+        nlohmann::json out = {
+            {"kind", USER_SCOPE_KIND},
+            {"key", scope.key().str()},
+            {"role", scope.role()},
+            {"template", std::move(scopeTemplate)}
+        };
+        if (!scope.description().empty()) {
+            out["description"] = scope.description();
+        }
+        return out;
+    }
+}
+
+AccountClaims::AccountClaims(std::string_view accountPublicKey)
     : impl_(std::make_unique<Impl>()) {
-    impl_->subject_ = accountPublicKey;
+    impl_->subject_ = PublicKey(accountPublicKey);
 }
 
 AccountClaims::~AccountClaims() = default;
+AccountClaims::AccountClaims(const AccountClaims& other) : impl_(std::make_unique<Impl>(*other.impl_)) {}
+AccountClaims::AccountClaims(AccountClaims&& other) noexcept = default;
+AccountClaims& AccountClaims::operator=(const AccountClaims& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<Impl>(*other.impl_);
+    }
+    return *this;
+}
+AccountClaims& AccountClaims::operator=(AccountClaims&& other) noexcept = default;
 
-std::string AccountClaims::subject() const { return impl_->subject_; }
-std::string AccountClaims::issuer() const { return impl_->issuer_; }
+std::string AccountClaims::subject() const { return impl_->subject_.str(); }
+std::string AccountClaims::issuer() const { return impl_->issuer_.str(); }
+const PublicKey& AccountClaims::subjectKey() const { return impl_->subject_; }
+const PublicKey& AccountClaims::issuerKey() const { return impl_->issuer_; }
 std::optional<std::string> AccountClaims::name() const { return impl_->name_; }
 std::int64_t AccountClaims::issuedAt() const { return impl_->issuedAt_; }
 std::int64_t AccountClaims::expires() const { return impl_->expires_; }
+const TagSet& AccountClaims::tags() const { return impl_->tags_; }
 
-void AccountClaims::setName(const std::string& name) { impl_->name_ = name; }
+void AccountClaims::setName(std::string name) { impl_->name_ = std::move(name); }
 void AccountClaims::setExpires(std::int64_t exp) { impl_->expires_ = exp; }
-void AccountClaims::setIssuer(const std::string& issuerKey) { impl_->issuer_ = issuerKey; }
-void AccountClaims::addSigningKey(const std::string& publicKey) {
-    impl_->signingKeys_.push_back(publicKey);
+void AccountClaims::setTags(TagSet tags) { impl_->tags_ = std::move(tags); }
+void AccountClaims::addTag(std::string_view tag) { impl_->tags_.add(tag); }
+void AccountClaims::setIssuer(std::string_view issuerKey) { impl_->issuer_ = PublicKey(issuerKey); }
+void AccountClaims::addSigningKey(std::string_view publicKey) {
+    impl_->signingKeys_.emplace_back(publicKey);
+    impl_->signingKeyStrings_.invalidate();
+}
+void AccountClaims::addSigningKey(PublicKey publicKey) {
+    impl_->signingKeys_.push_back(std::move(publicKey));
+    impl_->signingKeyStrings_.invalidate();
+}
+void AccountClaims::setSigningKeys(std::vector<std::string>&& publicKeys) {
+    std::vector<std::string_view> encoded(publicKeys.begin(), publicKeys.end());
+    impl_->signingKeys_ = PublicKey::internAll(encoded);
+    impl_->signingKeyStrings_.invalidate();
+    impl_->scopes_.clear();
+    publicKeys.clear();
+}
+void AccountClaims::setSigningKeys(std::vector<PublicKey> publicKeys) {
+    impl_->signingKeys_ = std::move(publicKeys);
+    impl_->signingKeyStrings_.invalidate();
+    impl_->scopes_.clear();
 }
 const std::vector<std::string>& AccountClaims::signingKeys() const {
+    return impl_->signingKeyStrings_.get([this]() {
+        std::vector<std::string> keys;
+        keys.reserve(impl_->signingKeys_.size());
+        for (const auto& key : impl_->signingKeys_) {
+            keys.push_back(key.str());
+        }
+        return keys;
+    });
+}
+const std::vector<PublicKey>& AccountClaims::signingKeyHandles() const {
     return impl_->signingKeys_;
 }
+void AccountClaims::addScopedSigningKey(UserScope scope) {
+    const PublicKey& key = scope.key();
+    if (std::find(impl_->signingKeys_.begin(), impl_->signingKeys_.end(), key) == impl_->signingKeys_.end()) {
+        impl_->signingKeys_.push_back(key);
+        impl_->signingKeyStrings_.invalidate();
+    }
+    impl_->scopes_.insert_or_assign(key, std::move(scope));
+}
+const UserScope* AccountClaims::scopeFor(const PublicKey& signingKey) const {
+    auto it = impl_->scopes_.find(signingKey);
+    return it != impl_->scopes_.end() ? &it->second : nullptr;
+}
+ResolvedPermissions AccountClaims::userPermissions(const UserClaims& user) const {
+    if (const auto* scope = scopeFor(user.issuerKey())) {
+        return *scope->resolve(user);
+    }
+    return ResolvedPermissions{user.publishMatcher(), user.subscribeMatcher(), user.limits()};
+}
+void AccountClaims::addRevocation(std::string_view publicKey, std::int64_t timestamp) {
+    impl_->revocations_[PublicKey(publicKey)] = timestamp;
+    impl_->revocationStrings_.invalidate();
+}
+const std::map<std::string, std::int64_t>& AccountClaims::revocations() const {
+    return impl_->revocationStrings_.get([this]() {
+        std::map<std::string, std::int64_t> revocations;
+        for (const auto& [key, timestamp] : impl_->revocations_) {
+            revocations.emplace(key.str(), timestamp);
+        }
+        return revocations;
+    });
+}
+const std::unordered_map<PublicKey, std::int64_t>& AccountClaims::revocationKeys() const {
+    return impl_->revocations_;
+}
+bool AccountClaims::isRevoked(const PublicKey& publicKey, std::int64_t issuedAt) const {
+    static const PublicKey all_users(ALL_USERS_REVOCATION);
+    const auto& revocations = impl_->revocations_;
+    auto it = revocations.find(publicKey);
+    if (it != revocations.end() && issuedAt <= it->second) {
+        return true;
+    }
+    it = revocations.find(all_users);
+    return it != revocations.end() && issuedAt <= it->second;
+}
+bool AccountClaims::isRevoked(std::string_view publicKey, std::int64_t issuedAt) const {
+    return isRevoked(PublicKey(publicKey), issuedAt);
+}
+void AccountClaims::setExports(std::vector<Export> exports) {
+    impl_->exports_ = ExportIndex(std::move(exports));
+}
+const std::vector<Export>& AccountClaims::exports() const {
+    return impl_->exports_.exports();
+}
+const ExportIndex& AccountClaims::exportIndex() const {
+    return impl_->exports_;
+}
+void AccountClaims::setImports(std::vector<Import> imports) {
+    impl_->imports_ = imports.empty() ? nullptr : std::make_shared<const std::vector<Import>>(std::move(imports));
+}
+const std::vector<Import>& AccountClaims::imports() const {
+    static const std::vector<Import> none;
+    return impl_->imports_ ? *impl_->imports_ : none;
+}
+std::shared_ptr<const std::vector<Import>> AccountClaims::sharedImports() const {
+    return impl_->imports_;
+}
+void AccountClaims::setMappings(std::vector<SubjectMapping> mappings) {
+    impl_->mappings_ = SubjectMapper(std::move(mappings));
+}
+const std::vector<SubjectMapping>& AccountClaims::mappings() const {
+    return impl_->mappings_.mappings();
+}
+const SubjectMapper& AccountClaims::subjectMapper() const {
+    return impl_->mappings_;
+}
+void AccountClaims::setLimits(const AccountLimits& limits) {
+    impl_->limits_ = limits;
+}
+const AccountLimits& AccountClaims::limits() const {
+    return impl_->limits_;
+}
 
 std::string AccountClaims::encode(const std::string& seed) const {
+    return encode(Signer(seed));
+}
+
+std::string AccountClaims::encode(const Signer& signer) const {
     using namespace internal;
     using json = nlohmann::json;
 
+    JWT_PROBE(encode__entry, PROBE_ACCOUNT);
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] std::size_t probe_token_len = 0;
+    JWT_PROBE_ON_EXIT(probe_exit, encode__return, PROBE_ACCOUNT, probe_result, probe_token_len);
+
     validate();
 
     // Auto-generate JTI and issuedAt
@@ -54,8 +261,8 @@ std::string AccountClaims::encode(const std::string& seed) const {
     json payload = {
         {"jti", jti},
         {"iat", iat},
-        {"iss", impl_->issuer_},
-        {"sub", impl_->subject_}
+        {"iss", impl_->issuer_.str()},
+        {"sub", impl_->subject_.str()}
     };
 
     if (impl_->name_) {
@@ -71,38 +278,82 @@ std::string AccountClaims::encode(const std::string& seed) const {
         {"version", JWT_VERSION}
     };
     if (!impl_->signingKeys_.empty()) {
-        nats_claims["signing_keys"] = impl_->signingKeys_;
+        json signing_keys = json::array();
+        for (const auto& key : impl_->signingKeys_) {
+            if (const auto* scope = scopeFor(key)) {
+                signing_keys.push_back(encodeScope(*scope));
+            } else {
+                signing_keys.push_back(key.str());
+            }
+        }
+        nats_claims["signing_keys"] = std::move(signing_keys);
+    }
+    if (!impl_->revocations_.empty()) {
+        json revocations = json::object();
+        for (const auto& [key, timestamp] : impl_->revocations_) {
+            revocations[key.str()] = timestamp;
+        }
+        nats_claims["revocations"] = std::move(revocations);
+    }
+    if (!impl_->exports_.exports().empty()) {
+        json exports = json::array();
+        for (const auto& e : impl_->exports_.exports()) {
+            json entry = {{"subject", e.subject}, {"type", exportTypeName(e.type)}};
+            if (!e.name.empty()) {
+                entry["name"] = e.name;
+            }
+            if (e.tokenRequired) {
+                entry["token_req"] = true;
+            }
+            exports.push_back(std::move(entry));
+        }
+        nats_claims["exports"] = std::move(exports);
+    }
+    if (impl_->imports_) {
+        json imports = json::array();
+        for (const auto& i : *impl_->imports_) {
+            json entry = {{"subject", i.subject}, {"account", i.account.str()}, {"type", exportTypeName(i.type)}};
+            if (!i.name.empty()) {
+                entry["name"] = i.name;
+            }
+            if (!i.token.empty()) {
+                entry["token"] = i.token;
+            }
+            if (!i.localSubject.empty()) {
+                entry["local_subject"] = i.localSubject;
+            }
+            imports.push_back(std::move(entry));
+        }
+        nats_claims["imports"] = std::move(imports);
+    }
+    if (!impl_->mappings_.mappings().empty()) {
+        json mappings = json::object();
+        for (const auto& m : impl_->mappings_.mappings()) {
+            json destinations = json::array();
+            for (const auto& d : m.destinations) {
+                json entry = {{"subject", d.subject}};
+                if (d.weight != 0) {
+                    entry["weight"] = d.weight;
+                }
+                if (!d.cluster.empty()) {
+                    entry["cluster"] = d.cluster;
+                }
+                destinations.push_back(std::move(entry));
+            }
+            mappings[m.source] = std::move(destinations);
+        }
+        nats_claims["mappings"] = std::move(mappings);
     }
+    if (impl_->limits_ != AccountLimits{}) {
+        nats_claims["limits"] = encodeLimits(impl_->limits_);
+    }
+    writeTags(impl_->tags_, nats_claims);
     payload["nats"] = nats_claims;
 
-    // Create JWT: header.payload.signature
-    std::string header_json = createHeader();
-    std::string payload_json = payload.dump();
-
-    // Convert strings to byte spans for encoding
-    std::span<const std::uint8_t> header_bytes(
-        reinterpret_cast<const std::uint8_t*>(header_json.data()),
-        header_json.size()
-    );
-    std::span<const std::uint8_t> payload_bytes(
-        reinterpret_cast<const std::uint8_t*>(payload_json.data()),
-        payload_json.size()
-    );
-
-    std::string header_b64 = base64url_encode(header_bytes);
-    std::string payload_b64 = base64url_encode(payload_bytes);
-
-    // Sign "header.payload"
-    std::string signing_input = header_b64 + "." + payload_b64;
-    std::span<const std::uint8_t> signing_bytes(
-        reinterpret_cast<const std::uint8_t*>(signing_input.data()),
-        signing_input.size()
-    );
-
-    auto signature_bytes = signData(seed, signing_bytes);
-    std::string signature_b64 = base64url_encode(signature_bytes);
-
-    return signing_input + "." + signature_b64;
+    std::string token = signJwt(payload.dump(), signer);
+    probe_result = PROBE_OK;
+    probe_token_len = token.size();
+    return token;
 }
 
 void AccountClaims::validate() const {
@@ -112,46 +363,47 @@ void AccountClaims::validate() const {
     if (impl_->issuer_.empty()) {
         throw std::invalid_argument("Account issuer cannot be empty (must be signed by Operator)");
     }
-    if (impl_->subject_[0] != 'A') {
+    if (impl_->subject_.prefix() != 'A') {
         throw std::invalid_argument("Account subject must start with 'A'");
     }
-    if (impl_->issuer_[0] != 'O') {
+    if (impl_->issuer_.prefix() != 'O') {
         throw std::invalid_argument("Account issuer must be an Operator (start with 'O')");
     }
     if (impl_->expires_ > 0 && impl_->issuedAt_ > 0 &&
         impl_->expires_ <= impl_->issuedAt_) {
         throw std::invalid_argument("Expiration must be after issuedAt");
     }
+    for (const auto& import : imports()) {
+        if (import.subject.empty()) {
+            throw std::invalid_argument("Import subject cannot be empty");
+        }
+        if (import.account.prefix() != 'A') {
+            throw std::invalid_argument("Import account must be an Account (start with 'A')");
+        }
+    }
 }
 
 std::unique_ptr<AccountClaims> decodeAccountClaims(const std::string& jwt) {
     using namespace internal;
-    using json = nlohmann::json;
+
+    JWT_PROBE(decode__entry, jwt.size(), PROBE_ACCOUNT);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_ACCOUNT, probe_result);
 
     // Parse JWT into its three components
     auto parts = parseJwt(jwt);
 
     // Decode and validate header
-    auto header_bytes = base64url_decode(parts.header_b64);
-    std::string header_json(header_bytes.begin(), header_bytes.end());
-    auto header = json::parse(header_json);
-
-    if (!header.contains("alg") || header["alg"] != JWT_ALGORITHM) {
-        throw std::invalid_argument(
-            "Unsupported algorithm: expected '" + std::string(JWT_ALGORITHM) + "'"
-        );
-    }
+    decodeHeader(parts);
 
     // Decode and parse payload
-    auto payload_bytes = base64url_decode(parts.payload_b64);
-    std::string payload_json(payload_bytes.begin(), payload_bytes.end());
-    auto payload = json::parse(payload_json);
+    auto payload = decodePayload(parts);
 
     // Validate NATS-specific claims
     if (!payload.contains("nats")) {
         throw std::invalid_argument("Missing 'nats' object in JWT payload");
     }
-    auto nats = payload["nats"];
+    auto& nats = payload["nats"];
 
     if (!nats.contains("type") || nats["type"] != "account") {
         throw std::invalid_argument(
@@ -167,20 +419,20 @@ std::unique_ptr<AccountClaims> decodeAccountClaims(const std::string& jwt) {
     }
 
     // Extract required fields
-    std::string subject = payload.at("sub").get<std::string>();
-    std::string issuer = payload.at("iss").get<std::string>();
+    const auto& subject = payload.at("sub").get_ref<const std::string&>();
+    const auto& issuer = payload.at("iss").get_ref<const std::string&>();
     std::int64_t iat = payload.at("iat").get<std::int64_t>();
 
     // Create AccountClaims object
     auto claims = std::make_unique<AccountClaims>(subject);
 
     // Populate required fields (direct access via friend declaration)
-    claims->impl_->issuer_ = issuer;
+    claims->impl_->issuer_ = PublicKey(issuer);
     claims->impl_->issuedAt_ = iat;
 
     // Populate optional fields
     if (payload.contains("name")) {
-        claims->setName(payload["name"].get<std::string>());
+        claims->setName(std::move(payload["name"].get_ref<std::string&>()));
     }
 
     if (payload.contains("exp")) {
@@ -189,14 +441,114 @@ std::unique_ptr<AccountClaims> decodeAccountClaims(const std::string& jwt) {
 
     // Extract signing keys if present
     if (nats.contains("signing_keys") && nats["signing_keys"].is_array()) {
-        for (const auto& key : nats["signing_keys"]) {
-            claims->addSigningKey(key.get<std::string>());
+        auto& keys = nats["signing_keys"];
+        std::vector<std::string_view> encoded;
+        encoded.reserve(keys.size());
+        for (const auto& key : keys) {
+            // Plain keys are strings; scoped keys are objects with a "key" field
+            const auto& value = key.is_object() ? key.at("key") : key;
+            encoded.push_back(value.get_ref<const std::string&>());
+        }
+        // Interned together so new keys are decoded and checksummed as a batch
+        claims->impl_->signingKeys_ = PublicKey::internAll(encoded);
+
+        // Scope templates are parsed and, where possible, compiled here, once per account
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            auto& key = keys[i];
+            if (!key.is_object()) {
+                continue;
+            }
+            if (!key.contains("kind") || key["kind"] != USER_SCOPE_KIND) {
+                throw std::invalid_argument("Unsupported signing key scope kind");
+            }
+            ScopeTemplate scopeTemplate;
+            std::string role;
+            std::string description;
+            takeString(key, "role", role);
+            takeString(key, "description", description);
+            if (key.contains("template")) {
+                auto& templateJson = key["template"];
+                scopeTemplate.permissions = readPermissions(templateJson);
+                readNatsLimits(templateJson, scopeTemplate.limits);
+            }
+            claims->impl_->scopes_.insert_or_assign(
+                claims->impl_->signingKeys_[i],
+                UserScope(claims->impl_->signingKeys_[i], std::move(role), std::move(scopeTemplate),
+                          std::move(description)));
+        }
+    }
+
+    // Extract revocations if present
+    if (nats.contains("revocations") && nats["revocations"].is_object()) {
+        for (const auto& [key, timestamp] : nats["revocations"].items()) {
+            claims->addRevocation(key, timestamp.get<std::int64_t>());
+        }
+    }
+
+    // Extract exports (indexed once here) and imports if present
+    if (nats.contains("exports") && nats["exports"].is_array()) {
+        std::vector<Export> exports;
+        exports.reserve(nats["exports"].size());
+        for (auto& entry : nats["exports"]) {
+            Export& e = exports.emplace_back();
+            takeString(entry, "name", e.name);
+            e.subject = std::move(entry.at("subject").get_ref<std::string&>());
+            e.type = readExportType(entry, "type");
+            e.tokenRequired = entry.contains("token_req") && entry["token_req"].get<bool>();
+        }
+        claims->setExports(std::move(exports));
+    }
+    if (nats.contains("imports") && nats["imports"].is_array()) {
+        std::vector<Import> imports;
+        imports.reserve(nats["imports"].size());
+        for (auto& entry : nats["imports"]) {
+            Import& i = imports.emplace_back();
+            takeString(entry, "name", i.name);
+            i.subject = std::move(entry.at("subject").get_ref<std::string&>());
+            i.account = PublicKey(entry.at("account").get_ref<const std::string&>());
+            takeString(entry, "token", i.token);
+            takeString(entry, "local_subject", i.localSubject);
+            i.type = readExportType(entry, "type");
+        }
+        claims->setImports(std::move(imports));
+    }
+
+    // Extract subject mappings (compiled once here)
+    if (nats.contains("mappings") && nats["mappings"].is_object()) {
+        std::vector<SubjectMapping> mappings;
+        mappings.reserve(nats["mappings"].size());
+        for (auto& [source, entries] : nats["mappings"].items()) {
+            SubjectMapping& m = mappings.emplace_back();
+            m.source = source;
+            m.destinations.reserve(entries.size());
+            for (auto& entry : entries) {
+                WeightedMapping& d = m.destinations.emplace_back();
+                d.subject = std::move(entry.at("subject").get_ref<std::string&>());
+                if (auto it = entry.find("weight"); it != entry.end()) {
+                    auto weight = it->get<std::int64_t>();
+                    if (weight < 0 || weight > 100) {
+                        throw std::invalid_argument("Mapping weight must be between 0 and 100");
+                    }
+                    d.weight = static_cast<std::uint8_t>(weight);
+                }
+                takeString(entry, "cluster", d.cluster);
+            }
         }
+        claims->setMappings(std::move(mappings));
     }
 
+    // Extract limits if present (decoded in place, no allocation)
+    if (nats.contains("limits") && nats["limits"].is_object()) {
+        decodeLimits(nats["limits"], claims->impl_->limits_);
+    }
+
+    // Tags become interned IDs
+    claims->impl_->tags_ = readTags(nats);
+
     // Validate the decoded claims
     claims->validate();
 
+    probe_result = PROBE_OK;
     return claims;
 }
 
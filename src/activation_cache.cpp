@@ -0,0 +1,133 @@
+#include "jwt/activation_cache.hpp"
+#include "jwt/account_claims.hpp"
+#include "jwt/activation_claims.hpp"
+#include "jwt_utils.hpp"
+#include "lock_stats.hpp"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    struct Key {
+        PublicKey importer;
+        PublicKey exporter;
+        std::string subject;
+    };
+
+    /// Lookup form of Key, so that find() does not copy the subject
+    struct KeyView {
+        const PublicKey& importer;
+        const PublicKey& exporter;
+        std::string_view subject;
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(const KeyView& key) const noexcept {
+            std::size_t h = std::hash<PublicKey>{}(key.importer);
+            h ^= std::hash<PublicKey>{}(key.exporter) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            return h ^ (std::hash<std::string_view>{}(key.subject) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+        }
+        std::size_t operator()(const Key& key) const noexcept {
+            return (*this)(KeyView{key.importer, key.exporter, key.subject});
+        }
+    };
+
+    struct KeyEqual {
+        using is_transparent = void;
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const noexcept {
+            return a.importer == b.importer && a.exporter == b.exporter &&
+                std::string_view(a.subject) == std::string_view(b.subject);
+        }
+    };
+
+    bool live(const Activation& activation, std::int64_t now) {
+        return activation.expires <= 0 || now <= activation.expires;
+    }
+}
+
+class ActivationCache::Impl {
+public:
+    mutable internal::InstrumentedMutex mutex{"activation_cache"};
+    std::unordered_map<Key, Activation, KeyHash, KeyEqual> activations;
+};
+
+ActivationCache::ActivationCache() : impl_(std::make_unique<Impl>()) {}
+ActivationCache::~ActivationCache() = default;
+
+ValidationResult ActivationCache::add(const std::string& token, const AccountClaims& exporter,
+                                      const ValidationOptions& opts) {
+    std::unique_ptr<ActivationClaims> claims;
+    try {
+        claims = decodeActivationClaims(token);
+    } catch (const std::exception& e) {
+        return ValidationResult::failure(std::string("Failed to decode activation: ") + e.what());
+    }
+    if (!verify(token)) {
+        return ValidationResult::failure("Invalid activation signature");
+    }
+    if (auto timing = validateTiming(*claims, opts); !timing.valid) {
+        return timing;
+    }
+
+    // The signer must be the exporting account or one of its signing keys
+    const auto& signingKeys = exporter.signingKeyHandles();
+    bool issuedByExporter = claims->issuerKey() == exporter.subjectKey() ||
+        (claims->issuerAccountKey() == exporter.subjectKey() &&
+         std::find(signingKeys.begin(), signingKeys.end(), claims->issuerKey()) != signingKeys.end());
+    if (!issuedByExporter || claims->exporterKey() != exporter.subjectKey()) {
+        return ValidationResult::failure("Activation for '" + claims->importSubject() +
+                                         "' was not issued by account '" + exporter.subject() + "'");
+    }
+
+    Activation activation{exporter.subjectKey(), claims->importType(), claims->expires()};
+    Key key{claims->subjectKey(), exporter.subjectKey(), claims->importSubject()};
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    impl_->activations.insert_or_assign(std::move(key), activation);
+    return ValidationResult::success();
+}
+
+std::optional<Activation> ActivationCache::find(const PublicKey& importer, const PublicKey& exporter,
+                                                std::string_view subject, std::int64_t now) const {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    auto it = impl_->activations.find(KeyView{importer, exporter, subject});
+    if (it == impl_->activations.end() || !live(it->second, now)) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool ActivationCache::authorizes(const PublicKey& importer, const Import& import, std::int64_t now) const {
+    auto activation = find(importer, import.account, import.subject, now);
+    return activation && activation->type == import.type;
+}
+
+bool ActivationCache::authorizes(const PublicKey& importer, const Import& import) const {
+    return authorizes(importer, import, internal::getCurrentTimestamp());
+}
+
+bool ActivationCache::remove(const PublicKey& importer, const PublicKey& exporter, std::string_view subject) {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    auto it = impl_->activations.find(KeyView{importer, exporter, subject});
+    if (it == impl_->activations.end()) {
+        return false;
+    }
+    impl_->activations.erase(it);
+    return true;
+}
+
+std::size_t ActivationCache::purgeExpired(std::int64_t now) {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    return std::erase_if(impl_->activations, [now](const auto& entry) { return !live(entry.second, now); });
+}
+
+std::size_t ActivationCache::size() const {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    return impl_->activations.size();
+}
+
+}
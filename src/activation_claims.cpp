@@ -0,0 +1,228 @@
+#include "jwt/activation_claims.hpp"
+#include "jwt/jwt_constants.hpp"
+#include "base64url.hpp"
+#include "jwt_utils.hpp"
+#include "probes.hpp"
+#include "subject.hpp"
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+namespace jwt {
+
+class ActivationClaims::Impl {
+public:
+    PublicKey subject_;
+    PublicKey issuer_;
+    std::optional<std::string> name_;
+    std::int64_t issuedAt_ = 0;
+    std::int64_t expires_ = 0;
+    TagSet tags_;
+    PublicKey issuerAccount_;
+    std::string importSubject_;
+    ExportType importType_ = ExportType::Stream;
+};
+
+ActivationClaims::ActivationClaims(std::string_view importerPublicKey)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->subject_ = PublicKey(importerPublicKey);
+}
+
+ActivationClaims::~ActivationClaims() = default;
+ActivationClaims::ActivationClaims(const ActivationClaims& other) : impl_(std::make_unique<Impl>(*other.impl_)) {}
+ActivationClaims::ActivationClaims(ActivationClaims&& other) noexcept = default;
+ActivationClaims& ActivationClaims::operator=(const ActivationClaims& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<Impl>(*other.impl_);
+    }
+    return *this;
+}
+ActivationClaims& ActivationClaims::operator=(ActivationClaims&& other) noexcept = default;
+
+std::string ActivationClaims::subject() const { return impl_->subject_.str(); }
+std::string ActivationClaims::issuer() const { return impl_->issuer_.str(); }
+const PublicKey& ActivationClaims::subjectKey() const { return impl_->subject_; }
+const PublicKey& ActivationClaims::issuerKey() const { return impl_->issuer_; }
+std::optional<std::string> ActivationClaims::name() const { return impl_->name_; }
+std::int64_t ActivationClaims::issuedAt() const { return impl_->issuedAt_; }
+std::int64_t ActivationClaims::expires() const { return impl_->expires_; }
+const TagSet& ActivationClaims::tags() const { return impl_->tags_; }
+
+void ActivationClaims::setName(std::string name) { impl_->name_ = std::move(name); }
+void ActivationClaims::setExpires(std::int64_t exp) { impl_->expires_ = exp; }
+void ActivationClaims::setTags(TagSet tags) { impl_->tags_ = std::move(tags); }
+void ActivationClaims::addTag(std::string_view tag) { impl_->tags_.add(tag); }
+void ActivationClaims::setIssuer(std::string_view issuerKey) { impl_->issuer_ = PublicKey(issuerKey); }
+void ActivationClaims::setIssuerAccount(std::string_view accountPublicKey) {
+    impl_->issuerAccount_ = PublicKey(accountPublicKey);
+}
+std::optional<std::string> ActivationClaims::issuerAccount() const {
+    if (impl_->issuerAccount_.empty()) {
+        return std::nullopt;
+    }
+    return impl_->issuerAccount_.str();
+}
+const PublicKey& ActivationClaims::issuerAccountKey() const {
+    return impl_->issuerAccount_;
+}
+const PublicKey& ActivationClaims::exporterKey() const {
+    return impl_->issuerAccount_.empty() ? impl_->issuer_ : impl_->issuerAccount_;
+}
+
+void ActivationClaims::setImportSubject(std::string subject) { impl_->importSubject_ = std::move(subject); }
+const std::string& ActivationClaims::importSubject() const { return impl_->importSubject_; }
+void ActivationClaims::setImportType(ExportType type) { impl_->importType_ = type; }
+ExportType ActivationClaims::importType() const { return impl_->importType_; }
+
+std::string ActivationClaims::encode(const std::string& seed) const {
+    return encode(Signer(seed));
+}
+
+std::string ActivationClaims::encode(const Signer& signer) const {
+    using namespace internal;
+    using json = nlohmann::json;
+
+    JWT_PROBE(encode__entry, PROBE_ACTIVATION);
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] std::size_t probe_token_len = 0;
+    JWT_PROBE_ON_EXIT(probe_exit, encode__return, PROBE_ACTIVATION, probe_result, probe_token_len);
+
+    validate();
+
+    // Auto-generate JTI and issuedAt
+    std::string jti = generateJti();
+    std::int64_t iat = (impl_->issuedAt_ == 0) ? getCurrentTimestamp() : impl_->issuedAt_;
+
+    // Build payload JSON
+    json payload = {
+        {"jti", jti},
+        {"iat", iat},
+        {"iss", impl_->issuer_.str()},
+        {"sub", impl_->subject_.str()}
+    };
+
+    if (impl_->name_) {
+        payload["name"] = *impl_->name_;
+    }
+    if (impl_->expires_ > 0) {
+        payload["exp"] = impl_->expires_;
+    }
+
+    // NATS-specific claims
+    json nats_claims = {
+        {"type", "activation"},
+        {"version", JWT_VERSION},
+        {"subject", impl_->importSubject_},
+        {"kind", exportTypeName(impl_->importType_)}
+    };
+    if (!impl_->issuerAccount_.empty()) {
+        nats_claims["issuer_account"] = impl_->issuerAccount_.str();
+    }
+    writeTags(impl_->tags_, nats_claims);
+    payload["nats"] = nats_claims;
+
+    std::string token = signJwt(payload.dump(), signer);
+    probe_result = PROBE_OK;
+    probe_token_len = token.size();
+    return token;
+}
+
+void ActivationClaims::validate() const {
+    if (impl_->subject_.empty()) {
+        throw std::invalid_argument("Activation subject cannot be empty");
+    }
+    if (impl_->issuer_.empty()) {
+        throw std::invalid_argument("Activation issuer cannot be empty (must be signed by Account)");
+    }
+    if (impl_->subject_.prefix() != 'A') {
+        throw std::invalid_argument("Activation subject must be the importing Account (start with 'A')");
+    }
+    if (impl_->issuer_.prefix() != 'A') {
+        throw std::invalid_argument("Activation issuer must be an Account (start with 'A')");
+    }
+    if (!impl_->issuerAccount_.empty() && impl_->issuerAccount_.prefix() != 'A') {
+        throw std::invalid_argument("Activation issuer account must start with 'A'");
+    }
+    if (!internal::isValidSubject(impl_->importSubject_)) {
+        throw std::invalid_argument("Activation import subject '" + impl_->importSubject_ + "' is invalid");
+    }
+    if (impl_->expires_ > 0 && impl_->issuedAt_ > 0 &&
+        impl_->expires_ <= impl_->issuedAt_) {
+        throw std::invalid_argument("Expiration must be after issuedAt");
+    }
+}
+
+std::unique_ptr<ActivationClaims> decodeActivationClaims(const std::string& jwt) {
+    using namespace internal;
+
+    JWT_PROBE(decode__entry, jwt.size(), PROBE_ACTIVATION);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_ACTIVATION, probe_result);
+
+    // Parse JWT into its three components
+    auto parts = parseJwt(jwt);
+
+    // Decode and validate header
+    decodeHeader(parts);
+
+    // Decode and parse payload
+    auto payload = decodePayload(parts);
+
+    // Validate NATS-specific claims
+    if (!payload.contains("nats")) {
+        throw std::invalid_argument("Missing 'nats' object in JWT payload");
+    }
+    auto& nats = payload["nats"];
+
+    if (!nats.contains("type") || nats["type"] != "activation") {
+        throw std::invalid_argument(
+            "JWT type mismatch: expected 'activation', got '" +
+            (nats.contains("type") ? nats["type"].get<std::string>() : "missing") + "'"
+        );
+    }
+
+    if (!nats.contains("version") || nats["version"] != JWT_VERSION) {
+        throw std::invalid_argument(
+            "Unsupported JWT version: expected " + std::to_string(JWT_VERSION)
+        );
+    }
+
+    // Extract required fields
+    const auto& subject = payload.at("sub").get_ref<const std::string&>();
+    const auto& issuer = payload.at("iss").get_ref<const std::string&>();
+    std::int64_t iat = payload.at("iat").get<std::int64_t>();
+
+    // Create ActivationClaims object
+    auto claims = std::make_unique<ActivationClaims>(subject);
+
+    // Populate required fields (direct access via friend declaration)
+    claims->impl_->issuer_ = PublicKey(issuer);
+    claims->impl_->issuedAt_ = iat;
+    if (nats.contains("subject")) {
+        claims->impl_->importSubject_ = std::move(nats["subject"].get_ref<std::string&>());
+    }
+    claims->impl_->importType_ = readExportType(nats, "kind");
+
+    // Populate optional fields
+    if (payload.contains("name")) {
+        claims->setName(std::move(payload["name"].get_ref<std::string&>()));
+    }
+
+    if (payload.contains("exp")) {
+        claims->setExpires(payload["exp"].get<std::int64_t>());
+    }
+
+    if (nats.contains("issuer_account")) {
+        claims->impl_->issuerAccount_ = PublicKey(nats["issuer_account"].get_ref<const std::string&>());
+    }
+
+    // Tags become interned IDs
+    claims->impl_->tags_ = readTags(nats);
+
+    // Validate the decoded claims
+    claims->validate();
+
+    probe_result = PROBE_OK;
+    return claims;
+}
+
+}
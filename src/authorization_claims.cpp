@@ -0,0 +1,498 @@
+#include "jwt/authorization_claims.hpp"
+#include "jwt/jwt_constants.hpp"
+#include "jwt_utils.hpp"
+#include "probes.hpp"
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+namespace jwt {
+
+namespace {
+    using json = nlohmann::json;
+    using internal::takeString;
+
+    /// Add a string field only if it is non-empty (NATS omits empty fields)
+    void putString(json& object, const char* field, const std::string& value) {
+        if (!value.empty()) {
+            object[field] = value;
+        }
+    }
+
+    void takeStrings(json& object, const char* field, std::vector<std::string>& out) {
+        if (auto it = object.find(field); it != object.end() && it->is_array()) {
+            out.reserve(it->size());
+            for (auto& value : *it) {
+                out.push_back(std::move(value.get_ref<std::string&>()));
+            }
+        }
+    }
+
+    json encodeRequest(const AuthorizationRequest& request) {
+        json server = json::object();
+        putString(server, "name", request.server.name);
+        putString(server, "host", request.server.host);
+        putString(server, "id", request.server.id);
+        putString(server, "version", request.server.version);
+        putString(server, "cluster", request.server.cluster);
+        if (!request.server.tags.empty()) {
+            server["tags"] = request.server.tags;
+        }
+        putString(server, "xkey", request.server.xkey);
+
+        json client = json::object();
+        putString(client, "host", request.client.host);
+        if (request.client.id != 0) {
+            client["id"] = request.client.id;
+        }
+        putString(client, "user", request.client.user);
+        putString(client, "name", request.client.name);
+        if (!request.client.tags.empty()) {
+            client["tags"] = request.client.tags;
+        }
+        putString(client, "name_tag", request.client.nameTag);
+        putString(client, "kind", request.client.kind);
+        putString(client, "type", request.client.type);
+        putString(client, "mqtt_id", request.client.mqttId);
+        putString(client, "nonce", request.client.nonce);
+
+        json connect = json::object();
+        putString(connect, "jwt", request.connect.jwt);
+        putString(connect, "nkey", request.connect.nkey);
+        putString(connect, "sig", request.connect.signedNonce);
+        putString(connect, "auth_token", request.connect.token);
+        putString(connect, "user", request.connect.username);
+        putString(connect, "pass", request.connect.password);
+        putString(connect, "name", request.connect.name);
+        putString(connect, "lang", request.connect.lang);
+        putString(connect, "version", request.connect.version);
+        if (request.connect.protocol != 0) {
+            connect["protocol"] = request.connect.protocol;
+        }
+
+        json out = {
+            {"server_id", std::move(server)},
+            {"user_nkey", request.userNkey.str()},
+            {"client_info", std::move(client)},
+            {"connect_opts", std::move(connect)}
+        };
+        putString(out, "request_nonce", request.requestNonce);
+        return out;
+    }
+
+    AuthorizationRequest decodeRequest(json& nats) {
+        AuthorizationRequest request;
+        if (auto it = nats.find("server_id"); it != nats.end() && it->is_object()) {
+            takeString(*it, "name", request.server.name);
+            takeString(*it, "host", request.server.host);
+            takeString(*it, "id", request.server.id);
+            takeString(*it, "version", request.server.version);
+            takeString(*it, "cluster", request.server.cluster);
+            takeStrings(*it, "tags", request.server.tags);
+            takeString(*it, "xkey", request.server.xkey);
+        }
+        if (auto it = nats.find("user_nkey"); it != nats.end()) {
+            request.userNkey = PublicKey(it->get_ref<const std::string&>());
+        }
+        if (auto it = nats.find("client_info"); it != nats.end() && it->is_object()) {
+            takeString(*it, "host", request.client.host);
+            if (auto id = it->find("id"); id != it->end()) {
+                request.client.id = id->get<std::uint64_t>();
+            }
+            takeString(*it, "user", request.client.user);
+            takeString(*it, "name", request.client.name);
+            takeStrings(*it, "tags", request.client.tags);
+            takeString(*it, "name_tag", request.client.nameTag);
+            takeString(*it, "kind", request.client.kind);
+            takeString(*it, "type", request.client.type);
+            takeString(*it, "mqtt_id", request.client.mqttId);
+            takeString(*it, "nonce", request.client.nonce);
+        }
+        if (auto it = nats.find("connect_opts"); it != nats.end() && it->is_object()) {
+            takeString(*it, "jwt", request.connect.jwt);
+            takeString(*it, "nkey", request.connect.nkey);
+            takeString(*it, "sig", request.connect.signedNonce);
+            takeString(*it, "auth_token", request.connect.token);
+            takeString(*it, "user", request.connect.username);
+            takeString(*it, "pass", request.connect.password);
+            takeString(*it, "name", request.connect.name);
+            takeString(*it, "lang", request.connect.lang);
+            takeString(*it, "version", request.connect.version);
+            if (auto protocol = it->find("protocol"); protocol != it->end()) {
+                request.connect.protocol = protocol->get<int>();
+            }
+        }
+        takeString(nats, "request_nonce", request.requestNonce);
+        return request;
+    }
+
+    /// Check the "nats" object's type and version
+    json& natsObject(json& payload, const char* expectedType) {
+        if (!payload.contains("nats")) {
+            throw std::invalid_argument("Missing 'nats' object in JWT payload");
+        }
+        auto& nats = payload["nats"];
+        if (!nats.contains("type") || nats["type"] != expectedType) {
+            throw std::invalid_argument(
+                std::string("JWT type mismatch: expected '") + expectedType + "', got '" +
+                (nats.contains("type") ? nats["type"].get<std::string>() : "missing") + "'"
+            );
+        }
+        if (!nats.contains("version") || nats["version"] != JWT_VERSION) {
+            throw std::invalid_argument(
+                "Unsupported JWT version: expected " + std::to_string(JWT_VERSION)
+            );
+        }
+        return nats;
+    }
+}
+
+// ============================================================================
+// AuthorizationRequestClaims
+// ============================================================================
+
+class AuthorizationRequestClaims::Impl {
+public:
+    PublicKey subject_;
+    PublicKey issuer_;
+    std::optional<std::string> name_;
+    std::int64_t issuedAt_ = 0;
+    std::int64_t expires_ = 0;
+    TagSet tags_;
+    AuthorizationRequest request_;
+};
+
+AuthorizationRequestClaims::AuthorizationRequestClaims(std::string_view serverPublicKey)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->subject_ = PublicKey(serverPublicKey);
+    impl_->issuer_ = impl_->subject_;  // Signed by the server itself
+}
+
+AuthorizationRequestClaims::~AuthorizationRequestClaims() = default;
+AuthorizationRequestClaims::AuthorizationRequestClaims(const AuthorizationRequestClaims& other)
+    : impl_(std::make_unique<Impl>(*other.impl_)) {}
+AuthorizationRequestClaims::AuthorizationRequestClaims(AuthorizationRequestClaims&& other) noexcept = default;
+AuthorizationRequestClaims& AuthorizationRequestClaims::operator=(const AuthorizationRequestClaims& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<Impl>(*other.impl_);
+    }
+    return *this;
+}
+AuthorizationRequestClaims& AuthorizationRequestClaims::operator=(AuthorizationRequestClaims&& other) noexcept = default;
+
+std::string AuthorizationRequestClaims::subject() const { return impl_->subject_.str(); }
+std::string AuthorizationRequestClaims::issuer() const { return impl_->issuer_.str(); }
+const PublicKey& AuthorizationRequestClaims::subjectKey() const { return impl_->subject_; }
+const PublicKey& AuthorizationRequestClaims::issuerKey() const { return impl_->issuer_; }
+std::optional<std::string> AuthorizationRequestClaims::name() const { return impl_->name_; }
+std::int64_t AuthorizationRequestClaims::issuedAt() const { return impl_->issuedAt_; }
+std::int64_t AuthorizationRequestClaims::expires() const { return impl_->expires_; }
+const TagSet& AuthorizationRequestClaims::tags() const { return impl_->tags_; }
+
+void AuthorizationRequestClaims::setName(std::string name) { impl_->name_ = std::move(name); }
+void AuthorizationRequestClaims::setExpires(std::int64_t exp) { impl_->expires_ = exp; }
+void AuthorizationRequestClaims::setTags(TagSet tags) { impl_->tags_ = std::move(tags); }
+void AuthorizationRequestClaims::setRequest(AuthorizationRequest request) { impl_->request_ = std::move(request); }
+const AuthorizationRequest& AuthorizationRequestClaims::request() const { return impl_->request_; }
+
+std::string AuthorizationRequestClaims::encode(const std::string& seed) const {
+    return encode(Signer(seed));
+}
+
+std::string AuthorizationRequestClaims::encode(const Signer& signer) const {
+    using namespace internal;
+
+    JWT_PROBE(encode__entry, PROBE_AUTH_REQUEST);
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] std::size_t probe_token_len = 0;
+    JWT_PROBE_ON_EXIT(probe_exit, encode__return, PROBE_AUTH_REQUEST, probe_result, probe_token_len);
+
+    validate();
+
+    std::int64_t iat = (impl_->issuedAt_ == 0) ? getCurrentTimestamp() : impl_->issuedAt_;
+    json payload = {
+        {"jti", generateJti()},
+        {"iat", iat},
+        {"iss", impl_->issuer_.str()},
+        {"sub", impl_->subject_.str()},
+        {"aud", AUTH_REQUEST_AUDIENCE}
+    };
+    if (impl_->name_) {
+        payload["name"] = *impl_->name_;
+    }
+    if (impl_->expires_ > 0) {
+        payload["exp"] = impl_->expires_;
+    }
+
+    json nats_claims = encodeRequest(impl_->request_);
+    nats_claims["type"] = "authorization_request";
+    nats_claims["version"] = JWT_VERSION;
+    writeTags(impl_->tags_, nats_claims);
+    payload["nats"] = std::move(nats_claims);
+
+    std::string token = signJwt(payload.dump(), signer);
+    probe_result = PROBE_OK;
+    probe_token_len = token.size();
+    return token;
+}
+
+void AuthorizationRequestClaims::validate() const {
+    if (impl_->subject_.empty()) {
+        throw std::invalid_argument("Authorization request subject cannot be empty");
+    }
+    if (impl_->subject_.prefix() != 'N') {
+        throw std::invalid_argument("Authorization request subject must be a Server (start with 'N')");
+    }
+    if (impl_->issuer_.empty() || impl_->issuer_.prefix() != 'N') {
+        throw std::invalid_argument("Authorization request issuer must be a Server (start with 'N')");
+    }
+    if (impl_->request_.userNkey.empty() || impl_->request_.userNkey.prefix() != 'U') {
+        throw std::invalid_argument("Authorization request user_nkey must be a User key (start with 'U')");
+    }
+    if (impl_->expires_ > 0 && impl_->issuedAt_ > 0 &&
+        impl_->expires_ <= impl_->issuedAt_) {
+        throw std::invalid_argument("Expiration must be after issuedAt");
+    }
+}
+
+std::unique_ptr<AuthorizationRequestClaims> internal::decodeAuthorizationRequest(const JwtParts& parts) {
+    JWT_PROBE(decode__entry, parts.signing_input.size(), PROBE_AUTH_REQUEST);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_AUTH_REQUEST, probe_result);
+
+    decodeHeader(parts);
+    auto payload = decodePayload(parts);
+    auto& nats = natsObject(payload, "authorization_request");
+
+    auto claims = std::make_unique<AuthorizationRequestClaims>(
+        payload.at("sub").get_ref<const std::string&>());
+    claims->impl_->issuer_ = PublicKey(payload.at("iss").get_ref<const std::string&>());
+    claims->impl_->issuedAt_ = payload.at("iat").get<std::int64_t>();
+    if (payload.contains("name")) {
+        claims->impl_->name_ = std::move(payload["name"].get_ref<std::string&>());
+    }
+    if (payload.contains("exp")) {
+        claims->impl_->expires_ = payload["exp"].get<std::int64_t>();
+    }
+    claims->impl_->request_ = decodeRequest(nats);
+    claims->impl_->tags_ = readTags(nats);
+
+    // Validate the decoded claims
+    claims->validate();
+
+    probe_result = PROBE_OK;
+    return claims;
+}
+
+std::unique_ptr<AuthorizationRequestClaims> decodeAuthorizationRequestClaims(const std::string& jwt) {
+    return internal::decodeAuthorizationRequest(internal::parseJwt(jwt));
+}
+
+// ============================================================================
+// AuthorizationResponseClaims
+// ============================================================================
+
+class AuthorizationResponseClaims::Impl {
+public:
+    PublicKey subject_;
+    PublicKey issuer_;
+    std::int64_t issuedAt_ = 0;
+    std::int64_t expires_ = 0;
+    TagSet tags_;  // Always empty; responses carry no tags
+    PublicKey issuerAccount_;
+    std::string audience_;
+    std::string jwt_;
+    std::string error_;
+};
+
+AuthorizationResponseClaims::AuthorizationResponseClaims(std::string_view userNkey)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->subject_ = PublicKey(userNkey);
+}
+
+AuthorizationResponseClaims::~AuthorizationResponseClaims() = default;
+AuthorizationResponseClaims::AuthorizationResponseClaims(const AuthorizationResponseClaims& other)
+    : impl_(std::make_unique<Impl>(*other.impl_)) {}
+AuthorizationResponseClaims::AuthorizationResponseClaims(AuthorizationResponseClaims&& other) noexcept = default;
+AuthorizationResponseClaims& AuthorizationResponseClaims::operator=(const AuthorizationResponseClaims& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<Impl>(*other.impl_);
+    }
+    return *this;
+}
+AuthorizationResponseClaims& AuthorizationResponseClaims::operator=(AuthorizationResponseClaims&& other) noexcept = default;
+
+std::string AuthorizationResponseClaims::subject() const { return impl_->subject_.str(); }
+std::string AuthorizationResponseClaims::issuer() const { return impl_->issuer_.str(); }
+const PublicKey& AuthorizationResponseClaims::subjectKey() const { return impl_->subject_; }
+const PublicKey& AuthorizationResponseClaims::issuerKey() const { return impl_->issuer_; }
+std::optional<std::string> AuthorizationResponseClaims::name() const { return std::nullopt; }
+std::int64_t AuthorizationResponseClaims::issuedAt() const { return impl_->issuedAt_; }
+std::int64_t AuthorizationResponseClaims::expires() const { return impl_->expires_; }
+const TagSet& AuthorizationResponseClaims::tags() const { return impl_->tags_; }
+
+void AuthorizationResponseClaims::setExpires(std::int64_t exp) { impl_->expires_ = exp; }
+void AuthorizationResponseClaims::setIssuer(std::string_view issuerKey) { impl_->issuer_ = PublicKey(issuerKey); }
+void AuthorizationResponseClaims::setIssuerAccount(std::string_view accountPublicKey) {
+    impl_->issuerAccount_ = PublicKey(accountPublicKey);
+}
+const PublicKey& AuthorizationResponseClaims::issuerAccountKey() const { return impl_->issuerAccount_; }
+void AuthorizationResponseClaims::setAudience(std::string audience) { impl_->audience_ = std::move(audience); }
+const std::string& AuthorizationResponseClaims::audience() const { return impl_->audience_; }
+void AuthorizationResponseClaims::setJwt(std::string userJwt) { impl_->jwt_ = std::move(userJwt); }
+const std::string& AuthorizationResponseClaims::jwt() const { return impl_->jwt_; }
+void AuthorizationResponseClaims::setError(std::string error) { impl_->error_ = std::move(error); }
+const std::string& AuthorizationResponseClaims::error() const { return impl_->error_; }
+
+std::string AuthorizationResponseClaims::encode(const std::string& seed) const {
+    return encode(Signer(seed));
+}
+
+std::string AuthorizationResponseClaims::encode(const Signer& signer) const {
+    using namespace internal;
+
+    JWT_PROBE(encode__entry, PROBE_AUTH_RESPONSE);
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] std::size_t probe_token_len = 0;
+    JWT_PROBE_ON_EXIT(probe_exit, encode__return, PROBE_AUTH_RESPONSE, probe_result, probe_token_len);
+
+    validate();
+
+    std::int64_t iat = (impl_->issuedAt_ == 0) ? getCurrentTimestamp() : impl_->issuedAt_;
+    json payload = {
+        {"jti", generateJti()},
+        {"iat", iat},
+        {"iss", impl_->issuer_.str()},
+        {"sub", impl_->subject_.str()},
+        {"aud", impl_->audience_}
+    };
+    if (impl_->expires_ > 0) {
+        payload["exp"] = impl_->expires_;
+    }
+
+    json nats_claims = {
+        {"type", "authorization_response"},
+        {"version", JWT_VERSION}
+    };
+    putString(nats_claims, "jwt", impl_->jwt_);
+    putString(nats_claims, "error", impl_->error_);
+    if (!impl_->issuerAccount_.empty()) {
+        nats_claims["issuer_account"] = impl_->issuerAccount_.str();
+    }
+    payload["nats"] = std::move(nats_claims);
+
+    std::string token = signJwt(payload.dump(), signer);
+    probe_result = PROBE_OK;
+    probe_token_len = token.size();
+    return token;
+}
+
+void AuthorizationResponseClaims::validate() const {
+    if (impl_->subject_.empty() || impl_->subject_.prefix() != 'U') {
+        throw std::invalid_argument("Authorization response subject must be a User key (start with 'U')");
+    }
+    if (impl_->issuer_.empty() || impl_->issuer_.prefix() != 'A') {
+        throw std::invalid_argument("Authorization response issuer must be an Account (start with 'A')");
+    }
+    if (!impl_->issuerAccount_.empty() && impl_->issuerAccount_.prefix() != 'A') {
+        throw std::invalid_argument("Authorization response issuer account must start with 'A'");
+    }
+    if (impl_->audience_.empty()) {
+        throw std::invalid_argument("Authorization response audience (server ID) cannot be empty");
+    }
+    if (impl_->jwt_.empty() == impl_->error_.empty()) {
+        throw std::invalid_argument("Authorization response must carry either a user JWT or an error");
+    }
+    if (impl_->expires_ > 0 && impl_->issuedAt_ > 0 &&
+        impl_->expires_ <= impl_->issuedAt_) {
+        throw std::invalid_argument("Expiration must be after issuedAt");
+    }
+}
+
+std::unique_ptr<AuthorizationResponseClaims> decodeAuthorizationResponseClaims(const std::string& jwt) {
+    using namespace internal;
+
+    JWT_PROBE(decode__entry, jwt.size(), PROBE_AUTH_RESPONSE);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_AUTH_RESPONSE, probe_result);
+
+    auto parts = parseJwt(jwt);
+    decodeHeader(parts);
+    auto payload = decodePayload(parts);
+    auto& nats = natsObject(payload, "authorization_response");
+
+    auto claims = std::make_unique<AuthorizationResponseClaims>(payload.at("sub").get_ref<const std::string&>());
+    claims->impl_->issuer_ = PublicKey(payload.at("iss").get_ref<const std::string&>());
+    claims->impl_->issuedAt_ = payload.at("iat").get<std::int64_t>();
+    if (payload.contains("exp")) {
+        claims->impl_->expires_ = payload["exp"].get<std::int64_t>();
+    }
+    takeString(payload, "aud", claims->impl_->audience_);
+    takeString(nats, "jwt", claims->impl_->jwt_);
+    takeString(nats, "error", claims->impl_->error_);
+    if (nats.contains("issuer_account")) {
+        claims->impl_->issuerAccount_ = PublicKey(nats["issuer_account"].get_ref<const std::string&>());
+    }
+
+    // Validate the decoded claims
+    claims->validate();
+
+    probe_result = PROBE_OK;
+    return claims;
+}
+
+// ============================================================================
+// AuthorizationResponder
+// ============================================================================
+
+AuthorizationResponder::AuthorizationResponder(Signer signer, std::string_view issuerAccount)
+    : signer_(std::move(signer)), issuerAccount_(issuerAccount) {
+    if (signer_.publicKey().prefix() != 'A') {
+        throw std::invalid_argument("Authorization responses must be signed by an Account key");
+    }
+    if (!issuerAccount_.empty() && issuerAccount_.prefix() != 'A') {
+        throw std::invalid_argument("Issuer account must start with 'A'");
+    }
+}
+
+std::string AuthorizationResponder::respond(const std::string& requestJwt, const Authorizer& authorize,
+                                            const ValidationOptions& opts) const {
+    // One split and one JSON parse serve both the signature check and the claims
+    auto parts = internal::parseJwt(requestJwt);
+    std::unique_ptr<AuthorizationRequestClaims> request;
+    try {
+        request = internal::decodeAuthorizationRequest(parts);
+    } catch (const std::invalid_argument&) {
+        throw;
+    } catch (const std::exception& e) {
+        throw std::invalid_argument(std::string("Malformed authorization request: ") + e.what());
+    }
+    if (!internal::verifySignature(request->issuerKey(), parts.signing_input, parts.signature_b64)) {
+        throw std::invalid_argument("Invalid authorization request signature");
+    }
+    if (auto timing = validateTiming(*request, opts); !timing.valid) {
+        throw std::invalid_argument("Authorization request rejected: " + timing.error.value_or("unknown error"));
+    }
+
+    const auto& body = request->request();
+    AuthorizationResponseClaims response(body.userNkey.str());
+    response.setIssuer(signer_.publicKey().str());
+    if (!issuerAccount_.empty()) {
+        response.setIssuerAccount(issuerAccount_.str());
+    }
+    response.setAudience(body.server.id.empty() ? request->subject() : body.server.id);
+
+    try {
+        UserClaims user(body.userNkey.str());
+        authorize(*request, user);
+        user.setIssuer(signer_.publicKey().str());
+        if (!issuerAccount_.empty()) {
+            user.setIssuerAccount(issuerAccount_.str());
+        }
+        response.setJwt(user.encode(signer_));
+    } catch (const std::exception& e) {
+        response.setError(*e.what() != '\0' ? e.what() : "authorization denied");
+    }
+    return response.encode(signer_);
+}
+
+}
@@ -1,3 +1,24 @@
 #include "jwt/claims.hpp"
 
-namespace jwt {}
+namespace jwt {
+
+namespace {
+    /// Re-intern only when the string changed, so repeated calls return the same handle
+    const PublicKey& internCached(std::mutex& mutex, PublicKey& cached, const std::string& encoded) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cached.str() != encoded) {
+            cached = PublicKey(encoded);
+        }
+        return cached;
+    }
+}
+
+const PublicKey& Claims::subjectKey() const {
+    return internCached(keyCache_.mutex, keyCache_.subject, subject());
+}
+
+const PublicKey& Claims::issuerKey() const {
+    return internCached(keyCache_.mutex, keyCache_.issuer, issuer());
+}
+
+}
@@ -0,0 +1,26 @@
+#include "jwt/claims_snapshot.hpp"
+#include <cstring>
+#include <new>
+
+namespace jwt {
+
+// The token is stored directly behind the snapshot in the same allocation
+ClaimsSnapshot::Ptr ClaimsSnapshot::create(const Claims& claims, std::string_view token) {
+    auto flat = FlatClaims::from(claims);
+    void* memory = ::operator new(sizeof(ClaimsSnapshot) + token.size());
+    auto* snapshot = new (memory) ClaimsSnapshot(std::move(flat), token.size());
+    std::memcpy(static_cast<char*>(memory) + sizeof(ClaimsSnapshot), token.data(), token.size());
+    return Ptr(snapshot);
+}
+
+void ClaimsSnapshot::destroy(ClaimsSnapshot* snapshot) noexcept {
+    snapshot->~ClaimsSnapshot();
+    ::operator delete(static_cast<void*>(snapshot));
+}
+
+ClaimsSnapshot::Ptr decodeSnapshot(const std::string& jwt) {
+    auto claims = decode(jwt);
+    return ClaimsSnapshot::create(*claims, jwt);
+}
+
+}
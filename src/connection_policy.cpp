@@ -0,0 +1,376 @@
+#include "jwt/connection_policy.hpp"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace jwt {
+
+namespace {
+    constexpr std::array<std::string_view, 7> kTypeNames = {
+        "STANDARD", "WEBSOCKET", "LEAFNODE", "LEAFNODE_WS", "MQTT", "MQTT_WS", "IN_PROCESS",
+    };
+    constexpr std::uint32_t kAllTypes = (1u << kTypeNames.size()) - 1;
+    constexpr int kSecondsPerDay = 24 * 60 * 60;
+
+    /// Parse a decimal number of 1..maxDigits digits, all of text
+    bool parseNumber(std::string_view text, std::size_t maxDigits, unsigned& out) {
+        if (text.empty() || text.size() > maxDigits) {
+            return false;
+        }
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+        return ec == std::errc() && end == text.data() + text.size();
+    }
+
+    bool parseV4(std::string_view text, std::uint8_t* out) {
+        for (int i = 0; i < 4; ++i) {
+            auto dot = text.find('.');
+            if ((dot == std::string_view::npos) != (i == 3)) {
+                return false;
+            }
+            auto part = text.substr(0, dot);
+            unsigned value = 0;
+            if (!parseNumber(part, 3, value) || value > 255 || (part.size() > 1 && part[0] == '0')) {
+                return false;
+            }
+            out[i] = static_cast<std::uint8_t>(value);
+            text = dot == std::string_view::npos ? std::string_view() : text.substr(dot + 1);
+        }
+        return true;
+    }
+
+    /// Parse ':'-separated hex groups; an IPv4 tail (allowed only if v4Tail) counts as two
+    bool parseGroups(std::string_view text, bool v4Tail, std::vector<std::uint16_t>& out) {
+        if (text.empty()) {
+            return true;
+        }
+        while (true) {
+            auto colon = text.find(':');
+            auto group = text.substr(0, colon);
+            if (colon == std::string_view::npos && v4Tail && group.find('.') != std::string_view::npos) {
+                std::uint8_t v4[4];
+                if (!parseV4(group, v4)) {
+                    return false;
+                }
+                out.push_back(static_cast<std::uint16_t>(v4[0] << 8 | v4[1]));
+                out.push_back(static_cast<std::uint16_t>(v4[2] << 8 | v4[3]));
+                return true;
+            }
+            if (group.empty() || group.size() > 4) {
+                return false;
+            }
+            std::uint16_t value = 0;
+            auto [end, ec] = std::from_chars(group.data(), group.data() + group.size(), value, 16);
+            if (ec != std::errc() || end != group.data() + group.size()) {
+                return false;
+            }
+            out.push_back(value);
+            if (colon == std::string_view::npos) {
+                return true;
+            }
+            text = text.substr(colon + 1);
+        }
+    }
+
+    bool parseV6(std::string_view text, std::uint8_t* out) {
+        auto gap = text.find("::");
+        if (gap != std::string_view::npos && text.find("::", gap + 1) != std::string_view::npos) {
+            return false;
+        }
+        std::vector<std::uint16_t> head;
+        std::vector<std::uint16_t> tail;
+        if (gap == std::string_view::npos) {
+            if (!parseGroups(text, true, head) || head.size() != 8) {
+                return false;
+            }
+        } else if (!parseGroups(text.substr(0, gap), false, head) ||
+                   !parseGroups(text.substr(gap + 2), true, tail) || head.size() + tail.size() > 7) {
+            return false;
+        }
+
+        std::array<std::uint16_t, 8> groups{};
+        std::copy(head.begin(), head.end(), groups.begin());
+        std::copy(tail.begin(), tail.end(), groups.end() - static_cast<std::ptrdiff_t>(tail.size()));
+        for (std::size_t i = 0; i < 8; ++i) {
+            out[2 * i] = static_cast<std::uint8_t>(groups[i] >> 8);
+            out[2 * i + 1] = static_cast<std::uint8_t>(groups[i]);
+        }
+        return true;
+    }
+
+    bool isV4Mapped(const std::array<std::uint8_t, 16>& bytes) {
+        return std::all_of(bytes.begin(), bytes.begin() + 10, [](std::uint8_t b) { return b == 0; }) &&
+               bytes[10] == 0xff && bytes[11] == 0xff;
+    }
+
+    unsigned nibble(const std::uint8_t* bytes, int index) {
+        std::uint8_t byte = bytes[index / 2];
+        return (index % 2 == 0) ? (byte >> 4) : (byte & 0x0f);
+    }
+
+    /// Add a prefix; callers insert shortest prefixes first
+    void insert(std::vector<CidrSet::Node>& nodes, const std::uint8_t* bytes, int length) {
+        if (nodes.empty()) {
+            nodes.emplace_back();
+        }
+        std::uint32_t node = 0;
+        for (int depth = 0;; depth += 4) {
+            unsigned slot = nibble(bytes, depth / 4);
+            int remaining = length - depth;
+            if (remaining <= 4) {
+                // Expand the last partial stride into the slots it covers
+                unsigned span = 1u << (4 - remaining);
+                unsigned base = slot & ~(span - 1);
+                for (unsigned i = base; i < base + span; ++i) {
+                    nodes[node].slots[i] = CidrSet::FULL;
+                }
+                return;
+            }
+            std::uint32_t child = nodes[node].slots[slot];
+            if (child == CidrSet::FULL) {
+                return;  // Already covered by a shorter prefix
+            }
+            if (child == 0) {
+                child = static_cast<std::uint32_t>(nodes.size());
+                nodes.emplace_back();
+                nodes[node].slots[slot] = child;
+            }
+            node = child;
+        }
+    }
+
+    bool lookup(const std::vector<CidrSet::Node>& nodes, const std::uint8_t* bytes, int bits) {
+        if (nodes.empty()) {
+            return false;
+        }
+        std::uint32_t node = 0;
+        for (int level = 0; level < bits / 4; ++level) {
+            std::uint32_t slot = nodes[node].slots[nibble(bytes, level)];
+            if (slot == CidrSet::FULL) {
+                return true;
+            }
+            if (slot == 0) {
+                return false;
+            }
+            node = slot;
+        }
+        return false;
+    }
+
+    /// Seconds since midnight of "H:MM:SS" or "HH:MM:SS"
+    int parseTimeOfDay(const std::string& text) {
+        auto first = text.find(':');
+        auto second = text.find(':', first == std::string::npos ? first : first + 1);
+        unsigned h = 0;
+        unsigned m = 0;
+        unsigned s = 0;
+        if (first == std::string::npos || second == std::string::npos ||
+            !parseNumber(std::string_view(text).substr(0, first), 2, h) ||
+            second - first != 3 || !parseNumber(std::string_view(text).substr(first + 1, 2), 2, m) ||
+            text.size() - second != 3 || !parseNumber(std::string_view(text).substr(second + 1), 2, s) ||
+            h > 23 || m > 59 || s > 59) {
+            throw std::invalid_argument("Invalid time of day '" + text + "' (expected HH:MM:SS)");
+        }
+        return static_cast<int>(h * 3600 + m * 60 + s);
+    }
+
+    /// Whole minutes inside the closed second range [start, end]
+    void addWindow(std::vector<MinuteInterval>& windows, int start, int end) {
+        int begin = (start + 59) / 60;
+        int stop = (end + 1) / 60;
+        if (begin < stop) {
+            windows.push_back({static_cast<std::uint16_t>(begin), static_cast<std::uint16_t>(stop)});
+        }
+    }
+}
+
+std::string_view connectionTypeName(ConnectionType type) {
+    return kTypeNames.at(static_cast<std::size_t>(type));
+}
+
+std::optional<ConnectionType> parseConnectionType(std::string_view name) {
+    for (std::size_t i = 0; i < kTypeNames.size(); ++i) {
+        if (kTypeNames[i] == name) {
+            return static_cast<ConnectionType>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<IpAddress> IpAddress::parse(std::string_view text) {
+    IpAddress address;
+    if (text.find(':') == std::string_view::npos) {
+        if (!parseV4(text, address.bytes.data())) {
+            return std::nullopt;
+        }
+        return address;
+    }
+    if (!parseV6(text, address.bytes.data())) {
+        return std::nullopt;
+    }
+    if (isV4Mapped(address.bytes)) {
+        std::copy(address.bytes.begin() + 12, address.bytes.end(), address.bytes.begin());
+        std::fill(address.bytes.begin() + 4, address.bytes.end(), 0);
+        return address;
+    }
+    address.v6 = true;
+    return address;
+}
+
+CidrSet::CidrSet(const std::vector<std::string>& networks) {
+    struct Prefix {
+        IpAddress address;
+        int length;
+    };
+    std::vector<Prefix> prefixes;
+    prefixes.reserve(networks.size());
+    for (const auto& network : networks) {
+        auto slash = network.find('/');
+        auto address = IpAddress::parse(std::string_view(network).substr(0, slash));
+        if (!address) {
+            throw std::invalid_argument("Invalid network address '" + network + "'");
+        }
+        bool mapped = !address->v6 && network.find(':') != std::string::npos;
+        unsigned maxLength = (address->v6 || mapped) ? 128 : 32;
+        unsigned length = maxLength;
+        if (slash != std::string::npos &&
+            (!parseNumber(std::string_view(network).substr(slash + 1), 3, length) || length > maxLength)) {
+            throw std::invalid_argument("Invalid prefix length in '" + network + "'");
+        }
+        if (mapped) {
+            // ::ffff:a.b.c.d/len is an IPv4 network of len - 96 bits
+            if (length < 96) {
+                throw std::invalid_argument("IPv4-mapped network '" + network + "' must be at least /96");
+            }
+            length -= 96;
+        }
+        prefixes.push_back({*address, static_cast<int>(length)});
+    }
+
+    std::stable_sort(prefixes.begin(), prefixes.end(),
+                     [](const Prefix& a, const Prefix& b) { return a.length < b.length; });
+    for (const auto& prefix : prefixes) {
+        insert(prefix.address.v6 ? v6_ : v4_, prefix.address.bytes.data(), prefix.length);
+    }
+}
+
+bool CidrSet::contains(const IpAddress& address) const {
+    return address.v6 ? lookup(v6_, address.bytes.data(), 128) : lookup(v4_, address.bytes.data(), 32);
+}
+
+bool CidrSet::contains(std::string_view address) const {
+    auto parsed = IpAddress::parse(address);
+    return parsed && contains(*parsed);
+}
+
+bool CidrSet::empty() const { return v4_.empty() && v6_.empty(); }
+std::size_t CidrSet::nodeCount() const { return v4_.size() + v6_.size(); }
+
+int minuteOfDay(std::int64_t unixSeconds, std::int32_t utcOffsetSeconds) {
+    std::int64_t seconds = (unixSeconds + utcOffsetSeconds) % kSecondsPerDay;
+    if (seconds < 0) {
+        seconds += kSecondsPerDay;
+    }
+    return static_cast<int>(seconds / 60);
+}
+
+class ConnectionPolicy::Impl {
+public:
+    CidrSet src;
+    bool restrictSrc = false;
+    std::vector<MinuteInterval> windows;
+    std::array<std::uint64_t, (MINUTES_PER_DAY + 63) / 64> minutes{};
+    bool restrictTimes = false;
+    std::uint32_t typeMask = kAllTypes;
+    std::string location;
+};
+
+ConnectionPolicy::ConnectionPolicy(const ConnectionRestrictions& restrictions) {
+    auto impl = std::make_shared<Impl>();
+
+    impl->restrictSrc = !restrictions.src.empty();
+    impl->src = CidrSet(restrictions.src);
+
+    impl->restrictTimes = !restrictions.times.empty();
+    for (const auto& range : restrictions.times) {
+        int start = parseTimeOfDay(range.start);
+        int end = parseTimeOfDay(range.end);
+        if (end < start) {
+            addWindow(impl->windows, start, kSecondsPerDay - 1);
+            addWindow(impl->windows, 0, end);
+        } else {
+            addWindow(impl->windows, start, end);
+        }
+    }
+    std::sort(impl->windows.begin(), impl->windows.end(),
+              [](const MinuteInterval& a, const MinuteInterval& b) { return a.begin < b.begin; });
+    std::vector<MinuteInterval> merged;
+    for (const auto& window : impl->windows) {
+        if (!merged.empty() && window.begin <= merged.back().end) {
+            merged.back().end = std::max(merged.back().end, window.end);
+        } else {
+            merged.push_back(window);
+        }
+        for (unsigned m = window.begin; m < window.end; ++m) {
+            impl->minutes[m / 64] |= std::uint64_t{1} << (m % 64);
+        }
+    }
+    impl->windows = std::move(merged);
+
+    if (!restrictions.connectionTypes.empty()) {
+        impl->typeMask = 0;
+        for (const auto& name : restrictions.connectionTypes) {
+            if (auto type = parseConnectionType(name)) {
+                impl->typeMask |= 1u << static_cast<unsigned>(*type);
+            }
+        }
+    }
+
+    impl->location = restrictions.timesLocation;
+    impl_ = std::move(impl);
+}
+
+bool ConnectionPolicy::allowsAddress(const IpAddress& address) const {
+    return !impl_ || !impl_->restrictSrc || impl_->src.contains(address);
+}
+
+bool ConnectionPolicy::allowsAddress(std::string_view address) const {
+    if (!impl_ || !impl_->restrictSrc) {
+        return true;
+    }
+    auto parsed = IpAddress::parse(address);
+    return parsed && impl_->src.contains(*parsed);
+}
+
+bool ConnectionPolicy::allowsMinute(int minute) const {
+    if (!impl_ || !impl_->restrictTimes) {
+        return true;
+    }
+    if (minute < 0 || minute >= MINUTES_PER_DAY) {
+        return false;
+    }
+    return (impl_->minutes[minute / 64] >> (minute % 64)) & 1;
+}
+
+bool ConnectionPolicy::allowsType(ConnectionType type) const {
+    return ((impl_ ? impl_->typeMask : kAllTypes) >> static_cast<unsigned>(type)) & 1;
+}
+
+bool ConnectionPolicy::allows(const IpAddress& address, ConnectionType type, int minute) const {
+    return allowsType(type) && allowsMinute(minute) && allowsAddress(address);
+}
+
+const std::vector<MinuteInterval>& ConnectionPolicy::timeWindows() const {
+    static const std::vector<MinuteInterval> none;
+    return impl_ ? impl_->windows : none;
+}
+
+std::uint32_t ConnectionPolicy::typeMask() const {
+    return impl_ ? impl_->typeMask : kAllTypes;
+}
+
+const std::string& ConnectionPolicy::timesLocation() const {
+    static const std::string utc;
+    return impl_ ? impl_->location : utc;
+}
+
+}
@@ -0,0 +1,398 @@
+#include "jwt/expiry_scheduler.hpp"
+#include "jwt/account_claims.hpp"
+#include "jwt_utils.hpp"
+#include "lock_stats.hpp"
+#include <array>
+#include <bit>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    constexpr unsigned kLevelBits = 8;
+    constexpr std::uint32_t kSlots = 1u << kLevelBits;
+    constexpr std::uint32_t kLevels = 4;  // Covers 2^32 seconds ahead
+
+    // List numbers: the wheel's slots, then entries already due, entries
+    // beyond the top level, and entries that never expire
+    constexpr std::uint32_t kDue = kLevels * kSlots;
+    constexpr std::uint32_t kOverflow = kDue + 1;
+    constexpr std::uint32_t kNever = kDue + 2;
+    constexpr std::uint32_t kLists = kDue + 3;
+
+    constexpr std::uint32_t kNil = std::numeric_limits<std::uint32_t>::max();
+
+    /// Earlier of two expiries, where 0 means never
+    std::int64_t earliest(std::int64_t a, std::int64_t b) {
+        if (a == 0) return b;
+        if (b == 0) return a;
+        return a < b ? a : b;
+    }
+}
+
+class ExpiryScheduler::Impl {
+public:
+    struct Account {
+        std::int64_t expires = 0;
+        std::uint32_t head = kNil;
+        std::size_t count = 0;
+    };
+
+    struct Entry {
+        Id id = 0;
+        std::int64_t own = 0;        // The entry's own expiry
+        std::int64_t effective = 0;  // Earlier of own and the account's
+        Account* account = nullptr;
+        const PublicKey* accountKey = nullptr;
+        std::uint32_t list = kNil;  // kNil while free
+        std::uint32_t prev = kNil;
+        std::uint32_t next = kNil;
+        std::uint32_t accountPrev = kNil;
+        std::uint32_t accountNext = kNil;
+        std::uint32_t generation = 0;
+    };
+
+    mutable internal::InstrumentedMutex mutex{"expiry_scheduler"};
+    std::int64_t now = 0;
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> freeList;
+    std::array<std::uint32_t, kLists> heads;
+    std::array<std::size_t, kLevels> levelCounts{};
+    std::size_t timed = 0;  // Entries in the wheel or overflow
+    std::size_t live = 0;
+    std::unordered_map<PublicKey, Account> accounts;
+
+    Impl() { heads.fill(kNil); }
+
+    static Handle handleOf(std::uint32_t index, std::uint32_t generation) {
+        return (static_cast<Handle>(generation) << 32) | (static_cast<Handle>(index) + 1);
+    }
+
+    /// Entry index of a live handle, or kNil
+    std::uint32_t find(Handle handle) const {
+        auto low = static_cast<std::uint32_t>(handle);
+        if (low == 0 || low > entries.size()) {
+            return kNil;
+        }
+        std::uint32_t index = low - 1;
+        const Entry& entry = entries[index];
+        if (entry.list == kNil || entry.generation != static_cast<std::uint32_t>(handle >> 32)) {
+            return kNil;
+        }
+        return index;
+    }
+
+    void link(std::uint32_t index, std::uint32_t list) {
+        Entry& entry = entries[index];
+        entry.list = list;
+        entry.prev = kNil;
+        entry.next = heads[list];
+        if (entry.next != kNil) {
+            entries[entry.next].prev = index;
+        }
+        heads[list] = index;
+        if (list < kDue) {
+            ++levelCounts[list / kSlots];
+        }
+        if (list < kDue || list == kOverflow) {
+            ++timed;
+        }
+    }
+
+    void unlink(std::uint32_t index) {
+        Entry& entry = entries[index];
+        if (entry.prev != kNil) {
+            entries[entry.prev].next = entry.next;
+        } else {
+            heads[entry.list] = entry.next;
+        }
+        if (entry.next != kNil) {
+            entries[entry.next].prev = entry.prev;
+        }
+        if (entry.list < kDue) {
+            --levelCounts[entry.list / kSlots];
+        }
+        if (entry.list < kDue || entry.list == kOverflow) {
+            --timed;
+        }
+    }
+
+    /// List for an entry: the slot of the tick after its expiry, at the
+    /// level of the highest 8-bit digit in which that tick differs from now
+    std::uint32_t listFor(std::int64_t effective) const {
+        if (effective == 0) {
+            return kNever;
+        }
+        if (effective >= std::numeric_limits<std::int64_t>::max() - 1) {
+            return kOverflow;
+        }
+        std::int64_t tick = effective + 1;
+        if (tick <= now) {
+            return kDue;
+        }
+        auto diff = static_cast<std::uint64_t>(tick) ^ static_cast<std::uint64_t>(now);
+        auto level = static_cast<std::uint32_t>((std::bit_width(diff) - 1) / kLevelBits);
+        if (level >= kLevels) {
+            return kOverflow;
+        }
+        auto slot = static_cast<std::uint32_t>((static_cast<std::uint64_t>(tick) >> (level * kLevelBits)) & (kSlots - 1));
+        return level * kSlots + slot;
+    }
+
+    void place(std::uint32_t index) {
+        link(index, listFor(entries[index].effective));
+    }
+
+    std::uint32_t allocate() {
+        if (!freeList.empty()) {
+            std::uint32_t index = freeList.back();
+            freeList.pop_back();
+            return index;
+        }
+        if (entries.size() >= kNil - 1) {
+            throw std::invalid_argument("Expiry scheduler is full");
+        }
+        entries.emplace_back();
+        return static_cast<std::uint32_t>(entries.size() - 1);
+    }
+
+    void detachAccount(std::uint32_t index) {
+        Entry& entry = entries[index];
+        Account* account = entry.account;
+        if (account == nullptr) {
+            return;
+        }
+        if (entry.accountPrev != kNil) {
+            entries[entry.accountPrev].accountNext = entry.accountNext;
+        } else {
+            account->head = entry.accountNext;
+        }
+        if (entry.accountNext != kNil) {
+            entries[entry.accountNext].accountPrev = entry.accountPrev;
+        }
+        --account->count;
+        if (account->count == 0 && account->expires == 0) {
+            accounts.erase(accounts.find(*entry.accountKey));
+        }
+        entry.account = nullptr;
+        entry.accountKey = nullptr;
+    }
+
+    /// Unlink an entry from every list and free its slot
+    void release(std::uint32_t index) {
+        unlink(index);
+        detachAccount(index);
+        Entry& entry = entries[index];
+        entry.list = kNil;
+        ++entry.generation;
+        freeList.push_back(index);
+        --live;
+    }
+
+    Handle add(Id id, std::int64_t expiresAt, const PublicKey& accountKey) {
+        std::uint32_t index = allocate();
+        Entry& entry = entries[index];
+        entry.id = id;
+        entry.own = expiresAt;
+        entry.account = nullptr;
+        entry.accountKey = nullptr;
+        entry.accountPrev = kNil;
+        entry.accountNext = kNil;
+        if (!accountKey.empty()) {
+            auto it = accounts.try_emplace(accountKey).first;
+            Account& account = it->second;
+            entry.account = &account;
+            entry.accountKey = &it->first;
+            entry.accountNext = account.head;
+            if (account.head != kNil) {
+                entries[account.head].accountPrev = index;
+            }
+            account.head = index;
+            ++account.count;
+        }
+        entry.effective = earliest(expiresAt, entry.account != nullptr ? entry.account->expires : 0);
+        place(index);
+        ++live;
+        return handleOf(index, entry.generation);
+    }
+
+    /// Move an entry whose effective expiry changed
+    bool refresh(std::uint32_t index) {
+        Entry& entry = entries[index];
+        std::int64_t effective = earliest(entry.own, entry.account != nullptr ? entry.account->expires : 0);
+        if (effective == entry.effective) {
+            return false;
+        }
+        unlink(index);
+        entry.effective = effective;
+        place(index);
+        return true;
+    }
+
+    void fire(std::uint32_t list, std::vector<Expired>& out) {
+        std::uint32_t index = heads[list];
+        while (index != kNil) {
+            std::uint32_t next = entries[index].next;
+            out.push_back(Expired{entries[index].id, entries[index].effective});
+            release(index);
+            index = next;
+        }
+    }
+
+    /// Re-place every entry of a list relative to the current time
+    void cascade(std::uint32_t list) {
+        std::uint32_t index = heads[list];
+        while (index != kNil) {
+            std::uint32_t next = entries[index].next;
+            unlink(index);
+            place(index);
+            index = next;
+        }
+    }
+
+    void advanceTo(std::int64_t target, std::vector<Expired>& out) {
+        fire(kDue, out);
+        while (now < target) {
+            if (timed == 0) {
+                now = target;
+                break;
+            }
+            if (levelCounts[0] == 0) {
+                // Nothing at the lowest level: skip to its next wrap
+                std::int64_t wrap = (now | (kSlots - 1)) + 1;
+                if (wrap > target) {
+                    now = target;
+                    break;
+                }
+                now = wrap - 1;
+            }
+            ++now;
+            auto tick = static_cast<std::uint64_t>(now);
+            if ((tick & (kSlots - 1)) == 0) {
+                // The lowest level wrapped; pull down the next slot of each
+                // higher level whose digit changed
+                std::uint32_t level = 1;
+                for (; level < kLevels; ++level) {
+                    auto slot = static_cast<std::uint32_t>((tick >> (level * kLevelBits)) & (kSlots - 1));
+                    cascade(level * kSlots + slot);
+                    if (slot != 0) {
+                        break;
+                    }
+                }
+                if (level == kLevels) {
+                    cascade(kOverflow);
+                }
+            }
+            fire(static_cast<std::uint32_t>(tick & (kSlots - 1)), out);
+            if (heads[kDue] != kNil) {
+                fire(kDue, out);  // Cascaded entries that expire on this tick
+            }
+        }
+    }
+};
+
+ExpiryScheduler::ExpiryScheduler(std::int64_t now) : impl_(std::make_unique<Impl>()) {
+    impl_->now = now;
+}
+
+ExpiryScheduler::ExpiryScheduler() : ExpiryScheduler(internal::getCurrentTimestamp()) {}
+
+ExpiryScheduler::~ExpiryScheduler() = default;
+
+ExpiryScheduler::Handle ExpiryScheduler::schedule(Id id, std::int64_t expiresAt, const PublicKey& account) {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    return impl_->add(id, expiresAt, account);
+}
+
+ExpiryScheduler::Handle ExpiryScheduler::schedule(Id id, const ValidationResult& result, const PublicKey& account) {
+    if (!result.valid) {
+        throw std::invalid_argument("Cannot schedule a credential that failed validation: " +
+                                    result.error.value_or("unknown error"));
+    }
+    return schedule(id, result.expiresAt, account);
+}
+
+bool ExpiryScheduler::reschedule(Handle handle, std::int64_t expiresAt) {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    std::uint32_t index = impl_->find(handle);
+    if (index == kNil) {
+        return false;
+    }
+    impl_->entries[index].own = expiresAt;
+    impl_->refresh(index);
+    return true;
+}
+
+bool ExpiryScheduler::cancel(Handle handle) {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    std::uint32_t index = impl_->find(handle);
+    if (index == kNil) {
+        return false;
+    }
+    impl_->release(index);
+    return true;
+}
+
+std::size_t ExpiryScheduler::updateAccount(const PublicKey& account, std::int64_t expiresAt) {
+    if (account.empty()) {
+        throw std::invalid_argument("Account key is empty");
+    }
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    auto it = impl_->accounts.find(account);
+    if (it == impl_->accounts.end()) {
+        if (expiresAt != 0) {
+            impl_->accounts[account].expires = expiresAt;
+        }
+        return 0;
+    }
+    Impl::Account& state = it->second;
+    state.expires = expiresAt;
+    std::size_t moved = 0;
+    for (std::uint32_t index = state.head; index != kNil; index = impl_->entries[index].accountNext) {
+        moved += impl_->refresh(index);
+    }
+    if (state.count == 0 && state.expires == 0) {
+        impl_->accounts.erase(it);
+    }
+    return moved;
+}
+
+std::size_t ExpiryScheduler::updateAccount(const AccountClaims& account) {
+    return updateAccount(account.subjectKey(), account.expires());
+}
+
+std::size_t ExpiryScheduler::advance(std::int64_t now, const Callback& callback) {
+    std::vector<Expired> expired = advance(now);
+    for (const auto& entry : expired) {
+        callback(entry);
+    }
+    return expired.size();
+}
+
+std::vector<ExpiryScheduler::Expired> ExpiryScheduler::advance(std::int64_t now) {
+    std::vector<Expired> expired;
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    impl_->advanceTo(now, expired);
+    return expired;
+}
+
+std::int64_t ExpiryScheduler::expiresAt(Handle handle) const {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    std::uint32_t index = impl_->find(handle);
+    return index == kNil ? 0 : impl_->entries[index].effective;
+}
+
+std::size_t ExpiryScheduler::size() const {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    return impl_->live;
+}
+
+std::int64_t ExpiryScheduler::now() const {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    return impl_->now;
+}
+
+}
@@ -0,0 +1,167 @@
+#include "jwt/exports.hpp"
+#include "jwt/account_claims.hpp"
+#include "lock_stats.hpp"
+#include "subject.hpp"
+#include <array>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    using internal::StringHash;
+    using internal::nextToken;
+
+    constexpr std::uint32_t kNone = UINT32_MAX;
+
+    std::size_t typeIndex(ExportType type) {
+        return static_cast<std::size_t>(type);
+    }
+}
+
+class ExportIndex::Impl {
+public:
+    struct Node {
+        std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> literal;
+        std::uint32_t star = kNone;
+        std::array<std::uint32_t, 2> exact{kNone, kNone};  // Export ending here, per type
+        std::array<std::uint32_t, 2> tail{kNone, kNone};   // Export continuing with '>' here
+    };
+
+    std::vector<Export> exports;
+    std::vector<Node> nodes;
+
+    /// Most specific export covering subject[pos..] below node
+    std::uint32_t lookup(std::uint32_t node, std::string_view subject, std::size_t pos, std::size_t type) const {
+        const Node& current = nodes[node];
+        auto [token, last] = nextToken(subject, pos);
+        auto step = [&](std::uint32_t child) {
+            if (child == kNone) {
+                return kNone;
+            }
+            return last ? nodes[child].exact[type] : lookup(child, subject, pos, type);
+        };
+
+        if (token != "*" && token != ">") {
+            if (auto it = current.literal.find(token); it != current.literal.end()) {
+                if (auto found = step(it->second); found != kNone) {
+                    return found;
+                }
+            }
+        }
+        if (token != ">") {
+            if (auto found = step(current.star); found != kNone) {
+                return found;
+            }
+        }
+        return current.tail[type];
+    }
+};
+
+ExportIndex::ExportIndex(std::vector<Export> exports) {
+    if (exports.empty()) {
+        return;
+    }
+
+    auto impl = std::make_shared<Impl>();
+    impl->nodes.emplace_back();
+    for (std::uint32_t i = 0; i < exports.size(); ++i) {
+        const auto& subject = exports[i].subject;
+        if (!internal::isValidSubject(subject)) {
+            throw std::invalid_argument("Invalid export subject '" + subject + "'");
+        }
+        std::size_t type = typeIndex(exports[i].type);
+
+        // First export wins if two share a subject and type
+        std::uint32_t node = 0;
+        std::size_t pos = 0;
+        while (true) {
+            auto [token, last] = nextToken(subject, pos);
+            if (token == ">") {
+                if (impl->nodes[node].tail[type] == kNone) {
+                    impl->nodes[node].tail[type] = i;
+                }
+                break;
+            }
+
+            std::uint32_t next;
+            if (token == "*") {
+                if (impl->nodes[node].star == kNone) {
+                    impl->nodes[node].star = static_cast<std::uint32_t>(impl->nodes.size());
+                    impl->nodes.emplace_back();
+                }
+                next = impl->nodes[node].star;
+            } else if (auto it = impl->nodes[node].literal.find(token); it != impl->nodes[node].literal.end()) {
+                next = it->second;
+            } else {
+                next = static_cast<std::uint32_t>(impl->nodes.size());
+                impl->nodes.emplace_back();
+                impl->nodes[node].literal.emplace(std::string(token), next);
+            }
+            node = next;
+
+            if (last) {
+                if (impl->nodes[node].exact[type] == kNone) {
+                    impl->nodes[node].exact[type] = i;
+                }
+                break;
+            }
+        }
+    }
+    impl->exports = std::move(exports);
+    impl_ = std::move(impl);
+}
+
+const std::vector<Export>& ExportIndex::exports() const {
+    static const std::vector<Export> none;
+    return impl_ ? impl_->exports : none;
+}
+
+const Export* ExportIndex::find(std::string_view subject, ExportType type) const {
+    if (!impl_ || !internal::isValidSubject(subject)) {
+        return nullptr;
+    }
+    std::uint32_t found = impl_->lookup(0, subject, 0, typeIndex(type));
+    return found != kNone ? &impl_->exports[found] : nullptr;
+}
+
+class ExportRegistry::Impl {
+public:
+    mutable internal::InstrumentedMutex mutex{"export_registry"};
+    std::unordered_map<PublicKey, ExportIndex> accounts;
+};
+
+ExportRegistry::ExportRegistry() : impl_(std::make_unique<Impl>()) {}
+ExportRegistry::~ExportRegistry() = default;
+
+void ExportRegistry::update(const AccountClaims& account) {
+    ExportIndex index = account.exportIndex();
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    impl_->accounts.insert_or_assign(account.subjectKey(), std::move(index));
+}
+
+bool ExportRegistry::remove(const PublicKey& account) {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    return impl_->accounts.erase(account) > 0;
+}
+
+ExportIndex ExportRegistry::exportsOf(const PublicKey& account) const {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    auto it = impl_->accounts.find(account);
+    return it != impl_->accounts.end() ? it->second : ExportIndex();
+}
+
+ExportMatch ExportRegistry::resolve(const Import& import) const {
+    // Only the index handle is copied under the lock; the trie walk runs outside it
+    ExportMatch match{exportsOf(import.account), nullptr};
+    match.exportClaim = match.index.find(import.subject, import.type);
+    return match;
+}
+
+std::size_t ExportRegistry::size() const {
+    std::lock_guard<internal::InstrumentedMutex> lock(impl_->mutex);
+    return impl_->accounts.size();
+}
+
+}
@@ -0,0 +1,248 @@
+#include "jwt/flat_claims.hpp"
+#include "jwt/operator_claims.hpp"
+#include "jwt/account_claims.hpp"
+#include "jwt/user_claims.hpp"
+#include "jwt/activation_claims.hpp"
+#include "jwt/authorization_claims.hpp"
+#include "jwt/jwt_constants.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace jwt {
+
+// Trailing buffer: [AccountLimits (accounts only)][PublicKey x signingKeyCount]
+//                  [FlatRevocation x revocationCount][UserScope x scopeCount][name bytes]
+static_assert(sizeof(FlatClaims) % alignof(AccountLimits) == 0);
+static_assert(sizeof(AccountLimits) % alignof(PublicKey) == 0);
+static_assert(sizeof(FlatClaims) % alignof(FlatRevocation) == 0);
+static_assert(sizeof(PublicKey) % alignof(FlatRevocation) == 0);
+static_assert(sizeof(FlatRevocation) % alignof(UserScope) == 0);
+static_assert(sizeof(PublicKey) % alignof(UserScope) == 0);
+
+namespace {
+    std::size_t limitsSize(ClaimType type) {
+        return type == ClaimType::Account ? sizeof(AccountLimits) : 0;
+    }
+
+    std::size_t trailingSize(ClaimType type, std::size_t signingKeys, std::size_t revocations, std::size_t scopes,
+                             std::size_t nameSize) {
+        return limitsSize(type) + signingKeys * sizeof(PublicKey) + revocations * sizeof(FlatRevocation) +
+               scopes * sizeof(UserScope) + nameSize;
+    }
+
+    /// Revocations are kept sorted by key hash so lookups can binary search
+    bool byHash(const FlatRevocation& a, const FlatRevocation& b) {
+        return a.key.hash() < b.key.hash();
+    }
+}
+
+void FlatClaims::Deleter::operator()(FlatClaims* claims) const noexcept {
+    claims->~FlatClaims();
+    ::operator delete(static_cast<void*>(claims));
+}
+
+FlatClaims::~FlatClaims() {
+    std::destroy_n(signingKeyData(), signingKeyCount_);
+    std::destroy_n(revocationData(), revocationCount_);
+    std::destroy_n(scopeData(), scopeCount_);
+}
+
+AccountLimits* FlatClaims::accountLimitsData() {
+    return std::launder(reinterpret_cast<AccountLimits*>(trailing()));
+}
+
+PublicKey* FlatClaims::signingKeyData() {
+    return std::launder(reinterpret_cast<PublicKey*>(trailing() + limitsSize(type_)));
+}
+
+UserScope* FlatClaims::scopeData() {
+    return std::launder(reinterpret_cast<UserScope*>(trailing() + limitsSize(type_) +
+                                                     signingKeyCount_ * sizeof(PublicKey) +
+                                                     revocationCount_ * sizeof(FlatRevocation)));
+}
+
+FlatRevocation* FlatClaims::revocationData() {
+    return std::launder(reinterpret_cast<FlatRevocation*>(trailing() + limitsSize(type_) +
+                                                          signingKeyCount_ * sizeof(PublicKey)));
+}
+
+char* FlatClaims::nameData() {
+    return reinterpret_cast<char*>(trailing() + limitsSize(type_) + signingKeyCount_ * sizeof(PublicKey) +
+                                   revocationCount_ * sizeof(FlatRevocation) + scopeCount_ * sizeof(UserScope));
+}
+
+FlatClaims::Ptr FlatClaims::allocate(ClaimType type, const Claims& claims, std::size_t signingKeyCount,
+                                     std::size_t revocationCount, std::size_t scopeCount) {
+    auto name = claims.name();
+    std::size_t nameSize = name ? name->size() : 0;
+    void* memory = ::operator new(sizeof(FlatClaims) +
+                                  trailingSize(type, signingKeyCount, revocationCount, scopeCount, nameSize));
+
+    Ptr flat(new (memory) FlatClaims());
+    flat->type_ = type;
+    flat->subject_ = claims.subjectKey();
+    flat->issuer_ = claims.issuerKey();
+    flat->issuedAt_ = claims.issuedAt();
+    flat->expires_ = claims.expires();
+    flat->tags_ = claims.tags();
+    flat->hasName_ = name.has_value();
+    flat->nameSize_ = static_cast<std::uint32_t>(nameSize);
+    if (type == ClaimType::Account) {
+        new (flat->accountLimitsData()) AccountLimits();
+    }
+    std::uninitialized_value_construct_n(flat->signingKeyData(), signingKeyCount);
+    flat->signingKeyCount_ = static_cast<std::uint32_t>(signingKeyCount);
+    std::uninitialized_value_construct_n(flat->revocationData(), revocationCount);
+    flat->revocationCount_ = static_cast<std::uint32_t>(revocationCount);
+    flat->scopeCount_ = static_cast<std::uint32_t>(scopeCount);
+    if (nameSize > 0) {
+        std::memcpy(flat->nameData(), name->data(), nameSize);
+    }
+    return flat;
+}
+
+FlatClaims::Ptr FlatClaims::from(const OperatorClaims& claims) {
+    const auto& keys = claims.signingKeyHandles();
+    auto flat = allocate(ClaimType::Operator, claims, keys.size(), 0);
+    std::copy(keys.begin(), keys.end(), flat->signingKeyData());
+    return flat;
+}
+
+FlatClaims::Ptr FlatClaims::from(const AccountClaims& claims) {
+    const auto& keys = claims.signingKeyHandles();
+    const auto& revocations = claims.revocationKeys();
+    auto scoped = static_cast<std::size_t>(std::count_if(
+        keys.begin(), keys.end(), [&](const PublicKey& key) { return claims.scopeFor(key) != nullptr; }));
+
+    auto flat = allocate(ClaimType::Account, claims, keys.size(), revocations.size(), scoped);
+    UserScope* scopeOut = flat->scopeData();
+    for (const auto& key : keys) {
+        if (const UserScope* scope = claims.scopeFor(key)) {
+            new (scopeOut++) UserScope(*scope);  // Copies a handle; cannot throw
+        }
+    }
+    *flat->accountLimitsData() = claims.limits();
+    flat->natsLimits_ = claims.limits().nats;
+    flat->exportIndex_ = claims.exportIndex();
+    flat->imports_ = claims.sharedImports();
+    flat->subjectMapper_ = claims.subjectMapper();
+    std::copy(keys.begin(), keys.end(), flat->signingKeyData());
+
+    FlatRevocation* out = flat->revocationData();
+    for (const auto& [key, timestamp] : revocations) {
+        out->key = key;
+        out->timestamp = timestamp;
+        ++out;
+    }
+    std::sort(flat->revocationData(), out, byHash);
+    return flat;
+}
+
+FlatClaims::Ptr FlatClaims::from(const UserClaims& claims) {
+    auto flat = allocate(ClaimType::User, claims, 0, 0);
+    flat->issuerAccount_ = claims.issuerAccountKey();
+    flat->natsLimits_ = claims.limits();
+    flat->publish_ = claims.publishMatcher();
+    flat->subscribe_ = claims.subscribeMatcher();
+    flat->connectionPolicy_ = claims.connectionPolicy();
+    return flat;
+}
+
+FlatClaims::Ptr FlatClaims::from(const ActivationClaims& claims) {
+    auto flat = allocate(ClaimType::Activation, claims, 0, 0);
+    flat->issuerAccount_ = claims.issuerAccountKey();
+    return flat;
+}
+
+FlatClaims::Ptr FlatClaims::from(const AuthorizationRequestClaims& claims) {
+    return allocate(ClaimType::AuthorizationRequest, claims, 0, 0);
+}
+
+FlatClaims::Ptr FlatClaims::from(const AuthorizationResponseClaims& claims) {
+    auto flat = allocate(ClaimType::AuthorizationResponse, claims, 0, 0);
+    flat->issuerAccount_ = claims.issuerAccountKey();
+    return flat;
+}
+
+FlatClaims::Ptr FlatClaims::from(const Claims& claims) {
+    if (const auto* user = dynamic_cast<const UserClaims*>(&claims)) {
+        return from(*user);
+    }
+    if (const auto* account = dynamic_cast<const AccountClaims*>(&claims)) {
+        return from(*account);
+    }
+    if (const auto* op = dynamic_cast<const OperatorClaims*>(&claims)) {
+        return from(*op);
+    }
+    if (const auto* activation = dynamic_cast<const ActivationClaims*>(&claims)) {
+        return from(*activation);
+    }
+    if (const auto* request = dynamic_cast<const AuthorizationRequestClaims*>(&claims)) {
+        return from(*request);
+    }
+    if (const auto* response = dynamic_cast<const AuthorizationResponseClaims*>(&claims)) {
+        return from(*response);
+    }
+    throw std::invalid_argument("Unsupported claims type for FlatClaims");
+}
+
+std::optional<std::string_view> FlatClaims::name() const {
+    if (!hasName_) {
+        return std::nullopt;
+    }
+    return std::string_view(const_cast<FlatClaims*>(this)->nameData(), nameSize_);
+}
+
+const AccountLimits& FlatClaims::accountLimits() const {
+    static const AccountLimits unlimited;
+    return type_ == ClaimType::Account ? *const_cast<FlatClaims*>(this)->accountLimitsData() : unlimited;
+}
+
+std::span<const PublicKey> FlatClaims::signingKeys() const {
+    return {const_cast<FlatClaims*>(this)->signingKeyData(), signingKeyCount_};
+}
+
+std::span<const FlatRevocation> FlatClaims::revocations() const {
+    return {const_cast<FlatClaims*>(this)->revocationData(), revocationCount_};
+}
+
+bool FlatClaims::isRevoked(const PublicKey& publicKey, std::int64_t issuedAt) const {
+    static const PublicKey all_users(ALL_USERS_REVOCATION);
+    auto entries = revocations();
+    auto revokedAt = [&](const PublicKey& key) -> bool {
+        auto it = std::lower_bound(entries.begin(), entries.end(), key.hash(),
+                                   [](const FlatRevocation& r, std::size_t hash) { return r.key.hash() < hash; });
+        for (; it != entries.end() && it->key.hash() == key.hash(); ++it) {
+            if (it->key == key) {
+                return issuedAt <= it->timestamp;
+            }
+        }
+        return false;
+    };
+    return !entries.empty() && (revokedAt(publicKey) || revokedAt(all_users));
+}
+
+std::span<const Import> FlatClaims::imports() const {
+    if (!imports_) {
+        return {};
+    }
+    return *imports_;
+}
+
+const UserScope* FlatClaims::scopeFor(const PublicKey& signingKey) const {
+    const UserScope* scopes = const_cast<FlatClaims*>(this)->scopeData();
+    for (std::uint32_t i = 0; i < scopeCount_; ++i) {
+        if (scopes[i].key() == signingKey) {
+            return &scopes[i];
+        }
+    }
+    return nullptr;
+}
+
+std::size_t FlatClaims::allocationSize() const {
+    return sizeof(FlatClaims) + trailingSize(type_, signingKeyCount_, revocationCount_, scopeCount_, nameSize_);
+}
+
+}
@@ -0,0 +1,416 @@
+#include "jwt/generic_claims.hpp"
+#include "base64url.hpp"
+#include "jwt_utils.hpp"
+#include "probes.hpp"
+#include <nlohmann/json.hpp>
+#include <charconv>
+#include <deque>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace jwt {
+
+namespace {
+    /// A scanned object member; rawName is the quoted key as it appears in the JSON
+    struct Member {
+        std::string_view name;
+        std::string_view rawName;
+        std::string_view json;
+    };
+
+    bool isWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    std::size_t skipWhitespace(std::string_view s, std::size_t pos) {
+        while (pos < s.size() && isWhitespace(s[pos])) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    /// End of the string starting at s[pos] == '"'
+    std::size_t scanString(std::string_view s, std::size_t pos) {
+        for (std::size_t i = pos + 1; i < s.size(); ++i) {
+            if (s[i] == '\\') {
+                ++i;
+            } else if (s[i] == '"') {
+                return i + 1;
+            } else if (static_cast<unsigned char>(s[i]) < 0x20) {
+                throw std::invalid_argument("Control character in JSON string");
+            }
+        }
+        throw std::invalid_argument("Unterminated JSON string");
+    }
+
+    /// End of the value starting at s[pos]. Containers are scanned iteratively
+    /// for matching brackets and strings; their contents are not interpreted.
+    std::size_t scanValue(std::string_view s, std::size_t pos) {
+        if (pos >= s.size()) {
+            throw std::invalid_argument("Missing JSON value");
+        }
+        char c = s[pos];
+        if (c == '"') {
+            return scanString(s, pos);
+        }
+        if (c == '{' || c == '[') {
+            std::string closers;
+            for (std::size_t i = pos; i < s.size(); ++i) {
+                switch (s[i]) {
+                    case '"':
+                        i = scanString(s, i) - 1;
+                        break;
+                    case '{':
+                        closers.push_back('}');
+                        break;
+                    case '[':
+                        closers.push_back(']');
+                        break;
+                    case '}':
+                    case ']':
+                        if (closers.empty() || closers.back() != s[i]) {
+                            throw std::invalid_argument("Mismatched bracket in JSON value");
+                        }
+                        closers.pop_back();
+                        if (closers.empty()) {
+                            return i + 1;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+            throw std::invalid_argument("Unterminated JSON value");
+        }
+
+        // Number or literal
+        std::size_t end = pos;
+        while (end < s.size() && s[end] != ',' && s[end] != '}' && s[end] != ']' && !isWhitespace(s[end])) {
+            ++end;
+        }
+        std::string_view scalar = s.substr(pos, end - pos);
+        if (scalar == "true" || scalar == "false" || scalar == "null") {
+            return end;
+        }
+        if (scalar.empty() || scalar.find_first_not_of("+-0123456789.eE") != std::string_view::npos) {
+            throw std::invalid_argument("Invalid JSON value");
+        }
+        return end;
+    }
+
+    /// Decode a JSON string value (fast path when it has no escapes)
+    std::string decodeString(std::string_view json) {
+        if (json.size() < 2 || json.front() != '"' || json.back() != '"') {
+            throw std::invalid_argument("Expected a JSON string");
+        }
+        if (json.find('\\') == std::string_view::npos) {
+            return std::string(json.substr(1, json.size() - 2));
+        }
+        return nlohmann::json::parse(json).get<std::string>();
+    }
+
+    std::int64_t decodeInteger(std::string_view json) {
+        std::int64_t value = 0;
+        auto [end, ec] = std::from_chars(json.data(), json.data() + json.size(), value);
+        if (ec != std::errc() || end != json.data() + json.size()) {
+            throw std::invalid_argument("Expected an integer, got '" + std::string(json) + "'");
+        }
+        return value;
+    }
+
+    /// Scan an object's members into spans; decoded keys with escapes go to owned
+    std::vector<Member> scanObject(std::string_view s, std::deque<std::string>& owned) {
+        std::size_t pos = skipWhitespace(s, 0);
+        if (pos >= s.size() || s[pos] != '{') {
+            throw std::invalid_argument("Expected a JSON object");
+        }
+        pos = skipWhitespace(s, pos + 1);
+
+        std::vector<Member> members;
+        std::unordered_set<std::string_view> seen;
+        if (pos < s.size() && s[pos] == '}') {
+            ++pos;
+        } else {
+            while (true) {
+                if (pos >= s.size() || s[pos] != '"') {
+                    throw std::invalid_argument("Expected a member name");
+                }
+                std::size_t keyEnd = scanString(s, pos);
+                Member member;
+                member.rawName = s.substr(pos, keyEnd - pos);
+                if (member.rawName.find('\\') == std::string_view::npos) {
+                    member.name = member.rawName.substr(1, member.rawName.size() - 2);
+                } else {
+                    member.name = owned.emplace_back(decodeString(member.rawName));
+                }
+                if (!seen.insert(member.name).second) {
+                    throw std::invalid_argument("Duplicate member '" + std::string(member.name) + "'");
+                }
+
+                pos = skipWhitespace(s, keyEnd);
+                if (pos >= s.size() || s[pos] != ':') {
+                    throw std::invalid_argument("Expected ':' after member name");
+                }
+                pos = skipWhitespace(s, pos + 1);
+                std::size_t valueEnd = scanValue(s, pos);
+                member.json = s.substr(pos, valueEnd - pos);
+                members.push_back(member);
+
+                pos = skipWhitespace(s, valueEnd);
+                if (pos < s.size() && s[pos] == ',') {
+                    pos = skipWhitespace(s, pos + 1);
+                    continue;
+                }
+                if (pos < s.size() && s[pos] == '}') {
+                    ++pos;
+                    break;
+                }
+                throw std::invalid_argument("Expected ',' or '}' in JSON object");
+            }
+        }
+        if (skipWhitespace(s, pos) != s.size()) {
+            throw std::invalid_argument("Trailing data after JSON object");
+        }
+        return members;
+    }
+
+    const Member* findMember(const std::vector<Member>& members, std::string_view name) {
+        for (const auto& member : members) {
+            if (member.name == name) {
+                return &member;
+            }
+        }
+        return nullptr;
+    }
+}
+
+class GenericClaims::Impl {
+public:
+    /// Values of the standard fields, interpreted from their spans
+    struct Known {
+        PublicKey subject;
+        PublicKey issuer;
+        std::optional<std::string> name;
+        std::int64_t issuedAt = 0;
+        std::int64_t expires = 0;
+        std::string type;
+        TagSet tags;
+        std::vector<Member> natsMembers;
+    };
+
+    std::string token;
+    std::string payload;
+    std::deque<std::string> owned;  // Storage for replaced values and escaped names; never shrinks
+    std::vector<Member> members;
+    Known known;
+
+    /// Interpret one member into k (throws, leaving k partly updated, on a bad value)
+    void interpret(Known& k, std::string_view name, std::optional<std::string_view> json) {
+        try {
+            interpretMember(k, name, json);
+        } catch (const nlohmann::json::exception& e) {
+            throw std::invalid_argument("Invalid '" + std::string(name) + "' field: " + e.what());
+        }
+    }
+
+private:
+    void interpretMember(Known& k, std::string_view name, std::optional<std::string_view> json) {
+        if (name == "sub") {
+            k.subject = json ? PublicKey(decodeString(*json)) : PublicKey();
+        } else if (name == "iss") {
+            k.issuer = json ? PublicKey(decodeString(*json)) : PublicKey();
+        } else if (name == "name") {
+            k.name = json ? std::optional<std::string>(decodeString(*json)) : std::nullopt;
+        } else if (name == "iat") {
+            k.issuedAt = json ? decodeInteger(*json) : 0;
+        } else if (name == "exp") {
+            k.expires = json ? decodeInteger(*json) : 0;
+        } else if (name == "nats") {
+            k.natsMembers = json ? scanObject(*json, owned) : std::vector<Member>{};
+            const Member* type = findMember(k.natsMembers, "type");
+            k.type = type ? decodeString(type->json) : std::string();
+            k.tags = TagSet();
+            if (const Member* tags = findMember(k.natsMembers, "tags")) {
+                // Tag arrays are short; parse just this span
+                for (const auto& tag : nlohmann::json::parse(tags->json)) {
+                    k.tags.addUninterned(tag.get_ref<const std::string&>());
+                }
+            }
+        }
+    }
+};
+
+GenericClaims::GenericClaims() : impl_(std::make_unique<Impl>()) {}
+GenericClaims::~GenericClaims() = default;
+GenericClaims::GenericClaims(GenericClaims&& other) noexcept = default;
+GenericClaims& GenericClaims::operator=(GenericClaims&& other) noexcept = default;
+
+std::string GenericClaims::subject() const { return impl_->known.subject.str(); }
+std::string GenericClaims::issuer() const { return impl_->known.issuer.str(); }
+const PublicKey& GenericClaims::subjectKey() const { return impl_->known.subject; }
+const PublicKey& GenericClaims::issuerKey() const { return impl_->known.issuer; }
+std::optional<std::string> GenericClaims::name() const { return impl_->known.name; }
+std::int64_t GenericClaims::issuedAt() const { return impl_->known.issuedAt; }
+std::int64_t GenericClaims::expires() const { return impl_->known.expires; }
+const TagSet& GenericClaims::tags() const { return impl_->known.tags; }
+std::string_view GenericClaims::type() const { return impl_->known.type; }
+const std::string& GenericClaims::token() const { return impl_->token; }
+
+std::vector<GenericClaims::Field> GenericClaims::fields() const {
+    std::vector<Field> out;
+    out.reserve(impl_->members.size());
+    for (const auto& member : impl_->members) {
+        out.push_back({member.name, member.json});
+    }
+    return out;
+}
+
+std::optional<std::string_view> GenericClaims::field(std::string_view name) const {
+    const Member* member = findMember(impl_->members, name);
+    return member ? std::optional<std::string_view>(member->json) : std::nullopt;
+}
+
+std::optional<std::string_view> GenericClaims::natsField(std::string_view name) const {
+    const Member* member = findMember(impl_->known.natsMembers, name);
+    return member ? std::optional<std::string_view>(member->json) : std::nullopt;
+}
+
+void GenericClaims::setField(std::string_view name, std::string json) {
+    std::size_t begin = skipWhitespace(json, 0);
+    std::size_t end = scanValue(json, begin);
+    if (skipWhitespace(json, end) != json.size()) {
+        throw std::invalid_argument("Field '" + std::string(name) + "' must be a single JSON value");
+    }
+
+    // Interpret before changing anything, so a bad standard field leaves the claims as they were
+    std::string_view value = impl_->owned.emplace_back(std::move(json));
+    value = value.substr(begin, end - begin);
+    Impl::Known known = impl_->known;
+    impl_->interpret(known, name, value);
+    impl_->known = std::move(known);
+
+    for (auto& member : impl_->members) {
+        if (member.name == name) {
+            member.json = value;
+            return;
+        }
+    }
+    std::string_view rawName = impl_->owned.emplace_back(nlohmann::json(std::string(name)).dump());
+    impl_->members.push_back({rawName.substr(1, rawName.size() - 2), rawName, value});
+    if (impl_->members.back().name != name) {
+        // The name needed escaping; keep the decoded form for lookups
+        impl_->members.back().name = impl_->owned.emplace_back(name);
+    }
+}
+
+bool GenericClaims::removeField(std::string_view name) {
+    for (auto it = impl_->members.begin(); it != impl_->members.end(); ++it) {
+        if (it->name == name) {
+            impl_->members.erase(it);
+            impl_->interpret(impl_->known, name, std::nullopt);
+            return true;
+        }
+    }
+    return false;
+}
+
+void GenericClaims::setIssuer(std::string_view issuerKey) {
+    setField("iss", nlohmann::json(std::string(issuerKey)).dump());
+}
+void GenericClaims::setName(std::string_view name) {
+    setField("name", nlohmann::json(std::string(name)).dump());
+}
+void GenericClaims::setExpires(std::int64_t exp) {
+    if (exp > 0) {
+        setField("exp", std::to_string(exp));
+    } else {
+        removeField("exp");
+    }
+}
+
+std::string GenericClaims::payload() const {
+    std::size_t size = 2;
+    for (const auto& member : impl_->members) {
+        size += member.rawName.size() + member.json.size() + 2;
+    }
+    std::string out;
+    out.reserve(size);
+    out += '{';
+    for (std::size_t i = 0; i < impl_->members.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += impl_->members[i].rawName;
+        out += ':';
+        out += impl_->members[i].json;
+    }
+    out += '}';
+    return out;
+}
+
+std::string GenericClaims::encode(const std::string& seed) const {
+    return encode(Signer(seed));
+}
+
+std::string GenericClaims::encode(const Signer& signer) const {
+    using namespace internal;
+
+    JWT_PROBE(encode__entry, PROBE_ANY);
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] std::size_t probe_token_len = 0;
+    JWT_PROBE_ON_EXIT(probe_exit, encode__return, PROBE_ANY, probe_result, probe_token_len);
+
+    validate();
+    std::string token = signJwt(payload(), signer);
+    probe_result = PROBE_OK;
+    probe_token_len = token.size();
+    return token;
+}
+
+void GenericClaims::validate() const {
+    if (impl_->known.subject.empty()) {
+        throw std::invalid_argument("Claims subject cannot be empty");
+    }
+    if (impl_->known.issuer.empty()) {
+        throw std::invalid_argument("Claims issuer cannot be empty");
+    }
+    if (impl_->known.expires > 0 && impl_->known.issuedAt > 0 &&
+        impl_->known.expires <= impl_->known.issuedAt) {
+        throw std::invalid_argument("Expiration must be after issuedAt");
+    }
+}
+
+std::unique_ptr<GenericClaims> decodeGenericClaims(const std::string& jwt) {
+    using namespace internal;
+
+    JWT_PROBE(decode__entry, jwt.size(), PROBE_ANY);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_ANY, probe_result);
+
+    // Parse JWT into its three components and check the header
+    auto parts = parseJwt(jwt);
+    decodeHeader(parts);
+
+    std::unique_ptr<GenericClaims> claims(new GenericClaims());
+    auto& impl = *claims->impl_;
+    impl.token = jwt;
+    auto bytes = base64url_decode(parts.payload_b64);
+    impl.payload.assign(bytes.begin(), bytes.end());
+
+    // One scan over the payload; only the standard fields are interpreted
+    impl.members = scanObject(impl.payload, impl.owned);
+    for (const auto& member : impl.members) {
+        impl.interpret(impl.known, member.name, member.json);
+    }
+    if (!findMember(impl.members, "nats")) {
+        throw std::invalid_argument("Missing 'nats' object in JWT payload");
+    }
+
+    // Validate the decoded claims
+    claims->validate();
+
+    probe_result = PROBE_OK;
+    return claims;
+}
+
+}
@@ -0,0 +1,387 @@
+#include "jwt/hierarchy_generator.hpp"
+#include "jwt/operator_claims.hpp"
+#include "jwt/account_claims.hpp"
+#include "jwt/user_claims.hpp"
+#include "jwt_utils.hpp"
+#include "nkey_codec.hpp"
+#include <nkeys/nkeys.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace jwt {
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr std::int64_t kMinUserLifetime = 60 * 60;             // 1 hour
+    constexpr std::int64_t kMaxUserLifetime = 30 * 24 * 60 * 60;   // 30 days
+    constexpr std::int64_t kRevocationWindow = 24 * 60 * 60;       // Covers users issued within a day of `now`
+    constexpr std::size_t kUserChunk = 64;
+
+    /// Distinguishes the key streams derived from one seed
+    enum class KeyRole : std::uint64_t {
+        Operator = 1,
+        Account = 2,
+        SigningKey = 3,
+        User = 4,
+    };
+
+    /// splitmix64: small, fast and good enough to spread seeds into key material
+    class SplitMix64 {
+    public:
+        explicit SplitMix64(std::uint64_t state) : state_(state) {}
+
+        std::uint64_t next() {
+            std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /// Uniform value in [0, 1)
+        double nextUnit() {
+            return static_cast<double>(next() >> 11) * 0x1.0p-53;
+        }
+
+    private:
+        std::uint64_t state_;
+    };
+
+    SplitMix64 streamFor(std::uint64_t seed, KeyRole role, std::uint64_t a, std::uint64_t b = 0,
+                         std::uint64_t c = 0) {
+        SplitMix64 mix(seed);
+        std::uint64_t state = mix.next();
+        for (std::uint64_t part : {static_cast<std::uint64_t>(role), a, b, c}) {
+            state = SplitMix64(state ^ part).next();
+        }
+        return SplitMix64(state);
+    }
+
+    /// Encode 32 raw bytes as an nkey seed string ("S" + type prefix)
+    std::string encodeSeed(nkeys::PrefixByte prefix, const std::array<std::uint8_t, 32>& raw) {
+        auto type = static_cast<std::uint8_t>(prefix);
+        std::array<std::uint8_t, 36> bytes{};
+        bytes[0] = static_cast<std::uint8_t>(static_cast<std::uint8_t>(nkeys::PrefixByte::Seed) | (type >> 5));
+        bytes[1] = static_cast<std::uint8_t>((type & 31) << 3);
+        std::copy(raw.begin(), raw.end(), bytes.begin() + 2);
+        std::uint16_t crc = internal::crc16(std::span<const std::uint8_t>(bytes.data(), 34));
+        bytes[34] = static_cast<std::uint8_t>(crc & 0xFF);
+        bytes[35] = static_cast<std::uint8_t>(crc >> 8);
+        return internal::base32Encode(bytes);
+    }
+
+    GeneratedKey deriveKey(SplitMix64& stream, nkeys::PrefixByte prefix) {
+        std::array<std::uint8_t, 32> raw{};
+        for (std::size_t i = 0; i < raw.size(); i += 8) {
+            std::uint64_t word = stream.next();
+            for (std::size_t j = 0; j < 8; ++j) {
+                raw[i + j] = static_cast<std::uint8_t>(word >> (8 * j));
+            }
+        }
+        GeneratedKey key;
+        key.seed = encodeSeed(prefix, raw);
+        key.publicKey = nkeys::FromSeed(key.seed)->publicString();
+        return key;
+    }
+
+    std::string operatorName(std::size_t o) {
+        return "operator-" + std::to_string(o);
+    }
+
+    std::string accountName(std::size_t o, std::size_t a) {
+        return "account-" + std::to_string(o) + "-" + std::to_string(a);
+    }
+
+    std::string userName(std::size_t o, std::size_t a, std::size_t u) {
+        return "user-" + std::to_string(o) + "-" + std::to_string(a) + "-" + std::to_string(u);
+    }
+
+    void validateSpec(const HierarchySpec& spec) {
+        if (spec.revocationsPerAccount > spec.usersPerAccount) {
+            throw std::invalid_argument("revocationsPerAccount cannot exceed usersPerAccount");
+        }
+        if (!(spec.expiringUserFraction >= 0.0 && spec.expiringUserFraction <= 1.0)) {
+            throw std::invalid_argument("expiringUserFraction must be between 0 and 1");
+        }
+        if (spec.signUsersWithSigningKeys && spec.signingKeysPerAccount == 0) {
+            throw std::invalid_argument("signUsersWithSigningKeys requires signingKeysPerAccount > 0");
+        }
+    }
+
+    /// Run fn(begin, end) over [0, count) in chunks on a small worker pool
+    template <typename F>
+    void parallelFor(std::size_t count, std::size_t chunk, unsigned threads, F fn) {
+        if (count == 0) return;
+        std::size_t chunks = (count + chunk - 1) / chunk;
+        unsigned workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        workers = static_cast<unsigned>(std::min<std::size_t>(workers, chunks));
+
+        std::atomic<std::size_t> nextChunk{0};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto work = [&]() {
+            for (;;) {
+                std::size_t c = nextChunk.fetch_add(1, std::memory_order_relaxed);
+                if (c >= chunks) return;
+                try {
+                    fn(c * chunk, std::min(count, (c + 1) * chunk));
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                    nextChunk.store(chunks, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (unsigned i = 1; i < workers; ++i) {
+            pool.emplace_back(work);
+        }
+        work();
+        for (auto& t : pool) {
+            t.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void writeFile(const fs::path& path, const std::string& content) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot write to file: " + path.string());
+        }
+        file << content << "\n";
+    }
+
+    fs::path operatorDir(const fs::path& root, const GeneratedOperator& op) {
+        return root / op.name;
+    }
+
+    fs::path accountDir(const fs::path& root, const GeneratedOperator& op, const GeneratedAccount& acct) {
+        return root / op.name / "accounts" / acct.name;
+    }
+
+    void writeOperator(const fs::path& root, const GeneratedOperator& op) {
+        auto dir = operatorDir(root, op);
+        fs::create_directories(dir);
+        writeFile(dir / (op.name + ".jwt"), op.jwt);
+        writeFile(dir / (op.name + ".seed"), op.key.seed);
+    }
+
+    void writeAccount(const fs::path& root, const GeneratedOperator& op, const GeneratedAccount& acct) {
+        auto dir = accountDir(root, op, acct);
+        fs::create_directories(dir / "users");
+        writeFile(dir / (acct.name + ".jwt"), acct.jwt);
+        writeFile(dir / (acct.name + ".seed"), acct.key.seed);
+        for (std::size_t k = 0; k < acct.signingKeys.size(); ++k) {
+            writeFile(dir / ("signing-key-" + std::to_string(k) + ".seed"), acct.signingKeys[k].seed);
+        }
+    }
+
+    void writeUser(const fs::path& usersDir, const GeneratedUser& user) {
+        writeFile(usersDir / (user.name + ".jwt"), user.jwt);
+        writeFile(usersDir / (user.name + ".seed"), user.key.seed);
+        std::ofstream creds(usersDir / (user.name + ".creds"), std::ios::binary | std::ios::trunc);
+        if (!creds) {
+            throw std::runtime_error("Cannot write to file: " + (usersDir / (user.name + ".creds")).string());
+        }
+        creds << formatUserConfig(user.jwt, user.key.seed);
+    }
+
+    /**
+     * Generates operators and accounts (without users). Users are produced
+     * separately so that a single large account still spreads across threads.
+     */
+    class Generator {
+    public:
+        explicit Generator(const HierarchySpec& spec) : spec_(spec) {
+            validateSpec(spec_);
+            if (spec_.now == 0) {
+                spec_.now = internal::getCurrentTimestamp();
+            }
+        }
+
+        [[nodiscard]] std::size_t userTotal() const {
+            return spec_.operators * spec_.accountsPerOperator * spec_.usersPerAccount;
+        }
+
+        TrustHierarchy skeleton() const {
+            TrustHierarchy hierarchy;
+            hierarchy.operators.resize(spec_.operators);
+            for (std::size_t o = 0; o < spec_.operators; ++o) {
+                auto& op = hierarchy.operators[o];
+                auto stream = streamFor(spec_.seed, KeyRole::Operator, o);
+                op.name = operatorName(o);
+                op.key = deriveKey(stream, nkeys::PrefixByte::Operator);
+
+                OperatorClaims claims(op.key.publicKey);
+                claims.setName(op.name);
+                op.jwt = claims.encode(op.key.seed);
+                op.accounts.resize(spec_.accountsPerOperator);
+            }
+
+            std::size_t accountTotal = spec_.operators * spec_.accountsPerOperator;
+            parallelFor(accountTotal, 1, spec_.threads, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    std::size_t o = i / spec_.accountsPerOperator;
+                    std::size_t a = i % spec_.accountsPerOperator;
+                    fillAccount(hierarchy.operators[o], o, a);
+                }
+            });
+            return hierarchy;
+        }
+
+        GeneratedUser user(const GeneratedAccount& acct, std::size_t o, std::size_t a, std::size_t u) const {
+            auto stream = streamFor(spec_.seed, KeyRole::User, o, a, u);
+            GeneratedUser user;
+            user.name = userName(o, a, u);
+            user.key = deriveKey(stream, nkeys::PrefixByte::User);
+            if (stream.nextUnit() < spec_.expiringUserFraction) {
+                auto span = static_cast<std::uint64_t>(kMaxUserLifetime - kMinUserLifetime);
+                user.expires = spec_.now + kMinUserLifetime + static_cast<std::int64_t>(stream.next() % span);
+            }
+
+            // Issued at `now`, so fillAccount's revocation at `now + kRevocationWindow`
+            // covers the last users of the account for any spec.now
+            user.revoked = u >= spec_.usersPerAccount - spec_.revocationsPerAccount;
+            UserClaims claims(user.key.publicKey);
+            claims.setName(user.name);
+            claims.setIssuedAt(spec_.now);
+            if (user.expires > 0) {
+                claims.setExpires(user.expires);
+            }
+            if (spec_.signUsersWithSigningKeys) {
+                const auto& signer = acct.signingKeys[u % acct.signingKeys.size()];
+                claims.setIssuer(signer.publicKey);
+                claims.setIssuerAccount(acct.key.publicKey);
+                user.jwt = claims.encode(signer.seed);
+            } else {
+                claims.setIssuer(acct.key.publicKey);
+                user.jwt = claims.encode(acct.key.seed);
+            }
+            return user;
+        }
+
+        /// Visit every (operator, account, user index) in [begin, end) of the flattened user range
+        template <typename F>
+        void forUsers(const TrustHierarchy& hierarchy, F fn) const {
+            std::size_t perOperator = spec_.accountsPerOperator * spec_.usersPerAccount;
+            parallelFor(userTotal(), kUserChunk, spec_.threads, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    std::size_t o = i / perOperator;
+                    std::size_t a = (i % perOperator) / spec_.usersPerAccount;
+                    std::size_t u = i % spec_.usersPerAccount;
+                    fn(o, a, u, user(hierarchy.operators[o].accounts[a], o, a, u));
+                }
+            });
+        }
+
+    private:
+        void fillAccount(GeneratedOperator& op, std::size_t o, std::size_t a) const {
+            auto& acct = op.accounts[a];
+            auto stream = streamFor(spec_.seed, KeyRole::Account, o, a);
+            acct.name = accountName(o, a);
+            acct.key = deriveKey(stream, nkeys::PrefixByte::Account);
+
+            AccountClaims claims(acct.key.publicKey);
+            claims.setName(acct.name);
+            claims.setIssuer(op.key.publicKey);
+
+            acct.signingKeys.reserve(spec_.signingKeysPerAccount);
+            for (std::size_t k = 0; k < spec_.signingKeysPerAccount; ++k) {
+                auto keyStream = streamFor(spec_.seed, KeyRole::SigningKey, o, a, k);
+                acct.signingKeys.push_back(deriveKey(keyStream, nkeys::PrefixByte::Account));
+                claims.addSigningKey(acct.signingKeys.back().publicKey);
+            }
+
+            // Revoke the last users; their keys are re-derived from the same streams
+            for (std::size_t u = spec_.usersPerAccount - spec_.revocationsPerAccount; u < spec_.usersPerAccount; ++u) {
+                auto userStream = streamFor(spec_.seed, KeyRole::User, o, a, u);
+                claims.addRevocation(deriveKey(userStream, nkeys::PrefixByte::User).publicKey,
+                                     spec_.now + kRevocationWindow);
+            }
+
+            acct.jwt = claims.encode(op.key.seed);
+        }
+
+        HierarchySpec spec_;
+    };
+}
+
+std::size_t TrustHierarchy::accountCount() const {
+    std::size_t count = 0;
+    for (const auto& op : operators) {
+        count += op.accounts.size();
+    }
+    return count;
+}
+
+std::size_t TrustHierarchy::userCount() const {
+    std::size_t count = 0;
+    for (const auto& op : operators) {
+        for (const auto& acct : op.accounts) {
+            count += acct.users.size();
+        }
+    }
+    return count;
+}
+
+TrustHierarchy generateHierarchy(const HierarchySpec& spec) {
+    Generator generator(spec);
+    TrustHierarchy hierarchy = generator.skeleton();
+    for (auto& op : hierarchy.operators) {
+        for (auto& acct : op.accounts) {
+            acct.users.resize(spec.usersPerAccount);
+        }
+    }
+
+    // Each user lands in its own preallocated slot, so workers never contend
+    generator.forUsers(hierarchy, [&](std::size_t o, std::size_t a, std::size_t u, GeneratedUser user) {
+        hierarchy.operators[o].accounts[a].users[u] = std::move(user);
+    });
+    return hierarchy;
+}
+
+void generateHierarchy(const HierarchySpec& spec, const std::string& directory) {
+    Generator generator(spec);
+    TrustHierarchy hierarchy = generator.skeleton();
+    fs::path root(directory);
+    for (const auto& op : hierarchy.operators) {
+        writeOperator(root, op);
+        for (const auto& acct : op.accounts) {
+            writeAccount(root, op, acct);
+        }
+    }
+
+    generator.forUsers(hierarchy, [&](std::size_t o, std::size_t a, std::size_t, const GeneratedUser& user) {
+        const auto& op = hierarchy.operators[o];
+        writeUser(accountDir(root, op, op.accounts[a]) / "users", user);
+    });
+}
+
+void writeHierarchy(const TrustHierarchy& hierarchy, const std::string& directory) {
+    fs::path root(directory);
+    for (const auto& op : hierarchy.operators) {
+        writeOperator(root, op);
+        for (const auto& acct : op.accounts) {
+            writeAccount(root, op, acct);
+            auto usersDir = accountDir(root, op, acct) / "users";
+            for (const auto& user : acct.users) {
+                writeUser(usersDir, user);
+            }
+        }
+    }
+}
+
+}
@@ -2,8 +2,11 @@
 #include "jwt/operator_claims.hpp"
 #include "jwt/account_claims.hpp"
 #include "jwt/user_claims.hpp"
+#include "jwt/activation_claims.hpp"
+#include "jwt/authorization_claims.hpp"
 #include "base64url.hpp"
 #include "jwt_utils.hpp"
+#include "probes.hpp"
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 
@@ -11,51 +14,59 @@ namespace jwt {
 
 std::unique_ptr<Claims> decode(const std::string& jwt) {
     using namespace internal;
-    using json = nlohmann::json;
+
+    JWT_PROBE(decode__entry, jwt.size(), PROBE_ANY);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_ANY, probe_result);
 
     auto parts = parseJwt(jwt);
 
-    auto payload_bytes = base64url_decode(parts.payload_b64);
-    std::string payload_json(payload_bytes.begin(), payload_bytes.end());
-    auto payload = json::parse(payload_json);
+    auto payload = decodePayload(parts);
 
     if (!payload.contains("nats")) {
         throw std::invalid_argument("Missing 'nats' object in JWT payload");
     }
-    auto nats = payload["nats"];
+    auto& nats = payload["nats"];
 
     if (!nats.contains("type")) {
         throw std::invalid_argument("Missing 'type' field in nats object");
     }
 
     // Dispatch to type-specific decoder
-    if (auto type = nats["type"].get<std::string>(); type == "operator") {
-        return decodeOperatorClaims(jwt);
+    std::unique_ptr<Claims> claims;
+    if (const auto& type = nats["type"].get_ref<const std::string&>(); type == "operator") {
+        claims = decodeOperatorClaims(jwt);
     } else if (type == "account") {
-        return decodeAccountClaims(jwt);
+        claims = decodeAccountClaims(jwt);
     } else if (type == "user") {
-        return decodeUserClaims(jwt);
+        claims = decodeUserClaims(jwt);
+    } else if (type == "activation") {
+        claims = decodeActivationClaims(jwt);
+    } else if (type == "authorization_request") {
+        claims = decodeAuthorizationRequestClaims(jwt);
+    } else if (type == "authorization_response") {
+        claims = decodeAuthorizationResponseClaims(jwt);
     } else {
         throw std::invalid_argument("Unknown JWT type: " + type);
     }
+
+    probe_result = PROBE_OK;
+    return claims;
 }
 
 bool verify(const std::string& jwt) {
     using namespace internal;
-    using json = nlohmann::json;
 
     try {
         auto parts = parseJwt(jwt);
 
-        auto payload_bytes = base64url_decode(parts.payload_b64);
-        std::string payload_json(payload_bytes.begin(), payload_bytes.end());
-        auto payload = json::parse(payload_json);
+        auto payload = decodePayload(parts);
 
         // Extract issuer (the public key that signed this JWT)
         if (!payload.contains("iss")) {
             return false;
         }
-        std::string issuer = payload["iss"].get<std::string>();
+        PublicKey issuer(payload["iss"].get_ref<const std::string&>());
 
         return verifySignature(issuer, parts.signing_input, parts.signature_b64);
 
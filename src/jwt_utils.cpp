@@ -1,6 +1,9 @@
 #include "jwt_utils.hpp"
 #include "jwt/jwt_constants.hpp"
 #include "base64url.hpp"
+#include "key_cache.hpp"
+#include "metrics_internal.hpp"
+#include "probes.hpp"
 #include <nkeys/nkeys.hpp>
 #include <nlohmann/json.hpp>
 #include <chrono>
@@ -35,13 +38,29 @@ std::string createHeader() {
     return header.dump();
 }
 
-std::vector<std::uint8_t> signData(const std::string& seed,
-                                     std::span<const std::uint8_t> data) {
-    auto keypair = nkeys::FromSeed(seed);
-    return keypair->sign(data);
+std::string signJwt(std::string_view payload_json, const Signer& signer) {
+    static const std::string header_b64 = [] {
+        std::string header_json = createHeader();
+        return base64url_encode(std::span<const std::uint8_t>(
+            reinterpret_cast<const std::uint8_t*>(header_json.data()), header_json.size()));
+    }();
+
+    std::string token = header_b64;
+    token += '.';
+    token += base64url_encode(std::span<const std::uint8_t>(
+        reinterpret_cast<const std::uint8_t*>(payload_json.data()), payload_json.size()));
+
+    // Sign "header.payload", then append the signature in place
+    auto signature = signer.sign(std::span<const std::uint8_t>(
+        reinterpret_cast<const std::uint8_t*>(token.data()), token.size()));
+    token += '.';
+    token += base64url_encode(signature);
+    return token;
 }
 
 JwtParts parseJwt(std::string_view jwt) {
+    JWT_METRICS_STAGE(stage, Split);
+
     // Find the two dots separating header.payload.signature
     size_t first_dot = jwt.find('.');
     if (first_dot == std::string_view::npos) {
@@ -77,6 +96,7 @@ JwtParts parseJwt(std::string_view jwt) {
     // Create signing input (what was actually signed)
     std::string signing_input = header_b64 + "." + payload_b64;
 
+    JWT_METRICS_SUCCESS(stage);
     return JwtParts{
         std::move(header_b64),
         std::move(payload_b64),
@@ -85,9 +105,206 @@ JwtParts parseJwt(std::string_view jwt) {
     };
 }
 
-bool verifySignature(const std::string& issuer_public_key,
+nlohmann::json decodeHeader(const JwtParts& parts) {
+    JWT_METRICS_STAGE(stage, HeaderDecode);
+
+    auto header_bytes = base64url_decode(parts.header_b64);
+    auto header = nlohmann::json::parse(header_bytes.begin(), header_bytes.end());
+
+    if (!header.contains("alg") || header["alg"] != JWT_ALGORITHM) {
+        throw std::invalid_argument(
+            "Unsupported algorithm: expected '" + std::string(JWT_ALGORITHM) + "'"
+        );
+    }
+
+    JWT_METRICS_SUCCESS(stage);
+    return header;
+}
+
+nlohmann::json decodePayload(const JwtParts& parts) {
+    std::vector<std::uint8_t> payload_bytes;
+    {
+        JWT_METRICS_STAGE(stage, PayloadDecode);
+        payload_bytes = base64url_decode(parts.payload_b64);
+        JWT_METRICS_SUCCESS(stage);
+    }
+
+    JWT_METRICS_STAGE(stage, Parse);
+    auto payload = nlohmann::json::parse(payload_bytes.begin(), payload_bytes.end());
+    JWT_METRICS_SUCCESS(stage);
+    return payload;
+}
+
+void takeString(nlohmann::json& object, const char* field, std::string& out) {
+    if (auto it = object.find(field); it != object.end()) {
+        out = std::move(it->get_ref<std::string&>());
+    }
+}
+
+void readLimit(const nlohmann::json& object, const char* field, std::int64_t& out) {
+    if (auto it = object.find(field); it != object.end()) {
+        out = it->get<std::int64_t>();
+    }
+}
+
+void readNatsLimits(const nlohmann::json& object, NatsLimits& limits) {
+    readLimit(object, "subs", limits.subs);
+    readLimit(object, "data", limits.data);
+    readLimit(object, "payload", limits.payload);
+}
+
+void writeNatsLimits(const NatsLimits& limits, nlohmann::json& object) {
+    object["subs"] = limits.subs;
+    object["data"] = limits.data;
+    object["payload"] = limits.payload;
+}
+
+namespace {
+    void moveSubjects(nlohmann::json& list, std::vector<std::string>& out) {
+        out.reserve(list.size());
+        for (auto& subject : list) {
+            out.push_back(std::move(subject.get_ref<std::string&>()));
+        }
+    }
+
+    Permission readPermission(nlohmann::json& object) {
+        Permission permission;
+        if (auto it = object.find("allow"); it != object.end()) {
+            moveSubjects(*it, permission.allow);
+        }
+        if (auto it = object.find("deny"); it != object.end()) {
+            moveSubjects(*it, permission.deny);
+        }
+        return permission;
+    }
+
+    nlohmann::json writePermission(const Permission& permission) {
+        nlohmann::json out = nlohmann::json::object();
+        if (!permission.allow.empty()) {
+            out["allow"] = permission.allow;
+        }
+        if (!permission.deny.empty()) {
+            out["deny"] = permission.deny;
+        }
+        return out;
+    }
+}
+
+Permissions readPermissions(nlohmann::json& object) {
+    Permissions permissions;
+    if (auto it = object.find("pub"); it != object.end()) {
+        permissions.pub = readPermission(*it);
+    }
+    if (auto it = object.find("sub"); it != object.end()) {
+        permissions.sub = readPermission(*it);
+    }
+    return permissions;
+}
+
+void writePermissions(const Permissions& permissions, nlohmann::json& object) {
+    if (!permissions.pub.empty()) {
+        object["pub"] = writePermission(permissions.pub);
+    }
+    if (!permissions.sub.empty()) {
+        object["sub"] = writePermission(permissions.sub);
+    }
+}
+
+ConnectionRestrictions readConnectionRestrictions(nlohmann::json& object) {
+    ConnectionRestrictions restrictions;
+    if (auto it = object.find("src"); it != object.end()) {
+        if (it->is_string()) {
+            std::string_view list = it->get_ref<const std::string&>();
+            while (!list.empty()) {
+                auto comma = list.find(',');
+                auto entry = list.substr(0, comma);
+                auto first = entry.find_first_not_of(' ');
+                if (first != std::string_view::npos) {
+                    restrictions.src.emplace_back(entry.substr(first, entry.find_last_not_of(' ') - first + 1));
+                }
+                list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            }
+        } else {
+            moveSubjects(*it, restrictions.src);
+        }
+    }
+    if (auto it = object.find("times"); it != object.end()) {
+        restrictions.times.reserve(it->size());
+        for (auto& range : *it) {
+            TimeRange& out = restrictions.times.emplace_back();
+            takeString(range, "start", out.start);
+            takeString(range, "end", out.end);
+        }
+    }
+    takeString(object, "times_location", restrictions.timesLocation);
+    if (auto it = object.find("allowed_connection_types"); it != object.end()) {
+        moveSubjects(*it, restrictions.connectionTypes);
+    }
+    return restrictions;
+}
+
+void writeConnectionRestrictions(const ConnectionRestrictions& restrictions, nlohmann::json& object) {
+    if (!restrictions.src.empty()) {
+        object["src"] = restrictions.src;
+    }
+    if (!restrictions.times.empty()) {
+        auto& times = object["times"] = nlohmann::json::array();
+        for (const auto& range : restrictions.times) {
+            times.push_back({{"start", range.start}, {"end", range.end}});
+        }
+    }
+    if (!restrictions.timesLocation.empty()) {
+        object["times_location"] = restrictions.timesLocation;
+    }
+    if (!restrictions.connectionTypes.empty()) {
+        object["allowed_connection_types"] = restrictions.connectionTypes;
+    }
+}
+
+TagSet readTags(const nlohmann::json& nats) {
+    TagSet tags;
+    if (auto it = nats.find("tags"); it != nats.end() && it->is_array()) {
+        for (const auto& tag : *it) {
+            tags.addUninterned(tag.get_ref<const std::string&>());
+        }
+    }
+    return tags;
+}
+
+void writeTags(const TagSet& tags, nlohmann::json& nats) {
+    if (!tags.empty()) {
+        nats["tags"] = tags.names();
+    }
+}
+
+const char* exportTypeName(ExportType type) {
+    return type == ExportType::Service ? "service" : "stream";
+}
+
+ExportType readExportType(const nlohmann::json& object, const char* field) {
+    auto it = object.find(field);
+    if (it == object.end()) {
+        return ExportType::Stream;
+    }
+    const auto& type = it->get_ref<const std::string&>();
+    if (type == "stream") {
+        return ExportType::Stream;
+    }
+    if (type == "service") {
+        return ExportType::Service;
+    }
+    throw std::invalid_argument("Unknown export type '" + type + "'");
+}
+
+bool verifySignature(const PublicKey& issuer_public_key,
                      const std::string& signing_input,
                      const std::string& signature_b64) {
+    JWT_PROBE(verify_signature__entry, signing_input.size(),
+              static_cast<int>(issuer_public_key.prefix()));
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] bool probe_cache_hit = false;
+    JWT_PROBE_ON_EXIT(probe_exit, verify_signature__return, probe_result, static_cast<int>(probe_cache_hit));
+
     try {
         // Decode the Base64 URL signature
         std::vector<std::uint8_t> signature_bytes = base64url_decode(signature_b64);
@@ -100,8 +317,13 @@ bool verifySignature(const std::string& issuer_public_key,
             );
         }
 
-        // Create public key from the issuer's public key string
-        auto public_key = nkeys::FromPublicKey(issuer_public_key);
+        // Create public key from the issuer's public key string (cached)
+        std::shared_ptr<const nkeys::KeyPair> public_key;
+        {
+            JWT_METRICS_STAGE(stage, KeyPreparation);
+            public_key = preparePublicKey(issuer_public_key, &probe_cache_hit);
+            JWT_METRICS_SUCCESS(stage);
+        }
 
         // Convert signing input to byte span
         std::span<const std::uint8_t> signing_bytes(
@@ -110,7 +332,13 @@ bool verifySignature(const std::string& issuer_public_key,
         );
 
         // Verify the signature (Ed25519 verification)
-        return public_key->verify(signing_bytes, signature_bytes);
+        JWT_METRICS_STAGE(stage, SignatureVerify);
+        bool valid = public_key->verify(signing_bytes, signature_bytes);
+        if (valid) {
+            JWT_METRICS_SUCCESS(stage);
+        }
+        probe_result = valid ? PROBE_OK : PROBE_INVALID;
+        return valid;
 
     } catch (const std::exception& e) {
         // Any error during verification means invalid signature
@@ -1,5 +1,14 @@
 #pragma once
 
+#include "jwt/connection_policy.hpp"
+#include "jwt/exports.hpp"
+#include "jwt/limits.hpp"
+#include "jwt/permissions.hpp"
+#include "jwt/public_key.hpp"
+#include "jwt/signer.hpp"
+#include "jwt/tags.hpp"
+#include <nlohmann/json.hpp>
+#include <mutex>
 #include <string>
 #include <cstdint>
 #include <vector>
@@ -19,12 +28,11 @@ std::int64_t getCurrentTimestamp();
 /// @return JSON string: {"typ":"JWT","alg":"ed25519-nkey"}
 std::string createHeader();
 
-/// Sign data with Ed25519 key and return signature bytes
-/// @param seed Ed25519 seed string (e.g., "SOABC...")
-/// @param data Data to sign
-/// @return 64-byte Ed25519 signature
-std::vector<std::uint8_t> signData(const std::string& seed,
-                                     std::span<const std::uint8_t> data);
+/// Assemble and sign a JWT around an encoded payload
+/// @param payload_json Serialized payload object
+/// @param signer Key to sign with
+/// @return "header.payload.signature" (the constant header is encoded once per process)
+std::string signJwt(std::string_view payload_json, const Signer& signer);
 
 /// Parsed JWT components
 struct JwtParts {
@@ -40,15 +48,120 @@ struct JwtParts {
 /// @throws std::invalid_argument if JWT format is invalid
 JwtParts parseJwt(std::string_view jwt);
 
+/// Decode and parse the JWT header, checking the signing algorithm
+/// @param parts Parsed JWT components
+/// @return Header JSON object
+/// @throws std::invalid_argument if the algorithm is not ed25519-nkey
+nlohmann::json decodeHeader(const JwtParts& parts);
+
+/// Decode and parse the JWT payload
+/// @param parts Parsed JWT components
+/// @return Payload JSON object
+/// @throws std::invalid_argument or nlohmann::json::exception if malformed
+nlohmann::json decodePayload(const JwtParts& parts);
+
+/// Move a string field out of a JSON object if present (out is left unchanged otherwise)
+/// @param object JSON object holding the field
+/// @param field Field name
+/// @param out String to overwrite
+void takeString(nlohmann::json& object, const char* field, std::string& out);
+
+/// Read an integer limit from a JSON object if present (out is left unchanged otherwise)
+/// @param object JSON object holding the limit
+/// @param field Field name
+/// @param out Limit to overwrite
+void readLimit(const nlohmann::json& object, const char* field, std::int64_t& out);
+
+/// Read "subs", "data" and "payload" from a JSON object; missing fields stay unlimited
+/// @param object JSON object ("limits" for accounts, "nats" for users)
+/// @param limits Limits to fill in place
+void readNatsLimits(const nlohmann::json& object, NatsLimits& limits);
+
+/// Write "subs", "data" and "payload" into a JSON object
+/// @param limits Limits to write
+/// @param object JSON object to add the fields to
+void writeNatsLimits(const NatsLimits& limits, nlohmann::json& object);
+
+/// Read "pub"/"sub" allow/deny lists from a JSON object, moving the strings out
+/// @param object The "nats" object of a user, or a signing key scope template
+/// @return Permissions (empty if neither list is present)
+Permissions readPermissions(nlohmann::json& object);
+
+/// Write non-empty "pub"/"sub" allow/deny lists into a JSON object
+/// @param permissions Permissions to write
+/// @param object JSON object to add the fields to
+void writePermissions(const Permissions& permissions, nlohmann::json& object);
+
+/// Read "src", "times", "times_location" and "allowed_connection_types", moving the strings out.
+/// "src" may also be a comma-separated string, as older issuers write it.
+/// @param object The "nats" object of a user
+/// @return Restrictions (empty if none are present)
+ConnectionRestrictions readConnectionRestrictions(nlohmann::json& object);
+
+/// Write non-empty connection restrictions into a JSON object
+/// @param restrictions Restrictions to write
+/// @param object JSON object to add the fields to
+void writeConnectionRestrictions(const ConnectionRestrictions& restrictions, nlohmann::json& object);
+
+/// Read the "tags" array of a NATS claims object, if present, without interning new tags
+/// @param nats The "nats" JSON object
+/// @return Tag set (empty if there are no tags)
+TagSet readTags(const nlohmann::json& nats);
+
+/// Write non-empty tags as a "tags" array into a NATS claims object
+/// @param tags Tags to write
+/// @param nats The "nats" JSON object
+void writeTags(const TagSet& tags, nlohmann::json& nats);
+
+/// JSON name of an export type ("stream" or "service")
+const char* exportTypeName(ExportType type);
+
+/// Read an export type from a JSON object; a missing field means a stream
+/// @param object JSON object holding the type
+/// @param field Field name ("type" for exports/imports, "kind" for activations)
+/// @throws std::invalid_argument for an unknown type
+ExportType readExportType(const nlohmann::json& object, const char* field);
+
 /// Verify JWT signature using Ed25519 public key
-/// @param issuer_public_key Public key string (e.g., "OABC..." or "AABC...")
+/// @param issuer_public_key Interned public key (e.g., "OABC..." or "AABC...")
 /// @param signing_input The "header.payload" string that was signed
 /// @param signature_b64 Base64 URL encoded signature
 /// @return true if signature is valid, false otherwise
 /// @throws std::invalid_argument if inputs are malformed
-bool verifySignature(const std::string& issuer_public_key,
+bool verifySignature(const PublicKey& issuer_public_key,
                      const std::string& signing_input,
                      const std::string& signature_b64);
 
-}
+/// Value derived from other members on first read and kept until invalidate().
+/// Reads may race with each other (the build runs under a lock); copies start
+/// unbuilt, so an owning Impl keeps its defaulted copy constructor.
+template <typename T>
+class LazyValue {
+public:
+    LazyValue() = default;
+    LazyValue(const LazyValue&) {}
+    LazyValue& operator=(const LazyValue&) {
+        invalidate();
+        return *this;
+    }
 
+    /// Rebuilt in place on the next get(), so earlier references stay valid
+    void invalidate() { built_ = false; }
+
+    template <typename Build>
+    const T& get(Build&& build) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!built_) {
+            value_ = build();
+            built_ = true;
+        }
+        return value_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    mutable T value_{};
+    mutable bool built_ = false;
+};
+
+}
@@ -0,0 +1,93 @@
+#include "key_cache.hpp"
+#include "jwt/key_cache.hpp"
+#include "lock_stats.hpp"
+#include "metrics_internal.hpp"
+#include <nkeys/nkeys.hpp>
+#include <mutex>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    struct KeyCache {
+        internal::InstrumentedMutex mutex{"key_cache"};
+        // Interned keys: lookups hash and compare without touching the string
+        std::unordered_map<PublicKey, std::shared_ptr<const nkeys::KeyPair>> entries;
+        std::size_t capacity = DEFAULT_KEY_CACHE_CAPACITY;
+        KeyCacheStats stats;
+    };
+
+    KeyCache& cache() {
+        static KeyCache instance;
+        return instance;
+    }
+}
+
+void setKeyCacheCapacity(std::size_t capacity) {
+    auto& c = cache();
+    std::lock_guard<internal::InstrumentedMutex> lock(c.mutex);
+    c.capacity = capacity;
+    while (c.entries.size() > capacity) {
+        c.entries.erase(c.entries.begin());
+        ++c.stats.evictions;
+    }
+}
+
+KeyCacheStats keyCacheStats() {
+    auto& c = cache();
+    std::lock_guard<internal::InstrumentedMutex> lock(c.mutex);
+    KeyCacheStats stats = c.stats;
+    stats.size = c.entries.size();
+    stats.capacity = c.capacity;
+    return stats;
+}
+
+void clearKeyCache() {
+    auto& c = cache();
+    std::lock_guard<internal::InstrumentedMutex> lock(c.mutex);
+    c.entries.clear();
+    c.stats = KeyCacheStats{};
+}
+
+namespace internal {
+
+std::shared_ptr<const nkeys::KeyPair> preparePublicKey(const PublicKey& public_key,
+                                                        bool* cache_hit) {
+    auto& c = cache();
+    {
+        std::lock_guard<internal::InstrumentedMutex> lock(c.mutex);
+        if (auto it = c.entries.find(public_key); it != c.entries.end()) {
+            ++c.stats.hits;
+            if (cache_hit) *cache_hit = true;
+            JWT_METRICS_EVENT(KeyCache, CacheHit);
+            return it->second;
+        }
+        ++c.stats.misses;
+    }
+    if (cache_hit) *cache_hit = false;
+    JWT_METRICS_EVENT(KeyCache, CacheMiss);
+
+    // Decode outside the lock; racing threads may both decode the same key
+    std::shared_ptr<const nkeys::KeyPair> key = nkeys::FromPublicKey(public_key.str());
+
+    std::lock_guard<internal::InstrumentedMutex> lock(c.mutex);
+    if (c.capacity == 0) {
+        return key;
+    }
+    if (c.entries.size() >= c.capacity) {
+        // Arbitrary victim: issuer sets are small and stable, so any policy works
+        c.entries.erase(c.entries.begin());
+        ++c.stats.evictions;
+    }
+    c.entries.emplace(public_key, key);
+    return key;
+}
+
+std::shared_ptr<const nkeys::KeyPair> preparePublicKey(std::string_view public_key,
+                                                        bool* cache_hit) {
+    return preparePublicKey(PublicKey(public_key), cache_hit);
+}
+
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "jwt/public_key.hpp"
+#include <memory>
+#include <string_view>
+
+namespace nkeys {
+class KeyPair;
+}
+
+namespace jwt::internal {
+
+/// Get a verifier for an interned public key, reusing a cached one if present
+/// @param public_key Interned public key (e.g., "OABC...")
+/// @param cache_hit Optional; set to whether the key came from the cache
+/// @return Shared, immutable key pair able to verify signatures
+/// @throws std::exception from nkeys if the key is malformed
+std::shared_ptr<const nkeys::KeyPair> preparePublicKey(const PublicKey& public_key,
+                                                        bool* cache_hit = nullptr);
+
+/// Get a verifier for an encoded public key (interns it first)
+std::shared_ptr<const nkeys::KeyPair> preparePublicKey(std::string_view public_key,
+                                                        bool* cache_hit = nullptr);
+
+}
@@ -0,0 +1,66 @@
+#include "lock_stats.hpp"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace jwt {
+
+namespace {
+    struct LockRegistry {
+        std::mutex mutex;
+        std::vector<internal::InstrumentedMutex*> locks;
+    };
+
+    // Intentionally leaked: locks in other statics may unregister during exit
+    LockRegistry& registry() {
+        static LockRegistry* instance = new LockRegistry();
+        return *instance;
+    }
+}
+
+namespace internal {
+
+InstrumentedMutex::InstrumentedMutex(const char* name) : name_(name) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.locks.push_back(this);
+}
+
+InstrumentedMutex::~InstrumentedMutex() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.locks.erase(std::remove(reg.locks.begin(), reg.locks.end(), this), reg.locks.end());
+}
+
+}
+
+std::vector<LockStats> lockStats() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<LockStats> stats;
+    stats.reserve(reg.locks.size());
+    for (const auto* m : reg.locks) {
+        // Sharded locks share a name and are reported as one
+        LockStats s = m->stats();
+        auto it = std::find_if(stats.begin(), stats.end(),
+                               [&](const LockStats& existing) { return existing.name == s.name; });
+        if (it == stats.end()) {
+            stats.push_back(std::move(s));
+            continue;
+        }
+        it->acquisitions += s.acquisitions;
+        it->contended += s.contended;
+        it->waitNanos += s.waitNanos;
+    }
+    return stats;
+}
+
+void resetLockStats() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto* m : reg.locks) {
+        m->reset();
+    }
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "jwt/lock_stats.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace jwt::internal {
+
+/**
+ * std::mutex that counts acquisitions, contended acquisitions and time
+ * spent waiting. Uncontended locking costs one extra try_lock attempt;
+ * counters are only written while the lock is held, so no atomic
+ * read-modify-write is needed. Registers itself for jwt::lockStats().
+ */
+class InstrumentedMutex {
+public:
+    explicit InstrumentedMutex(const char* name);
+    ~InstrumentedMutex();
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    void lock() {
+        if (mutex_.try_lock()) {
+            bump(acquisitions_);
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        mutex_.lock();
+        auto waited = std::chrono::steady_clock::now() - start;
+        bump(acquisitions_);
+        bump(contended_);
+        bump(waitNanos_, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count()));
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        bump(acquisitions_);
+        return true;
+    }
+
+    void unlock() { mutex_.unlock(); }
+
+    [[nodiscard]] LockStats stats() const {
+        return LockStats{name_,
+                         acquisitions_.load(std::memory_order_relaxed),
+                         contended_.load(std::memory_order_relaxed),
+                         waitNanos_.load(std::memory_order_relaxed)};
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        acquisitions_.store(0, std::memory_order_relaxed);
+        contended_.store(0, std::memory_order_relaxed);
+        waitNanos_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Only called with mutex_ held: a plain load + store suffices
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    const char* name_;
+    std::mutex mutex_;
+    std::atomic<std::uint64_t> acquisitions_{0};
+    std::atomic<std::uint64_t> contended_{0};
+    std::atomic<std::uint64_t> waitNanos_{0};
+};
+
+}
@@ -0,0 +1,257 @@
+#include "metrics_internal.hpp"
+#include "lock_stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <sstream>
+
+namespace jwt::metrics {
+
+namespace {
+    constexpr unsigned kSubBits = 3;
+    constexpr std::uint64_t kSubBuckets = 1ULL << kSubBits;
+
+    // Log-linear bucket index: exact below 16ns, then 8 sub-buckets per power of two
+    std::size_t bucketFor(std::uint64_t nanos) {
+        if (nanos < 2 * kSubBuckets) {
+            return static_cast<std::size_t>(nanos);
+        }
+        unsigned exponent = static_cast<unsigned>(std::bit_width(nanos)) - 1;
+        std::uint64_t sub = (nanos >> (exponent - kSubBits)) & (kSubBuckets - 1);
+        return static_cast<std::size_t>(2 * kSubBuckets + (exponent - kSubBits - 1) * kSubBuckets + sub);
+    }
+
+    /// Counters owned by one thread. Only the owner writes, any thread may read.
+    struct ThreadBlock {
+        std::array<std::array<std::atomic<std::uint64_t>, kBucketCount>, kStageCount> buckets{};
+        std::array<std::array<std::atomic<std::uint64_t>, kOutcomeCount>, kStageCount> outcomes{};
+        std::array<std::atomic<std::uint64_t>, kStageCount> totalNanos{};
+        std::array<std::atomic<std::uint64_t>, kStageCount> maxNanos{};
+    };
+
+    // Single-writer increment: no read-modify-write instruction needed
+    inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    void addInto(StageStats& out, const ThreadBlock& block, std::size_t stage) {
+        for (std::size_t o = 0; o < kOutcomeCount; ++o) {
+            out.outcomes[o] += block.outcomes[stage][o].load(std::memory_order_relaxed);
+        }
+        for (std::size_t b = 0; b < kBucketCount; ++b) {
+            auto n = block.buckets[stage][b].load(std::memory_order_relaxed);
+            out.buckets[b] += n;
+            out.count += n;
+        }
+        out.totalNanos += block.totalNanos[stage].load(std::memory_order_relaxed);
+        out.maxNanos = std::max(out.maxNanos, block.maxNanos[stage].load(std::memory_order_relaxed));
+    }
+
+    void clearBlock(ThreadBlock& block) {
+        for (std::size_t s = 0; s < kStageCount; ++s) {
+            for (auto& c : block.buckets[s]) c.store(0, std::memory_order_relaxed);
+            for (auto& c : block.outcomes[s]) c.store(0, std::memory_order_relaxed);
+            block.totalNanos[s].store(0, std::memory_order_relaxed);
+            block.maxNanos[s].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// All live thread blocks plus the totals of threads that have exited
+    struct Registry {
+        jwt::internal::InstrumentedMutex mutex{"metrics_registry"};
+        std::vector<ThreadBlock*> live;
+        Snapshot retired;
+        std::atomic<Observer*> observer{nullptr};
+    };
+
+    // Intentionally leaked: threads may record during static destruction
+    Registry& registry() {
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    /// Registers the thread's block on first use and folds it into the
+    /// retired totals when the thread exits
+    struct ThreadHandle {
+        ThreadBlock* block = nullptr;
+
+        ThreadBlock& get() {
+            if (block == nullptr) {
+                block = new ThreadBlock();
+                auto& reg = registry();
+                std::lock_guard<jwt::internal::InstrumentedMutex> lock(reg.mutex);
+                reg.live.push_back(block);
+            }
+            return *block;
+        }
+
+        ~ThreadHandle() {
+            if (block == nullptr) return;
+            auto& reg = registry();
+            std::lock_guard<jwt::internal::InstrumentedMutex> lock(reg.mutex);
+            for (std::size_t s = 0; s < kStageCount; ++s) {
+                addInto(reg.retired.stages[s], *block, s);
+            }
+            reg.live.erase(std::remove(reg.live.begin(), reg.live.end(), block), reg.live.end());
+            delete block;
+        }
+    };
+
+    thread_local ThreadHandle tl_handle;
+
+    // Prometheus label values are the stage/outcome names, which need no escaping
+    void writeSeconds(std::ostringstream& oss, std::uint64_t nanos) {
+        oss << static_cast<double>(nanos) / 1e9;
+    }
+}
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Split: return "split";
+        case Stage::HeaderDecode: return "header_decode";
+        case Stage::PayloadDecode: return "payload_decode";
+        case Stage::Parse: return "parse";
+        case Stage::KeyPreparation: return "key_preparation";
+        case Stage::SignatureVerify: return "signature_verify";
+        case Stage::Timing: return "timing";
+        case Stage::Hierarchy: return "hierarchy";
+        case Stage::KeyCache: return "key_cache";
+        default: return "unknown";
+    }
+}
+
+const char* outcomeName(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::Success: return "success";
+        case Outcome::Failure: return "failure";
+        case Outcome::CacheHit: return "hit";
+        case Outcome::CacheMiss: return "miss";
+        default: return "unknown";
+    }
+}
+
+std::uint64_t bucketLowerBound(std::size_t bucket) {
+    if (bucket < 2 * kSubBuckets) {
+        return bucket;
+    }
+    std::size_t rel = bucket - 2 * kSubBuckets;
+    unsigned exponent = static_cast<unsigned>(rel / kSubBuckets) + kSubBits + 1;
+    std::uint64_t sub = rel % kSubBuckets;
+    return (1ULL << exponent) + (sub << (exponent - kSubBits));
+}
+
+std::uint64_t StageStats::percentileNanos(double q) const {
+    if (count == 0) return 0;
+    q = std::clamp(q, 0.0, 1.0);
+    auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < buckets.size(); ++b) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            auto upper = b + 1 < kBucketCount ? bucketLowerBound(b + 1) - 1 : maxNanos;
+            return std::min(upper, maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+void setObserver(Observer* observer) {
+    registry().observer.store(observer, std::memory_order_release);
+}
+
+Snapshot snapshot() {
+    auto& reg = registry();
+    std::lock_guard<jwt::internal::InstrumentedMutex> lock(reg.mutex);
+    Snapshot snap = reg.retired;
+    for (const ThreadBlock* block : reg.live) {
+        for (std::size_t s = 0; s < kStageCount; ++s) {
+            addInto(snap.stages[s], *block, s);
+        }
+    }
+    return snap;
+}
+
+void reset() {
+    auto& reg = registry();
+    std::lock_guard<jwt::internal::InstrumentedMutex> lock(reg.mutex);
+    reg.retired = Snapshot{};
+    for (ThreadBlock* block : reg.live) {
+        clearBlock(*block);
+    }
+}
+
+std::string exportPrometheus(const Snapshot& snap) {
+    std::ostringstream oss;
+
+    oss << "# HELP jwt_stage_duration_seconds Time spent in each JWT processing stage\n";
+    oss << "# TYPE jwt_stage_duration_seconds summary\n";
+    for (std::size_t s = 0; s < kStageCount; ++s) {
+        const auto& st = snap.stages[s];
+        const char* name = stageName(static_cast<Stage>(s));
+        for (double q : {0.5, 0.9, 0.99}) {
+            oss << "jwt_stage_duration_seconds{stage=\"" << name << "\",quantile=\"" << q << "\"} ";
+            writeSeconds(oss, st.percentileNanos(q));
+            oss << "\n";
+        }
+        oss << "jwt_stage_duration_seconds_sum{stage=\"" << name << "\"} ";
+        writeSeconds(oss, st.totalNanos);
+        oss << "\n";
+        oss << "jwt_stage_duration_seconds_count{stage=\"" << name << "\"} " << st.count << "\n";
+    }
+
+    oss << "# HELP jwt_stage_outcomes_total Stage completions by outcome\n";
+    oss << "# TYPE jwt_stage_outcomes_total counter\n";
+    for (std::size_t s = 0; s < kStageCount; ++s) {
+        for (std::size_t o = 0; o < kOutcomeCount; ++o) {
+            auto n = snap.stages[s].outcomes[o];
+            if (n == 0) continue;
+            oss << "jwt_stage_outcomes_total{stage=\"" << stageName(static_cast<Stage>(s))
+                << "\",outcome=\"" << outcomeName(static_cast<Outcome>(o)) << "\"} " << n << "\n";
+        }
+    }
+
+    return oss.str();
+}
+
+namespace internal {
+
+void record(Stage stage, Outcome outcome, std::uint64_t nanos) noexcept {
+    auto s = static_cast<std::size_t>(stage);
+    ThreadBlock* block = nullptr;
+    try {
+        block = &tl_handle.get();
+    } catch (...) {
+        return;  // Out of memory registering the thread: drop the sample
+    }
+
+    bump(block->buckets[s][std::min(bucketFor(nanos), kBucketCount - 1)]);
+    bump(block->outcomes[s][static_cast<std::size_t>(outcome)]);
+    bump(block->totalNanos[s], nanos);
+    if (nanos > block->maxNanos[s].load(std::memory_order_relaxed)) {
+        block->maxNanos[s].store(nanos, std::memory_order_relaxed);
+    }
+
+    if (auto* observer = registry().observer.load(std::memory_order_acquire)) {
+        observer->onStage(stage, outcome, nanos);
+    }
+}
+
+void recordEvent(Stage stage, Outcome outcome) noexcept {
+    ThreadBlock* block = nullptr;
+    try {
+        block = &tl_handle.get();
+    } catch (...) {
+        return;
+    }
+
+    bump(block->outcomes[static_cast<std::size_t>(stage)][static_cast<std::size_t>(outcome)]);
+
+    if (auto* observer = registry().observer.load(std::memory_order_acquire)) {
+        observer->onStage(stage, outcome, 0);
+    }
+}
+
+}
+
+}
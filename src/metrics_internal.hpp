@@ -0,0 +1,56 @@
+#pragma once
+
+#include "jwt/metrics.hpp"
+#include <chrono>
+
+namespace jwt::metrics::internal {
+
+/// Record one stage event on the calling thread's histograms
+void record(Stage stage, Outcome outcome, std::uint64_t nanos) noexcept;
+
+/// Record an outcome without a timing sample (e.g. cache hit/miss)
+void recordEvent(Stage stage, Outcome outcome) noexcept;
+
+/**
+ * Times a scope and records it as a failure unless success() was called,
+ * so stages left through an exception are counted correctly.
+ */
+class StageTimer {
+public:
+    explicit StageTimer(Stage stage) noexcept
+        : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    ~StageTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        record(stage_, outcome_, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    void success() noexcept { outcome_ = Outcome::Success; }
+    void outcome(Outcome o) noexcept { outcome_ = o; }
+
+private:
+    Stage stage_;
+    Outcome outcome_ = Outcome::Failure;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}
+
+// Instrumentation macros: expand to nothing unless built with JWT_ENABLE_METRICS
+#if defined(JWT_ENABLE_METRICS)
+#define JWT_METRICS_STAGE(var, stage) \
+    ::jwt::metrics::internal::StageTimer var(::jwt::metrics::Stage::stage)
+#define JWT_METRICS_SUCCESS(var) var.success()
+#define JWT_METRICS_OUTCOME(var, result) var.outcome(::jwt::metrics::Outcome::result)
+#define JWT_METRICS_EVENT(stage, result) \
+    ::jwt::metrics::internal::recordEvent(::jwt::metrics::Stage::stage, ::jwt::metrics::Outcome::result)
+#else
+#define JWT_METRICS_STAGE(var, stage) ((void)0)
+#define JWT_METRICS_SUCCESS(var) ((void)0)
+#define JWT_METRICS_OUTCOME(var, result) ((void)0)
+#define JWT_METRICS_EVENT(stage, result) ((void)0)
+#endif
@@ -0,0 +1,169 @@
+#include "nkey_codec.hpp"
+#include <algorithm>
+
+namespace jwt::internal {
+
+namespace {
+    constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+    /// Character -> 5-bit value; 0xFF marks characters outside the alphabet
+    constexpr std::array<std::uint8_t, 256> kDecodeTable = [] {
+        std::array<std::uint8_t, 256> table{};
+        table.fill(0xFF);
+        for (std::uint8_t i = 0; i < 32; ++i) {
+            table[static_cast<std::uint8_t>(kAlphabet[i])] = i;
+        }
+        return table;
+    }();
+
+    /// CRC16/XMODEM lookup, one entry per byte value
+    constexpr std::array<std::uint16_t, 256> kCrcTable = [] {
+        std::array<std::uint16_t, 256> table{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t crc = i << 8;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+            }
+            table[i] = static_cast<std::uint16_t>(crc);
+        }
+        return table;
+    }();
+
+    /// nkeys prefix bytes accepted for public keys (operator, account, user, server, cluster, curve)
+    constexpr std::array<bool, 256> kPublicPrefix = [] {
+        std::array<bool, 256> table{};
+        for (std::uint8_t prefix : {14 << 3, 0, 20 << 3, 13 << 3, 2 << 3, 23 << 3}) {
+            table[prefix] = true;
+        }
+        return table;
+    }();
+
+    constexpr std::size_t kRawEncodedSize = 1 + RAW_PUBLIC_KEY_SIZE + 2;  // prefix + key + CRC16
+
+    /// Decode one 8-character block into 5 bytes without data-dependent branches
+    /// @return Non-zero if any character was outside the alphabet
+    inline std::uint8_t decodeBlock(const char* in, std::uint8_t* out) {
+        std::uint64_t bits = 0;
+        std::uint8_t invalid = 0;
+        for (int i = 0; i < 8; ++i) {
+            std::uint8_t value = kDecodeTable[static_cast<std::uint8_t>(in[i])];
+            invalid |= value;
+            bits = (bits << 5) | (value & 31);
+        }
+        for (int i = 0; i < 5; ++i) {
+            out[i] = static_cast<std::uint8_t>(bits >> (32 - 8 * i));
+        }
+        return invalid & 0xE0;
+    }
+
+    inline std::uint16_t crcStep(std::uint16_t crc, std::uint8_t byte) {
+        return static_cast<std::uint16_t>((crc << 8) ^ kCrcTable[((crc >> 8) ^ byte) & 0xFF]);
+    }
+
+    /// Base32-decode a 56-character key into prefix + key + CRC bytes
+    inline bool decodeRaw(std::string_view encoded, std::array<std::uint8_t, kRawEncodedSize>& raw) {
+        if (encoded.size() != ENCODED_PUBLIC_KEY_SIZE) {
+            return false;
+        }
+        std::uint8_t invalid = 0;
+        for (std::size_t block = 0; block < ENCODED_PUBLIC_KEY_SIZE / 8; ++block) {
+            invalid |= decodeBlock(encoded.data() + block * 8, raw.data() + block * 5);
+        }
+        return invalid == 0;
+    }
+
+    inline bool finishKey(const std::array<std::uint8_t, kRawEncodedSize>& raw, std::uint16_t crc,
+                          DecodedPublicKey& out) {
+        std::uint16_t expected = static_cast<std::uint16_t>(raw[33] | (raw[34] << 8));
+        if (!kPublicPrefix[raw[0]] || crc != expected) {
+            return false;
+        }
+        out.prefix = raw[0];
+        std::copy(raw.begin() + 1, raw.begin() + 1 + RAW_PUBLIC_KEY_SIZE, out.key.begin());
+        return true;
+    }
+}
+
+std::uint16_t crc16(std::span<const std::uint8_t> data) {
+    std::uint16_t crc = 0;
+    for (std::uint8_t byte : data) {
+        crc = crcStep(crc, byte);
+    }
+    return crc;
+}
+
+std::string base32Encode(std::span<const std::uint8_t> data) {
+    std::string out;
+    out.reserve((data.size() * 8 + 4) / 5);
+    std::uint32_t buffer = 0;
+    int bits = 0;
+    for (std::uint8_t byte : data) {
+        buffer = (buffer << 8) | byte;
+        bits += 8;
+        while (bits >= 5) {
+            out.push_back(kAlphabet[(buffer >> (bits - 5)) & 31]);
+            bits -= 5;
+        }
+    }
+    if (bits > 0) {
+        out.push_back(kAlphabet[(buffer << (5 - bits)) & 31]);
+    }
+    return out;
+}
+
+bool base32Decode(std::string_view in, std::span<std::uint8_t> out) {
+    if (in.size() % 8 != 0 || out.size() != in.size() / 8 * 5) {
+        return false;
+    }
+    std::uint8_t invalid = 0;
+    for (std::size_t block = 0; block < in.size() / 8; ++block) {
+        invalid |= decodeBlock(in.data() + block * 8, out.data() + block * 5);
+    }
+    return invalid == 0;
+}
+
+bool decodePublicKey(std::string_view encoded, DecodedPublicKey& out) {
+    std::array<std::uint8_t, kRawEncodedSize> raw;
+    if (!decodeRaw(encoded, raw)) {
+        return false;
+    }
+    std::uint16_t crc = 0;
+    for (std::size_t i = 0; i < 1 + RAW_PUBLIC_KEY_SIZE; ++i) {
+        crc = crcStep(crc, raw[i]);
+    }
+    return finishKey(raw, crc, out);
+}
+
+std::size_t decodePublicKeys(std::span<const std::string_view> encoded, std::span<DecodedPublicKey> out,
+                             std::span<bool> ok) {
+    constexpr std::size_t kLanes = 4;
+    std::size_t valid = 0;
+    std::size_t i = 0;
+
+    // Four keys at a time: the CRC is a serial dependency chain per key, so
+    // interleaving independent keys keeps the table lookups overlapped
+    for (; i + kLanes <= encoded.size(); i += kLanes) {
+        std::array<std::array<std::uint8_t, kRawEncodedSize>, kLanes> raw{};
+        std::array<bool, kLanes> decoded{};
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            decoded[lane] = decodeRaw(encoded[i + lane], raw[lane]);
+        }
+        std::array<std::uint16_t, kLanes> crc{};
+        for (std::size_t byte = 0; byte < 1 + RAW_PUBLIC_KEY_SIZE; ++byte) {
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                crc[lane] = crcStep(crc[lane], raw[lane][byte]);
+            }
+        }
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            ok[i + lane] = decoded[lane] && finishKey(raw[lane], crc[lane], out[i + lane]);
+            valid += ok[i + lane];
+        }
+    }
+    for (; i < encoded.size(); ++i) {
+        ok[i] = decodePublicKey(encoded[i], out[i]);
+        valid += ok[i];
+    }
+    return valid;
+}
+
+}
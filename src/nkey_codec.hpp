@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace jwt::internal {
+
+/// Length of an encoded public nkey: base32 of prefix byte + 32-byte key + CRC16
+inline constexpr std::size_t ENCODED_PUBLIC_KEY_SIZE = 56;
+
+/// Length of a raw Ed25519 public key
+inline constexpr std::size_t RAW_PUBLIC_KEY_SIZE = 32;
+
+/// Public key decoded from its nkey string form
+struct DecodedPublicKey {
+    std::uint8_t prefix = 0;  // nkeys prefix byte (e.g., 20 << 3 for users)
+    std::array<std::uint8_t, RAW_PUBLIC_KEY_SIZE> key{};
+};
+
+/// CRC16/XMODEM as used by nkeys (polynomial 0x1021, initial value 0)
+/// @param data Bytes to checksum
+/// @return Checksum
+std::uint16_t crc16(std::span<const std::uint8_t> data);
+
+/// Encode bytes as unpadded base32 (RFC 4648 alphabet)
+/// @param data Bytes to encode
+/// @return Base32 string
+std::string base32Encode(std::span<const std::uint8_t> data);
+
+/// Decode unpadded base32 (RFC 4648 alphabet)
+/// @param in Base32 characters; in.size() must be a multiple of 8
+/// @param out Receives in.size() / 8 * 5 bytes
+/// @return false if a character is outside the alphabet or sizes disagree
+bool base32Decode(std::string_view in, std::span<std::uint8_t> out);
+
+/// Decode a public nkey, checking its length, type prefix and checksum
+/// @param encoded Encoded public key (e.g., "UABC...")
+/// @param out Receives the prefix byte and raw key
+/// @return false if the key is malformed
+bool decodePublicKey(std::string_view encoded, DecodedPublicKey& out);
+
+/// Decode and checksum many public keys at once (e.g., all signing keys of an account)
+/// @param encoded Encoded public keys
+/// @param out Receives one decoded key per input; entries for malformed keys are left untouched
+/// @param ok Receives whether each key is well-formed
+/// @return Number of well-formed keys
+std::size_t decodePublicKeys(std::span<const std::string_view> encoded, std::span<DecodedPublicKey> out,
+                             std::span<bool> ok);
+
+}
@@ -2,6 +2,7 @@
 #include "jwt/jwt_constants.hpp"
 #include "base64url.hpp"
 #include "jwt_utils.hpp"
+#include "probes.hpp"
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 
@@ -9,41 +10,91 @@ namespace jwt {
 
 class OperatorClaims::Impl {
 public:
-    std::string subject_;
-    std::string issuer_;
+    PublicKey subject_;
+    PublicKey issuer_;
     std::optional<std::string> name_;
     std::int64_t issuedAt_ = 0;
     std::int64_t expires_ = 0;
-    std::vector<std::string> signingKeys_;
+    TagSet tags_;
+    std::vector<PublicKey> signingKeys_;
+    internal::LazyValue<std::vector<std::string>> signingKeyStrings_;
 };
 
-OperatorClaims::OperatorClaims(const std::string& operatorPublicKey)
+OperatorClaims::OperatorClaims(std::string_view operatorPublicKey)
     : impl_(std::make_unique<Impl>()) {
-    impl_->subject_ = operatorPublicKey;
-    impl_->issuer_ = operatorPublicKey;  // Self-signed
+    impl_->subject_ = PublicKey(operatorPublicKey);
+    impl_->issuer_ = impl_->subject_;  // Self-signed
 }
 
 OperatorClaims::~OperatorClaims() = default;
+OperatorClaims::OperatorClaims(const OperatorClaims& other) : impl_(std::make_unique<Impl>(*other.impl_)) {}
+OperatorClaims::OperatorClaims(OperatorClaims&& other) noexcept = default;
+OperatorClaims& OperatorClaims::operator=(const OperatorClaims& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<Impl>(*other.impl_);
+    }
+    return *this;
+}
+OperatorClaims& OperatorClaims::operator=(OperatorClaims&& other) noexcept = default;
 
-std::string OperatorClaims::subject() const { return impl_->subject_; }
-std::string OperatorClaims::issuer() const { return impl_->issuer_; }
+std::string OperatorClaims::subject() const { return impl_->subject_.str(); }
+std::string OperatorClaims::issuer() const { return impl_->issuer_.str(); }
+const PublicKey& OperatorClaims::subjectKey() const { return impl_->subject_; }
+const PublicKey& OperatorClaims::issuerKey() const { return impl_->issuer_; }
 std::optional<std::string> OperatorClaims::name() const { return impl_->name_; }
 std::int64_t OperatorClaims::issuedAt() const { return impl_->issuedAt_; }
 std::int64_t OperatorClaims::expires() const { return impl_->expires_; }
+const TagSet& OperatorClaims::tags() const { return impl_->tags_; }
 
-void OperatorClaims::setName(const std::string& name) { impl_->name_ = name; }
+void OperatorClaims::setName(std::string name) { impl_->name_ = std::move(name); }
 void OperatorClaims::setExpires(std::int64_t exp) { impl_->expires_ = exp; }
-void OperatorClaims::addSigningKey(const std::string& publicKey) {
-    impl_->signingKeys_.push_back(publicKey);
+void OperatorClaims::setTags(TagSet tags) { impl_->tags_ = std::move(tags); }
+void OperatorClaims::addTag(std::string_view tag) { impl_->tags_.add(tag); }
+void OperatorClaims::addSigningKey(std::string_view publicKey) {
+    impl_->signingKeys_.emplace_back(publicKey);
+    impl_->signingKeyStrings_.invalidate();
+}
+void OperatorClaims::addSigningKey(PublicKey publicKey) {
+    impl_->signingKeys_.push_back(std::move(publicKey));
+    impl_->signingKeyStrings_.invalidate();
+}
+void OperatorClaims::setSigningKeys(std::vector<std::string>&& publicKeys) {
+    std::vector<std::string_view> encoded(publicKeys.begin(), publicKeys.end());
+    impl_->signingKeys_ = PublicKey::internAll(encoded);
+    impl_->signingKeyStrings_.invalidate();
+    publicKeys.clear();
+}
+void OperatorClaims::setSigningKeys(std::vector<PublicKey> publicKeys) {
+    impl_->signingKeys_ = std::move(publicKeys);
+    impl_->signingKeyStrings_.invalidate();
 }
 const std::vector<std::string>& OperatorClaims::signingKeys() const {
+    return impl_->signingKeyStrings_.get([this]() {
+        std::vector<std::string> keys;
+        keys.reserve(impl_->signingKeys_.size());
+        for (const auto& key : impl_->signingKeys_) {
+            keys.push_back(key.str());
+        }
+        return keys;
+    });
+}
+const std::vector<PublicKey>& OperatorClaims::signingKeyHandles() const {
     return impl_->signingKeys_;
 }
 
 std::string OperatorClaims::encode(const std::string& seed) const {
+    return encode(Signer(seed));
+}
+
+std::string OperatorClaims::encode(const Signer& signer) const {
     using namespace internal;
     using json = nlohmann::json;
 
+    JWT_PROBE(encode__entry, PROBE_OPERATOR);
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] std::size_t probe_token_len = 0;
+    JWT_PROBE_ON_EXIT(probe_exit, encode__return, PROBE_OPERATOR, probe_result, probe_token_len);
+
     validate();
 
     // Auto-generate JTI and issuedAt
@@ -54,8 +105,8 @@ std::string OperatorClaims::encode(const std::string& seed) const {
     json payload = {
         {"jti", jti},
         {"iat", iat},
-        {"iss", impl_->issuer_},
-        {"sub", impl_->subject_}
+        {"iss", impl_->issuer_.str()},
+        {"sub", impl_->subject_.str()}
     };
 
     if (impl_->name_) {
@@ -71,38 +122,19 @@ std::string OperatorClaims::encode(const std::string& seed) const {
         {"version", JWT_VERSION}
     };
     if (!impl_->signingKeys_.empty()) {
-        nats_claims["signing_keys"] = impl_->signingKeys_;
+        json signing_keys = json::array();
+        for (const auto& key : impl_->signingKeys_) {
+            signing_keys.push_back(key.str());
+        }
+        nats_claims["signing_keys"] = std::move(signing_keys);
     }
+    writeTags(impl_->tags_, nats_claims);
     payload["nats"] = nats_claims;
 
-    // Create JWT: header.payload.signature
-    std::string header_json = createHeader();
-    std::string payload_json = payload.dump();
-
-    // Convert strings to byte spans for encoding
-    std::span<const std::uint8_t> header_bytes(
-        reinterpret_cast<const std::uint8_t*>(header_json.data()),
-        header_json.size()
-    );
-    std::span<const std::uint8_t> payload_bytes(
-        reinterpret_cast<const std::uint8_t*>(payload_json.data()),
-        payload_json.size()
-    );
-
-    std::string header_b64 = base64url_encode(header_bytes);
-    std::string payload_b64 = base64url_encode(payload_bytes);
-
-    // Sign "header.payload"
-    std::string signing_input = header_b64 + "." + payload_b64;
-    std::span<const std::uint8_t> signing_bytes(
-        reinterpret_cast<const std::uint8_t*>(signing_input.data()),
-        signing_input.size()
-    );
-
-    auto signature_bytes = signData(seed, signing_bytes);
-    std::string signature_b64 = base64url_encode(signature_bytes);
-
-    return signing_input + "." + signature_b64;
+    std::string token = signJwt(payload.dump(), signer);
+    probe_result = PROBE_OK;
+    probe_token_len = token.size();
+    return token;
 }
 
 void OperatorClaims::validate() const {
@@ -112,7 +144,7 @@ void OperatorClaims::validate() const {
     if (impl_->issuer_.empty()) {
         throw std::invalid_argument("Operator issuer cannot be empty");
     }
-    if (impl_->subject_[0] != 'O') {
+    if (impl_->subject_.prefix() != 'O') {
         throw std::invalid_argument("Operator subject must start with 'O'");
     }
     if (impl_->expires_ > 0 && impl_->issuedAt_ > 0 &&
@@ -123,32 +155,25 @@ void OperatorClaims::validate() const {
 
 std::unique_ptr<OperatorClaims> decodeOperatorClaims(const std::string& jwt) {
     using namespace internal;
-    using json = nlohmann::json;
+
+    JWT_PROBE(decode__entry, jwt.size(), PROBE_OPERATOR);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_OPERATOR, probe_result);
 
     // Parse JWT into its three components
     auto parts = parseJwt(jwt);
 
     // Decode and validate header
-    auto header_bytes = base64url_decode(parts.header_b64);
-    std::string header_json(header_bytes.begin(), header_bytes.end());
-    auto header = json::parse(header_json);
-
-    if (!header.contains("alg") || header["alg"] != JWT_ALGORITHM) {
-        throw std::invalid_argument(
-            "Unsupported algorithm: expected '" + std::string(JWT_ALGORITHM) + "'"
-        );
-    }
+    decodeHeader(parts);
 
     // Decode and parse payload
-    auto payload_bytes = base64url_decode(parts.payload_b64);
-    std::string payload_json(payload_bytes.begin(), payload_bytes.end());
-    auto payload = json::parse(payload_json);
+    auto payload = decodePayload(parts);
 
     // Validate NATS-specific claims
     if (!payload.contains("nats")) {
         throw std::invalid_argument("Missing 'nats' object in JWT payload");
     }
-    auto nats = payload["nats"];
+    auto& nats = payload["nats"];
 
     if (!nats.contains("type") || nats["type"] != "operator") {
         throw std::invalid_argument(
@@ -164,20 +189,20 @@ std::unique_ptr<OperatorClaims> decodeOperatorClaims(const std::string& jwt) {
     }
 
     // Extract required fields
-    std::string subject = payload.at("sub").get<std::string>();
-    std::string issuer = payload.at("iss").get<std::string>();
+    const auto& subject = payload.at("sub").get_ref<const std::string&>();
+    const auto& issuer = payload.at("iss").get_ref<const std::string&>();
     std::int64_t iat = payload.at("iat").get<std::int64_t>();
 
     // Create OperatorClaims object
     auto claims = std::make_unique<OperatorClaims>(subject);
 
     // Populate required fields (direct access via friend declaration)
-    claims->impl_->issuer_ = issuer;
+    claims->impl_->issuer_ = PublicKey(issuer);
     claims->impl_->issuedAt_ = iat;
 
     // Populate optional fields
     if (payload.contains("name")) {
-        claims->setName(payload["name"].get<std::string>());
+        claims->setName(std::move(payload["name"].get_ref<std::string&>()));
     }
 
     if (payload.contains("exp")) {
@@ -186,14 +211,23 @@ std::unique_ptr<OperatorClaims> decodeOperatorClaims(const std::string& jwt) {
 
     // Extract signing keys if present
     if (nats.contains("signing_keys") && nats["signing_keys"].is_array()) {
-        for (const auto& key : nats["signing_keys"]) {
-            claims->addSigningKey(key.get<std::string>());
+        const auto& keys = nats["signing_keys"];
+        std::vector<std::string_view> encoded;
+        encoded.reserve(keys.size());
+        for (const auto& key : keys) {
+            encoded.push_back(key.get_ref<const std::string&>());
         }
+        // Interned together so new keys are decoded and checksummed as a batch
+        claims->impl_->signingKeys_ = PublicKey::internAll(encoded);
     }
 
+    // Tags become interned IDs
+    claims->impl_->tags_ = readTags(nats);
+
     // Validate the decoded claims
     claims->validate();
 
+    probe_result = PROBE_OK;
     return claims;
 }
 
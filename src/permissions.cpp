@@ -0,0 +1,274 @@
+#include "jwt/permissions.hpp"
+#include "subject.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    using internal::StringHash;
+    using internal::nextToken;
+
+    constexpr std::uint32_t kNone = UINT32_MAX;
+
+    enum Flags : std::uint8_t {
+        ALLOW_END = 1,   // An allow pattern ends here
+        DENY_END = 2,    // A deny pattern ends here
+        ALLOW_TAIL = 4,  // An allow pattern continues with '>' here
+        DENY_TAIL = 8,   // A deny pattern continues with '>' here
+    };
+
+    /// Pattern trie node
+    struct Node {
+        std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> literal;
+        std::uint32_t star = kNone;
+        std::uint8_t flags = 0;
+    };
+
+    void addPattern(std::vector<Node>& nodes, std::string_view pattern, bool deny) {
+        if (pattern.empty()) {
+            throw std::invalid_argument("Subject pattern cannot be empty");
+        }
+        std::uint32_t current = 0;
+        std::size_t pos = 0;
+        while (true) {
+            auto [token, last] = nextToken(pattern, pos);
+            if (token.empty()) {
+                throw std::invalid_argument("Empty token in subject pattern '" + std::string(pattern) + "'");
+            }
+            if (token == ">") {
+                if (!last) {
+                    throw std::invalid_argument("'>' must be the last token in subject pattern '" +
+                                                std::string(pattern) + "'");
+                }
+                nodes[current].flags |= deny ? DENY_TAIL : ALLOW_TAIL;
+                return;
+            }
+
+            std::uint32_t next;
+            if (token == "*") {
+                if (nodes[current].star == kNone) {
+                    nodes[current].star = static_cast<std::uint32_t>(nodes.size());
+                    nodes.emplace_back();
+                }
+                next = nodes[current].star;
+            } else if (auto it = nodes[current].literal.find(token); it != nodes[current].literal.end()) {
+                next = it->second;
+            } else {
+                next = static_cast<std::uint32_t>(nodes.size());
+                nodes.emplace_back();
+                nodes[current].literal.emplace(std::string(token), next);
+            }
+            current = next;
+
+            if (last) {
+                nodes[current].flags |= deny ? DENY_END : ALLOW_END;
+                return;
+            }
+        }
+    }
+}
+
+class PermissionMatcher::Impl {
+public:
+    struct State {
+        std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> edges;
+        std::uint32_t other = kNone;  // Target for tokens without a literal edge
+        std::uint8_t flags = 0;
+    };
+
+    std::vector<Node> nodes;    // Pattern trie; nodes[0] is the root
+    std::vector<State> states;  // Deterministic automaton, states[0] the start; empty if too costly
+    bool hasAllow = false;
+
+    /// Subset construction, abandoned once it costs more than budget steps
+    bool determinize(std::size_t budget);
+
+    /// Flags of the pattern ends and '>' tails a subject reaches, or false if malformed
+    bool walkStates(std::string_view subject, std::uint8_t& tails, std::uint8_t& end) const;
+    bool walkTrie(std::string_view subject, std::uint8_t& tails, std::uint8_t& end) const;
+};
+
+bool PermissionMatcher::Impl::determinize(std::size_t budget) {
+    std::map<std::vector<std::uint32_t>, std::uint32_t> ids;
+    std::vector<std::vector<std::uint32_t>> sets;
+    std::vector<std::uint32_t> pending;
+    std::size_t work = 0;
+
+    auto stateFor = [&](std::vector<std::uint32_t> set) -> std::uint32_t {
+        if (set.empty()) {
+            return kNone;
+        }
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+        if (auto it = ids.find(set); it != ids.end()) {
+            return it->second;
+        }
+        auto id = static_cast<std::uint32_t>(states.size());
+        states.emplace_back();
+        for (std::uint32_t node : set) {
+            states[id].flags |= nodes[node].flags;
+        }
+        ids.emplace(set, id);
+        sets.push_back(std::move(set));
+        pending.push_back(id);
+        return id;
+    };
+
+    stateFor({0});
+    while (!pending.empty()) {
+        std::uint32_t id = pending.back();
+        pending.pop_back();
+        std::vector<std::uint32_t> set = sets[id];
+
+        std::vector<std::uint32_t> starTargets;
+        std::map<std::string_view, std::vector<std::uint32_t>> byToken;
+        for (std::uint32_t node : set) {
+            if (nodes[node].star != kNone) {
+                starTargets.push_back(nodes[node].star);
+            }
+            for (const auto& [token, child] : nodes[node].literal) {
+                byToken[token].push_back(child);
+            }
+            work += 1 + nodes[node].literal.size();
+        }
+
+        // A literal token follows both its literal edges and every '*' edge
+        for (auto& [token, targets] : byToken) {
+            work += targets.size() + starTargets.size();
+            if (work > budget) {
+                break;
+            }
+            targets.insert(targets.end(), starTargets.begin(), starTargets.end());
+            std::uint32_t target = stateFor(std::move(targets));
+            states[id].edges.emplace(std::string(token), target);
+        }
+        std::uint32_t other = stateFor(std::move(starTargets));
+        states[id].other = other;
+
+        if (work > budget) {
+            states.clear();
+            states.shrink_to_fit();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PermissionMatcher::Impl::walkStates(std::string_view subject, std::uint8_t& tails, std::uint8_t& end) const {
+    std::uint32_t state = 0;
+    std::size_t pos = 0;
+    bool last = false;
+    while (!last) {
+        auto [token, isLast] = nextToken(subject, pos);
+        last = isLast;
+        if (token.empty() || (token == ">" && !last)) {
+            return false;
+        }
+        if (state == kNone) {
+            continue;  // No pattern left to follow; just validate the rest
+        }
+
+        // A '>' pattern at this state covers this token and everything after it
+        const auto& current = states[state];
+        tails |= current.flags & (ALLOW_TAIL | DENY_TAIL);
+        if (token == ">") {
+            state = kNone;  // Only a '>' pattern covers a '>' subject token
+            continue;
+        }
+        auto it = current.edges.find(token);
+        state = it != current.edges.end() ? it->second : current.other;
+    }
+    end = state != kNone ? states[state].flags : 0;
+    return true;
+}
+
+bool PermissionMatcher::Impl::walkTrie(std::string_view subject, std::uint8_t& tails, std::uint8_t& end) const {
+    // Trie nodes have one path from the root, so the live set never repeats a node
+    thread_local std::vector<std::uint32_t> current;
+    thread_local std::vector<std::uint32_t> next;
+    current.assign(1, 0);
+    std::size_t pos = 0;
+    bool last = false;
+    while (!last) {
+        auto [token, isLast] = nextToken(subject, pos);
+        last = isLast;
+        if (token.empty() || (token == ">" && !last)) {
+            return false;
+        }
+        next.clear();
+        for (std::uint32_t node : current) {
+            tails |= nodes[node].flags & (ALLOW_TAIL | DENY_TAIL);
+            if (token == ">") {
+                continue;
+            }
+            if (token != "*") {
+                if (auto it = nodes[node].literal.find(token); it != nodes[node].literal.end()) {
+                    next.push_back(it->second);
+                }
+            }
+            if (nodes[node].star != kNone) {
+                next.push_back(nodes[node].star);
+            }
+        }
+        current.swap(next);
+    }
+    end = 0;
+    for (std::uint32_t node : current) {
+        end |= nodes[node].flags;
+    }
+    return true;
+}
+
+PermissionMatcher::PermissionMatcher(const Permission& permission) {
+    if (permission.empty()) {
+        return;
+    }
+
+    auto impl = std::make_shared<Impl>();
+    impl->hasAllow = !permission.allow.empty();
+    impl->nodes.resize(1);
+    for (const auto& pattern : permission.allow) {
+        addPattern(impl->nodes, pattern, false);
+    }
+    for (const auto& pattern : permission.deny) {
+        addPattern(impl->nodes, pattern, true);
+    }
+
+    // Keep the automaton only while building it stays linear in the trie
+    impl->determinize(DETERMINIZE_BUDGET * (impl->nodes.size() + 4096));
+    impl_ = std::move(impl);
+}
+
+bool PermissionMatcher::allows(std::string_view subject) const {
+    if (!impl_) {
+        return true;
+    }
+    if (subject.empty()) {
+        return false;
+    }
+
+    std::uint8_t tails = 0;
+    std::uint8_t end = 0;
+    bool wellFormed = impl_->states.empty() ? impl_->walkTrie(subject, tails, end)
+                                            : impl_->walkStates(subject, tails, end);
+    if (!wellFormed) {
+        return false;
+    }
+    bool allowed = !impl_->hasAllow || (tails & ALLOW_TAIL) || (end & ALLOW_END);
+    bool denied = (tails & DENY_TAIL) || (end & DENY_END);
+    return allowed && !denied;
+}
+
+bool PermissionMatcher::isDeterministic() const {
+    return !impl_ || !impl_->states.empty();
+}
+
+std::size_t PermissionMatcher::stateCount() const {
+    return impl_ ? impl_->states.size() : 0;
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Linux SDT (USDT) probes, provider "jwt". Built in with -DJWT_ENABLE_USDT=ON
+// (requires <sys/sdt.h>); each probe site is a single NOP until a tracer
+// attaches. Probe names and arguments:
+//
+//   decode__entry            (token_len, claim_type)
+//   decode__return           (claim_type, result)
+//   verify_signature__entry  (signing_input_len, issuer_prefix)
+//   verify_signature__return (result, cache_hit)
+//   validate__entry          (token_len)            token_len is 0 for decoded claims
+//   validate__return         (result)
+//   validate_chain__entry    (chain_len)
+//   validate_chain__return   (result, failed_index) failed_index is -1 on success
+//   encode__entry            (claim_type)
+//   encode__return           (claim_type, result, token_len)
+//
+// claim_type: ProbeClaimType below. result: 0 = ok, 1 = invalid, 2 = error.
+//
+// Example: bpftrace -e 'usdt:./my-server:jwt:verify_signature__return
+//                       { @[arg0, arg1] = count(); }'
+
+#include <utility>
+
+namespace jwt::internal {
+
+enum ProbeClaimType : int {
+    PROBE_ANY = 0,
+    PROBE_OPERATOR = 1,
+    PROBE_ACCOUNT = 2,
+    PROBE_USER = 3,
+    PROBE_ACTIVATION = 4,
+    PROBE_AUTH_REQUEST = 5,
+    PROBE_AUTH_RESPONSE = 6,
+};
+
+enum ProbeResult : int {
+    PROBE_OK = 0,
+    PROBE_INVALID = 1,
+    PROBE_ERROR = 2,
+};
+
+/// Runs a callable when the enclosing scope exits (including by exception)
+template <typename F>
+class OnScopeExit {
+public:
+    explicit OnScopeExit(F fn) : fn_(std::move(fn)) {}
+    OnScopeExit(const OnScopeExit&) = delete;
+    OnScopeExit& operator=(const OnScopeExit&) = delete;
+    ~OnScopeExit() { fn_(); }
+
+private:
+    F fn_;
+};
+
+}
+
+// Holds the result reported by a return probe; starts as PROBE_ERROR so that
+// exceptions are reported as errors
+#define JWT_PROBE_RESULT(var) [[maybe_unused]] int var = ::jwt::internal::PROBE_ERROR
+
+#if defined(JWT_ENABLE_USDT)
+#include <sys/sdt.h>
+#define JWT_PROBE(name, ...) STAP_PROBEV(jwt, name, __VA_ARGS__)
+#define JWT_PROBE_ON_EXIT(var, name, ...) \
+    ::jwt::internal::OnScopeExit var([&]() { JWT_PROBE(name, __VA_ARGS__); })
+#else
+#define JWT_PROBE(name, ...) ((void)0)
+#define JWT_PROBE_ON_EXIT(var, name, ...) ((void)0)
+#endif
@@ -0,0 +1,164 @@
+#include "jwt/public_key.hpp"
+#include "lock_stats.hpp"
+#include "nkey_codec.hpp"
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    constexpr std::size_t kShardCount = 16;
+
+    struct Shard {
+        internal::InstrumentedMutex mutex{"public_key_pool"};
+        // Keys view the entry's own encoded string
+        std::unordered_map<std::string_view, detail::PublicKeyEntry*> entries;
+    };
+
+    struct Pool {
+        std::array<Shard, kShardCount> shards;
+    };
+
+    // Intentionally leaked: handles in other statics may be released during exit
+    Pool& pool() {
+        static Pool* instance = new Pool();
+        return *instance;
+    }
+}
+
+namespace detail {
+
+void releasePublicKey(PublicKeyEntry* entry) noexcept {
+    // Drop a reference without locking unless it may be the last one
+    auto refs = entry->refs.load(std::memory_order_relaxed);
+    while (refs > 1) {
+        if (entry->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+            return;
+        }
+    }
+
+    // Interning increments under the shard lock, so a count that reaches
+    // zero here cannot be revived concurrently
+    auto& shard = pool().shards[entry->shard];
+    {
+        std::lock_guard<internal::InstrumentedMutex> lock(shard.mutex);
+        if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        shard.entries.erase(entry->encoded);
+    }
+    delete entry;
+}
+
+}
+
+namespace {
+    std::size_t shardOf(std::size_t hash) { return hash % kShardCount; }
+
+    /// Take a reference to an existing entry; caller holds the shard lock
+    detail::PublicKeyEntry* findLocked(Shard& shard, std::string_view encoded) {
+        auto it = shard.entries.find(encoded);
+        if (it == shard.entries.end()) {
+            return nullptr;
+        }
+        it->second->refs.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+
+    /// Add a new entry with one reference; caller holds the shard lock
+    detail::PublicKeyEntry* insertLocked(Shard& shard, std::string_view encoded, std::size_t hash,
+                                         const internal::DecodedPublicKey* decoded) {
+        auto* entry = new detail::PublicKeyEntry();
+        entry->encoded.assign(encoded);
+        entry->hash = hash;
+        entry->shard = static_cast<std::uint8_t>(shardOf(hash));
+        entry->refs.store(1, std::memory_order_relaxed);
+        if (decoded != nullptr) {
+            entry->valid = true;
+            entry->prefixByte = decoded->prefix;
+            entry->bytes = decoded->key;
+        }
+        shard.entries.emplace(entry->encoded, entry);
+        return entry;
+    }
+}
+
+PublicKey::PublicKey(std::string_view encoded) {
+    if (encoded.empty()) {
+        return;
+    }
+    std::size_t hash = std::hash<std::string_view>{}(encoded);
+    auto& shard = pool().shards[shardOf(hash)];
+
+    std::lock_guard<internal::InstrumentedMutex> lock(shard.mutex);
+    if ((entry_ = findLocked(shard, encoded)) != nullptr) {
+        return;
+    }
+    internal::DecodedPublicKey decoded;
+    bool valid = internal::decodePublicKey(encoded, decoded);
+    entry_ = insertLocked(shard, encoded, hash, valid ? &decoded : nullptr);
+}
+
+std::vector<PublicKey> PublicKey::internAll(std::span<const std::string_view> encoded) {
+    std::vector<PublicKey> keys(encoded.size());
+
+    // Resolve keys already in the pool
+    std::vector<std::size_t> misses;
+    for (std::size_t i = 0; i < encoded.size(); ++i) {
+        if (encoded[i].empty()) {
+            continue;
+        }
+        auto& shard = pool().shards[shardOf(std::hash<std::string_view>{}(encoded[i]))];
+        std::lock_guard<internal::InstrumentedMutex> lock(shard.mutex);
+        if ((keys[i].entry_ = findLocked(shard, encoded[i])) == nullptr) {
+            misses.push_back(i);
+        }
+    }
+    if (misses.empty()) {
+        return keys;
+    }
+
+    // Decode the new keys as one batch, outside any lock
+    std::vector<std::string_view> pending;
+    pending.reserve(misses.size());
+    for (std::size_t i : misses) {
+        pending.push_back(encoded[i]);
+    }
+    std::vector<internal::DecodedPublicKey> decoded(misses.size());
+    std::unique_ptr<bool[]> ok(new bool[misses.size()]);
+    internal::decodePublicKeys(pending, decoded, std::span<bool>(ok.get(), misses.size()));
+
+    // Another thread, or a duplicate earlier in this batch, may have added the key meanwhile
+    for (std::size_t m = 0; m < misses.size(); ++m) {
+        std::size_t hash = std::hash<std::string_view>{}(pending[m]);
+        auto& shard = pool().shards[shardOf(hash)];
+        std::lock_guard<internal::InstrumentedMutex> lock(shard.mutex);
+        auto& entry = keys[misses[m]].entry_;
+        if ((entry = findLocked(shard, pending[m])) == nullptr) {
+            entry = insertLocked(shard, pending[m], hash, ok[m] ? &decoded[m] : nullptr);
+        }
+    }
+    return keys;
+}
+
+const detail::PublicKeyEntry& PublicKey::emptyEntry() noexcept {
+    static const detail::PublicKeyEntry empty;
+    return empty;
+}
+
+std::ostream& operator<<(std::ostream& os, const PublicKey& key) {
+    return os << key.str();
+}
+
+std::size_t internedPublicKeyCount() {
+    std::size_t count = 0;
+    for (auto& shard : pool().shards) {
+        std::lock_guard<internal::InstrumentedMutex> lock(shard.mutex);
+        count += shard.entries.size();
+    }
+    return count;
+}
+
+}
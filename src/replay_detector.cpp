@@ -0,0 +1,256 @@
+#include "jwt/replay_detector.hpp"
+#include "jwt_utils.hpp"
+#include "lock_stats.hpp"
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace jwt {
+
+namespace {
+    constexpr std::int64_t kEmpty = std::numeric_limits<std::int64_t>::min();
+    constexpr std::int64_t kClearing = kEmpty + 1;
+
+    std::uint64_t mix(std::uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    bool parseHex64(std::string_view text, std::uint64_t& out) {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out, 16);
+        return ec == std::errc() && end == text.data() + text.size();
+    }
+
+    /// 64-bit fingerprint of a JTI; never 0 (0 marks an empty slot)
+    std::uint64_t fingerprint(std::string_view jti) {
+        std::uint64_t high = 0;
+        std::uint64_t low = 0;
+        std::uint64_t fp;
+        if (jti.size() == 32 && jti.find_first_of("+-") == std::string_view::npos &&
+            parseHex64(jti.substr(0, 16), high) && parseHex64(jti.substr(16), low)) {
+            fp = mix(high ^ mix(low));
+        } else {
+            fp = 14695981039346656037ULL;
+            for (unsigned char c : jti) {
+                fp ^= c;
+                fp *= 1099511628211ULL;
+            }
+            fp = mix(fp);
+        }
+        return fp == 0 ? 1 : fp;
+    }
+
+    std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+        std::int64_t q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
+
+    std::int64_t ceilDiv(std::int64_t a, std::int64_t b) {
+        return -floorDiv(-a, b);
+    }
+}
+
+class ReplayDetector::Impl {
+public:
+    struct Bucket {
+        std::atomic<std::int64_t> epoch{kEmpty};  // Expiry epoch this bucket holds
+        std::atomic<std::uint32_t> count{0};
+        std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+    };
+
+    Options options;
+    std::size_t mask = 0;
+    std::uint32_t limit = 0;
+    std::unique_ptr<Bucket[]> buckets;
+    internal::InstrumentedMutex mutex{"replay_detector"};
+
+    Bucket& bucketFor(std::int64_t epoch) const {
+        auto count = static_cast<std::int64_t>(options.buckets);
+        return buckets[static_cast<std::size_t>(((epoch % count) + count) % count)];
+    }
+
+    bool contains(const Bucket& bucket, std::int64_t epoch, std::uint64_t fp) const {
+        if (bucket.epoch.load(std::memory_order_acquire) != epoch) {
+            return false;
+        }
+        std::size_t i = fp & mask;
+        for (std::size_t probes = 0; probes <= mask; ++probes) {
+            std::uint64_t value = bucket.slots[i].load(std::memory_order_acquire);
+            if (value == fp) {
+                return true;
+            }
+            if (value == 0) {
+                return false;
+            }
+            i = (i + 1) & mask;
+        }
+        return false;
+    }
+
+    /// Empty an expired bucket and give it to epoch; false if it still holds live tokens
+    bool claim(Bucket& bucket, std::int64_t epoch, std::int64_t nowEpoch) {
+        std::lock_guard<internal::InstrumentedMutex> lock(mutex);
+        std::int64_t current = bucket.epoch.load();
+        if (current == epoch) {
+            return true;
+        }
+        if (current >= nowEpoch) {
+            return false;
+        }
+        // Writers that raced with the reset see the epoch change and retry
+        bucket.epoch.store(kClearing);
+        for (std::size_t i = 0; i <= mask; ++i) {
+            bucket.slots[i].store(0, std::memory_order_relaxed);
+        }
+        bucket.count.store(0, std::memory_order_relaxed);
+        bucket.epoch.store(epoch);
+        return true;
+    }
+
+    ReplayCheck probeInsert(Bucket& bucket, std::uint64_t fp) {
+        std::size_t i = fp & mask;
+        for (std::size_t probes = 0; probes <= mask; ++probes) {
+            std::uint64_t value = bucket.slots[i].load(std::memory_order_acquire);
+            if (value == fp) {
+                return ReplayCheck::Replayed;
+            }
+            if (value == 0) {
+                if (bucket.count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+                    bucket.count.fetch_sub(1, std::memory_order_relaxed);
+                    return ReplayCheck::Overflow;
+                }
+                if (bucket.slots[i].compare_exchange_strong(value, fp)) {
+                    return ReplayCheck::Fresh;
+                }
+                bucket.count.fetch_sub(1, std::memory_order_relaxed);
+                if (value == fp) {
+                    return ReplayCheck::Replayed;  // Lost the race to the same JTI
+                }
+            }
+            i = (i + 1) & mask;
+        }
+        return ReplayCheck::Overflow;
+    }
+
+    ReplayCheck insert(std::int64_t epoch, std::int64_t nowEpoch, std::uint64_t fp) {
+        Bucket& bucket = bucketFor(epoch);
+        while (true) {
+            if (bucket.epoch.load() != epoch && !claim(bucket, epoch, nowEpoch)) {
+                return ReplayCheck::Overflow;
+            }
+            ReplayCheck result = probeInsert(bucket, fp);
+            if (bucket.epoch.load() == epoch) {
+                return result;
+            }
+        }
+    }
+
+    /// Bucket epoch for a token, and whether it outlives the window
+    std::pair<std::int64_t, bool> route(std::int64_t expires, std::int64_t nowEpoch) const {
+        std::int64_t last = nowEpoch + static_cast<std::int64_t>(options.buckets) - 1;
+        if (expires == 0) {
+            return {last, true};
+        }
+        std::int64_t epoch = ceilDiv(expires, options.granularity);
+        return epoch > last ? std::pair{last, true} : std::pair{epoch, false};
+    }
+
+    bool containsAnyLive(std::uint64_t fp, std::int64_t nowEpoch) const {
+        for (std::size_t i = 0; i < options.buckets; ++i) {
+            std::int64_t epoch = nowEpoch + static_cast<std::int64_t>(i);
+            if (contains(bucketFor(epoch), epoch, fp)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+ReplayDetector::ReplayDetector() : ReplayDetector(Options{}) {}
+
+ReplayDetector::ReplayDetector(Options options) : impl_(std::make_unique<Impl>()) {
+    if (options.granularity <= 0 || options.buckets == 0 || options.capacityPerBucket == 0) {
+        throw std::invalid_argument("Replay detector granularity, buckets and capacity must be positive");
+    }
+    std::size_t capacity = std::bit_ceil(options.capacityPerBucket);
+    impl_->options = options;
+    impl_->mask = capacity - 1;
+    impl_->limit = static_cast<std::uint32_t>(std::min<std::size_t>(capacity - capacity / 4, UINT32_MAX));
+    impl_->buckets = std::make_unique<Impl::Bucket[]>(options.buckets);
+    for (std::size_t i = 0; i < options.buckets; ++i) {
+        impl_->buckets[i].slots = std::make_unique<std::atomic<std::uint64_t>[]>(capacity);
+    }
+}
+
+ReplayDetector::~ReplayDetector() = default;
+
+ReplayCheck ReplayDetector::check(std::string_view jti, std::int64_t expires, std::int64_t now) {
+    if (expires != 0 && expires < now) {
+        return ReplayCheck::Expired;
+    }
+    std::uint64_t fp = fingerprint(jti);
+    std::int64_t nowEpoch = floorDiv(now, impl_->options.granularity);
+    auto [epoch, outlivesWindow] = impl_->route(expires, nowEpoch);
+    if (outlivesWindow && impl_->containsAnyLive(fp, nowEpoch)) {
+        return ReplayCheck::Replayed;
+    }
+    return impl_->insert(epoch, nowEpoch, fp);
+}
+
+ReplayCheck ReplayDetector::check(std::string_view jti, std::int64_t expires) {
+    return check(jti, expires, internal::getCurrentTimestamp());
+}
+
+ReplayCheck ReplayDetector::checkToken(const std::string& token, std::int64_t now) {
+    using namespace internal;
+    std::string jti;
+    std::int64_t expires = 0;
+    try {
+        auto payload = decodePayload(parseJwt(token));
+        takeString(payload, "jti", jti);
+        if (auto it = payload.find("exp"); it != payload.end()) {
+            expires = it->get<std::int64_t>();
+        }
+    } catch (const nlohmann::json::exception& e) {
+        throw std::invalid_argument(std::string("Malformed JWT payload: ") + e.what());
+    }
+    if (jti.empty()) {
+        throw std::invalid_argument("Token has no 'jti'");
+    }
+    return check(jti, expires, now);
+}
+
+bool ReplayDetector::seen(std::string_view jti, std::int64_t expires, std::int64_t now) const {
+    std::uint64_t fp = fingerprint(jti);
+    std::int64_t nowEpoch = floorDiv(now, impl_->options.granularity);
+    auto [epoch, outlivesWindow] = impl_->route(expires, nowEpoch);
+    if (outlivesWindow) {
+        return impl_->containsAnyLive(fp, nowEpoch);
+    }
+    return impl_->contains(impl_->bucketFor(epoch), epoch, fp);
+}
+
+std::size_t ReplayDetector::memoryBytes() const {
+    return impl_->options.buckets * (sizeof(Impl::Bucket) + (impl_->mask + 1) * sizeof(std::uint64_t));
+}
+
+std::size_t ReplayDetector::size(std::int64_t now) const {
+    std::int64_t nowEpoch = floorDiv(now, impl_->options.granularity);
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < impl_->options.buckets; ++i) {
+        std::int64_t epoch = impl_->buckets[i].epoch.load();
+        if (epoch >= nowEpoch) {
+            total += impl_->buckets[i].count.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+}
@@ -0,0 +1,22 @@
+#include "jwt/signer.hpp"
+#include <nkeys/nkeys.hpp>
+#include <stdexcept>
+
+namespace jwt {
+
+Signer::Signer(const std::string& seed) {
+    try {
+        keyPair_ = nkeys::FromSeed(seed);
+    } catch (const std::exception& e) {
+        throw std::invalid_argument(std::string("Invalid seed: ") + e.what());
+    }
+    publicKey_ = PublicKey(keyPair_->publicString());
+}
+
+const PublicKey& Signer::publicKey() const { return publicKey_; }
+
+std::vector<std::uint8_t> Signer::sign(std::span<const std::uint8_t> data) const {
+    return keyPair_->sign(data);
+}
+
+}
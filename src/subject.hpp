@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+namespace jwt::internal {
+
+/// Hash that allows looking up std::string keys by string_view
+struct StringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+/// Split off the next dot-separated subject token; pos is advanced past the dot
+/// @param subject Subject or subject pattern
+/// @param pos Offset of the token to return
+/// @return The token, and whether it was the last one
+inline std::pair<std::string_view, bool> nextToken(std::string_view subject, std::size_t& pos) {
+    auto dot = subject.find('.', pos);
+    if (dot == std::string_view::npos) {
+        auto token = subject.substr(pos);
+        pos = subject.size();
+        return {token, true};
+    }
+    auto token = subject.substr(pos, dot - pos);
+    pos = dot + 1;
+    return {token, false};
+}
+
+/// Check that a subject is non-empty, has no empty tokens and '>' only as its last token
+/// @param subject Subject or subject pattern
+/// @return true if well-formed
+inline bool isValidSubject(std::string_view subject) {
+    if (subject.empty()) {
+        return false;
+    }
+    std::size_t pos = 0;
+    while (true) {
+        auto [token, last] = nextToken(subject, pos);
+        if (token.empty() || (token == ">" && !last)) {
+            return false;
+        }
+        if (last) {
+            return true;
+        }
+    }
+}
+
+}
@@ -0,0 +1,491 @@
+#include "jwt/subject_mapping.hpp"
+#include "subject.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    using internal::StringHash;
+    using internal::nextToken;
+
+    constexpr std::uint32_t kNone = UINT32_MAX;
+    constexpr std::size_t kMaxWildcards = 16;
+
+    /// Tokens a source pattern's wildcards matched, in source order
+    struct Captures {
+        std::array<std::string_view, kMaxWildcards> star;
+        std::size_t count = 0;
+        std::string_view tail;
+    };
+
+    enum class OpKind : std::uint8_t {
+        Literal,
+        Wildcard,
+        Tail,
+        Partition,
+        Split,
+        SplitFromLeft,
+        SplitFromRight,
+        SliceFromLeft,
+        SliceFromRight,
+    };
+
+    /// One destination token, parsed from its template
+    struct Op {
+        OpKind kind = OpKind::Literal;
+        std::string text;                  // Literal, or Split delimiter
+        std::vector<std::uint8_t> stars;   // 0-based wildcard indexes
+        std::uint32_t n = 0;               // Partition count, split position or slice size
+    };
+
+    struct Destination {
+        std::vector<Op> ops;
+        bool identity = false;  // Keep the published subject
+    };
+
+    std::string_view trim(std::string_view s) {
+        auto first = s.find_first_not_of(' ');
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return s.substr(first, s.find_last_not_of(' ') - first + 1);
+    }
+
+    std::uint32_t parseArg(std::string_view arg, std::string_view destination) {
+        arg = trim(arg);
+        std::uint32_t value = 0;
+        auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+        if (arg.empty() || ec != std::errc() || end != arg.data() + arg.size()) {
+            throw std::invalid_argument("Invalid argument '" + std::string(arg) + "' in mapping '" +
+                                        std::string(destination) + "'");
+        }
+        return value;
+    }
+
+    std::uint8_t starIndex(std::string_view arg, std::size_t stars, std::string_view destination) {
+        std::uint32_t index = parseArg(arg, destination);
+        if (index < 1 || index > stars) {
+            throw std::invalid_argument("Wildcard index " + std::to_string(index) + " out of range in mapping '" +
+                                        std::string(destination) + "'");
+        }
+        return static_cast<std::uint8_t>(index - 1);
+    }
+
+    Op parseToken(std::string_view token, std::size_t stars, bool sourceTail, bool last,
+                  std::string_view destination) {
+        Op op;
+        if (token == ">") {
+            if (!sourceTail || !last) {
+                throw std::invalid_argument("'>' in mapping '" + std::string(destination) +
+                                            "' needs a source ending in '>'");
+            }
+            op.kind = OpKind::Tail;
+            return op;
+        }
+        if (token.size() > 1 && token[0] == '$' &&
+            token.find_first_not_of("0123456789", 1) == std::string_view::npos) {
+            op.kind = OpKind::Wildcard;
+            op.stars.push_back(starIndex(token.substr(1), stars, destination));
+            return op;
+        }
+        if (token.size() < 4 || token.substr(0, 2) != "{{" || token.substr(token.size() - 2) != "}}") {
+            if (token.find("{{") != std::string_view::npos || token.find("}}") != std::string_view::npos) {
+                throw std::invalid_argument("Mapping function must be a whole token in '" +
+                                            std::string(destination) + "'");
+            }
+            op.text = std::string(token);
+            return op;
+        }
+
+        // {{name(arg, ...)}}
+        auto call = trim(token.substr(2, token.size() - 4));
+        auto open = call.find('(');
+        if (open == std::string_view::npos || call.back() != ')') {
+            throw std::invalid_argument("Malformed mapping function in '" + std::string(destination) + "'");
+        }
+        std::string name(trim(call.substr(0, open)));
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        std::vector<std::string_view> args;
+        auto list = call.substr(open + 1, call.size() - open - 2);
+        for (std::size_t pos = 0; !trim(list).empty() && pos <= list.size();) {
+            auto comma = list.find(',', pos);
+            args.push_back(list.substr(pos, comma == std::string_view::npos ? std::string_view::npos : comma - pos));
+            pos = comma == std::string_view::npos ? list.size() + 1 : comma + 1;
+        }
+
+        auto expectArgs = [&](std::size_t count) {
+            if (args.size() != count) {
+                throw std::invalid_argument("Function '" + name + "' takes " + std::to_string(count) +
+                                            " arguments in mapping '" + std::string(destination) + "'");
+            }
+        };
+        if (name == "wildcard") {
+            expectArgs(1);
+            op.kind = OpKind::Wildcard;
+            op.stars.push_back(starIndex(args[0], stars, destination));
+        } else if (name == "partition") {
+            if (args.empty()) {
+                expectArgs(1);
+            }
+            op.kind = OpKind::Partition;
+            op.n = parseArg(args[0], destination);
+            if (op.n == 0) {
+                throw std::invalid_argument("Partition count must be positive in mapping '" +
+                                            std::string(destination) + "'");
+            }
+            for (std::size_t i = 1; i < args.size(); ++i) {
+                op.stars.push_back(starIndex(args[i], stars, destination));
+            }
+        } else if (name == "split") {
+            expectArgs(2);
+            op.kind = OpKind::Split;
+            op.stars.push_back(starIndex(args[0], stars, destination));
+            op.text = std::string(trim(args[1]));
+            if (op.text.empty()) {
+                throw std::invalid_argument("Split delimiter cannot be empty in mapping '" +
+                                            std::string(destination) + "'");
+            }
+        } else if (name == "splitfromleft" || name == "splitfromright" || name == "slicefromleft" ||
+                   name == "slicefromright") {
+            expectArgs(2);
+            op.kind = name == "splitfromleft"    ? OpKind::SplitFromLeft
+                      : name == "splitfromright" ? OpKind::SplitFromRight
+                      : name == "slicefromleft"  ? OpKind::SliceFromLeft
+                                                 : OpKind::SliceFromRight;
+            op.stars.push_back(starIndex(args[0], stars, destination));
+            op.n = parseArg(args[1], destination);
+            if (op.n == 0) {
+                throw std::invalid_argument("Function '" + name + "' needs a positive size in mapping '" +
+                                            std::string(destination) + "'");
+            }
+        } else {
+            throw std::invalid_argument("Unknown mapping function '" + name + "' in '" +
+                                        std::string(destination) + "'");
+        }
+        return op;
+    }
+
+    std::uint32_t fnv32a(std::uint32_t hash, std::string_view data) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    /// Append token in chunks of size, the first (fromLeft) or last chunk taking the remainder
+    void appendSlices(std::string& out, std::string_view token, std::size_t size, bool fromLeft) {
+        std::size_t first = size;
+        if (!fromLeft && token.size() % size != 0) {
+            first = token.size() % size;
+        }
+        first = std::min(first, token.size());
+        out += token.substr(0, first);
+        for (std::size_t pos = first; pos < token.size(); pos += size) {
+            out += '.';
+            out += token.substr(pos, size);
+        }
+    }
+
+    void appendOp(std::string& out, const Op& op, std::string_view subject, const Captures& captures) {
+        switch (op.kind) {
+            case OpKind::Literal:
+                out += op.text;
+                break;
+            case OpKind::Wildcard:
+                out += captures.star[op.stars[0]];
+                break;
+            case OpKind::Tail:
+                out += captures.tail;
+                break;
+            case OpKind::Partition: {
+                std::uint32_t hash = 2166136261u;
+                if (op.stars.empty()) {
+                    hash = fnv32a(hash, subject);
+                }
+                for (auto index : op.stars) {
+                    hash = fnv32a(hash, captures.star[index]);
+                }
+                char digits[10];
+                auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), hash % op.n);
+                out.append(digits, end);
+                break;
+            }
+            case OpKind::Split: {
+                std::string_view token = captures.star[op.stars[0]];
+                bool any = false;
+                for (std::size_t pos = 0; pos <= token.size();) {
+                    auto next = token.find(op.text, pos);
+                    auto part = token.substr(pos, next == std::string_view::npos ? std::string_view::npos : next - pos);
+                    if (!part.empty()) {
+                        if (any) {
+                            out += '.';
+                        }
+                        out += part;
+                        any = true;
+                    }
+                    pos = next == std::string_view::npos ? token.size() + 1 : next + op.text.size();
+                }
+                if (!any) {
+                    out += token;
+                }
+                break;
+            }
+            case OpKind::SplitFromLeft:
+            case OpKind::SplitFromRight: {
+                std::string_view token = captures.star[op.stars[0]];
+                std::size_t at = op.kind == OpKind::SplitFromLeft
+                                     ? op.n
+                                     : token.size() - std::min<std::size_t>(op.n, token.size());
+                if (at > 0 && at < token.size()) {
+                    out += token.substr(0, at);
+                    out += '.';
+                    out += token.substr(at);
+                } else {
+                    out += token;
+                }
+                break;
+            }
+            case OpKind::SliceFromLeft:
+            case OpKind::SliceFromRight:
+                appendSlices(out, captures.star[op.stars[0]], op.n, op.kind == OpKind::SliceFromLeft);
+                break;
+        }
+    }
+}
+
+class SubjectMapper::Impl {
+public:
+    struct Node {
+        std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> literal;
+        std::uint32_t star = kNone;
+        std::uint32_t exact = kNone;  // Entry whose source ends here
+        std::uint32_t tail = kNone;   // Entry whose source continues with '>' here
+    };
+
+    /// A compiled source: destinations plus their alias table
+    struct Entry {
+        std::vector<Destination> destinations;
+        std::vector<std::uint64_t> threshold;  // Out of 2^32: keep the column, else take its alias
+        std::vector<std::uint32_t> alias;
+    };
+
+    std::vector<SubjectMapping> mappings;
+    std::vector<Node> nodes;
+    std::vector<Entry> entries;
+
+    /// Most specific entry matching subject[pos..] below node
+    std::uint32_t lookup(std::uint32_t node, std::string_view subject, std::size_t pos, Captures& captures) const {
+        const Node& current = nodes[node];
+        std::size_t start = pos;
+        auto [token, last] = nextToken(subject, pos);
+        auto step = [&](std::uint32_t child) {
+            return last ? nodes[child].exact : lookup(child, subject, pos, captures);
+        };
+
+        if (auto it = current.literal.find(token); it != current.literal.end()) {
+            if (auto found = step(it->second); found != kNone) {
+                return found;
+            }
+        }
+        if (current.star != kNone) {
+            std::size_t saved = captures.count;
+            captures.star[captures.count++] = token;
+            if (auto found = step(current.star); found != kNone) {
+                return found;
+            }
+            captures.count = saved;
+        }
+        if (current.tail != kNone) {
+            captures.tail = subject.substr(start);
+        }
+        return current.tail;
+    }
+
+    /// Insert a source pattern; returns its node slot (exact or tail) to fill
+    std::uint32_t& insert(std::string_view source) {
+        std::uint32_t node = 0;
+        std::size_t pos = 0;
+        while (true) {
+            auto [token, last] = nextToken(source, pos);
+            if (token == ">") {
+                return nodes[node].tail;
+            }
+            std::uint32_t next;
+            if (token == "*") {
+                if (nodes[node].star == kNone) {
+                    nodes[node].star = static_cast<std::uint32_t>(nodes.size());
+                    nodes.emplace_back();
+                }
+                next = nodes[node].star;
+            } else if (auto it = nodes[node].literal.find(token); it != nodes[node].literal.end()) {
+                next = it->second;
+            } else {
+                next = static_cast<std::uint32_t>(nodes.size());
+                nodes.emplace_back();
+                nodes[node].literal.emplace(std::string(token), next);
+            }
+            node = next;
+            if (last) {
+                return nodes[node].exact;
+            }
+        }
+    }
+
+    /// Vose's alias method over integer percentages
+    static void buildAliasTable(Entry& entry, const std::vector<std::uint32_t>& weights) {
+        std::size_t k = weights.size();
+        std::vector<std::uint64_t> scaled(k);
+        std::vector<std::uint32_t> small;
+        std::vector<std::uint32_t> large;
+        for (std::uint32_t i = 0; i < k; ++i) {
+            scaled[i] = std::uint64_t{weights[i]} * k;
+            (scaled[i] < 100 ? small : large).push_back(i);
+        }
+        entry.threshold.assign(k, std::uint64_t{1} << 32);
+        entry.alias.resize(k);
+        for (std::uint32_t i = 0; i < k; ++i) {
+            entry.alias[i] = i;
+        }
+        while (!small.empty() && !large.empty()) {
+            std::uint32_t s = small.back();
+            small.pop_back();
+            std::uint32_t l = large.back();
+            entry.threshold[s] = (scaled[s] << 32) / 100;
+            entry.alias[s] = l;
+            scaled[l] -= 100 - scaled[s];
+            if (scaled[l] < 100) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+    }
+};
+
+SubjectMapper::SubjectMapper(std::vector<SubjectMapping> mappings, std::string_view cluster) {
+    if (mappings.empty()) {
+        return;
+    }
+
+    auto impl = std::make_shared<Impl>();
+    impl->nodes.emplace_back();
+    for (const auto& mapping : mappings) {
+        const auto& source = mapping.source;
+        if (!internal::isValidSubject(source)) {
+            throw std::invalid_argument("Invalid mapping source '" + source + "'");
+        }
+        std::size_t stars = 0;
+        bool sourceTail = false;
+        for (std::size_t pos = 0; pos < source.size();) {
+            auto [token, last] = nextToken(source, pos);
+            stars += token == "*";
+            sourceTail = token == ">";
+        }
+        if (stars > kMaxWildcards) {
+            throw std::invalid_argument("Mapping source '" + source + "' has more than " +
+                                        std::to_string(kMaxWildcards) + " wildcards");
+        }
+
+        // Destinations for the local cluster replace the cluster-less ones
+        bool local = !cluster.empty() && std::any_of(mapping.destinations.begin(), mapping.destinations.end(),
+                                                     [&](const WeightedMapping& d) { return d.cluster == cluster; });
+        Impl::Entry entry;
+        std::vector<std::uint32_t> weights;
+        std::uint32_t total = 0;
+        for (const auto& destination : mapping.destinations) {
+            if (local ? destination.cluster != cluster : !destination.cluster.empty()) {
+                continue;
+            }
+            if (!internal::isValidSubject(destination.subject)) {
+                throw std::invalid_argument("Invalid mapping destination '" + destination.subject + "'");
+            }
+            Destination& compiled = entry.destinations.emplace_back();
+            for (std::size_t pos = 0; pos < destination.subject.size();) {
+                auto [token, last] = nextToken(destination.subject, pos);
+                compiled.ops.push_back(parseToken(token, stars, sourceTail, last, destination.subject));
+            }
+            std::uint32_t weight = destination.weight == 0 ? 100 : destination.weight;
+            weights.push_back(weight);
+            total += weight;
+        }
+        if (total > 100) {
+            throw std::invalid_argument("Weights of mapping '" + source + "' add up to more than 100");
+        }
+        if (entry.destinations.empty()) {
+            continue;  // Only for other clusters
+        }
+        if (total < 100) {
+            entry.destinations.emplace_back().identity = true;
+            weights.push_back(100 - total);
+        }
+        Impl::buildAliasTable(entry, weights);
+
+        // First mapping wins if two share a source
+        std::uint32_t& slot = impl->insert(source);
+        if (slot == kNone) {
+            slot = static_cast<std::uint32_t>(impl->entries.size());
+            impl->entries.push_back(std::move(entry));
+        }
+    }
+    impl->mappings = std::move(mappings);
+    impl_ = std::move(impl);
+}
+
+const std::vector<SubjectMapping>& SubjectMapper::mappings() const {
+    static const std::vector<SubjectMapping> none;
+    return impl_ ? impl_->mappings : none;
+}
+
+bool SubjectMapper::empty() const {
+    return !impl_ || impl_->entries.empty();
+}
+
+bool SubjectMapper::map(std::string_view subject, std::uint64_t random, std::string& out) const {
+    if (!impl_ || impl_->entries.empty() || !internal::isValidSubject(subject)) {
+        return false;
+    }
+    Captures captures;
+    std::uint32_t found = impl_->lookup(0, subject, 0, captures);
+    if (found == kNone) {
+        return false;
+    }
+
+    // Pick a column with the high bits and flip its biased coin with the low bits
+    const auto& entry = impl_->entries[found];
+    std::size_t column = static_cast<std::size_t>(((random >> 32) * entry.destinations.size()) >> 32);
+    if ((random & 0xffffffffu) >= entry.threshold[column]) {
+        column = entry.alias[column];
+    }
+
+    const Destination& destination = entry.destinations[column];
+    out.clear();
+    if (destination.identity) {
+        out += subject;
+        return true;
+    }
+    for (std::size_t i = 0; i < destination.ops.size(); ++i) {
+        if (i > 0) {
+            out += '.';
+        }
+        appendOp(out, destination.ops[i], subject, captures);
+    }
+    return true;
+}
+
+std::optional<std::string> SubjectMapper::map(std::string_view subject) const {
+    thread_local std::mt19937_64 random{std::random_device{}()};
+    std::string out;
+    if (!map(subject, random(), out)) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,219 @@
+#include "jwt/tags.hpp"
+#include "lock_stats.hpp"
+#include "subject.hpp"
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace jwt {
+
+namespace {
+    std::string normalize(std::string_view tag) {
+        auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
+        while (!tag.empty() && isSpace(static_cast<unsigned char>(tag.front()))) tag.remove_prefix(1);
+        while (!tag.empty() && isSpace(static_cast<unsigned char>(tag.back()))) tag.remove_suffix(1);
+
+        std::string normalized(tag);
+        for (auto& c : normalized) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return normalized;
+    }
+
+    /// Process-wide dictionary; leaked so it outlives static claims
+    struct Dictionary {
+        internal::InstrumentedMutex mutex{"tag_dictionary"};
+        std::unordered_map<std::string, TagId, internal::StringHash, std::equal_to<>> ids;
+        std::vector<std::string> names;
+    };
+
+    Dictionary& dictionary() {
+        static auto* instance = new Dictionary();
+        return *instance;
+    }
+
+    /// Intern a normalized tag; nullopt once the dictionary is full
+    std::optional<TagId> tryIntern(std::string normalized) {
+        auto& dict = dictionary();
+        std::lock_guard<internal::InstrumentedMutex> lock(dict.mutex);
+        if (auto it = dict.ids.find(normalized); it != dict.ids.end()) {
+            return it->second;
+        }
+        if (dict.names.size() >= MAX_INTERNED_TAGS) {
+            return std::nullopt;
+        }
+        auto id = static_cast<TagId>(dict.names.size());
+        dict.ids.emplace(normalized, id);
+        dict.names.push_back(std::move(normalized));
+        return id;
+    }
+
+    std::optional<TagId> findNormalized(std::string_view normalized) {
+        auto& dict = dictionary();
+        std::lock_guard<internal::InstrumentedMutex> lock(dict.mutex);
+        auto it = dict.ids.find(normalized);
+        if (it == dict.ids.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    template <typename T>
+    void insertSorted(std::vector<T>& values, T value) {
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        if (it == values.end() || *it != value) {
+            values.insert(it, std::move(value));
+        }
+    }
+
+    template <typename T>
+    bool sortedContains(const std::vector<T>& values, const T& value) {
+        return std::binary_search(values.begin(), values.end(), value);
+    }
+}
+
+TagId internTag(std::string_view tag) {
+    std::string normalized = normalize(tag);
+    if (normalized.empty()) {
+        throw std::invalid_argument("Tag cannot be blank");
+    }
+    auto id = tryIntern(std::move(normalized));
+    if (!id) {
+        throw std::invalid_argument("Tag dictionary is full");
+    }
+    return *id;
+}
+
+std::optional<TagId> findTag(std::string_view tag) {
+    return findNormalized(normalize(tag));
+}
+
+std::string tagName(TagId id) {
+    auto& dict = dictionary();
+    std::lock_guard<internal::InstrumentedMutex> lock(dict.mutex);
+    return dict.names.at(id);
+}
+
+std::size_t internedTagCount() {
+    auto& dict = dictionary();
+    std::lock_guard<internal::InstrumentedMutex> lock(dict.mutex);
+    return dict.names.size();
+}
+
+TagSet::TagSet(std::initializer_list<std::string_view> tags) {
+    for (auto tag : tags) {
+        add(tag);
+    }
+}
+
+TagSet::TagSet(const std::vector<std::string>& tags) {
+    for (const auto& tag : tags) {
+        add(std::string_view(tag));
+    }
+}
+
+void TagSet::add(TagId id) {
+    insertSorted(ids_, id);
+}
+
+void TagSet::add(std::string_view tag) {
+    std::string normalized = normalize(tag);
+    if (normalized.empty()) {
+        return;
+    }
+    if (auto id = tryIntern(normalized)) {
+        add(*id);
+    } else {
+        insertSorted(names_, std::move(normalized));
+    }
+}
+
+void TagSet::addUninterned(std::string_view tag) {
+    std::string normalized = normalize(tag);
+    if (normalized.empty()) {
+        return;
+    }
+    if (auto id = findNormalized(normalized)) {
+        add(*id);
+    } else {
+        insertSorted(names_, std::move(normalized));
+    }
+}
+
+bool TagSet::containsName(const std::string& normalized) const {
+    if (sortedContains(names_, normalized)) {
+        return true;
+    }
+    // The tag may have been interned after another set kept it by name
+    auto id = ids_.empty() ? std::nullopt : findNormalized(normalized);
+    return id && sortedContains(ids_, *id);
+}
+
+bool TagSet::contains(TagId id) const {
+    if (sortedContains(ids_, id)) {
+        return true;
+    }
+    return !names_.empty() && sortedContains(names_, tagName(id));
+}
+
+bool TagSet::contains(std::string_view tag) const {
+    return containsName(normalize(tag));
+}
+
+bool TagSet::hasAll(const TagSet& required) const {
+    if (names_.empty() && required.names_.empty()) {
+        return std::includes(ids_.begin(), ids_.end(), required.ids_.begin(), required.ids_.end());
+    }
+    return std::all_of(required.ids_.begin(), required.ids_.end(), [&](TagId id) { return contains(id); }) &&
+           std::all_of(required.names_.begin(), required.names_.end(),
+                       [&](const std::string& name) { return containsName(name); });
+}
+
+bool TagSet::hasAny(const TagSet& wanted) const {
+    if (names_.empty() && wanted.names_.empty()) {
+        auto a = ids_.begin();
+        auto b = wanted.ids_.begin();
+        while (a != ids_.end() && b != wanted.ids_.end()) {
+            if (*a == *b) {
+                return true;
+            }
+            *a < *b ? ++a : ++b;
+        }
+        return false;
+    }
+    return std::any_of(wanted.ids_.begin(), wanted.ids_.end(), [&](TagId id) { return contains(id); }) ||
+           std::any_of(wanted.names_.begin(), wanted.names_.end(),
+                       [&](const std::string& name) { return containsName(name); });
+}
+
+std::vector<std::string> TagSet::names() const {
+    std::vector<std::string> names;
+    names.reserve(size());
+    if (!ids_.empty()) {
+        auto& dict = dictionary();
+        std::lock_guard<internal::InstrumentedMutex> lock(dict.mutex);
+        for (auto id : ids_) {
+            names.push_back(dict.names[id]);
+        }
+    }
+    names.insert(names.end(), names_.begin(), names_.end());
+    return names;
+}
+
+bool operator==(const TagSet& a, const TagSet& b) {
+    if (a.names_.empty() && b.names_.empty()) {
+        return a.ids_ == b.ids_;
+    }
+    if (a.size() != b.size()) {
+        return false;
+    }
+    auto left = a.names();
+    auto right = b.names();
+    std::sort(left.begin(), left.end());
+    std::sort(right.begin(), right.end());
+    return left == right;
+}
+
+}
@@ -5,8 +5,10 @@
 #include "cmd_args.hpp"
 #include <nkeys/nkeys.hpp>
 #include <nlohmann/json.hpp>
+#include <chrono>
 #include <iostream>
 #include <fstream>
+#include <utility>
 #include <sstream>
 
 std::string readFile(const std::string& path) {
@@ -37,6 +39,7 @@ Commands:
     --decode              Decode and display JWT
     --verify              Verify JWT signature
     --generate-creds      Generate user credentials file
+    --generate-hierarchy  Generate a synthetic operator/account/user hierarchy
 
 Options:
     --version, -v         Show version
@@ -47,6 +50,18 @@ Options:
     --out <file>          Output file (default: stdout)
     --compact             Compact JSON output (for decode)
 
+Hierarchy options (for --generate-hierarchy):
+    --operators <n>       Operators (default: 1)
+    --accounts <n>        Accounts per operator (default: 1)
+    --signing-keys <n>    Signing keys per account (default: 0)
+    --revocations <n>     Revoked users per account (default: 0)
+    --users <n>           Users per account (default: 1)
+    --expiring <f>        Fraction of users with an expiry (default: 0.5)
+    --use-signing-keys    Sign users with the account signing keys
+    --seed <n>            Deterministic seed (default: 1)
+    --threads <n>         Worker threads (default: all cores)
+    --out-dir <dir>       Write JWTs, seeds and creds (default: in memory only)
+
 Examples:
     # Encode operator JWT (self-signed)
     jwt++ --encode --type operator --inkey operator.seed
@@ -65,6 +80,9 @@ Examples:
 
     # Generate user credentials file
     jwt++ --generate-creds --inkey user.seed user.jwt
+
+    # Generate 10 accounts with 1000 users each
+    jwt++ --generate-hierarchy --accounts 10 --users 1000 --seed 7 --out-dir ./hierarchy
 )";
 }
 
@@ -108,7 +126,7 @@ void encodeCommand(const cmd_args& args) {
 
         // Set optional fields if provided
         if (auto name = args.get("name")) {
-            claims.setName(*name);
+            claims.setName(std::move(*name));
         }
 
         jwt_string = claims.encode(signing_seed);
@@ -124,7 +142,7 @@ void encodeCommand(const cmd_args& args) {
         claims.setIssuer(*issuer_opt);
 
         if (auto name = args.get("name")) {
-            claims.setName(*name);
+            claims.setName(std::move(*name));
         }
 
         jwt_string = claims.encode(signing_seed);
@@ -140,7 +158,7 @@ void encodeCommand(const cmd_args& args) {
         claims.setIssuer(*issuer_opt);
 
         if (auto name = args.get("name")) {
-            claims.setName(*name);
+            claims.setName(std::move(*name));
         }
 
         if (auto issuer_acct = args.get("issuer-account")) {
@@ -282,6 +300,63 @@ void generateCredsCommand(const cmd_args& args) {
     }
 }
 
+std::size_t countOption(const cmd_args& args, const std::string& name, std::size_t fallback) {
+    auto value = args.get(name);
+    if (!value) {
+        return fallback;
+    }
+    try {
+        std::size_t pos = 0;
+        auto n = std::stoull(*value, &pos);
+        if (pos != value->size()) {
+            throw std::invalid_argument(*value);
+        }
+        return static_cast<std::size_t>(n);
+    } catch (const std::exception&) {
+        throw std::runtime_error("--" + name + " must be a non-negative integer, got '" + *value + "'");
+    }
+}
+
+void generateHierarchyCommand(const cmd_args& args) {
+    jwt::HierarchySpec spec;
+    spec.operators = countOption(args, "operators", spec.operators);
+    spec.accountsPerOperator = countOption(args, "accounts", spec.accountsPerOperator);
+    spec.signingKeysPerAccount = countOption(args, "signing-keys", spec.signingKeysPerAccount);
+    spec.revocationsPerAccount = countOption(args, "revocations", spec.revocationsPerAccount);
+    spec.usersPerAccount = countOption(args, "users", spec.usersPerAccount);
+    spec.seed = countOption(args, "seed", spec.seed);
+    spec.threads = static_cast<unsigned>(countOption(args, "threads", spec.threads));
+    spec.signUsersWithSigningKeys = args.get("use-signing-keys").has_value();
+
+    if (auto expiring = args.get("expiring")) {
+        try {
+            spec.expiringUserFraction = std::stod(*expiring);
+        } catch (const std::exception&) {
+            throw std::runtime_error("--expiring must be a number between 0 and 1, got '" + *expiring + "'");
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t accounts = spec.operators * spec.accountsPerOperator;
+    std::size_t users = accounts * spec.usersPerAccount;
+
+    auto out_opt = args.get("out-dir");
+    if (out_opt) {
+        jwt::generateHierarchy(spec, *out_opt);
+    } else {
+        auto hierarchy = jwt::generateHierarchy(spec);
+        users = hierarchy.userCount();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "Generated " << spec.operators << " operator(s), " << accounts << " account(s), "
+              << users << " user(s) in " << elapsed.count() << "s";
+    if (out_opt) {
+        std::cerr << " -> " << *out_opt;
+    }
+    std::cerr << "\n";
+}
+
 int main(int argc, char* argv[]) {
     try {
         auto args = cmd_args::parse(argc, argv);
@@ -305,6 +380,8 @@ int main(int argc, char* argv[]) {
             verifyCommand(args);
         } else if (args.get("generate-creds").has_value()) {
             generateCredsCommand(args);
+        } else if (args.get("generate-hierarchy").has_value()) {
+            generateHierarchyCommand(args);
         } else {
             std::cerr << "No command specified. Use --help for usage.\n";
             return 1;
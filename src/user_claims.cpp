@@ -2,6 +2,7 @@
 #include "jwt/jwt_constants.hpp"
 #include "base64url.hpp"
 #include "jwt_utils.hpp"
+#include "probes.hpp"
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <sstream>
@@ -10,41 +11,105 @@ namespace jwt {
 
 class UserClaims::Impl {
 public:
-    std::string subject_;
-    std::string issuer_;
+    PublicKey subject_;
+    PublicKey issuer_;
     std::optional<std::string> name_;
     std::int64_t issuedAt_ = 0;
     std::int64_t expires_ = 0;
-    std::optional<std::string> issuerAccount_;
+    TagSet tags_;
+    PublicKey issuerAccount_;
+    Permissions permissions_;
+    PermissionMatcher pubMatcher_;
+    PermissionMatcher subMatcher_;
+    NatsLimits limits_;
+    ConnectionRestrictions restrictions_;
+    ConnectionPolicy policy_;
 };
 
-UserClaims::UserClaims(const std::string& userPublicKey)
+UserClaims::UserClaims(std::string_view userPublicKey)
     : impl_(std::make_unique<Impl>()) {
-    impl_->subject_ = userPublicKey;
+    impl_->subject_ = PublicKey(userPublicKey);
 }
 
 UserClaims::~UserClaims() = default;
+UserClaims::UserClaims(const UserClaims& other) : impl_(std::make_unique<Impl>(*other.impl_)) {}
+UserClaims::UserClaims(UserClaims&& other) noexcept = default;
+UserClaims& UserClaims::operator=(const UserClaims& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<Impl>(*other.impl_);
+    }
+    return *this;
+}
+UserClaims& UserClaims::operator=(UserClaims&& other) noexcept = default;
 
-std::string UserClaims::subject() const { return impl_->subject_; }
-std::string UserClaims::issuer() const { return impl_->issuer_; }
+std::string UserClaims::subject() const { return impl_->subject_.str(); }
+std::string UserClaims::issuer() const { return impl_->issuer_.str(); }
+const PublicKey& UserClaims::subjectKey() const { return impl_->subject_; }
+const PublicKey& UserClaims::issuerKey() const { return impl_->issuer_; }
 std::optional<std::string> UserClaims::name() const { return impl_->name_; }
 std::int64_t UserClaims::issuedAt() const { return impl_->issuedAt_; }
 std::int64_t UserClaims::expires() const { return impl_->expires_; }
+const TagSet& UserClaims::tags() const { return impl_->tags_; }
 
-void UserClaims::setName(const std::string& name) { impl_->name_ = name; }
+void UserClaims::setName(std::string name) { impl_->name_ = std::move(name); }
 void UserClaims::setExpires(std::int64_t exp) { impl_->expires_ = exp; }
-void UserClaims::setIssuer(const std::string& issuerKey) { impl_->issuer_ = issuerKey; }
-void UserClaims::setIssuerAccount(const std::string& accountPublicKey) {
-    impl_->issuerAccount_ = accountPublicKey;
+void UserClaims::setIssuedAt(std::int64_t iat) { impl_->issuedAt_ = iat; }
+void UserClaims::setTags(TagSet tags) { impl_->tags_ = std::move(tags); }
+void UserClaims::addTag(std::string_view tag) { impl_->tags_.add(tag); }
+void UserClaims::setIssuer(std::string_view issuerKey) { impl_->issuer_ = PublicKey(issuerKey); }
+void UserClaims::setIssuerAccount(std::string_view accountPublicKey) {
+    impl_->issuerAccount_ = PublicKey(accountPublicKey);
 }
 std::optional<std::string> UserClaims::issuerAccount() const {
+    if (impl_->issuerAccount_.empty()) {
+        return std::nullopt;
+    }
+    return impl_->issuerAccount_.str();
+}
+const PublicKey& UserClaims::issuerAccountKey() const {
     return impl_->issuerAccount_;
 }
 
+void UserClaims::setPermissions(Permissions permissions) {
+    // Compile both before assigning so a bad pattern leaves the claims unchanged
+    PermissionMatcher pub(permissions.pub);
+    PermissionMatcher sub(permissions.sub);
+    impl_->permissions_ = std::move(permissions);
+    impl_->pubMatcher_ = std::move(pub);
+    impl_->subMatcher_ = std::move(sub);
+}
+const Permissions& UserClaims::permissions() const { return impl_->permissions_; }
+const PermissionMatcher& UserClaims::publishMatcher() const { return impl_->pubMatcher_; }
+const PermissionMatcher& UserClaims::subscribeMatcher() const { return impl_->subMatcher_; }
+bool UserClaims::canPublish(std::string_view subject) const { return impl_->pubMatcher_.allows(subject); }
+bool UserClaims::canSubscribe(std::string_view subject) const { return impl_->subMatcher_.allows(subject); }
+void UserClaims::setLimits(const NatsLimits& limits) { impl_->limits_ = limits; }
+const NatsLimits& UserClaims::limits() const { return impl_->limits_; }
+
+void UserClaims::setConnectionRestrictions(ConnectionRestrictions restrictions) {
+    ConnectionPolicy policy(restrictions);
+    impl_->restrictions_ = std::move(restrictions);
+    impl_->policy_ = std::move(policy);
+}
+const ConnectionRestrictions& UserClaims::connectionRestrictions() const { return impl_->restrictions_; }
+const ConnectionPolicy& UserClaims::connectionPolicy() const { return impl_->policy_; }
+bool UserClaims::canConnect(const IpAddress& address, ConnectionType type, int minuteOfDay) const {
+    return impl_->policy_.allows(address, type, minuteOfDay);
+}
+
 std::string UserClaims::encode(const std::string& seed) const {
+    return encode(Signer(seed));
+}
+
+std::string UserClaims::encode(const Signer& signer) const {
     using namespace internal;
     using json = nlohmann::json;
 
+    JWT_PROBE(encode__entry, PROBE_USER);
+    JWT_PROBE_RESULT(probe_result);
+    [[maybe_unused]] std::size_t probe_token_len = 0;
+    JWT_PROBE_ON_EXIT(probe_exit, encode__return, PROBE_USER, probe_result, probe_token_len);
+
     validate();
 
     // Auto-generate JTI and issuedAt
@@ -55,8 +120,8 @@ std::string UserClaims::encode(const std::string& seed) const {
     json payload = {
         {"jti", jti},
         {"iat", iat},
-        {"iss", impl_->issuer_},
-        {"sub", impl_->subject_}
+        {"iss", impl_->issuer_.str()},
+        {"sub", impl_->subject_.str()}
     };
 
     if (impl_->name_) {
@@ -71,39 +136,21 @@ std::string UserClaims::encode(const std::string& seed) const {
         {"type", "user"},
         {"version", JWT_VERSION}
     };
-    if (impl_->issuerAccount_) {
-        nats_claims["issuer_account"] = *impl_->issuerAccount_;
+    if (!impl_->issuerAccount_.empty()) {
+        nats_claims["issuer_account"] = impl_->issuerAccount_.str();
+    }
+    writePermissions(impl_->permissions_, nats_claims);
+    if (impl_->limits_ != NatsLimits{}) {
+        writeNatsLimits(impl_->limits_, nats_claims);
     }
+    writeConnectionRestrictions(impl_->restrictions_, nats_claims);
+    writeTags(impl_->tags_, nats_claims);
     payload["nats"] = nats_claims;
 
-    // Create JWT: header.payload.signature
-    std::string header_json = createHeader();
-    std::string payload_json = payload.dump();
-
-    // Convert strings to byte spans for encoding
-    std::span<const std::uint8_t> header_bytes(
-        reinterpret_cast<const std::uint8_t*>(header_json.data()),
-        header_json.size()
-    );
-    std::span<const std::uint8_t> payload_bytes(
-        reinterpret_cast<const std::uint8_t*>(payload_json.data()),
-        payload_json.size()
-    );
-
-    std::string header_b64 = base64url_encode(header_bytes);
-    std::string payload_b64 = base64url_encode(payload_bytes);
-
-    // Sign "header.payload"
-    std::string signing_input = header_b64 + "." + payload_b64;
-    std::span<const std::uint8_t> signing_bytes(
-        reinterpret_cast<const std::uint8_t*>(signing_input.data()),
-        signing_input.size()
-    );
-
-    auto signature_bytes = signData(seed, signing_bytes);
-    std::string signature_b64 = base64url_encode(signature_bytes);
-
-    return signing_input + "." + signature_b64;
+    std::string token = signJwt(payload.dump(), signer);
+    probe_result = PROBE_OK;
+    probe_token_len = token.size();
+    return token;
 }
 
 void UserClaims::validate() const {
@@ -113,10 +160,10 @@ void UserClaims::validate() const {
     if (impl_->issuer_.empty()) {
         throw std::invalid_argument("User issuer cannot be empty (must be signed by Account)");
     }
-    if (impl_->subject_[0] != 'U') {
+    if (impl_->subject_.prefix() != 'U') {
         throw std::invalid_argument("User subject must start with 'U'");
     }
-    if (impl_->issuer_[0] != 'A') {
+    if (impl_->issuer_.prefix() != 'A') {
         throw std::invalid_argument("User issuer must be an Account (start with 'A')");
     }
     if (impl_->expires_ > 0 && impl_->issuedAt_ > 0 &&
@@ -127,32 +174,25 @@ void UserClaims::validate() const {
 
 std::unique_ptr<UserClaims> decodeUserClaims(const std::string& jwt) {
     using namespace internal;
-    using json = nlohmann::json;
+
+    JWT_PROBE(decode__entry, jwt.size(), PROBE_USER);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, decode__return, PROBE_USER, probe_result);
 
     // Parse JWT into its three components
     auto parts = parseJwt(jwt);
 
     // Decode and validate header
-    auto header_bytes = base64url_decode(parts.header_b64);
-    std::string header_json(header_bytes.begin(), header_bytes.end());
-    auto header = json::parse(header_json);
-
-    if (!header.contains("alg") || header["alg"] != JWT_ALGORITHM) {
-        throw std::invalid_argument(
-            "Unsupported algorithm: expected '" + std::string(JWT_ALGORITHM) + "'"
-        );
-    }
+    decodeHeader(parts);
 
     // Decode and parse payload
-    auto payload_bytes = base64url_decode(parts.payload_b64);
-    std::string payload_json(payload_bytes.begin(), payload_bytes.end());
-    auto payload = json::parse(payload_json);
+    auto payload = decodePayload(parts);
 
     // Validate NATS-specific claims
     if (!payload.contains("nats")) {
         throw std::invalid_argument("Missing 'nats' object in JWT payload");
     }
-    auto nats = payload["nats"];
+    auto& nats = payload["nats"];
 
     if (!nats.contains("type") || nats["type"] != "user") {
         throw std::invalid_argument(
@@ -168,20 +208,20 @@ std::unique_ptr<UserClaims> decodeUserClaims(const std::string& jwt) {
     }
 
     // Extract required fields
-    std::string subject = payload.at("sub").get<std::string>();
-    std::string issuer = payload.at("iss").get<std::string>();
+    const auto& subject = payload.at("sub").get_ref<const std::string&>();
+    const auto& issuer = payload.at("iss").get_ref<const std::string&>();
     std::int64_t iat = payload.at("iat").get<std::int64_t>();
 
     // Create UserClaims object
     auto claims = std::make_unique<UserClaims>(subject);
 
     // Populate required fields (direct access via friend declaration)
-    claims->impl_->issuer_ = issuer;
+    claims->impl_->issuer_ = PublicKey(issuer);
     claims->impl_->issuedAt_ = iat;
 
     // Populate optional fields
     if (payload.contains("name")) {
-        claims->setName(payload["name"].get<std::string>());
+        claims->setName(std::move(payload["name"].get_ref<std::string&>()));
     }
 
     if (payload.contains("exp")) {
@@ -190,12 +230,29 @@ std::unique_ptr<UserClaims> decodeUserClaims(const std::string& jwt) {
 
     // Extract issuer_account if present
     if (nats.contains("issuer_account")) {
-        claims->setIssuerAccount(nats["issuer_account"].get<std::string>());
+        claims->impl_->issuerAccount_ = PublicKey(nats["issuer_account"].get_ref<const std::string&>());
     }
 
+    // Extract permissions; the matchers are compiled once here
+    if (auto permissions = readPermissions(nats); !permissions.empty()) {
+        claims->setPermissions(std::move(permissions));
+    }
+
+    // Extract limits (decoded in place, no allocation)
+    readNatsLimits(nats, claims->impl_->limits_);
+
+    // Networks, time windows and connection types are compiled once here
+    if (auto restrictions = readConnectionRestrictions(nats); !restrictions.empty()) {
+        claims->setConnectionRestrictions(std::move(restrictions));
+    }
+
+    // Tags become interned IDs
+    claims->impl_->tags_ = readTags(nats);
+
     // Validate the decoded claims
     claims->validate();
 
+    probe_result = PROBE_OK;
     return claims;
 }
 
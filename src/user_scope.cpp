@@ -0,0 +1,273 @@
+#include "jwt/user_scope.hpp"
+#include "jwt/user_claims.hpp"
+#include "subject.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace jwt {
+
+namespace {
+    /// Piece of a subject template: literal text or a placeholder
+    struct Segment {
+        enum class Kind : std::uint8_t { Literal, Name, Subject, Tag };
+        Kind kind;
+        std::string text;  // Literal text, or the "name:" prefix of a tag
+    };
+    using Template = std::vector<Segment>;
+
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && s.front() == ' ') s.remove_prefix(1);
+        while (!s.empty() && s.back() == ' ') s.remove_suffix(1);
+        return s;
+    }
+
+    Segment parsePlaceholder(std::string_view call, std::string_view subject) {
+        call = trim(call);
+        if (call == "name()") {
+            return {Segment::Kind::Name, {}};
+        }
+        if (call == "subject()") {
+            return {Segment::Kind::Subject, {}};
+        }
+        if (call.starts_with("tag(") && call.ends_with(")")) {
+            auto tagName = trim(call.substr(4, call.size() - 5));
+            if (!tagName.empty()) {
+                // Tags are stored lower-cased, so match the prefix the same way
+                std::string prefix;
+                for (char c : tagName) {
+                    prefix += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+                return {Segment::Kind::Tag, prefix + ":"};
+            }
+        }
+        throw std::invalid_argument("Unsupported template '{{" + std::string(call) + "}}' in subject '" +
+                                    std::string(subject) + "'");
+    }
+
+    Template parseTemplate(std::string_view subject) {
+        Template segments;
+        std::size_t pos = 0;
+        while (pos < subject.size()) {
+            auto open = subject.find("{{", pos);
+            if (open == std::string_view::npos) {
+                segments.push_back({Segment::Kind::Literal, std::string(subject.substr(pos))});
+                break;
+            }
+            if (open > pos) {
+                segments.push_back({Segment::Kind::Literal, std::string(subject.substr(pos, open - pos))});
+            }
+            auto close = subject.find("}}", open + 2);
+            if (close == std::string_view::npos) {
+                throw std::invalid_argument("Unterminated template in subject '" + std::string(subject) + "'");
+            }
+            segments.push_back(parsePlaceholder(subject.substr(open + 2, close - open - 2), subject));
+            pos = close + 2;
+        }
+        return segments;
+    }
+
+    bool hasPlaceholder(const Template& segments) {
+        return segments.size() != 1 || segments[0].kind != Segment::Kind::Literal;
+    }
+
+    /// Reject a value that would add tokens or wildcards to the subject it is substituted into
+    const std::string& checkValue(const std::string& value, std::string_view placeholder) {
+        if (value.empty()) {
+            throw std::invalid_argument("Template value for " + std::string(placeholder) + " is empty");
+        }
+        for (char c : value) {
+            if (c == '.' || c == '*' || c == '>' || std::isspace(static_cast<unsigned char>(c))) {
+                throw std::invalid_argument("Template value '" + value + "' for " + std::string(placeholder) +
+                                            " must be a single subject token without wildcards");
+            }
+        }
+        return value;
+    }
+
+    /// Expand a template for a user; a tag with several values yields several subjects
+    void expand(const Template& segments, const UserClaims& user, const std::vector<std::string>& tags,
+                std::vector<std::string>& out) {
+        std::vector<std::string> partial{std::string()};
+        for (const auto& segment : segments) {
+            std::vector<std::string> values;
+            switch (segment.kind) {
+                case Segment::Kind::Literal:
+                    values.push_back(segment.text);
+                    break;
+                case Segment::Kind::Name: {
+                    auto name = user.name();
+                    if (!name || name->empty()) {
+                        throw std::invalid_argument("Template uses {{name()}} but the user has no name");
+                    }
+                    values.push_back(checkValue(*name, "{{name()}}"));
+                    break;
+                }
+                case Segment::Kind::Subject:
+                    values.push_back(user.subjectKey().str());
+                    break;
+                case Segment::Kind::Tag:
+                    for (const auto& tag : tags) {
+                        if (tag.size() > segment.text.size() && tag.starts_with(segment.text)) {
+                            values.push_back(checkValue(tag.substr(segment.text.size()), "{{tag()}}"));
+                        }
+                    }
+                    if (values.empty()) {
+                        throw std::invalid_argument("Template uses tag '" +
+                                                    segment.text.substr(0, segment.text.size() - 1) +
+                                                    "' but the user has no such tag");
+                    }
+                    break;
+            }
+
+            std::vector<std::string> next;
+            next.reserve(partial.size() * values.size());
+            for (const auto& prefix : partial) {
+                for (const auto& value : values) {
+                    next.push_back(prefix + value);
+                }
+            }
+            partial = std::move(next);
+        }
+        out.insert(out.end(), std::make_move_iterator(partial.begin()), std::make_move_iterator(partial.end()));
+    }
+}
+
+class UserScope::Impl {
+public:
+    PublicKey key;
+    std::string role;
+    std::string description;
+    ScopeTemplate scopeTemplate;
+
+    // pub.allow, pub.deny, sub.allow, sub.deny
+    std::array<std::vector<Template>, 4> templates;
+    bool templated = false;
+    std::shared_ptr<const ResolvedPermissions> precompiled;  // Set when not templated
+
+    // What the templates read from a user, which is all a cache key needs
+    bool usesName = false;
+    bool usesSubject = false;
+    std::vector<std::string> tagPrefixes;
+
+    // Resolved permissions keyed by the user values the templates read. A
+    // plain mutex: scopes come and go with every account decode, too often
+    // for the process-wide lock registry.
+    mutable std::mutex mutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<const ResolvedPermissions>, internal::StringHash,
+                               std::equal_to<>> cache;
+
+    /// Cache key for a user: its subject, name and matching tags, each as used
+    /// and length-prefixed so no two users' values run together the same way
+    void cacheKey(const UserClaims& user, std::string& key) const {
+        auto append = [&key](std::string_view value) {
+            auto size = static_cast<std::uint32_t>(value.size());
+            key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            key.append(value);
+        };
+        key.clear();
+        append(usesSubject ? user.subjectKey().str() : std::string_view());
+        auto name = usesName ? user.name() : std::nullopt;
+        append(name ? std::string_view(*name) : std::string_view());
+        if (!tagPrefixes.empty()) {
+            for (const auto& tag : user.tags().names()) {
+                for (const auto& prefix : tagPrefixes) {
+                    if (tag.starts_with(prefix)) {
+                        append(tag);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    std::array<const std::vector<std::string>*, 4> lists() const {
+        const auto& p = scopeTemplate.permissions;
+        return {&p.pub.allow, &p.pub.deny, &p.sub.allow, &p.sub.deny};
+    }
+};
+
+UserScope::UserScope(PublicKey key, std::string role, ScopeTemplate scopeTemplate, std::string description) {
+    auto impl = std::make_shared<Impl>();
+    impl->key = std::move(key);
+    impl->role = std::move(role);
+    impl->description = std::move(description);
+    impl->scopeTemplate = std::move(scopeTemplate);
+
+    auto lists = impl->lists();
+    for (std::size_t i = 0; i < lists.size(); ++i) {
+        for (const auto& subject : *lists[i]) {
+            impl->templates[i].push_back(parseTemplate(subject));
+            impl->templated = impl->templated || hasPlaceholder(impl->templates[i].back());
+            for (const auto& segment : impl->templates[i].back()) {
+                impl->usesName = impl->usesName || segment.kind == Segment::Kind::Name;
+                impl->usesSubject = impl->usesSubject || segment.kind == Segment::Kind::Subject;
+                if (segment.kind == Segment::Kind::Tag &&
+                    std::find(impl->tagPrefixes.begin(), impl->tagPrefixes.end(), segment.text) ==
+                        impl->tagPrefixes.end()) {
+                    impl->tagPrefixes.push_back(segment.text);
+                }
+            }
+        }
+    }
+
+    if (!impl->templated) {
+        const auto& permissions = impl->scopeTemplate.permissions;
+        impl->precompiled = std::make_shared<const ResolvedPermissions>(ResolvedPermissions{
+            PermissionMatcher(permissions.pub), PermissionMatcher(permissions.sub), impl->scopeTemplate.limits});
+    }
+    impl_ = std::move(impl);
+}
+
+const PublicKey& UserScope::key() const { return impl_->key; }
+const std::string& UserScope::role() const { return impl_->role; }
+const std::string& UserScope::description() const { return impl_->description; }
+const ScopeTemplate& UserScope::scopeTemplate() const { return impl_->scopeTemplate; }
+bool UserScope::isTemplated() const { return impl_->templated; }
+
+std::shared_ptr<const ResolvedPermissions> UserScope::resolve(const UserClaims& user) const {
+    if (impl_->precompiled) {
+        return impl_->precompiled;
+    }
+
+    thread_local std::string key;
+    impl_->cacheKey(user, key);
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (auto it = impl_->cache.find(std::string_view(key)); it != impl_->cache.end()) {
+            return it->second;
+        }
+    }
+
+    std::vector<std::string> tags = user.tags().names();
+    std::array<std::vector<std::string>, 4> expanded;
+    for (std::size_t i = 0; i < expanded.size(); ++i) {
+        for (const auto& segments : impl_->templates[i]) {
+            expand(segments, user, tags, expanded[i]);
+        }
+    }
+    Permission pub{std::move(expanded[0]), std::move(expanded[1])};
+    Permission sub{std::move(expanded[2]), std::move(expanded[3])};
+    auto resolved = std::make_shared<const ResolvedPermissions>(
+        ResolvedPermissions{PermissionMatcher(pub), PermissionMatcher(sub), impl_->scopeTemplate.limits});
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->cache.size() >= MAX_CACHED_USERS) {
+        impl_->cache.clear();
+    }
+    impl_->cache.emplace(key, resolved);
+    return resolved;
+}
+
+bool operator==(const UserScope& a, const UserScope& b) {
+    return a.impl_->key == b.impl_->key && a.impl_->role == b.impl_->role &&
+           a.impl_->description == b.impl_->description && a.impl_->scopeTemplate == b.impl_->scopeTemplate;
+}
+
+}
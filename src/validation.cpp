@@ -3,6 +3,10 @@
 #include "jwt/operator_claims.hpp"
 #include "jwt/account_claims.hpp"
 #include "jwt/user_claims.hpp"
+#include "jwt/activation_claims.hpp"
+#include "metrics_internal.hpp"
+#include "probes.hpp"
+#include <algorithm>
 #include <chrono>
 #include <sstream>
 
@@ -21,9 +25,8 @@ namespace {
     /**
      * Get the claim type from subject key prefix
      */
-    std::string getClaimType(const std::string& subject) {
-        if (subject.empty()) return "unknown";
-        switch (subject[0]) {
+    std::string getClaimType(char prefix) {
+        switch (prefix) {
             case 'O': return "operator";
             case 'A': return "account";
             case 'U': return "user";
@@ -73,6 +76,8 @@ ValidationResult validateNotBefore(const Claims& claims, std::int64_t clockSkewS
 }
 
 ValidationResult validateTiming(const Claims& claims, const ValidationOptions& opts) {
+    JWT_METRICS_STAGE(stage, Timing);
+
     if (opts.checkNotBefore) {
         auto nbfResult = validateNotBefore(claims, opts.clockSkewSeconds);
         if (!nbfResult.valid) {
@@ -87,12 +92,13 @@ ValidationResult validateTiming(const Claims& claims, const ValidationOptions& o
         }
     }
 
+    JWT_METRICS_SUCCESS(stage);
     return ValidationResult::success();
 }
 
 ValidationResult validateIssuerChain(const Claims& child, const Claims& parent) {
-    std::string childIssuer = child.issuer();
-    std::string parentSubject = parent.subject();
+    const PublicKey& childIssuer = child.issuerKey();
+    const PublicKey& parentSubject = parent.subjectKey();
 
     if (childIssuer.empty()) {
         return ValidationResult::failure("Child issuer is empty");
@@ -102,7 +108,13 @@ ValidationResult validateIssuerChain(const Claims& child, const Claims& parent)
         return ValidationResult::failure("Parent subject is empty");
     }
 
-    if (childIssuer != parentSubject) {
+    // An account may also issue users with one of its signing keys
+    const auto* account = dynamic_cast<const AccountClaims*>(&parent);
+    bool signedByAccountKey = account != nullptr &&
+        std::find(account->signingKeyHandles().begin(), account->signingKeyHandles().end(), childIssuer) !=
+            account->signingKeyHandles().end();
+
+    if (childIssuer != parentSubject && !signedByAccountKey) {
         std::ostringstream oss;
         oss << "Issuer chain broken: child issuer '" << childIssuer
             << "' does not match parent subject '" << parentSubject << "'";
@@ -113,17 +125,17 @@ ValidationResult validateIssuerChain(const Claims& child, const Claims& parent)
 }
 
 ValidationResult validateKeyHierarchy(const Claims& child, const Claims& parent) {
-    std::string childSubject = child.subject();
-    std::string childIssuer = child.issuer();
-    std::string parentSubject = parent.subject();
+    const PublicKey& childSubject = child.subjectKey();
+    const PublicKey& childIssuer = child.issuerKey();
+    const PublicKey& parentSubject = parent.subjectKey();
 
     if (childSubject.empty() || childIssuer.empty() || parentSubject.empty()) {
         return ValidationResult::failure("Empty subject or issuer in key hierarchy validation");
     }
 
-    char childType = childSubject[0];
-    char issuerType = childIssuer[0];
-    char parentType = parentSubject[0];
+    char childType = childSubject.prefix();
+    char issuerType = childIssuer.prefix();
+    char parentType = parentSubject.prefix();
 
     // Verify issuer and parent have same type
     if (issuerType != parentType) {
@@ -145,121 +157,244 @@ ValidationResult validateKeyHierarchy(const Claims& child, const Claims& parent)
         // User signed by Account - OK
     } else {
         std::ostringstream oss;
-        oss << "Invalid hierarchy: " << getClaimType(childSubject)
-            << " cannot be signed by " << getClaimType(parentSubject);
+        oss << "Invalid hierarchy: " << getClaimType(childType)
+            << " cannot be signed by " << getClaimType(parentType);
         return ValidationResult::failure(oss.str());
     }
 
     return ValidationResult::success();
 }
 
-ValidationResult validate(const std::string& jwt, const ValidationOptions& opts) {
-    // Decode JWT
-    std::unique_ptr<Claims> claims;
-    try {
-        claims = decode(jwt);
-    } catch (const std::exception& e) {
+ValidationResult validateKeys(const Claims& claims) {
+    auto malformed = [](const char* role, const PublicKey& key) {
         std::ostringstream oss;
-        oss << "Failed to decode JWT: " << e.what();
+        oss << "Malformed " << role << " key '" << key << "' (bad encoding, type or checksum)";
         return ValidationResult::failure(oss.str());
-    }
+    };
 
-    // Check signature if requested
-    if (opts.checkSignature) {
-        bool valid = verify(jwt);
-        if (!valid) {
-            return ValidationResult::failure("Invalid JWT signature");
-        }
-    }
-
-    // Validate timing
-    auto timingResult = validateTiming(*claims, opts);
-    if (!timingResult.valid) {
-        return timingResult;
+    if (!claims.subjectKey().valid()) {
+        return malformed("subject", claims.subjectKey());
     }
-
-    // Perform structural validation
-    try {
-        claims->validate();
-    } catch (const std::exception& e) {
-        std::ostringstream oss;
-        oss << "Structural validation failed: " << e.what();
-        return ValidationResult::failure(oss.str());
+    if (!claims.issuerKey().valid()) {
+        return malformed("issuer", claims.issuerKey());
     }
 
-    return ValidationResult::success();
-}
-
-ValidationResult validate(const Claims& claims, const ValidationOptions& opts) {
-    // Validate timing
-    auto timingResult = validateTiming(claims, opts);
-    if (!timingResult.valid) {
-        return timingResult;
+    const std::vector<PublicKey>* signingKeys = nullptr;
+    if (const auto* op = dynamic_cast<const OperatorClaims*>(&claims)) {
+        signingKeys = &op->signingKeyHandles();
+    } else if (const auto* account = dynamic_cast<const AccountClaims*>(&claims)) {
+        signingKeys = &account->signingKeyHandles();
+    } else if (const auto* user = dynamic_cast<const UserClaims*>(&claims)) {
+        const PublicKey& issuerAccount = user->issuerAccountKey();
+        if (!issuerAccount.empty() && !issuerAccount.valid()) {
+            return malformed("issuer account", issuerAccount);
+        }
+    } else if (const auto* activation = dynamic_cast<const ActivationClaims*>(&claims)) {
+        const PublicKey& issuerAccount = activation->issuerAccountKey();
+        if (!issuerAccount.empty() && !issuerAccount.valid()) {
+            return malformed("issuer account", issuerAccount);
+        }
     }
-
-    // Perform structural validation
-    try {
-        claims.validate();
-    } catch (const std::exception& e) {
-        std::ostringstream oss;
-        oss << "Structural validation failed: " << e.what();
-        return ValidationResult::failure(oss.str());
+    if (signingKeys != nullptr) {
+        for (const auto& key : *signingKeys) {
+            if (!key.valid()) {
+                return malformed("signing", key);
+            }
+        }
     }
 
     return ValidationResult::success();
 }
 
-ValidationResult validateChain(const std::vector<std::string>& jwts, const ValidationOptions& opts) {
-    if (jwts.empty()) {
-        return ValidationResult::failure("Empty JWT chain");
-    }
-
-    // Decode all JWTs
-    std::vector<std::unique_ptr<Claims>> claimsChain;
-    for (size_t i = 0; i < jwts.size(); ++i) {
-        // Validate each JWT individually
-        auto result = validate(jwts[i], opts);
-        if (!result.valid) {
+namespace {
+    ValidationResult validateToken(const std::string& jwt, const ValidationOptions& opts) {
+        // Decode JWT
+        std::unique_ptr<Claims> claims;
+        try {
+            claims = decode(jwt);
+        } catch (const std::exception& e) {
             std::ostringstream oss;
-            oss << "JWT at index " << i << " failed validation: " << result.error.value_or("unknown error");
+            oss << "Failed to decode JWT: " << e.what();
             return ValidationResult::failure(oss.str());
         }
 
-        // Decode for chain validation
+        // Check signature if requested
+        if (opts.checkSignature) {
+            bool valid = verify(jwt);
+            if (!valid) {
+                return ValidationResult::failure("Invalid JWT signature");
+            }
+        }
+
+        // Validate timing
+        auto timingResult = validateTiming(*claims, opts);
+        if (!timingResult.valid) {
+            return timingResult;
+        }
+
+        // Perform structural validation
         try {
-            claimsChain.push_back(decode(jwts[i]));
+            claims->validate();
         } catch (const std::exception& e) {
             std::ostringstream oss;
-            oss << "Failed to decode JWT at index " << i << ": " << e.what();
+            oss << "Structural validation failed: " << e.what();
             return ValidationResult::failure(oss.str());
         }
+
+        if (opts.checkKeys) {
+            auto keysResult = validateKeys(*claims);
+            if (!keysResult.valid) {
+                return keysResult;
+            }
+        }
+
+        return ValidationResult::success(claims->expires());
     }
 
-    // Validate chain relationships if requested
-    if (opts.checkIssuerChain && claimsChain.size() > 1) {
-        for (size_t i = 1; i < claimsChain.size(); ++i) {
-            const Claims& child = *claimsChain[i];
-            const Claims& parent = *claimsChain[i - 1];
+    ValidationResult validateTokenChain(const std::vector<std::string>& jwts, const ValidationOptions& opts,
+                                        long& failedIndex) {
+        if (jwts.empty()) {
+            return ValidationResult::failure("Empty JWT chain");
+        }
+
+        // Decode all JWTs
+        std::vector<std::unique_ptr<Claims>> claimsChain;
+        for (size_t i = 0; i < jwts.size(); ++i) {
+            failedIndex = static_cast<long>(i);
 
-            // Validate issuer chain
-            auto chainResult = validateIssuerChain(child, parent);
-            if (!chainResult.valid) {
+            // Validate each JWT individually
+            auto result = validateToken(jwts[i], opts);
+            if (!result.valid) {
                 std::ostringstream oss;
-                oss << "Chain validation failed at index " << i << ": " << chainResult.error.value_or("unknown error");
+                oss << "JWT at index " << i << " failed validation: " << result.error.value_or("unknown error");
                 return ValidationResult::failure(oss.str());
             }
 
-            // Validate key hierarchy
-            auto hierarchyResult = validateKeyHierarchy(child, parent);
-            if (!hierarchyResult.valid) {
+            // Decode for chain validation
+            try {
+                claimsChain.push_back(decode(jwts[i]));
+            } catch (const std::exception& e) {
                 std::ostringstream oss;
-                oss << "Hierarchy validation failed at index " << i << ": " << hierarchyResult.error.value_or("unknown error");
+                oss << "Failed to decode JWT at index " << i << ": " << e.what();
                 return ValidationResult::failure(oss.str());
             }
         }
+
+        // Validate chain relationships if requested
+        if (opts.checkIssuerChain && claimsChain.size() > 1) {
+            for (size_t i = 1; i < claimsChain.size(); ++i) {
+                failedIndex = static_cast<long>(i);
+                const Claims& child = *claimsChain[i];
+                const Claims& parent = *claimsChain[i - 1];
+                JWT_METRICS_STAGE(stage, Hierarchy);
+
+                // Validate issuer chain
+                auto chainResult = validateIssuerChain(child, parent);
+                if (!chainResult.valid) {
+                    std::ostringstream oss;
+                    oss << "Chain validation failed at index " << i << ": " << chainResult.error.value_or("unknown error");
+                    return ValidationResult::failure(oss.str());
+                }
+
+                // Validate key hierarchy
+                auto hierarchyResult = validateKeyHierarchy(child, parent);
+                if (!hierarchyResult.valid) {
+                    std::ostringstream oss;
+                    oss << "Hierarchy validation failed at index " << i << ": " << hierarchyResult.error.value_or("unknown error");
+                    return ValidationResult::failure(oss.str());
+                }
+
+                // Reject users the account has revoked
+                const auto* account = dynamic_cast<const AccountClaims*>(&parent);
+                if (account != nullptr && !account->revocationKeys().empty()) {
+                    if (account->isRevoked(child.subjectKey(), child.issuedAt())) {
+                        std::ostringstream oss;
+                        oss << "Revocation check failed at index " << i << ": user '"
+                            << child.subjectKey() << "' has been revoked";
+                        return ValidationResult::failure(oss.str());
+                    }
+                }
+
+                // Users of a scoped signing key get their permissions from the scope only
+                const auto* user = dynamic_cast<const UserClaims*>(&child);
+                if (account != nullptr && user != nullptr && account->scopeFor(user->issuerKey()) != nullptr &&
+                    (!user->permissions().empty() || user->limits() != NatsLimits{})) {
+                    std::ostringstream oss;
+                    oss << "Scope check failed at index " << i << ": user signed by scoped key '"
+                        << user->issuerKey() << "' must not carry its own permissions or limits";
+                    return ValidationResult::failure(oss.str());
+                }
+                JWT_METRICS_SUCCESS(stage);
+            }
+        }
+
+        // The chain lapses with its first credential to expire
+        std::int64_t expiresAt = 0;
+        for (const auto& claims : claimsChain) {
+            std::int64_t exp = claims->expires();
+            if (exp != 0 && (expiresAt == 0 || exp < expiresAt)) {
+                expiresAt = exp;
+            }
+        }
+
+        failedIndex = -1;
+        return ValidationResult::success(expiresAt);
     }
+}
 
-    return ValidationResult::success();
+ValidationResult validate(const std::string& jwt, const ValidationOptions& opts) {
+    using namespace internal;
+
+    JWT_PROBE(validate__entry, jwt.size());
+    auto result = validateToken(jwt, opts);
+    JWT_PROBE(validate__return, result.valid ? PROBE_OK : PROBE_INVALID);
+    return result;
+}
+
+ValidationResult validate(const Claims& claims, const ValidationOptions& opts) {
+    using namespace internal;
+
+    JWT_PROBE(validate__entry, 0);
+    JWT_PROBE_RESULT(probe_result);
+    JWT_PROBE_ON_EXIT(probe_exit, validate__return, probe_result);
+
+    // Validate timing
+    auto timingResult = validateTiming(claims, opts);
+    if (!timingResult.valid) {
+        probe_result = PROBE_INVALID;
+        return timingResult;
+    }
+
+    // Perform structural validation
+    try {
+        claims.validate();
+    } catch (const std::exception& e) {
+        std::ostringstream oss;
+        oss << "Structural validation failed: " << e.what();
+        probe_result = PROBE_INVALID;
+        return ValidationResult::failure(oss.str());
+    }
+
+    if (opts.checkKeys) {
+        auto keysResult = validateKeys(claims);
+        if (!keysResult.valid) {
+            probe_result = PROBE_INVALID;
+            return keysResult;
+        }
+    }
+
+    probe_result = PROBE_OK;
+    return ValidationResult::success(claims.expires());
+}
+
+ValidationResult validateChain(const std::vector<std::string>& jwts, const ValidationOptions& opts) {
+    using namespace internal;
+
+    JWT_PROBE(validate_chain__entry, jwts.size());
+    long failedIndex = jwts.empty() ? 0 : -1;
+    auto result = validateTokenChain(jwts, opts, failedIndex);
+    JWT_PROBE(validate_chain__return, result.valid ? PROBE_OK : PROBE_INVALID, failedIndex);
+    return result;
 }
 
 }
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <chrono>
+#include <string>
+
+namespace {
+
+std::int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+struct Accounts {
+    std::unique_ptr<nkeys::KeyPair> exporter_kp = nkeys::CreateAccount();
+    std::unique_ptr<nkeys::KeyPair> signing_kp = nkeys::CreateAccount();
+    std::unique_ptr<nkeys::KeyPair> importer_kp = nkeys::CreateAccount();
+    jwt::AccountClaims exporter{exporter_kp->publicString()};
+    jwt::PublicKey importer{importer_kp->publicString()};
+
+    Accounts() {
+        exporter.setIssuer(nkeys::CreateOperator()->publicString());
+        exporter.addSigningKey(signing_kp->publicString());
+    }
+
+    jwt::ActivationClaims activation(std::string subject, jwt::ExportType type = jwt::ExportType::Service) const {
+        jwt::ActivationClaims claims(importer.str());
+        claims.setIssuer(exporter.subject());
+        claims.setImportSubject(std::move(subject));
+        claims.setImportType(type);
+        return claims;
+    }
+
+    jwt::Import import(std::string subject, jwt::ExportType type = jwt::ExportType::Service) const {
+        jwt::Import i;
+        i.subject = std::move(subject);
+        i.account = exporter.subjectKey();
+        i.type = type;
+        return i;
+    }
+};
+
+}
+
+TEST(ActivationTest, EncodeDecodeRoundTrip) {
+    Accounts accounts;
+    auto claims = accounts.activation("orders.*");
+    claims.setName("orders activation");
+    claims.setExpires(now() + 3600);
+    claims.addTag("billing");
+    auto token = claims.encode(accounts.exporter_kp->seedString());
+
+    auto decoded = jwt::decodeActivationClaims(token);
+    EXPECT_EQ(decoded->subjectKey(), accounts.importer);
+    EXPECT_EQ(decoded->issuerKey(), accounts.exporter.subjectKey());
+    EXPECT_EQ(decoded->exporterKey(), accounts.exporter.subjectKey());
+    EXPECT_EQ(decoded->importSubject(), "orders.*");
+    EXPECT_EQ(decoded->importType(), jwt::ExportType::Service);
+    EXPECT_EQ(decoded->name(), "orders activation");
+    EXPECT_EQ(decoded->expires(), claims.expires());
+    EXPECT_TRUE(decoded->tags().contains("billing"));
+    EXPECT_TRUE(jwt::verify(token));
+}
+
+TEST(ActivationTest, GenericDecodeDispatchesActivations) {
+    Accounts accounts;
+    auto token = accounts.activation("orders.>").encode(accounts.exporter_kp->seedString());
+
+    auto claims = jwt::decode(token);
+    auto* activation = dynamic_cast<jwt::ActivationClaims*>(claims.get());
+    ASSERT_NE(activation, nullptr);
+    EXPECT_EQ(activation->importSubject(), "orders.>");
+    EXPECT_TRUE(jwt::validate(token, jwt::ValidationOptions::strict()).valid);
+    EXPECT_THROW(static_cast<void>(jwt::decodeUserClaims(token)), std::invalid_argument);
+}
+
+TEST(ActivationTest, RejectsInvalidClaims) {
+    Accounts accounts;
+    auto seed = accounts.exporter_kp->seedString();
+
+    auto noSubject = accounts.activation("");
+    EXPECT_THROW(static_cast<void>(noSubject.encode(seed)), std::invalid_argument);
+
+    auto badSubject = accounts.activation("orders..x");
+    EXPECT_THROW(static_cast<void>(badSubject.encode(seed)), std::invalid_argument);
+
+    jwt::ActivationClaims userSubject("UABC123");
+    userSubject.setIssuer(accounts.exporter.subject());
+    userSubject.setImportSubject("orders");
+    EXPECT_THROW(userSubject.validate(), std::invalid_argument);
+}
+
+TEST(ActivationTest, CacheAuthorizesImports) {
+    Accounts accounts;
+    jwt::ActivationCache cache;
+    auto token = accounts.activation("orders.eu").encode(accounts.exporter_kp->seedString());
+    ASSERT_TRUE(cache.add(token, accounts.exporter).valid);
+    EXPECT_EQ(cache.size(), 1u);
+
+    EXPECT_TRUE(cache.authorizes(accounts.importer, accounts.import("orders.eu")));
+    EXPECT_FALSE(cache.authorizes(accounts.importer, accounts.import("orders.us")));
+    EXPECT_FALSE(cache.authorizes(accounts.importer, accounts.import("orders.eu", jwt::ExportType::Stream)));
+    EXPECT_FALSE(cache.authorizes(jwt::PublicKey("AOTHER"), accounts.import("orders.eu")));
+
+    auto wrongExporter = accounts.import("orders.eu");
+    wrongExporter.account = jwt::PublicKey("AOTHER");
+    EXPECT_FALSE(cache.authorizes(accounts.importer, wrongExporter));
+
+    EXPECT_TRUE(cache.remove(accounts.importer, accounts.exporter.subjectKey(), "orders.eu"));
+    EXPECT_FALSE(cache.authorizes(accounts.importer, accounts.import("orders.eu")));
+}
+
+TEST(ActivationTest, CacheKeepsOneEntryPerExporter) {
+    Accounts first;
+    Accounts second;
+    second.importer = first.importer;
+
+    jwt::ActivationCache cache;
+    ASSERT_TRUE(cache.add(first.activation("orders").encode(first.exporter_kp->seedString()), first.exporter).valid);
+    ASSERT_TRUE(cache.add(second.activation("orders", jwt::ExportType::Stream)
+                              .encode(second.exporter_kp->seedString()), second.exporter).valid);
+    EXPECT_EQ(cache.size(), 2u);
+
+    // Each exporter's activation authorizes only its own import
+    EXPECT_TRUE(cache.authorizes(first.importer, first.import("orders")));
+    EXPECT_TRUE(cache.authorizes(first.importer, second.import("orders", jwt::ExportType::Stream)));
+    EXPECT_FALSE(cache.authorizes(first.importer, second.import("orders")));
+
+    EXPECT_TRUE(cache.remove(first.importer, second.exporter.subjectKey(), "orders"));
+    EXPECT_TRUE(cache.authorizes(first.importer, first.import("orders")));
+    EXPECT_FALSE(cache.authorizes(first.importer, second.import("orders", jwt::ExportType::Stream)));
+}
+
+TEST(ActivationTest, CacheAcceptsExporterSigningKeys) {
+    Accounts accounts;
+    jwt::ActivationCache cache;
+
+    auto claims = accounts.activation("orders");
+    claims.setIssuer(accounts.signing_kp->publicString());
+    claims.setIssuerAccount(accounts.exporter.subject());
+    EXPECT_TRUE(cache.add(claims.encode(accounts.signing_kp->seedString()), accounts.exporter).valid);
+
+    // A key the exporter does not list is rejected
+    auto stranger_kp = nkeys::CreateAccount();
+    claims.setIssuer(stranger_kp->publicString());
+    auto result = cache.add(claims.encode(stranger_kp->seedString()), accounts.exporter);
+    EXPECT_FALSE(result.valid);
+    EXPECT_NE(result.error->find("not issued by"), std::string::npos);
+}
+
+TEST(ActivationTest, CacheRejectsBadTokens) {
+    Accounts accounts;
+    jwt::ActivationCache cache;
+
+    auto token = accounts.activation("orders").encode(accounts.exporter_kp->seedString());
+    auto tampered = token;
+    tampered[tampered.size() - 2] = tampered[tampered.size() - 2] == 'A' ? 'B' : 'A';
+    EXPECT_FALSE(cache.add(tampered, accounts.exporter).valid);
+
+    auto expired = accounts.activation("orders");
+    expired.setExpires(now() - 3600);
+    EXPECT_FALSE(cache.add(expired.encode(accounts.exporter_kp->seedString()), accounts.exporter).valid);
+
+    EXPECT_FALSE(cache.add("not.a.jwt", accounts.exporter).valid);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(ActivationTest, CacheEntriesExpire) {
+    Accounts accounts;
+    jwt::ActivationCache cache;
+    auto claims = accounts.activation("orders");
+    auto expires = now() + 60;
+    claims.setExpires(expires);
+    ASSERT_TRUE(cache.add(claims.encode(accounts.exporter_kp->seedString()), accounts.exporter).valid);
+
+    EXPECT_TRUE(cache.authorizes(accounts.importer, accounts.import("orders"), expires));
+    EXPECT_FALSE(cache.authorizes(accounts.importer, accounts.import("orders"), expires + 1));
+    EXPECT_EQ(cache.find(accounts.importer, accounts.exporter.subjectKey(), "orders", expires)->expires, expires);
+
+    EXPECT_EQ(cache.purgeExpired(expires), 0u);
+    EXPECT_EQ(cache.purgeExpired(expires + 1), 1u);
+    EXPECT_EQ(cache.size(), 0u);
+}
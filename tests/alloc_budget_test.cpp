@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include "alloc_tracker.hpp"
+#include <nkeys/nkeys.hpp>
+#include <array>
+#include <chrono>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+using jwt::testing::AllocationScope;
+using jwt::testing::CountingResource;
+using jwt::testing::countAllocations;
+
+// Hard per-call ceilings for the public API. They sit a few allocations above
+// today's counts (which vary slightly between nlohmann/json and nkeys-cpp
+// versions); lower them whenever an optimization lands, never raise them
+// without a reason in the commit message.
+namespace budget {
+    constexpr std::uint64_t kDecodeUser = 60;
+    constexpr std::uint64_t kDecodeAccount = 60;
+    constexpr std::uint64_t kDecodeGeneric = 100;
+    constexpr std::uint64_t kVerify = 44;
+    constexpr std::uint64_t kValidate = 140;
+    constexpr std::uint64_t kValidateChain = 720;
+    constexpr std::uint64_t kEncodeUser = 84;
+    constexpr std::uint64_t kRejectMalformed = 2;
+    constexpr std::uint64_t kFlatten = 1;
+}
+
+// ============================================================================
+// Test Fixture: one Operator -> Account -> User chain, built once
+// ============================================================================
+
+class AllocBudgetTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        auto operator_kp = nkeys::CreateOperator();
+        account_kp_ = nkeys::CreateAccount().release();
+        auto user_kp = nkeys::CreateUser();
+
+        jwt::OperatorClaims op(operator_kp->publicString());
+        op.setName("Budget Operator");
+        operator_jwt_ = op.encode(operator_kp->seedString());
+
+        jwt::AccountClaims acc(account_kp_->publicString());
+        acc.setIssuer(operator_kp->publicString());
+        acc.setName("Budget Account");
+        account_jwt_ = acc.encode(operator_kp->seedString());
+
+        user_ = new jwt::UserClaims(user_kp->publicString());
+        user_->setIssuer(account_kp_->publicString());
+        user_->setName("Budget User");
+        user_->setExpires(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() + 3600);
+        user_jwt_ = user_->encode(account_kp_->seedString());
+
+        // Warm one-time per-thread state (metrics block, key cache) so the
+        // budgets below measure steady-state calls
+        EXPECT_TRUE(jwt::validateChain({operator_jwt_, account_jwt_, user_jwt_}));
+    }
+
+    static void TearDownTestSuite() {
+        delete user_;
+        delete account_kp_;
+    }
+
+    static inline nkeys::KeyPair* account_kp_ = nullptr;
+    static inline jwt::UserClaims* user_ = nullptr;
+    static inline std::string operator_jwt_;
+    static inline std::string account_jwt_;
+    static inline std::string user_jwt_;
+};
+
+// ============================================================================
+// Facility Tests
+// ============================================================================
+
+TEST(AllocTrackerTest, ScopeCountsCallingThreadAllocations) {
+    AllocationScope scope;
+    auto p = std::make_unique<std::uint64_t[]>(64);
+    auto stats = scope.stats();
+
+    EXPECT_EQ(stats.count, 1);
+    EXPECT_GE(stats.bytes, 64 * sizeof(std::uint64_t));
+}
+
+TEST(AllocTrackerTest, ScopeIgnoresOtherThreads) {
+    AllocationScope scope;
+    std::thread worker([] {
+        std::vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < 100; ++i) v.push_back(std::make_unique<int>(i));
+    });
+    auto before_join = scope.stats().count;
+    worker.join();
+
+    // Creating the thread may allocate a little here, the 100+ ints must not show up
+    EXPECT_LT(scope.stats().count, 100);
+    EXPECT_LE(before_join, scope.stats().count);
+}
+
+TEST(AllocTrackerTest, NoAllocationForStackWork) {
+    std::array<char, 256> buf{};
+    std::size_t length = 0;
+    auto stats = countAllocations([&] {
+        buf.fill('x');
+        std::string small("short");  // fits the small string buffer
+        length = small.size();
+    });
+    EXPECT_EQ(buf[255], 'x');
+    EXPECT_EQ(length, 5);
+    EXPECT_EQ(stats.count, 0);
+    EXPECT_EQ(stats.bytes, 0);
+}
+
+TEST(AllocTrackerTest, CountingResourceTracksPmrContainers) {
+    CountingResource resource;
+    {
+        std::pmr::vector<std::pmr::string> v(&resource);
+        v.reserve(4);
+        v.emplace_back("a string long enough to defeat the small string buffer");
+        EXPECT_EQ(resource.allocations(), 2);
+        EXPECT_GT(resource.bytesInUse(), 0);
+    }
+    EXPECT_EQ(resource.deallocations(), 2);
+    EXPECT_EQ(resource.bytesInUse(), 0);
+    EXPECT_GE(resource.peakBytesInUse(), resource.bytesAllocated() / 2);
+}
+
+// ============================================================================
+// API Allocation Budgets
+// ============================================================================
+
+TEST_F(AllocBudgetTest, DecodeUserClaimsWithinBudget) {
+    auto stats = countAllocations([] { auto c = jwt::decodeUserClaims(user_jwt_); });
+    EXPECT_LE(stats.count, budget::kDecodeUser) << stats.bytes << " bytes";
+}
+
+TEST_F(AllocBudgetTest, DecodeAccountClaimsWithinBudget) {
+    auto stats = countAllocations([] { auto c = jwt::decodeAccountClaims(account_jwt_); });
+    EXPECT_LE(stats.count, budget::kDecodeAccount) << stats.bytes << " bytes";
+}
+
+TEST_F(AllocBudgetTest, GenericDecodeWithinBudget) {
+    auto stats = countAllocations([] { auto c = jwt::decode(user_jwt_); });
+    EXPECT_LE(stats.count, budget::kDecodeGeneric) << stats.bytes << " bytes";
+}
+
+TEST_F(AllocBudgetTest, VerifyWithinBudget) {
+    auto stats = countAllocations([] { EXPECT_TRUE(jwt::verify(user_jwt_)); });
+    EXPECT_LE(stats.count, budget::kVerify) << stats.bytes << " bytes";
+}
+
+TEST_F(AllocBudgetTest, WarmKeyCacheVerifyAllocatesLessThanCold) {
+    jwt::clearKeyCache();
+    auto cold = countAllocations([] { EXPECT_TRUE(jwt::verify(user_jwt_)); });
+    auto warm = countAllocations([] { EXPECT_TRUE(jwt::verify(user_jwt_)); });
+
+    EXPECT_LT(warm.count, cold.count);
+    EXPECT_EQ(jwt::keyCacheStats().hits, 1);
+}
+
+TEST_F(AllocBudgetTest, RepeatedVerifyIsSteadyState) {
+    auto first = countAllocations([] { EXPECT_TRUE(jwt::verify(user_jwt_)); });
+    for (int i = 0; i < 10; ++i) {
+        auto again = countAllocations([] { EXPECT_TRUE(jwt::verify(user_jwt_)); });
+        EXPECT_LE(again.count, first.count);
+    }
+}
+
+TEST_F(AllocBudgetTest, ValidateWithinBudget) {
+    auto stats = countAllocations([] { EXPECT_TRUE(jwt::validate(user_jwt_)); });
+    EXPECT_LE(stats.count, budget::kValidate) << stats.bytes << " bytes";
+}
+
+TEST_F(AllocBudgetTest, ValidateChainWithinBudget) {
+    std::vector<std::string> chain{operator_jwt_, account_jwt_, user_jwt_};
+    auto stats = countAllocations([&] {
+        EXPECT_TRUE(jwt::validateChain(chain, jwt::ValidationOptions::strict()));
+    });
+    EXPECT_LE(stats.count, budget::kValidateChain) << stats.bytes << " bytes";
+}
+
+TEST_F(AllocBudgetTest, EncodeUserWithinBudget) {
+    std::string seed = account_kp_->seedString();
+    auto stats = countAllocations([&] { auto token = user_->encode(seed); });
+    EXPECT_LE(stats.count, budget::kEncodeUser) << stats.bytes << " bytes";
+}
+
+TEST_F(AllocBudgetTest, FlattenedClaimsAreOneAllocation) {
+    auto user = jwt::decodeUserClaims(user_jwt_);
+    auto account = jwt::decodeAccountClaims(account_jwt_);
+    auto user_stats = countAllocations([&] { auto flat = jwt::FlatClaims::from(*user); });
+    auto account_stats = countAllocations([&] { auto flat = jwt::FlatClaims::from(*account); });
+    EXPECT_EQ(user_stats.count, budget::kFlatten);
+    EXPECT_EQ(account_stats.count, budget::kFlatten);
+}
+
+TEST_F(AllocBudgetTest, UserPermissionsDoNotAllocate) {
+    auto scoped_kp = nkeys::CreateAccount();
+    jwt::AccountClaims account(account_kp_->publicString());
+    jwt::ScopeTemplate scopeTemplate;
+    scopeTemplate.permissions.pub.allow = {"users.{{name()}}.>", "_INBOX.{{subject()}}.>"};
+    account.addScopedSigningKey(jwt::UserScope(jwt::PublicKey(scoped_kp->publicString()), "", scopeTemplate));
+
+    jwt::UserClaims scoped(*user_);
+    scoped.setIssuer(scoped_kp->publicString());
+    scoped.setName("budget");
+    ASSERT_TRUE(account.userPermissions(scoped).canPublish("users.budget.x"));
+
+    auto own = countAllocations([&] { auto permissions = account.userPermissions(*user_); });
+    auto cached = countAllocations([&] { auto permissions = account.userPermissions(scoped); });
+    EXPECT_EQ(own.count, 0u);
+    EXPECT_EQ(cached.count, 0u);
+}
+
+TEST_F(AllocBudgetTest, MalformedTokenRejectedCheaply) {
+    auto stats = countAllocations([] {
+        EXPECT_THROW(auto c = jwt::decode("a.b.c.d"), std::invalid_argument);
+    });
+    EXPECT_LE(stats.count, budget::kRejectMalformed);
+}
@@ -0,0 +1,85 @@
+#include "alloc_tracker.hpp"
+#include <cstdlib>
+#include <new>
+
+// Every replaceable allocation and deallocation function is replaced, so each
+// block is allocated and freed by the same malloc/free pair; a partial set
+// mixes this file's free() with the runtime's operator new under ASan.
+namespace {
+    // Plain thread_local PODs: safe to touch from inside operator new
+    thread_local std::uint64_t tl_count = 0;
+    thread_local std::uint64_t tl_bytes = 0;
+
+    void* countedAlloc(std::size_t size) {
+        ++tl_count;
+        tl_bytes += size;
+        if (void* p = std::malloc(size == 0 ? 1 : size)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+        ++tl_count;
+        tl_bytes += size;
+        auto alignment = static_cast<std::size_t>(align);
+        std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+        if (void* p = std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+namespace jwt::testing {
+
+AllocationStats threadAllocations() {
+    return AllocationStats{tl_count, tl_bytes};
+}
+
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlignedAlloc(size, align);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlignedAlloc(size, align);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
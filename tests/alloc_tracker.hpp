@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+
+namespace jwt::testing {
+
+/// Heap allocations observed while a scope or resource was active
+struct AllocationStats {
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+};
+
+/// Allocation totals for the calling thread since it started.
+/// Counted by the replacement global operator new in alloc_tracker.cpp,
+/// so only binaries that link that file observe non-zero values.
+AllocationStats threadAllocations();
+
+/**
+ * Counts global operator new calls made by the current thread while alive.
+ * Allocations from other threads are not included.
+ */
+class AllocationScope {
+public:
+    AllocationScope() : start_(threadAllocations()) {}
+
+    [[nodiscard]] AllocationStats stats() const {
+        auto now = threadAllocations();
+        return AllocationStats{now.count - start_.count, now.bytes - start_.bytes};
+    }
+
+private:
+    AllocationStats start_;
+};
+
+/// Run a callable and return the allocations it performed on this thread
+template <typename F>
+AllocationStats countAllocations(F&& fn) {
+    AllocationScope scope;
+    std::forward<F>(fn)();
+    return scope.stats();
+}
+
+/**
+ * std::pmr resource that forwards to an upstream resource and records
+ * allocation count, bytes and peak usage. Safe to share between threads.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+    [[nodiscard]] std::uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t deallocations() const { return deallocations_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t bytesAllocated() const { return bytes_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t bytesInUse() const { return inUse_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t peakBytesInUse() const { return peak_.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] AllocationStats stats() const { return AllocationStats{allocations(), bytesAllocated()}; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* p = upstream_->allocate(bytes, alignment);
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        auto inUse = inUse_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto peak = peak_.load(std::memory_order_relaxed);
+        while (inUse > peak && !peak_.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) {}
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        upstream_->deallocate(p, bytes, alignment);
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        inUse_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    std::atomic<std::uint64_t> allocations_{0};
+    std::atomic<std::uint64_t> deallocations_{0};
+    std::atomic<std::uint64_t> bytes_{0};
+    std::atomic<std::uint64_t> inUse_{0};
+    std::atomic<std::uint64_t> peak_{0};
+};
+
+}
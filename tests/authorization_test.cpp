@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <string>
+
+namespace {
+
+struct Callout {
+    std::unique_ptr<nkeys::KeyPair> server_kp = nkeys::CreateServer();
+    std::unique_ptr<nkeys::KeyPair> account_kp = nkeys::CreateAccount();
+    std::unique_ptr<nkeys::KeyPair> user_kp = nkeys::CreateUser();
+
+    jwt::AuthorizationRequestClaims request() const {
+        jwt::AuthorizationRequest body;
+        body.server.name = "n1";
+        body.server.id = server_kp->publicString();
+        body.server.tags = {"region:eu"};
+        body.userNkey = jwt::PublicKey(user_kp->publicString());
+        body.client.host = "10.0.0.7";
+        body.client.id = 42;
+        body.client.kind = "Client";
+        body.connect.username = "alice";
+        body.connect.password = "secret";
+        body.connect.protocol = 1;
+        body.requestNonce = "nonce";
+
+        jwt::AuthorizationRequestClaims claims(server_kp->publicString());
+        claims.setRequest(std::move(body));
+        return claims;
+    }
+};
+
+}
+
+TEST(AuthorizationTest, SignerMatchesSeed) {
+    auto account_kp = nkeys::CreateAccount();
+    jwt::Signer signer(account_kp->seedString());
+    EXPECT_EQ(signer.publicKey(), account_kp->publicString());
+
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    user.setIssuer(account_kp->publicString());
+    auto token = user.encode(signer);
+    EXPECT_TRUE(jwt::verify(token));
+    EXPECT_EQ(jwt::decodeUserClaims(token)->subjectKey(), user.subjectKey());
+
+    EXPECT_THROW(jwt::Signer("not-a-seed"), std::invalid_argument);
+}
+
+TEST(AuthorizationTest, EveryClaimTypeEncodesWithSigner) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    jwt::Signer operatorSigner(operator_kp->seedString());
+    jwt::Signer accountSigner(account_kp->seedString());
+
+    jwt::OperatorClaims op(operator_kp->publicString());
+    auto opToken = op.encode(operatorSigner);
+    EXPECT_TRUE(jwt::verify(opToken));
+    EXPECT_EQ(jwt::decodeOperatorClaims(opToken)->subjectKey(), op.subjectKey());
+
+    jwt::AccountClaims account(account_kp->publicString());
+    account.setIssuer(operator_kp->publicString());
+    auto accountToken = account.encode(operatorSigner);
+    EXPECT_TRUE(jwt::validateChain({opToken, accountToken}));
+
+    jwt::ActivationClaims activation(nkeys::CreateAccount()->publicString());
+    activation.setIssuer(account_kp->publicString());
+    activation.setImportSubject("orders.>");
+    activation.setImportType(jwt::ExportType::Stream);
+    auto activationToken = activation.encode(accountSigner);
+    EXPECT_TRUE(jwt::verify(activationToken));
+    EXPECT_EQ(jwt::decodeActivationClaims(activationToken)->importSubject(), "orders.>");
+}
+
+TEST(AuthorizationTest, RequestRoundTrip) {
+    Callout callout;
+    auto claims = callout.request();
+    auto token = claims.encode(callout.server_kp->seedString());
+    EXPECT_TRUE(jwt::verify(token));
+
+    auto decoded = jwt::decodeAuthorizationRequestClaims(token);
+    EXPECT_EQ(decoded->subjectKey(), callout.server_kp->publicString());
+    EXPECT_EQ(decoded->issuerKey(), decoded->subjectKey());
+    EXPECT_EQ(decoded->request(), claims.request());
+
+    auto generic = jwt::decode(token);
+    EXPECT_NE(dynamic_cast<jwt::AuthorizationRequestClaims*>(generic.get()), nullptr);
+}
+
+TEST(AuthorizationTest, RequestRequiresServerAndUserKeys) {
+    Callout callout;
+    jwt::AuthorizationRequestClaims noUser(callout.server_kp->publicString());
+    EXPECT_THROW(noUser.validate(), std::invalid_argument);
+
+    jwt::AuthorizationRequestClaims accountSubject(callout.account_kp->publicString());
+    auto body = callout.request().request();
+    accountSubject.setRequest(body);
+    EXPECT_THROW(accountSubject.validate(), std::invalid_argument);
+}
+
+TEST(AuthorizationTest, ResponseRoundTrip) {
+    Callout callout;
+    jwt::AuthorizationResponseClaims response(callout.user_kp->publicString());
+    response.setIssuer(callout.account_kp->publicString());
+    response.setAudience(callout.server_kp->publicString());
+    EXPECT_THROW(response.validate(), std::invalid_argument);  // Neither JWT nor error
+
+    response.setError("no such user");
+    auto token = response.encode(callout.account_kp->seedString());
+    auto decoded = jwt::decodeAuthorizationResponseClaims(token);
+    EXPECT_EQ(decoded->error(), "no such user");
+    EXPECT_TRUE(decoded->jwt().empty());
+    EXPECT_EQ(decoded->audience(), callout.server_kp->publicString());
+
+    response.setJwt("header.payload.signature");
+    EXPECT_THROW(response.validate(), std::invalid_argument);  // Both JWT and error
+
+    auto generic = jwt::decode(token);
+    EXPECT_NE(dynamic_cast<jwt::AuthorizationResponseClaims*>(generic.get()), nullptr);
+}
+
+TEST(AuthorizationTest, ResponderMintsUser) {
+    Callout callout;
+    auto request = callout.request().encode(callout.server_kp->seedString());
+    jwt::AuthorizationResponder responder(jwt::Signer(callout.account_kp->seedString()));
+
+    auto token = responder.respond(request, [](const jwt::AuthorizationRequestClaims& req, jwt::UserClaims& user) {
+        if (req.request().connect.password != "secret") {
+            throw std::runtime_error("bad password");
+        }
+        user.setName(req.request().connect.username);
+        user.setPermissions({{{"orders.>"}, {}}, {}});
+    });
+    EXPECT_TRUE(jwt::verify(token));
+
+    auto response = jwt::decodeAuthorizationResponseClaims(token);
+    EXPECT_EQ(response->subjectKey(), callout.user_kp->publicString());
+    EXPECT_EQ(response->issuerKey(), callout.account_kp->publicString());
+    EXPECT_EQ(response->audience(), callout.server_kp->publicString());
+    EXPECT_TRUE(response->error().empty());
+
+    EXPECT_TRUE(jwt::verify(response->jwt()));
+    auto user = jwt::decodeUserClaims(response->jwt());
+    EXPECT_EQ(user->subjectKey(), callout.user_kp->publicString());
+    EXPECT_EQ(user->issuerKey(), callout.account_kp->publicString());
+    EXPECT_EQ(user->name(), "alice");
+    EXPECT_TRUE(user->canPublish("orders.new"));
+    EXPECT_FALSE(user->canPublish("billing.new"));
+}
+
+TEST(AuthorizationTest, ResponderReportsDenial) {
+    Callout callout;
+    auto claims = callout.request();
+    auto body = claims.request();
+    body.connect.password = "wrong";
+    claims.setRequest(body);
+    auto request = claims.encode(callout.server_kp->seedString());
+
+    jwt::AuthorizationResponder responder(jwt::Signer(callout.account_kp->seedString()));
+    auto token = responder.respond(request, [](const jwt::AuthorizationRequestClaims& req, jwt::UserClaims&) {
+        if (req.request().connect.password != "secret") {
+            throw std::runtime_error("bad password");
+        }
+    });
+
+    auto response = jwt::decodeAuthorizationResponseClaims(token);
+    EXPECT_EQ(response->error(), "bad password");
+    EXPECT_TRUE(response->jwt().empty());
+}
+
+TEST(AuthorizationTest, ResponderUsesSigningKeys) {
+    Callout callout;
+    auto signing_kp = nkeys::CreateAccount();
+    auto request = callout.request().encode(callout.server_kp->seedString());
+    jwt::AuthorizationResponder responder(jwt::Signer(signing_kp->seedString()), callout.account_kp->publicString());
+
+    auto response = jwt::decodeAuthorizationResponseClaims(
+        responder.respond(request, [](const jwt::AuthorizationRequestClaims&, jwt::UserClaims&) {}));
+    EXPECT_EQ(response->issuerKey(), signing_kp->publicString());
+    EXPECT_EQ(response->issuerAccountKey(), callout.account_kp->publicString());
+
+    auto user = jwt::decodeUserClaims(response->jwt());
+    EXPECT_EQ(user->issuerKey(), signing_kp->publicString());
+    EXPECT_EQ(user->issuerAccountKey(), callout.account_kp->publicString());
+}
+
+TEST(AuthorizationTest, ResponderRejectsBadRequests) {
+    Callout callout;
+    jwt::AuthorizationResponder responder(jwt::Signer(callout.account_kp->seedString()));
+    auto allow = [](const jwt::AuthorizationRequestClaims&, jwt::UserClaims&) {};
+
+    // Signed by a different server than the one it claims to come from
+    auto forged = callout.request().encode(nkeys::CreateServer()->seedString());
+    EXPECT_THROW(static_cast<void>(responder.respond(forged, allow)), std::invalid_argument);
+
+    EXPECT_THROW(static_cast<void>(responder.respond("not.a.jwt", allow)), std::invalid_argument);
+    EXPECT_THROW(jwt::AuthorizationResponder(jwt::Signer(nkeys::CreateUser()->seedString())),
+                 std::invalid_argument);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string makeUserJwt(const std::string& name) {
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+    jwt::UserClaims claims(user_kp->publicString());
+    claims.setIssuer(account_kp->publicString());
+    claims.setName(name);
+    return claims.encode(account_kp->seedString());
+}
+
+}
+
+TEST(ClaimsSnapshotTest, DecodeKeepsClaimsAndToken) {
+    std::string token = makeUserJwt("snapshot user");
+    auto snapshot = jwt::decodeSnapshot(token);
+    auto decoded = jwt::decodeUserClaims(token);
+
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ(snapshot->token(), token);
+    EXPECT_EQ(snapshot->claims().type(), jwt::ClaimType::User);
+    EXPECT_EQ(snapshot->claims().subject(), decoded->subjectKey());
+    EXPECT_EQ(snapshot->claims().issuer(), decoded->issuerKey());
+    EXPECT_EQ(snapshot->claims().name(), "snapshot user");
+    EXPECT_EQ(snapshot->claims().issuedAt(), decoded->issuedAt());
+}
+
+TEST(ClaimsSnapshotTest, DecodesEveryTokenType) {
+    auto account_kp = nkeys::CreateAccount();
+    auto importer_kp = nkeys::CreateAccount();
+    auto signing_kp = nkeys::CreateAccount();
+
+    jwt::ActivationClaims activation(importer_kp->publicString());
+    activation.setIssuer(signing_kp->publicString());
+    activation.setIssuerAccount(account_kp->publicString());
+    activation.setImportSubject("orders.*");
+    activation.setName("orders");
+    auto snapshot = jwt::decodeSnapshot(activation.encode(signing_kp->seedString()));
+    EXPECT_EQ(snapshot->claims().type(), jwt::ClaimType::Activation);
+    EXPECT_EQ(snapshot->claims().subject(), activation.subjectKey());
+    EXPECT_EQ(snapshot->claims().issuerAccount(), activation.issuerAccountKey());
+    EXPECT_EQ(snapshot->claims().name(), "orders");
+
+    auto server_kp = nkeys::CreateServer();
+    jwt::AuthorizationRequest body;
+    body.server.name = "n1";
+    body.userNkey = jwt::PublicKey(nkeys::CreateUser()->publicString());
+    jwt::AuthorizationRequestClaims request(server_kp->publicString());
+    request.setRequest(std::move(body));
+    snapshot = jwt::decodeSnapshot(request.encode(server_kp->seedString()));
+    EXPECT_EQ(snapshot->claims().type(), jwt::ClaimType::AuthorizationRequest);
+    EXPECT_EQ(snapshot->claims().issuer(), request.issuerKey());
+
+    auto user_kp = nkeys::CreateUser();
+    jwt::AuthorizationResponseClaims response(user_kp->publicString());
+    response.setIssuer(account_kp->publicString());
+    response.setAudience(server_kp->publicString());
+    response.setError("denied");
+    snapshot = jwt::decodeSnapshot(response.encode(account_kp->seedString()));
+    EXPECT_EQ(snapshot->claims().type(), jwt::ClaimType::AuthorizationResponse);
+    EXPECT_EQ(snapshot->claims().subject(), response.subjectKey());
+}
+
+TEST(ClaimsSnapshotTest, RejectsMalformedTokens) {
+    EXPECT_THROW(auto s = jwt::decodeSnapshot("not.a.jwt"), std::invalid_argument);
+}
+
+TEST(ClaimsSnapshotTest, PointersShareOneSnapshot) {
+    auto snapshot = jwt::decodeSnapshot(makeUserJwt("shared"));
+    EXPECT_EQ(snapshot.useCount(), 1);
+    {
+        auto copy = snapshot;
+        EXPECT_EQ(copy, snapshot);
+        EXPECT_EQ(snapshot.useCount(), 2);
+        auto moved = std::move(copy);
+        EXPECT_FALSE(copy);
+        EXPECT_EQ(snapshot.useCount(), 2);
+    }
+    EXPECT_EQ(snapshot.useCount(), 1);
+
+    jwt::ClaimsSnapshot::Ptr empty;
+    EXPECT_FALSE(empty);
+    EXPECT_EQ(empty.useCount(), 0);
+}
+
+TEST(ClaimsSnapshotTest, ConcurrentReadersAndReleases) {
+    std::string token = makeUserJwt("concurrent");
+    auto snapshot = jwt::decodeSnapshot(token);
+    std::size_t before = jwt::internedPublicKeyCount();
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, local = snapshot] {
+            for (int i = 0; i < 1000; ++i) {
+                auto copy = local;
+                if (copy->token() != token || copy->claims().name() != "concurrent") {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(snapshot.useCount(), 1);
+    snapshot = jwt::ClaimsSnapshot::Ptr();
+    EXPECT_EQ(jwt::internedPublicKeyCount(), before - 2);  // Subject and issuer released
+}
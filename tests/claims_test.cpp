@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 #include "jwt/claims.hpp"
+#include "jwt/jwt_constants.hpp"
 #include "jwt/operator_claims.hpp"
 #include "jwt/account_claims.hpp"
 #include "jwt/user_claims.hpp"
 #include <nkeys/nkeys.hpp>
+#include <string>
+#include <vector>
 
 // ============================================================================
 // OperatorClaims Tests
@@ -61,6 +64,39 @@ TEST(OperatorClaimsTest, AddSigningKeysWorks) {
     EXPECT_EQ(claims.signingKeys()[1], "OXYZ789");
 }
 
+TEST(OperatorClaimsTest, SetSigningKeysReplacesKeys) {
+    auto kp = nkeys::CreateOperator();
+    jwt::OperatorClaims claims(kp->publicString());
+    claims.addSigningKey("OOLD");
+
+    std::vector<std::string> keys{nkeys::CreateOperator()->publicString(), "OABC123"};
+    std::string first = keys[0];
+    claims.setSigningKeys(std::move(keys));
+
+    ASSERT_EQ(claims.signingKeys().size(), 2);
+    EXPECT_EQ(claims.signingKeys()[0], first);
+    EXPECT_EQ(claims.signingKeys()[1], "OABC123");
+}
+
+TEST(OperatorClaimsTest, CopyAndMove) {
+    auto kp = nkeys::CreateOperator();
+    jwt::OperatorClaims original(kp->publicString());
+    original.setName("Operator");
+    original.addSigningKey("OABC123");
+
+    jwt::OperatorClaims copy(original);
+    copy.setName("Changed");
+    EXPECT_EQ(original.name(), "Operator");
+    EXPECT_EQ(copy.signingKeys(), original.signingKeys());
+
+    jwt::OperatorClaims moved(std::move(copy));
+    EXPECT_EQ(moved.name(), "Changed");
+    EXPECT_EQ(moved.subject(), kp->publicString());
+
+    copy = original;  // Moved-from objects can be assigned again
+    EXPECT_EQ(copy.name(), "Operator");
+}
+
 TEST(OperatorClaimsTest, IssuedAtDefaultsToZero) {
     auto kp = nkeys::CreateOperator();
     jwt::OperatorClaims claims(kp->publicString());
@@ -164,6 +200,38 @@ TEST(AccountClaimsTest, AddSigningKeysWorks) {
     EXPECT_EQ(claims.signingKeys()[0], "AABC123");
 }
 
+TEST(AccountClaimsTest, RevocationsWork) {
+    auto kp = nkeys::CreateAccount();
+    jwt::AccountClaims claims(kp->publicString());
+
+    EXPECT_TRUE(claims.revocations().empty());
+
+    claims.addRevocation("UABC123", 1000);
+    EXPECT_EQ(claims.revocations().size(), 1);
+    EXPECT_TRUE(claims.isRevoked("UABC123", 999));
+    EXPECT_TRUE(claims.isRevoked("UABC123", 1000));
+    EXPECT_FALSE(claims.isRevoked("UABC123", 1001));
+    EXPECT_FALSE(claims.isRevoked("UXYZ789", 999));
+
+    claims.addRevocation(jwt::ALL_USERS_REVOCATION, 500);
+    EXPECT_TRUE(claims.isRevoked("UXYZ789", 500));
+    EXPECT_FALSE(claims.isRevoked("UXYZ789", 501));
+}
+
+TEST(AccountClaimsTest, RevocationsRoundTrip) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+
+    jwt::AccountClaims claims(account_kp->publicString());
+    claims.setIssuer(operator_kp->publicString());
+    claims.addRevocation(user_kp->publicString(), 1234567890);
+
+    auto decoded = jwt::decodeAccountClaims(claims.encode(operator_kp->seedString()));
+    ASSERT_EQ(decoded->revocations().size(), 1);
+    EXPECT_EQ(decoded->revocations().at(user_kp->publicString()), 1234567890);
+}
+
 TEST(AccountClaimsTest, ValidateFailsForEmptySubject) {
     jwt::AccountClaims claims("");
     auto operator_kp = nkeys::CreateOperator();
@@ -199,6 +267,27 @@ TEST(AccountClaimsTest, ValidateFailsForNonOperatorIssuer) {
     EXPECT_THROW(claims.validate(), std::invalid_argument);
 }
 
+TEST(AccountClaimsTest, CopyAndMove) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+    jwt::AccountClaims original(account_kp->publicString());
+    original.setIssuer(operator_kp->publicString());
+    original.addRevocation(user_kp->publicString(), 100);
+
+    jwt::AccountClaims copy = original;
+    copy.addRevocation(jwt::ALL_USERS_REVOCATION, 200);
+    EXPECT_EQ(original.revocations().size(), 1);
+    EXPECT_EQ(copy.revocations().size(), 2);
+
+    std::vector<jwt::AccountClaims> stored;
+    stored.push_back(std::move(copy));
+    stored.push_back(original);
+    EXPECT_TRUE(stored[0].isRevoked(user_kp->publicString(), 150));
+    EXPECT_FALSE(stored[1].isRevoked(user_kp->publicString(), 150));
+    EXPECT_EQ(stored[1].issuer(), operator_kp->publicString());
+}
+
 // ============================================================================
 // UserClaims Tests
 // ============================================================================
@@ -301,6 +390,26 @@ TEST(UserClaimsTest, ValidateFailsForNonAccountIssuer) {
     EXPECT_THROW(claims.validate(), std::invalid_argument);
 }
 
+TEST(UserClaimsTest, CopyAndMove) {
+    auto user_kp = nkeys::CreateUser();
+    auto account_kp = nkeys::CreateAccount();
+    std::string name(64, 'n');  // Longer than the small string buffer
+
+    jwt::UserClaims original(user_kp->publicString());
+    original.setIssuer(account_kp->publicString());
+    original.setName(std::move(name));
+    original.setIssuerAccount(account_kp->publicString());
+
+    jwt::UserClaims moved = std::move(original);
+    EXPECT_EQ(moved.name(), std::string(64, 'n'));
+    EXPECT_EQ(moved.issuerAccount(), account_kp->publicString());
+
+    jwt::UserClaims copy(moved);
+    original = std::move(copy);
+    EXPECT_EQ(original.subject(), user_kp->publicString());
+    EXPECT_NO_THROW(original.validate());
+}
+
 // ============================================================================
 // Integration Tests - Trust Hierarchy
 // ============================================================================
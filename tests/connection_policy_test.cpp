@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <string>
+
+namespace {
+
+jwt::IpAddress ip(std::string_view text) {
+    auto parsed = jwt::IpAddress::parse(text);
+    EXPECT_TRUE(parsed.has_value()) << text;
+    return parsed.value_or(jwt::IpAddress{});
+}
+
+}
+
+TEST(ConnectionPolicyTest, ParsesAddresses) {
+    auto v4 = ip("192.168.1.20");
+    EXPECT_FALSE(v4.v6);
+    EXPECT_EQ(v4.bytes[0], 192);
+    EXPECT_EQ(v4.bytes[3], 20);
+
+    auto v6 = ip("2001:db8::1");
+    EXPECT_TRUE(v6.v6);
+    EXPECT_EQ(v6.bytes[0], 0x20);
+    EXPECT_EQ(v6.bytes[1], 0x01);
+    EXPECT_EQ(v6.bytes[15], 1);
+    EXPECT_EQ(ip("::"), ip("0:0:0:0:0:0:0:0"));
+    EXPECT_EQ(ip("64:ff9b::1.2.3.4").bytes[12], 1);
+
+    // IPv4-mapped IPv6 is treated as IPv4
+    EXPECT_EQ(ip("::ffff:10.0.0.1"), ip("10.0.0.1"));
+
+    for (auto bad : {"", "1.2.3", "1.2.3.4.5", "256.1.1.1", "01.2.3.4", "1::2::3", "12345::", "1:2:3:4:5:6:7:8:9",
+                     "1:2:3:4:5:6:7", "::1.2.3", "g::1"}) {
+        EXPECT_FALSE(jwt::IpAddress::parse(bad).has_value()) << bad;
+    }
+}
+
+TEST(ConnectionPolicyTest, CidrSetMatchesPrefixes) {
+    jwt::CidrSet set({"10.0.0.0/8", "192.168.1.0/26", "172.16.5.7", "2001:db8:aa00::/40", "::ffff:100.64.0.0/106"});
+    EXPECT_TRUE(set.contains("10.255.1.2"));
+    EXPECT_FALSE(set.contains("11.0.0.1"));
+    EXPECT_TRUE(set.contains("192.168.1.63"));
+    EXPECT_FALSE(set.contains("192.168.1.64"));
+    EXPECT_TRUE(set.contains("172.16.5.7"));
+    EXPECT_FALSE(set.contains("172.16.5.6"));
+    EXPECT_TRUE(set.contains("2001:db8:aaff::1"));
+    EXPECT_FALSE(set.contains("2001:db8:ab00::1"));
+    EXPECT_TRUE(set.contains("100.127.255.255"));
+    EXPECT_FALSE(set.contains("100.128.0.0"));
+    EXPECT_FALSE(set.contains("not-an-ip"));
+
+    // A prefix inside a shorter one adds no nodes
+    auto before = jwt::CidrSet({"10.0.0.0/8"}).nodeCount();
+    EXPECT_EQ(jwt::CidrSet({"10.1.2.0/24", "10.0.0.0/8"}).nodeCount(), before);
+
+    EXPECT_TRUE(jwt::CidrSet({"0.0.0.0/0"}).contains("8.8.8.8"));
+    EXPECT_FALSE(jwt::CidrSet({"0.0.0.0/0"}).contains("::1"));
+    EXPECT_TRUE(jwt::CidrSet().empty());
+
+    EXPECT_THROW(jwt::CidrSet({"10.0.0.0/33"}), std::invalid_argument);
+    EXPECT_THROW(jwt::CidrSet({"10.0.0/8"}), std::invalid_argument);
+    EXPECT_THROW(jwt::CidrSet({"::ffff:1.2.3.4/64"}), std::invalid_argument);
+}
+
+TEST(ConnectionPolicyTest, CidrSetMatchesManyNetworks) {
+    std::vector<std::string> networks;
+    for (int i = 0; i < 500; ++i) {
+        networks.push_back("10." + std::to_string(i / 4) + "." + std::to_string((i % 4) * 64) + ".0/18");
+    }
+    jwt::CidrSet set(networks);
+    EXPECT_TRUE(set.contains("10.124.200.1"));
+    EXPECT_FALSE(set.contains("10.125.0.1"));
+    EXPECT_FALSE(set.contains("9.0.0.1"));
+}
+
+TEST(ConnectionPolicyTest, TimeWindowsUseWholeMinutes) {
+    jwt::ConnectionRestrictions restrictions;
+    restrictions.times = {{"08:00:30", "12:00:00"}, {"11:00:00", "13:30:59"}, {"22:00:00", "02:00:00"}};
+    jwt::ConnectionPolicy policy(restrictions);
+
+    // 08:00:30 rounds up to 08:01; 12:00 overlaps the next window; 13:30:59 covers minute 13:30
+    std::vector<jwt::MinuteInterval> expected = {{0, 120}, {481, 811}, {1320, 1440}};
+    EXPECT_EQ(policy.timeWindows(), expected);
+    EXPECT_FALSE(policy.allowsMinute(480));
+    EXPECT_TRUE(policy.allowsMinute(481));
+    EXPECT_TRUE(policy.allowsMinute(810));
+    EXPECT_FALSE(policy.allowsMinute(811));
+    EXPECT_TRUE(policy.allowsMinute(1439));
+    EXPECT_TRUE(policy.allowsMinute(0));
+    EXPECT_FALSE(policy.allowsMinute(120));
+    EXPECT_FALSE(policy.allowsMinute(1440));
+
+    EXPECT_EQ(jwt::minuteOfDay(86400 + 3600 + 59), 60);
+    EXPECT_EQ(jwt::minuteOfDay(0, -60), 1439);
+
+    restrictions.times = {{"8:00", "9:00:00"}};
+    EXPECT_THROW(jwt::ConnectionPolicy{restrictions}, std::invalid_argument);
+    restrictions.times = {{"24:00:00", "01:00:00"}};
+    EXPECT_THROW(jwt::ConnectionPolicy{restrictions}, std::invalid_argument);
+}
+
+TEST(ConnectionPolicyTest, ConnectionTypesBecomeMask) {
+    jwt::ConnectionPolicy unrestricted;
+    EXPECT_TRUE(unrestricted.allowsType(jwt::ConnectionType::Mqtt));
+    EXPECT_TRUE(unrestricted.allowsAddress("1.2.3.4"));
+    EXPECT_TRUE(unrestricted.allowsMinute(5));
+
+    jwt::ConnectionRestrictions restrictions;
+    restrictions.connectionTypes = {"STANDARD", "WEBSOCKET", "SOMETHING_NEW"};
+    jwt::ConnectionPolicy policy(restrictions);
+    EXPECT_EQ(policy.typeMask(), 0b11u);
+    EXPECT_TRUE(policy.allowsType(jwt::ConnectionType::Websocket));
+    EXPECT_FALSE(policy.allowsType(jwt::ConnectionType::Leafnode));
+
+    restrictions.connectionTypes = {"SOMETHING_NEW"};
+    EXPECT_FALSE(jwt::ConnectionPolicy(restrictions).allowsType(jwt::ConnectionType::Standard));
+
+    EXPECT_EQ(jwt::connectionTypeName(jwt::ConnectionType::LeafnodeWebsocket), "LEAFNODE_WS");
+    EXPECT_EQ(jwt::parseConnectionType("IN_PROCESS"), jwt::ConnectionType::InProcess);
+    EXPECT_FALSE(jwt::parseConnectionType("standard").has_value());
+}
+
+TEST(ConnectionPolicyTest, UserRoundTrip) {
+    auto account_kp = nkeys::CreateAccount();
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    user.setIssuer(account_kp->publicString());
+
+    jwt::ConnectionRestrictions restrictions;
+    restrictions.src = {"192.168.0.0/16", "2001:db8::/32"};
+    restrictions.times = {{"09:00:00", "17:00:00"}};
+    restrictions.timesLocation = "Europe/Berlin";
+    restrictions.connectionTypes = {"STANDARD"};
+    user.setConnectionRestrictions(restrictions);
+
+    auto decoded = jwt::decodeUserClaims(user.encode(account_kp->seedString()));
+    EXPECT_EQ(decoded->connectionRestrictions(), restrictions);
+    EXPECT_EQ(decoded->connectionPolicy().timesLocation(), "Europe/Berlin");
+    EXPECT_TRUE(decoded->canConnect(ip("192.168.3.4"), jwt::ConnectionType::Standard, 10 * 60));
+    EXPECT_FALSE(decoded->canConnect(ip("192.169.3.4"), jwt::ConnectionType::Standard, 10 * 60));
+    EXPECT_FALSE(decoded->canConnect(ip("192.168.3.4"), jwt::ConnectionType::Websocket, 10 * 60));
+    EXPECT_FALSE(decoded->canConnect(ip("192.168.3.4"), jwt::ConnectionType::Standard, 17 * 60));
+    EXPECT_TRUE(decoded->canConnect(ip("2001:db8:1::5"), jwt::ConnectionType::Standard, 9 * 60));
+
+    // A bad network leaves the claims unchanged
+    restrictions.src = {"bogus"};
+    EXPECT_THROW(user.setConnectionRestrictions(restrictions), std::invalid_argument);
+    EXPECT_EQ(user.connectionRestrictions().src.size(), 2u);
+}
+
+TEST(ConnectionPolicyTest, DecodesCommaSeparatedSrc) {
+    auto account_kp = nkeys::CreateAccount();
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    user.setIssuer(account_kp->publicString());
+    auto generic = jwt::decodeGenericClaims(user.encode(account_kp->seedString()));
+    auto nats = std::string(*generic->field("nats"));
+    nats.insert(1, R"("src":"10.0.0.0/8, 192.168.1.1",)");
+    generic->setField("nats", nats);
+
+    auto decoded = jwt::decodeUserClaims(generic->encode(account_kp->seedString()));
+    std::vector<std::string> expected = {"10.0.0.0/8", "192.168.1.1"};
+    EXPECT_EQ(decoded->connectionRestrictions().src, expected);
+    EXPECT_TRUE(decoded->connectionPolicy().allowsAddress("192.168.1.1"));
+    EXPECT_FALSE(decoded->connectionPolicy().allowsAddress("192.168.1.2"));
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kNow = 1'700'000'000;
+
+std::vector<jwt::ExpiryScheduler::Id> ids(const std::vector<jwt::ExpiryScheduler::Expired>& expired) {
+    std::vector<jwt::ExpiryScheduler::Id> out;
+    for (const auto& entry : expired) {
+        out.push_back(entry.id);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+}
+
+TEST(ExpirySchedulerTest, FiresOnceExpired) {
+    jwt::ExpiryScheduler scheduler(kNow);
+    scheduler.schedule(1, kNow + 10);
+    scheduler.schedule(2, kNow + 300);
+    scheduler.schedule(3, 0);
+    EXPECT_EQ(scheduler.size(), 3u);
+
+    // A credential is still valid at its exp second
+    EXPECT_TRUE(scheduler.advance(kNow + 10).empty());
+    auto expired = scheduler.advance(kNow + 11);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].id, 1u);
+    EXPECT_EQ(expired[0].expiresAt, kNow + 10);
+
+    EXPECT_EQ(ids(scheduler.advance(kNow + 100'000)), std::vector<jwt::ExpiryScheduler::Id>{2});
+    EXPECT_EQ(scheduler.size(), 1u);  // Never expires
+    EXPECT_EQ(scheduler.now(), kNow + 100'000);
+
+    // Already expired entries fire on the next advance
+    scheduler.schedule(4, kNow);
+    EXPECT_EQ(ids(scheduler.advance(kNow + 100'000)), std::vector<jwt::ExpiryScheduler::Id>{4});
+}
+
+TEST(ExpirySchedulerTest, CancelAndReschedule) {
+    jwt::ExpiryScheduler scheduler(kNow);
+    auto a = scheduler.schedule(1, kNow + 60);
+    auto b = scheduler.schedule(2, kNow + 60);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(scheduler.expiresAt(a), kNow + 60);
+
+    EXPECT_TRUE(scheduler.cancel(a));
+    EXPECT_FALSE(scheduler.cancel(a));
+    EXPECT_EQ(scheduler.expiresAt(a), 0);
+
+    EXPECT_TRUE(scheduler.reschedule(b, kNow + 5000));
+    EXPECT_TRUE(scheduler.advance(kNow + 61).empty());
+    EXPECT_EQ(ids(scheduler.advance(kNow + 5001)), std::vector<jwt::ExpiryScheduler::Id>{2});
+
+    // Handles of fired entries stay dead after their slot is reused
+    auto c = scheduler.schedule(3, kNow + 6000);
+    EXPECT_FALSE(scheduler.reschedule(b, kNow + 7000));
+    EXPECT_FALSE(scheduler.cancel(b));
+    EXPECT_TRUE(scheduler.cancel(c));
+    EXPECT_EQ(scheduler.size(), 0u);
+    EXPECT_FALSE(scheduler.cancel(0));
+}
+
+TEST(ExpirySchedulerTest, MatchesBruteForceAcrossLevels) {
+    std::mt19937_64 random(7);
+    jwt::ExpiryScheduler scheduler(kNow);
+    std::map<jwt::ExpiryScheduler::Id, std::int64_t> pending;
+    for (jwt::ExpiryScheduler::Id id = 1; id <= 5000; ++id) {
+        // Spread over seconds to years so every level of the wheel is used
+        std::int64_t span = std::int64_t{1} << (random() % 27);
+        std::int64_t exp = kNow + static_cast<std::int64_t>(random() % static_cast<std::uint64_t>(span));
+        scheduler.schedule(id, exp);
+        pending[id] = exp;
+    }
+
+    std::int64_t now = kNow;
+    while (!pending.empty()) {
+        now += static_cast<std::int64_t>(random() % 200'000);
+        std::vector<jwt::ExpiryScheduler::Id> expected;
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (it->second < now) {
+                expected.push_back(it->first);
+                it = pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        auto expired = scheduler.advance(now);
+        for (const auto& entry : expired) {
+            EXPECT_LT(entry.expiresAt, now);
+        }
+        ASSERT_EQ(ids(expired), expected) << "at " << now;
+    }
+    EXPECT_EQ(scheduler.size(), 0u);
+}
+
+TEST(ExpirySchedulerTest, AccountUpdateMovesDependents) {
+    auto account = jwt::PublicKey(nkeys::CreateAccount()->publicString());
+    auto other = jwt::PublicKey(nkeys::CreateAccount()->publicString());
+
+    jwt::ExpiryScheduler scheduler(kNow);
+    auto u1 = scheduler.schedule(1, kNow + 1000, account);
+    auto u2 = scheduler.schedule(2, 0, account);
+    auto u3 = scheduler.schedule(3, kNow + 1000, other);
+
+    // Shortening the account pulls both of its users in
+    EXPECT_EQ(scheduler.updateAccount(account, kNow + 100), 2u);
+    EXPECT_EQ(scheduler.expiresAt(u1), kNow + 100);
+    EXPECT_EQ(scheduler.expiresAt(u2), kNow + 100);
+    EXPECT_EQ(scheduler.expiresAt(u3), kNow + 1000);
+
+    // A renewed account JWT gives them back their own expiry
+    EXPECT_EQ(scheduler.updateAccount(account, kNow + 5000), 2u);
+    EXPECT_EQ(scheduler.expiresAt(u1), kNow + 1000);
+    EXPECT_EQ(scheduler.expiresAt(u2), kNow + 5000);
+    EXPECT_TRUE(scheduler.advance(kNow + 101).empty());
+
+    // Users scheduled later inherit the account's expiry
+    auto u4 = scheduler.schedule(4, kNow + 9000, account);
+    EXPECT_EQ(scheduler.expiresAt(u4), kNow + 5000);
+
+    EXPECT_EQ(ids(scheduler.advance(kNow + 1001)), (std::vector<jwt::ExpiryScheduler::Id>{1, 3}));
+    EXPECT_EQ(ids(scheduler.advance(kNow + 5001)), (std::vector<jwt::ExpiryScheduler::Id>{2, 4}));
+    EXPECT_EQ(scheduler.updateAccount(account, 0), 0u);
+    EXPECT_THROW(scheduler.updateAccount(jwt::PublicKey{}, kNow), std::invalid_argument);
+}
+
+TEST(ExpirySchedulerTest, SchedulesValidationResults) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+    std::int64_t now = jwt::ExpiryScheduler().now();
+
+    jwt::OperatorClaims op(operator_kp->publicString());
+    jwt::AccountClaims acc(account_kp->publicString());
+    acc.setIssuer(operator_kp->publicString());
+    acc.setExpires(now + 600);
+    jwt::UserClaims user(user_kp->publicString());
+    user.setIssuer(account_kp->publicString());
+    user.setExpires(now + 3600);
+    auto op_jwt = op.encode(operator_kp->seedString());
+    auto acc_jwt = acc.encode(operator_kp->seedString());
+    auto user_jwt = user.encode(account_kp->seedString());
+
+    auto userResult = jwt::validate(user_jwt);
+    ASSERT_TRUE(userResult);
+    EXPECT_EQ(userResult.expiresAt, now + 3600);
+    EXPECT_EQ(jwt::validate(op_jwt).expiresAt, 0);
+    auto chainResult = jwt::validateChain({op_jwt, acc_jwt, user_jwt});
+    ASSERT_TRUE(chainResult);
+    EXPECT_EQ(chainResult.expiresAt, now + 600);
+
+    jwt::ExpiryScheduler scheduler(now);
+    EXPECT_EQ(scheduler.expiresAt(scheduler.schedule(1, chainResult)), now + 600);
+
+    auto handle = scheduler.schedule(2, userResult, acc.subjectKey());
+    EXPECT_EQ(scheduler.updateAccount(acc), 1u);
+    EXPECT_EQ(scheduler.expiresAt(handle), now + 600);
+
+    EXPECT_THROW(scheduler.schedule(3, jwt::ValidationResult::failure("bad")), std::invalid_argument);
+}
+
+TEST(ExpirySchedulerTest, CallbacksMayScheduleMore) {
+    jwt::ExpiryScheduler scheduler(kNow);
+    for (jwt::ExpiryScheduler::Id id = 0; id < 100; ++id) {
+        scheduler.schedule(id, kNow + static_cast<std::int64_t>(id));
+    }
+
+    std::vector<jwt::ExpiryScheduler::Id> fired;
+    auto count = scheduler.advance(kNow + 50, [&](const jwt::ExpiryScheduler::Expired& entry) {
+        fired.push_back(entry.id);
+        scheduler.schedule(1000 + entry.id, kNow + 1000);
+    });
+    EXPECT_EQ(count, 50u);
+    EXPECT_TRUE(std::is_sorted(fired.begin(), fired.end()));
+    EXPECT_EQ(scheduler.size(), 100u);
+    EXPECT_EQ(scheduler.advance(kNow + 1001).size(), 100u);
+}
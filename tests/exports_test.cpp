@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+jwt::Export stream(const std::string& subject, const std::string& name = "") {
+    return jwt::Export{name, subject, jwt::ExportType::Stream, false};
+}
+
+jwt::Export service(const std::string& subject, const std::string& name = "") {
+    return jwt::Export{name, subject, jwt::ExportType::Service, false};
+}
+
+}
+
+TEST(ExportsTest, FindsLiteralAndWildcardExports) {
+    jwt::ExportIndex index({stream("orders.created", "created"), stream("metrics.*.cpu", "cpu"),
+                            stream("logs.>", "logs")});
+
+    ASSERT_NE(index.find("orders.created", jwt::ExportType::Stream), nullptr);
+    EXPECT_EQ(index.find("orders.created", jwt::ExportType::Stream)->name, "created");
+    EXPECT_EQ(index.find("metrics.host1.cpu", jwt::ExportType::Stream)->name, "cpu");
+    EXPECT_EQ(index.find("logs.app.error", jwt::ExportType::Stream)->name, "logs");
+    EXPECT_EQ(index.find("orders.deleted", jwt::ExportType::Stream), nullptr);
+    EXPECT_EQ(index.find("logs", jwt::ExportType::Stream), nullptr);
+    EXPECT_EQ(index.find("orders..created", jwt::ExportType::Stream), nullptr);
+}
+
+TEST(ExportsTest, PrefersMostSpecificExport) {
+    jwt::ExportIndex index({stream("orders.>", "all"), stream("orders.*.created", "any-region"),
+                            stream("orders.eu.created", "eu")});
+
+    EXPECT_EQ(index.find("orders.eu.created", jwt::ExportType::Stream)->name, "eu");
+    EXPECT_EQ(index.find("orders.us.created", jwt::ExportType::Stream)->name, "any-region");
+    EXPECT_EQ(index.find("orders.us.deleted", jwt::ExportType::Stream)->name, "all");
+}
+
+TEST(ExportsTest, WildcardSubjectsMustBeCovered) {
+    jwt::ExportIndex index({stream("orders.*"), stream("logs.>")});
+
+    EXPECT_NE(index.find("orders.*", jwt::ExportType::Stream), nullptr);
+    EXPECT_EQ(index.find("orders.>", jwt::ExportType::Stream), nullptr);
+    EXPECT_NE(index.find("logs.*.error", jwt::ExportType::Stream), nullptr);
+    EXPECT_NE(index.find("logs.>", jwt::ExportType::Stream), nullptr);
+}
+
+TEST(ExportsTest, FiltersByType) {
+    jwt::ExportIndex index({stream("events.>", "events"), service("events.lookup", "lookup")});
+
+    EXPECT_EQ(index.find("events.lookup", jwt::ExportType::Service)->name, "lookup");
+    EXPECT_EQ(index.find("events.lookup", jwt::ExportType::Stream)->name, "events");
+    EXPECT_EQ(index.find("events.other", jwt::ExportType::Service), nullptr);
+}
+
+TEST(ExportsTest, RejectsMalformedExportSubjects) {
+    EXPECT_THROW(jwt::ExportIndex({stream("")}), std::invalid_argument);
+    EXPECT_THROW(jwt::ExportIndex({stream("orders.>.x")}), std::invalid_argument);
+}
+
+TEST(ExportsTest, RoundTripPreservesExportsAndImports) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto exporter_kp = nkeys::CreateAccount();
+
+    jwt::AccountClaims claims(account_kp->publicString());
+    claims.setIssuer(operator_kp->publicString());
+    claims.setExports({stream("orders.>", "orders"), jwt::Export{"", "rpc.lookup", jwt::ExportType::Service, true}});
+    jwt::Import import{"prices", "prices.eu", jwt::PublicKey(exporter_kp->publicString()), "activation-jwt",
+                       "local.prices", jwt::ExportType::Stream};
+    claims.setImports({import});
+
+    auto decoded = jwt::decodeAccountClaims(claims.encode(operator_kp->seedString()));
+    EXPECT_EQ(decoded->exports(), claims.exports());
+    ASSERT_EQ(decoded->imports().size(), 1u);
+    EXPECT_EQ(decoded->imports()[0], import);
+    EXPECT_TRUE(decoded->exports()[1].tokenRequired);
+    EXPECT_EQ(decoded->exportIndex().find("orders.eu", jwt::ExportType::Stream)->name, "orders");
+}
+
+TEST(ExportsTest, ValidateRejectsImportWithoutAccount) {
+    jwt::AccountClaims claims("AABC123");
+    claims.setIssuer("OABC123");
+    claims.setImports({jwt::Import{"", "prices", jwt::PublicKey(), "", "", jwt::ExportType::Stream}});
+    EXPECT_THROW(claims.validate(), std::invalid_argument);
+}
+
+TEST(ExportsTest, RegistryResolvesImportsAcrossAccounts) {
+    jwt::AccountClaims exporter("AEXPORTER");
+    exporter.setExports({stream("prices.>", "prices"), service("rpc.*", "rpc")});
+    jwt::AccountClaims other("AOTHER");
+    other.setExports({stream("orders.>", "orders")});
+
+    jwt::ExportRegistry registry;
+    registry.update(exporter);
+    registry.update(other);
+    EXPECT_EQ(registry.size(), 2u);
+
+    jwt::Import import{"", "prices.eu", jwt::PublicKey("AEXPORTER"), "", "", jwt::ExportType::Stream};
+    auto match = registry.resolve(import);
+    ASSERT_TRUE(match);
+    EXPECT_EQ(match->name, "prices");
+
+    import.type = jwt::ExportType::Service;
+    EXPECT_FALSE(registry.resolve(import));
+    import.account = jwt::PublicKey("AUNKNOWN");
+    EXPECT_FALSE(registry.resolve(import));
+}
+
+TEST(ExportsTest, RegistryUpdateReplacesAccount) {
+    jwt::AccountClaims exporter("AEXPORTER");
+    exporter.setExports({stream("prices.>", "v1")});
+    jwt::ExportRegistry registry;
+    registry.update(exporter);
+
+    jwt::Import import{"", "prices.eu", jwt::PublicKey("AEXPORTER"), "", "", jwt::ExportType::Stream};
+    auto before = registry.resolve(import);
+
+    exporter.setExports({stream("prices.eu", "v2")});
+    registry.update(exporter);
+    EXPECT_EQ(registry.resolve(import)->name, "v2");
+    EXPECT_EQ(before->name, "v1");  // Earlier matches keep their index alive
+
+    EXPECT_TRUE(registry.remove(jwt::PublicKey("AEXPORTER")));
+    EXPECT_FALSE(registry.resolve(import));
+    EXPECT_FALSE(registry.remove(jwt::PublicKey("AEXPORTER")));
+}
+
+TEST(ExportsTest, LargeExportSets) {
+    std::vector<jwt::Export> exports;
+    for (int i = 0; i < 5000; ++i) {
+        exports.push_back(service("svc." + std::to_string(i) + ".*", std::to_string(i)));
+    }
+    jwt::ExportIndex index(std::move(exports));
+
+    EXPECT_EQ(index.find("svc.4321.lookup", jwt::ExportType::Service)->name, "4321");
+    EXPECT_EQ(index.find("svc.5000.lookup", jwt::ExportType::Service), nullptr);
+}
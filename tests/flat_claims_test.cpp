@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <string>
+#include <vector>
+
+TEST(FlatClaimsTest, FlattensUserClaims) {
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+    jwt::UserClaims user(user_kp->publicString());
+    user.setIssuer(account_kp->publicString());
+    user.setIssuerAccount(account_kp->publicString());
+    user.setName("A user name long enough to need its own heap buffer");
+    user.setExpires(9999999999);
+
+    auto decoded = jwt::decodeUserClaims(user.encode(account_kp->seedString()));
+    auto flat = jwt::FlatClaims::from(*decoded);
+
+    EXPECT_EQ(flat->type(), jwt::ClaimType::User);
+    EXPECT_EQ(flat->subject(), decoded->subjectKey());
+    EXPECT_EQ(flat->issuer(), decoded->issuerKey());
+    EXPECT_EQ(flat->issuerAccount(), account_kp->publicString());
+    EXPECT_EQ(flat->name(), decoded->name());
+    EXPECT_EQ(flat->issuedAt(), decoded->issuedAt());
+    EXPECT_EQ(flat->expires(), 9999999999);
+    EXPECT_TRUE(flat->signingKeys().empty());
+    EXPECT_TRUE(flat->revocations().empty());
+    EXPECT_EQ(flat->allocationSize(), sizeof(jwt::FlatClaims) + decoded->name()->size());
+}
+
+TEST(FlatClaimsTest, FlattensAccountSigningKeysAndRevocations) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    jwt::AccountClaims account(account_kp->publicString());
+    account.setIssuer(operator_kp->publicString());
+
+    std::vector<std::string> users;
+    for (int i = 0; i < 20; ++i) {
+        users.push_back(nkeys::CreateUser()->publicString());
+        account.addRevocation(users.back(), 1000 + i);
+    }
+    for (int i = 0; i < 3; ++i) {
+        account.addSigningKey(nkeys::CreateAccount()->publicString());
+    }
+
+    auto flat = jwt::FlatClaims::from(static_cast<const jwt::Claims&>(account));
+
+    EXPECT_EQ(flat->type(), jwt::ClaimType::Account);
+    EXPECT_FALSE(flat->name().has_value());
+    ASSERT_EQ(flat->signingKeys().size(), 3);
+    for (std::size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(flat->signingKeys()[i], account.signingKeyHandles()[i]);
+    }
+    EXPECT_EQ(flat->revocations().size(), 20);
+    for (int i = 0; i < 20; ++i) {
+        jwt::PublicKey key(users[i]);
+        EXPECT_TRUE(flat->isRevoked(key, 1000 + i));
+        EXPECT_FALSE(flat->isRevoked(key, 1001 + i));
+        EXPECT_EQ(flat->isRevoked(key, 500), account.isRevoked(key, 500));
+    }
+    EXPECT_FALSE(flat->isRevoked(jwt::PublicKey(nkeys::CreateUser()->publicString()), 0));
+}
+
+TEST(FlatClaimsTest, AllUsersRevocationApplies) {
+    auto account_kp = nkeys::CreateAccount();
+    jwt::AccountClaims account(account_kp->publicString());
+    account.addRevocation(jwt::ALL_USERS_REVOCATION, 2000);
+
+    auto flat = jwt::FlatClaims::from(account);
+    jwt::PublicKey user(nkeys::CreateUser()->publicString());
+    EXPECT_TRUE(flat->isRevoked(user, 1999));
+    EXPECT_FALSE(flat->isRevoked(user, 2001));
+}
+
+TEST(FlatClaimsTest, FlattensOperatorClaims) {
+    auto operator_kp = nkeys::CreateOperator();
+    jwt::OperatorClaims op(operator_kp->publicString());
+    op.setName("Operator");
+    op.addSigningKey(nkeys::CreateOperator()->publicString());
+
+    auto flat = jwt::FlatClaims::from(op);
+    EXPECT_EQ(flat->type(), jwt::ClaimType::Operator);
+    EXPECT_EQ(flat->subject(), flat->issuer());
+    EXPECT_EQ(flat->name(), "Operator");
+    ASSERT_EQ(flat->signingKeys().size(), 1);
+    EXPECT_EQ(flat->signingKeys()[0], op.signingKeyHandles()[0]);
+    EXPECT_TRUE(flat->issuerAccount().empty());
+}
+
+TEST(FlatClaimsTest, FlatClaimsHoldKeyReferences) {
+    auto user_kp = nkeys::CreateUser();
+    std::size_t before = jwt::internedPublicKeyCount();
+    jwt::FlatClaims::Ptr flat;
+    {
+        jwt::UserClaims user(user_kp->publicString());
+        flat = jwt::FlatClaims::from(user);
+    }
+    EXPECT_EQ(flat->subject(), user_kp->publicString());
+    EXPECT_EQ(jwt::internedPublicKeyCount(), before + 1);
+    flat.reset();
+    EXPECT_EQ(jwt::internedPublicKeyCount(), before);
+}
+
+TEST(FlatClaimsTest, CarriesTags) {
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    user.setTags({"prod", "Team:Red"});
+    auto flat = jwt::FlatClaims::from(user);
+    EXPECT_EQ(flat->tags(), user.tags());
+    EXPECT_TRUE(flat->tags().contains("team:red"));
+    EXPECT_FALSE(flat->tags().contains("dev"));
+}
+
+TEST(FlatClaimsTest, SharesPermissionMatchers) {
+    auto account_kp = nkeys::CreateAccount();
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    user.setIssuer(account_kp->publicString());
+    user.setPermissions({{{"orders.>"}, {"orders.admin"}}, {{"_INBOX.>"}, {}}});
+    auto flat = jwt::FlatClaims::from(*jwt::decodeUserClaims(user.encode(account_kp->seedString())));
+
+    EXPECT_TRUE(flat->canPublish("orders.created"));
+    EXPECT_FALSE(flat->canPublish("orders.admin"));
+    EXPECT_TRUE(flat->canSubscribe("_INBOX.x"));
+    EXPECT_FALSE(flat->canSubscribe("orders.created"));
+    EXPECT_TRUE(jwt::FlatClaims::from(jwt::OperatorClaims(nkeys::CreateOperator()->publicString()))
+                    ->canPublish("anything"));
+}
+
+TEST(FlatClaimsTest, SharesConnectionPolicy) {
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    jwt::ConnectionRestrictions restrictions;
+    restrictions.src = {"10.0.0.0/8"};
+    user.setConnectionRestrictions(restrictions);
+    auto flat = jwt::FlatClaims::from(user);
+
+    EXPECT_TRUE(flat->canConnect(*jwt::IpAddress::parse("10.1.2.3"), jwt::ConnectionType::Standard, 0));
+    EXPECT_FALSE(flat->canConnect(*jwt::IpAddress::parse("192.168.0.1"), jwt::ConnectionType::Standard, 0));
+}
+
+TEST(FlatClaimsTest, SharesExportsAndImports) {
+    jwt::AccountClaims account(nkeys::CreateAccount()->publicString());
+    account.setExports({jwt::Export{"prices", "prices.>", jwt::ExportType::Stream, false}});
+    jwt::Import import;
+    import.subject = "rpc.lookup";
+    import.account = jwt::PublicKey(nkeys::CreateAccount()->publicString());
+    import.type = jwt::ExportType::Service;
+    account.setImports({import});
+    auto flat = jwt::FlatClaims::from(account);
+
+    EXPECT_NE(flat->exportIndex().find("prices.eu", jwt::ExportType::Stream), nullptr);
+    EXPECT_EQ(flat->exportIndex().find("orders.eu", jwt::ExportType::Stream), nullptr);
+    ASSERT_EQ(flat->imports().size(), 1u);
+    EXPECT_EQ(flat->imports()[0], import);
+    EXPECT_EQ(flat->imports().data(), account.imports().data());  // Shared, not copied
+    EXPECT_TRUE(jwt::FlatClaims::from(jwt::UserClaims(nkeys::CreateUser()->publicString()))->imports().empty());
+}
+
+TEST(FlatClaimsTest, SharesSubjectMapper) {
+    jwt::AccountClaims account(nkeys::CreateAccount()->publicString());
+    account.setMappings({{"plain", {{"renamed", 0, ""}}}});
+    auto flat = jwt::FlatClaims::from(account);
+
+    EXPECT_EQ(flat->subjectMapper().map("plain"), "renamed");
+    EXPECT_EQ(flat->subjectMapper().mappings(), account.mappings());
+}
+
+TEST(FlatClaimsTest, KeepsSigningKeyScopes) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto scoped_kp = nkeys::CreateAccount();
+    jwt::AccountClaims account(nkeys::CreateAccount()->publicString());
+    account.setIssuer(operator_kp->publicString());
+    account.addSigningKey(nkeys::CreateAccount()->publicString());
+    jwt::ScopeTemplate scopeTemplate;
+    scopeTemplate.permissions.pub.allow = {"scoped.>"};
+    account.addScopedSigningKey(jwt::UserScope(jwt::PublicKey(scoped_kp->publicString()), "role", scopeTemplate));
+    auto decoded = jwt::decodeAccountClaims(account.encode(operator_kp->seedString()));
+    auto flat = jwt::FlatClaims::from(*decoded);
+
+    ASSERT_EQ(flat->signingKeys().size(), 2u);
+    const jwt::UserScope* scope = flat->scopeFor(jwt::PublicKey(scoped_kp->publicString()));
+    ASSERT_NE(scope, nullptr);
+    EXPECT_EQ(scope->role(), "role");
+    EXPECT_EQ(*scope, *decoded->scopeFor(scope->key()));
+    EXPECT_EQ(flat->scopeFor(account.signingKeyHandles()[0]), nullptr);
+    EXPECT_EQ(flat->allocationSize(), sizeof(jwt::FlatClaims) + sizeof(jwt::AccountLimits) +
+                                          2 * sizeof(jwt::PublicKey) + sizeof(jwt::UserScope));
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include "../src/base64url.hpp"
+#include <nkeys/nkeys.hpp>
+#include <string>
+
+namespace {
+
+std::string payloadOf(const std::string& token) {
+    auto first = token.find('.');
+    auto second = token.find('.', first + 1);
+    auto bytes = jwt::internal::base64url_decode(std::string_view(token).substr(first + 1, second - first - 1));
+    return std::string(bytes.begin(), bytes.end());
+}
+
+struct Fixture {
+    std::unique_ptr<nkeys::KeyPair> account_kp = nkeys::CreateAccount();
+    std::unique_ptr<nkeys::KeyPair> user_kp = nkeys::CreateUser();
+
+    std::string userToken() const {
+        jwt::UserClaims claims(user_kp->publicString());
+        claims.setIssuer(account_kp->publicString());
+        claims.setName("alice");
+        claims.addTag("Region:EU");
+        claims.setPermissions({{{"orders.>"}, {}}, {}});
+        return claims.encode(account_kp->seedString());
+    }
+};
+
+}
+
+TEST(GenericClaimsTest, DecodesStandardFields) {
+    Fixture fx;
+    auto token = fx.userToken();
+    auto claims = jwt::decodeGenericClaims(token);
+
+    EXPECT_EQ(claims->type(), "user");
+    EXPECT_EQ(claims->subjectKey(), fx.user_kp->publicString());
+    EXPECT_EQ(claims->issuerKey(), fx.account_kp->publicString());
+    EXPECT_EQ(claims->name(), "alice");
+    EXPECT_GT(claims->issuedAt(), 0);
+    EXPECT_TRUE(claims->tags().contains("region:eu"));
+    EXPECT_EQ(claims->token(), token);
+    EXPECT_EQ(claims->natsField("version"), "2");
+    EXPECT_TRUE(claims->natsField("pub").has_value());
+    EXPECT_FALSE(claims->field("nope").has_value());
+}
+
+TEST(GenericClaimsTest, PassThroughIsByteIdentical) {
+    Fixture fx;
+    auto token = fx.userToken();
+    auto claims = jwt::decodeGenericClaims(token);
+    EXPECT_EQ(claims->payload(), payloadOf(token));
+
+    auto resigned = claims->encode(jwt::Signer(fx.account_kp->seedString()));
+    EXPECT_EQ(payloadOf(resigned), payloadOf(token));
+    EXPECT_TRUE(jwt::verify(resigned));
+}
+
+TEST(GenericClaimsTest, KeepsUnknownFields) {
+    Fixture fx;
+    auto claims = jwt::decodeGenericClaims(fx.userToken());
+    claims->setField("x-tenant", R"( {"id": 7, "labels": ["a", "b"]} )");
+    EXPECT_EQ(claims->field("x-tenant"), R"({"id": 7, "labels": ["a", "b"]})");
+
+    auto token = claims->encode(fx.account_kp->seedString());
+    auto again = jwt::decodeGenericClaims(token);
+    EXPECT_EQ(again->field("x-tenant"), R"({"id": 7, "labels": ["a", "b"]})");
+    EXPECT_EQ(again->fields().back().name, "x-tenant");
+
+    // Typed decoders ignore the extra member
+    auto user = jwt::decodeUserClaims(token);
+    EXPECT_EQ(user->name(), "alice");
+    EXPECT_TRUE(user->canPublish("orders.new"));
+}
+
+TEST(GenericClaimsTest, RewritesOnlyChangedFields) {
+    Fixture fx;
+    auto token = fx.userToken();
+    auto claims = jwt::decodeGenericClaims(token);
+    auto natsBefore = std::string(*claims->field("nats"));
+    auto jtiBefore = std::string(*claims->field("jti"));
+
+    auto signing_kp = nkeys::CreateAccount();
+    claims->setName("bob");
+    claims->setExpires(claims->issuedAt() + 3600);
+    claims->setIssuer(signing_kp->publicString());
+    auto resigned = claims->encode(signing_kp->seedString());
+
+    auto again = jwt::decodeGenericClaims(resigned);
+    EXPECT_EQ(again->name(), "bob");
+    EXPECT_EQ(again->expires(), claims->issuedAt() + 3600);
+    EXPECT_EQ(again->issuerKey(), signing_kp->publicString());
+    EXPECT_EQ(again->field("nats"), natsBefore);
+    EXPECT_EQ(again->field("jti"), jtiBefore);
+
+    EXPECT_TRUE(claims->removeField("exp"));
+    EXPECT_EQ(claims->expires(), 0);
+    EXPECT_FALSE(claims->removeField("exp"));
+}
+
+TEST(GenericClaimsTest, RejectsBadValues) {
+    Fixture fx;
+    auto claims = jwt::decodeGenericClaims(fx.userToken());
+    EXPECT_THROW(claims->setField("x", "1 2"), std::invalid_argument);
+    EXPECT_THROW(claims->setField("x", "{\"a\":"), std::invalid_argument);
+    EXPECT_THROW(claims->setField("x", "nope"), std::invalid_argument);
+    EXPECT_THROW(claims->setField("exp", "\"tomorrow\""), std::invalid_argument);
+    EXPECT_THROW(claims->setField("name", "42"), std::invalid_argument);
+
+    // A rejected standard field leaves the claims unchanged
+    EXPECT_EQ(claims->name(), "alice");
+    EXPECT_EQ(claims->expires(), 0);
+}
+
+TEST(GenericClaimsTest, RejectsMalformedPayloads) {
+    Fixture fx;
+    auto token = fx.userToken();
+    auto payload = payloadOf(token);
+    auto header = token.substr(0, token.find('.'));
+    auto sig = token.substr(token.rfind('.'));
+    auto withPayload = [&](const std::string& json) {
+        std::vector<uint8_t> bytes(json.begin(), json.end());
+        return header + "." + jwt::internal::base64url_encode(bytes) + sig;
+    };
+
+    auto duplicate = payload.substr(0, payload.size() - 1) + R"(,"name":"mallory"})";
+    EXPECT_THROW(jwt::decodeGenericClaims(withPayload(duplicate)), std::invalid_argument);
+    EXPECT_THROW(jwt::decodeGenericClaims(withPayload(payload + "x")), std::invalid_argument);
+    EXPECT_THROW(jwt::decodeGenericClaims(withPayload(payload.substr(0, payload.size() / 2))),
+                 std::invalid_argument);
+    EXPECT_THROW(jwt::decodeGenericClaims(withPayload(R"({"sub":"x","iss":"y"})")), std::invalid_argument);
+    EXPECT_THROW(jwt::decodeGenericClaims("not.a.jwt"), std::exception);
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+jwt::HierarchySpec smallSpec() {
+    jwt::HierarchySpec spec;
+    spec.operators = 2;
+    spec.accountsPerOperator = 3;
+    spec.signingKeysPerAccount = 2;
+    spec.revocationsPerAccount = 1;
+    spec.usersPerAccount = 4;
+    spec.seed = 42;
+    spec.threads = 3;
+    return spec;
+}
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+}
+
+TEST(HierarchyGeneratorTest, GeneratesRequestedShape) {
+    auto spec = smallSpec();
+    auto hierarchy = jwt::generateHierarchy(spec);
+
+    ASSERT_EQ(hierarchy.operators.size(), 2);
+    EXPECT_EQ(hierarchy.accountCount(), 6);
+    EXPECT_EQ(hierarchy.userCount(), 24);
+
+    std::set<std::string> keys;
+    for (const auto& op : hierarchy.operators) {
+        EXPECT_EQ(op.key.publicKey[0], 'O');
+        keys.insert(op.key.publicKey);
+        for (const auto& acct : op.accounts) {
+            EXPECT_EQ(acct.key.publicKey[0], 'A');
+            EXPECT_EQ(acct.signingKeys.size(), 2);
+            keys.insert(acct.key.publicKey);
+
+            auto decoded = jwt::decodeAccountClaims(acct.jwt);
+            EXPECT_EQ(decoded->issuer(), op.key.publicKey);
+            EXPECT_EQ(decoded->signingKeys().size(), 2);
+            EXPECT_EQ(decoded->revocations().size(), 1);
+
+            for (const auto& user : acct.users) {
+                EXPECT_EQ(user.key.publicKey[0], 'U');
+                keys.insert(user.key.publicKey);
+            }
+            EXPECT_FALSE(acct.users[2].revoked);
+            EXPECT_TRUE(acct.users[3].revoked);
+        }
+    }
+    EXPECT_EQ(keys.size(), 2 + 6 + 24);
+}
+
+TEST(HierarchyGeneratorTest, SeedsMatchPublicKeys) {
+    auto hierarchy = jwt::generateHierarchy(smallSpec());
+    const auto& acct = hierarchy.operators[1].accounts[2];
+
+    EXPECT_EQ(nkeys::FromSeed(acct.key.seed)->publicString(), acct.key.publicKey);
+    EXPECT_EQ(nkeys::FromSeed(acct.signingKeys[0].seed)->publicString(), acct.signingKeys[0].publicKey);
+    EXPECT_EQ(nkeys::FromSeed(acct.users[0].key.seed)->publicString(), acct.users[0].key.publicKey);
+}
+
+TEST(HierarchyGeneratorTest, DeterministicAcrossThreadCounts) {
+    auto spec = smallSpec();
+    spec.now = 1700000000;
+    spec.threads = 1;
+    auto serial = jwt::generateHierarchy(spec);
+    spec.threads = 4;
+    auto parallel = jwt::generateHierarchy(spec);
+
+    for (std::size_t o = 0; o < serial.operators.size(); ++o) {
+        EXPECT_EQ(serial.operators[o].key.seed, parallel.operators[o].key.seed);
+        for (std::size_t a = 0; a < serial.operators[o].accounts.size(); ++a) {
+            const auto& lhs = serial.operators[o].accounts[a];
+            const auto& rhs = parallel.operators[o].accounts[a];
+            EXPECT_EQ(lhs.key.seed, rhs.key.seed);
+            EXPECT_EQ(lhs.signingKeys[1].seed, rhs.signingKeys[1].seed);
+            for (std::size_t u = 0; u < lhs.users.size(); ++u) {
+                EXPECT_EQ(lhs.users[u].key.seed, rhs.users[u].key.seed);
+                EXPECT_EQ(lhs.users[u].expires, rhs.users[u].expires);
+            }
+        }
+    }
+
+    spec.seed = 43;
+    auto other = jwt::generateHierarchy(spec);
+    EXPECT_NE(other.operators[0].key.seed, serial.operators[0].key.seed);
+}
+
+TEST(HierarchyGeneratorTest, ChainsValidateAndRevokedUsersFail) {
+    auto spec = smallSpec();
+    spec.expiringUserFraction = 0.5;
+    auto hierarchy = jwt::generateHierarchy(spec);
+
+    jwt::ValidationOptions opts;
+    opts.checkIssuerChain = true;
+
+    std::size_t expiring = 0;
+    for (const auto& op : hierarchy.operators) {
+        for (const auto& acct : op.accounts) {
+            for (const auto& user : acct.users) {
+                auto result = jwt::validateChain({op.jwt, acct.jwt, user.jwt}, opts);
+                EXPECT_EQ(result.valid, !user.revoked) << result.error.value_or("");
+                if (user.expires > 0) {
+                    ++expiring;
+                    EXPECT_EQ(jwt::decodeUserClaims(user.jwt)->expires(), user.expires);
+                }
+            }
+        }
+    }
+    EXPECT_GT(expiring, 0);
+    EXPECT_LT(expiring, hierarchy.userCount());
+}
+
+TEST(HierarchyGeneratorTest, RevokedFlagFollowsSpecNow) {
+    auto spec = smallSpec();
+    spec.now = 1'000'000'000;  // Far before the wall clock
+    auto hierarchy = jwt::generateHierarchy(spec);
+
+    std::size_t revoked = 0;
+    for (const auto& op : hierarchy.operators) {
+        for (const auto& acct : op.accounts) {
+            auto account = jwt::decodeAccountClaims(acct.jwt);
+            for (const auto& user : acct.users) {
+                auto claims = jwt::decodeUserClaims(user.jwt);
+                EXPECT_EQ(claims->issuedAt(), spec.now);
+                EXPECT_EQ(account->isRevoked(claims->subjectKey(), claims->issuedAt()), user.revoked);
+                revoked += user.revoked ? 1 : 0;
+            }
+        }
+    }
+    EXPECT_EQ(revoked, hierarchy.accountCount() * spec.revocationsPerAccount);
+}
+
+TEST(HierarchyGeneratorTest, UsersCanBeSignedWithSigningKeys) {
+    auto spec = smallSpec();
+    spec.signUsersWithSigningKeys = true;
+    auto hierarchy = jwt::generateHierarchy(spec);
+
+    const auto& acct = hierarchy.operators[0].accounts[0];
+    for (std::size_t u = 0; u < acct.users.size(); ++u) {
+        auto decoded = jwt::decodeUserClaims(acct.users[u].jwt);
+        EXPECT_EQ(decoded->issuer(), acct.signingKeys[u % 2].publicKey);
+        EXPECT_EQ(decoded->issuerAccount(), acct.key.publicKey);
+        EXPECT_TRUE(jwt::verify(acct.users[u].jwt));
+    }
+}
+
+TEST(HierarchyGeneratorTest, RejectsInconsistentSpec) {
+    jwt::HierarchySpec spec;
+    spec.usersPerAccount = 1;
+    spec.revocationsPerAccount = 2;
+    EXPECT_THROW((void)jwt::generateHierarchy(spec), std::invalid_argument);
+
+    spec = jwt::HierarchySpec{};
+    spec.signUsersWithSigningKeys = true;
+    EXPECT_THROW((void)jwt::generateHierarchy(spec), std::invalid_argument);
+
+    spec = jwt::HierarchySpec{};
+    spec.expiringUserFraction = 1.5;
+    EXPECT_THROW((void)jwt::generateHierarchy(spec), std::invalid_argument);
+}
+
+TEST(HierarchyGeneratorTest, WritesDirectoryLayout) {
+    auto dir = fs::temp_directory_path() / "jwt_hierarchy_generator_test";
+    fs::remove_all(dir);
+
+    auto spec = smallSpec();
+    jwt::generateHierarchy(spec, dir.string());
+
+    auto acctDir = dir / "operator-1" / "accounts" / "account-1-2";
+    EXPECT_TRUE(fs::exists(dir / "operator-1" / "operator-1.jwt"));
+    EXPECT_TRUE(fs::exists(dir / "operator-1" / "operator-1.seed"));
+    EXPECT_TRUE(fs::exists(acctDir / "account-1-2.jwt"));
+    EXPECT_TRUE(fs::exists(acctDir / "signing-key-1.seed"));
+
+    auto userJwt = readFile(acctDir / "users" / "user-1-2-3.jwt");
+    userJwt.erase(userJwt.find_last_not_of(" \n\r\t") + 1);
+    EXPECT_TRUE(jwt::verify(userJwt));
+
+    auto creds = readFile(acctDir / "users" / "user-1-2-3.creds");
+    EXPECT_EQ(creds.rfind("-----BEGIN NATS USER JWT-----\n" + userJwt.substr(0, 64) + "\n", 0), 0);
+
+    // Files match the in-memory generator for the same spec
+    auto hierarchy = jwt::generateHierarchy(spec);
+    auto seed = readFile(acctDir / "users" / "user-1-2-3.seed");
+    EXPECT_EQ(seed, hierarchy.operators[1].accounts[2].users[3].key.seed + "\n");
+
+    std::size_t userFiles = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+        if (entry.path().extension() == ".creds") ++userFiles;
+    }
+    EXPECT_EQ(userFiles, 24);
+
+    fs::remove_all(dir);
+}
@@ -6,6 +6,8 @@
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <algorithm>
+#include <thread>
 
 TEST(JwtTest, PlaceholderTest) {
     // Placeholder test to ensure test framework works
@@ -255,6 +257,84 @@ TEST(JwtVerificationTest, WrongIssuer) {
     EXPECT_FALSE(jwt::verify(jwt_string));
 }
 
+// Test key cache - repeated verification reuses the prepared issuer key
+TEST(JwtVerificationTest, KeyCacheHitsOnRepeatedVerify) {
+    jwt::clearKeyCache();
+    auto operator_kp = nkeys::CreateOperator();
+    auto op_claims = jwt::OperatorClaims(operator_kp->publicString());
+    std::string jwt_string = op_claims.encode(operator_kp->seedString());
+
+    EXPECT_TRUE(jwt::verify(jwt_string));
+    EXPECT_TRUE(jwt::verify(jwt_string));
+    EXPECT_TRUE(jwt::verify(jwt_string));
+
+    auto stats = jwt::keyCacheStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.size, 1);
+}
+
+// Test key cache - capacity bounds the number of cached keys
+TEST(JwtVerificationTest, KeyCacheRespectsCapacity) {
+    jwt::clearKeyCache();
+    jwt::setKeyCacheCapacity(2);
+
+    for (int i = 0; i < 4; ++i) {
+        auto operator_kp = nkeys::CreateOperator();
+        auto op_claims = jwt::OperatorClaims(operator_kp->publicString());
+        EXPECT_TRUE(jwt::verify(op_claims.encode(operator_kp->seedString())));
+    }
+
+    auto stats = jwt::keyCacheStats();
+    EXPECT_EQ(stats.size, 2);
+    EXPECT_EQ(stats.evictions, 2);
+
+    // Capacity 0 disables caching but verification still works
+    jwt::setKeyCacheCapacity(0);
+    auto operator_kp = nkeys::CreateOperator();
+    auto op_claims = jwt::OperatorClaims(operator_kp->publicString());
+    std::string jwt_string = op_claims.encode(operator_kp->seedString());
+    EXPECT_TRUE(jwt::verify(jwt_string));
+    EXPECT_TRUE(jwt::verify(jwt_string));
+    EXPECT_EQ(jwt::keyCacheStats().size, 0);
+
+    jwt::setKeyCacheCapacity(jwt::DEFAULT_KEY_CACHE_CAPACITY);
+    jwt::clearKeyCache();
+}
+
+TEST(JwtVerificationTest, LockStatsCountKeyCacheAcquisitions) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto op_claims = jwt::OperatorClaims(operator_kp->publicString());
+    std::string jwt_string = op_claims.encode(operator_kp->seedString());
+    EXPECT_TRUE(jwt::verify(jwt_string));
+
+    jwt::resetLockStats();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&jwt_string]() {
+            for (int i = 0; i < 5; ++i) {
+                EXPECT_TRUE(jwt::verify(jwt_string));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto stats = jwt::lockStats();
+    auto it = std::find_if(stats.begin(), stats.end(),
+                           [](const jwt::LockStats& s) { return s.name == "key_cache"; });
+    ASSERT_NE(it, stats.end());
+    EXPECT_GE(it->acquisitions, 20);
+    EXPECT_LE(it->contended, it->acquisitions);
+    EXPECT_LE(it->contentionRate(), 1.0);
+
+    jwt::resetLockStats();
+    for (const auto& s : jwt::lockStats()) {
+        EXPECT_EQ(s.acquisitions, 0) << s.name;
+    }
+}
+
 // Test malformed JWT - missing parts
 TEST(JwtDecodingTest, MalformedJwtMissingParts) {
     EXPECT_THROW(jwt::decode("header.payload"), std::invalid_argument);
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+
+// The helpers are constexpr, so the basic semantics can be checked at compile time
+static_assert(jwt::belowLimit(jwt::NO_LIMIT, 1'000'000));
+static_assert(jwt::belowLimit(10, 9));
+static_assert(!jwt::belowLimit(10, 10));
+static_assert(!jwt::belowLimit(0, 0));
+static_assert(jwt::withinLimit(1024, 1024));
+static_assert(!jwt::withinLimit(1024, 1025));
+static_assert(jwt::withinLimit(jwt::NO_LIMIT, 1 << 30));
+
+TEST(LimitsTest, DefaultsAreUnlimited) {
+    jwt::AccountLimits limits;
+    EXPECT_EQ(limits.exhausted({1000, 1000, 1000, 1000, 1000}), 0u);
+    EXPECT_TRUE(limits.canConnect(1 << 20));
+    EXPECT_TRUE(limits.nats.canPublish(64 << 20));
+    EXPECT_FALSE(limits.jetstream.enabled());
+}
+
+TEST(LimitsTest, ExhaustedReportsEveryFullCounter) {
+    jwt::AccountLimits limits;
+    limits.nats.subs = 100;
+    limits.conn = 10;
+    limits.leaf = 0;
+    limits.exports = 5;
+
+    jwt::AccountUsage usage{99, 10, 0, 3, 2};
+    auto mask = limits.exhausted(usage);
+    EXPECT_FALSE(jwt::hasLimit(mask, jwt::LimitKind::Subs));
+    EXPECT_TRUE(jwt::hasLimit(mask, jwt::LimitKind::Conn));
+    EXPECT_TRUE(jwt::hasLimit(mask, jwt::LimitKind::Leaf));
+    EXPECT_FALSE(jwt::hasLimit(mask, jwt::LimitKind::Imports));
+    EXPECT_FALSE(jwt::hasLimit(mask, jwt::LimitKind::Exports));
+    EXPECT_FALSE(limits.canConnect(usage.conn));
+    EXPECT_FALSE(limits.canConnectLeaf(usage.leaf));
+}
+
+TEST(LimitsTest, AccountLimitsRoundTrip) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+
+    jwt::AccountLimits limits;
+    limits.nats = {1000, 1 << 20, 4096};
+    limits.imports = 10;
+    limits.exports = 20;
+    limits.conn = 50;
+    limits.leaf = 2;
+    limits.wildcardExports = false;
+    limits.jetstream.memoryStorage = 1 << 30;
+    limits.jetstream.streams = 8;
+    limits.jetstream.maxBytesRequired = true;
+
+    jwt::AccountClaims claims(account_kp->publicString());
+    claims.setIssuer(operator_kp->publicString());
+    claims.setLimits(limits);
+
+    auto decoded = jwt::decodeAccountClaims(claims.encode(operator_kp->seedString()));
+    EXPECT_EQ(decoded->limits(), limits);
+    EXPECT_TRUE(decoded->limits().jetstream.enabled());
+}
+
+TEST(LimitsTest, UserLimitsRoundTrip) {
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+
+    jwt::UserClaims claims(user_kp->publicString());
+    claims.setIssuer(account_kp->publicString());
+    claims.setLimits({10, jwt::NO_LIMIT, 1024});
+
+    auto decoded = jwt::decodeUserClaims(claims.encode(account_kp->seedString()));
+    EXPECT_EQ(decoded->limits(), (jwt::NatsLimits{10, jwt::NO_LIMIT, 1024}));
+    EXPECT_TRUE(decoded->limits().canPublish(1024));
+    EXPECT_FALSE(decoded->limits().canPublish(1025));
+    EXPECT_FALSE(decoded->limits().canSubscribe(10));
+}
+
+TEST(LimitsTest, MissingLimitsDecodeAsDefaults) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    jwt::AccountClaims claims(account_kp->publicString());
+    claims.setIssuer(operator_kp->publicString());
+
+    auto decoded = jwt::decodeAccountClaims(claims.encode(operator_kp->seedString()));
+    EXPECT_EQ(decoded->limits(), jwt::AccountLimits{});
+}
+
+TEST(LimitsTest, FlatClaimsCarryLimits) {
+    jwt::AccountClaims account("AABC123");
+    jwt::AccountLimits limits;
+    limits.conn = 3;
+    limits.nats.payload = 512;
+    account.setLimits(limits);
+    account.addSigningKey("AKEY1");
+
+    auto flatAccount = jwt::FlatClaims::from(account);
+    EXPECT_EQ(flatAccount->accountLimits(), limits);
+    EXPECT_EQ(flatAccount->natsLimits().payload, 512);
+    ASSERT_EQ(flatAccount->signingKeys().size(), 1u);
+    EXPECT_EQ(flatAccount->signingKeys()[0], "AKEY1");
+
+    jwt::UserClaims user("UABC123");
+    user.setLimits({5, 100, 64});
+    auto flatUser = jwt::FlatClaims::from(user);
+    EXPECT_EQ(flatUser->natsLimits(), (jwt::NatsLimits{5, 100, 64}));
+    EXPECT_EQ(flatUser->accountLimits(), jwt::AccountLimits{});
+}
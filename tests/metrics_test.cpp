@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <atomic>
+#include <thread>
+
+using jwt::metrics::Outcome;
+using jwt::metrics::Stage;
+
+namespace {
+
+std::string makeUserJwt() {
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+    jwt::UserClaims claims(user_kp->publicString());
+    claims.setIssuer(account_kp->publicString());
+    return claims.encode(account_kp->seedString());
+}
+
+/// Counts observer callbacks per stage
+class CountingObserver : public jwt::metrics::Observer {
+public:
+    void onStage(Stage stage, Outcome, std::uint64_t) noexcept override {
+        counts[static_cast<std::size_t>(stage)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count(Stage stage) const {
+        return counts[static_cast<std::size_t>(stage)].load(std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, jwt::metrics::kStageCount> counts{};
+};
+
+}
+
+// ============================================================================
+// Histogram and Export Tests (independent of JWT_ENABLE_METRICS)
+// ============================================================================
+
+TEST(MetricsTest, StageNamesAreStable) {
+    EXPECT_STREQ(jwt::metrics::stageName(Stage::Split), "split");
+    EXPECT_STREQ(jwt::metrics::stageName(Stage::SignatureVerify), "signature_verify");
+    EXPECT_STREQ(jwt::metrics::stageName(Stage::KeyCache), "key_cache");
+    EXPECT_STREQ(jwt::metrics::outcomeName(Outcome::CacheHit), "hit");
+}
+
+TEST(MetricsTest, BucketBoundsAreMonotonic) {
+    for (std::size_t b = 0; b < 16; ++b) {
+        EXPECT_EQ(jwt::metrics::bucketLowerBound(b), b);
+    }
+    for (std::size_t b = 1; b < jwt::metrics::kBucketCount; ++b) {
+        EXPECT_LT(jwt::metrics::bucketLowerBound(b - 1), jwt::metrics::bucketLowerBound(b));
+    }
+    // Relative bucket width stays within 12.5% (8 sub-buckets per power of two)
+    auto lo = jwt::metrics::bucketLowerBound(200);
+    auto hi = jwt::metrics::bucketLowerBound(201);
+    EXPECT_LE(static_cast<double>(hi - lo) / static_cast<double>(lo), 0.125);
+}
+
+TEST(MetricsTest, PercentileFromBuckets) {
+    jwt::metrics::StageStats stats;
+    // 90 samples in bucket 10 (exactly 10ns), 10 samples near 1000ns
+    stats.buckets[10] = 90;
+    std::size_t slow = 0;
+    while (jwt::metrics::bucketLowerBound(slow + 1) <= 1000) ++slow;
+    stats.buckets[slow] = 10;
+    stats.count = 100;
+    stats.maxNanos = 1000;
+
+    EXPECT_EQ(stats.percentileNanos(0.5), 10);
+    EXPECT_EQ(stats.percentileNanos(0.89), 10);
+    EXPECT_EQ(stats.percentileNanos(0.99), 1000);
+    EXPECT_EQ(jwt::metrics::StageStats{}.percentileNanos(0.5), 0);
+}
+
+TEST(MetricsTest, PrometheusExportFormat) {
+    jwt::metrics::Snapshot snap;
+    auto& verify = snap.stages[static_cast<std::size_t>(Stage::SignatureVerify)];
+    verify.outcomes[static_cast<std::size_t>(Outcome::Success)] = 3;
+    verify.buckets[12] = 3;
+    verify.count = 3;
+    verify.totalNanos = 36;
+    verify.maxNanos = 12;
+
+    std::string text = jwt::metrics::exportPrometheus(snap);
+    EXPECT_NE(text.find("# TYPE jwt_stage_duration_seconds summary"), std::string::npos);
+    EXPECT_NE(text.find("jwt_stage_duration_seconds_count{stage=\"signature_verify\"} 3"), std::string::npos);
+    EXPECT_NE(text.find("jwt_stage_outcomes_total{stage=\"signature_verify\",outcome=\"success\"} 3"),
+              std::string::npos);
+    // Zero outcome counters are omitted
+    EXPECT_EQ(text.find("outcome=\"failure\""), std::string::npos);
+}
+
+// ============================================================================
+// Library Instrumentation Tests
+// ============================================================================
+
+TEST(MetricsTest, DecodeAndVerifyRecordStages) {
+    std::string token = makeUserJwt();
+    jwt::metrics::reset();
+
+    auto claims = jwt::decodeUserClaims(token);
+    EXPECT_TRUE(jwt::verify(token));
+    auto snap = jwt::metrics::snapshot();
+
+    if (!jwt::metrics::enabled()) {
+        // Compiled out: nothing is ever recorded
+        for (const auto& stage : snap.stages) {
+            EXPECT_EQ(stage.count, 0);
+        }
+        return;
+    }
+
+    EXPECT_EQ(snap[Stage::Split].outcome(Outcome::Success), 2);
+    EXPECT_EQ(snap[Stage::HeaderDecode].outcome(Outcome::Success), 1);
+    EXPECT_EQ(snap[Stage::PayloadDecode].outcome(Outcome::Success), 2);
+    EXPECT_EQ(snap[Stage::Parse].outcome(Outcome::Success), 2);
+    EXPECT_EQ(snap[Stage::KeyPreparation].outcome(Outcome::Success), 1);
+    EXPECT_EQ(snap[Stage::SignatureVerify].outcome(Outcome::Success), 1);
+    EXPECT_EQ(snap[Stage::KeyCache].outcome(Outcome::CacheHit) +
+              snap[Stage::KeyCache].outcome(Outcome::CacheMiss), 1);
+    EXPECT_GT(snap[Stage::SignatureVerify].totalNanos, 0);
+}
+
+TEST(MetricsTest, FailuresAreRecorded) {
+    jwt::metrics::reset();
+    EXPECT_THROW(auto c = jwt::decode("a.b.c.d"), std::invalid_argument);
+
+    if (jwt::metrics::enabled()) {
+        EXPECT_EQ(jwt::metrics::snapshot()[Stage::Split].outcome(Outcome::Failure), 1);
+    }
+}
+
+TEST(MetricsTest, ChainValidationRecordsTimingAndHierarchy) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    jwt::OperatorClaims op(operator_kp->publicString());
+    jwt::AccountClaims acc(account_kp->publicString());
+    acc.setIssuer(operator_kp->publicString());
+    std::vector<std::string> chain{op.encode(operator_kp->seedString()),
+                                   acc.encode(operator_kp->seedString())};
+
+    jwt::metrics::reset();
+    ASSERT_TRUE(jwt::validateChain(chain, jwt::ValidationOptions::strict()));
+
+    if (jwt::metrics::enabled()) {
+        auto snap = jwt::metrics::snapshot();
+        EXPECT_EQ(snap[Stage::Timing].outcome(Outcome::Success), 2);
+        EXPECT_EQ(snap[Stage::Hierarchy].outcome(Outcome::Success), 1);
+    }
+}
+
+TEST(MetricsTest, ObserverSeesEvents) {
+    CountingObserver observer;
+    jwt::metrics::setObserver(&observer);
+    std::string token = makeUserJwt();
+    EXPECT_TRUE(jwt::verify(token));
+    jwt::metrics::setObserver(nullptr);
+
+    if (jwt::metrics::enabled()) {
+        EXPECT_EQ(observer.count(Stage::SignatureVerify), 1);
+        EXPECT_EQ(observer.count(Stage::KeyCache), 1);
+    } else {
+        EXPECT_EQ(observer.count(Stage::SignatureVerify), 0);
+    }
+}
+
+TEST(MetricsTest, ThreadsAggregateIntoSnapshot) {
+    std::string token = makeUserJwt();
+    jwt::metrics::reset();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&token] {
+            for (int i = 0; i < 5; ++i) {
+                EXPECT_TRUE(jwt::verify(token));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // Exited threads are folded into the totals
+    auto snap = jwt::metrics::snapshot();
+    std::uint64_t expected = jwt::metrics::enabled() ? 20 : 0;
+    EXPECT_EQ(snap[Stage::SignatureVerify].outcome(Outcome::Success), expected);
+    EXPECT_EQ(snap[Stage::SignatureVerify].count, expected);
+}
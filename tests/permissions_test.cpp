@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> split(const std::string& subject) {
+    std::vector<std::string> tokens;
+    std::size_t pos = 0;
+    while (true) {
+        auto dot = subject.find('.', pos);
+        tokens.push_back(subject.substr(pos, dot == std::string::npos ? std::string::npos : dot - pos));
+        if (dot == std::string::npos) return tokens;
+        pos = dot + 1;
+    }
+}
+
+/// Straightforward per-pattern matcher used as a reference
+bool naiveMatch(const std::string& pattern, const std::string& subject) {
+    auto p = split(pattern);
+    auto s = split(subject);
+    for (std::size_t i = 0; i < p.size(); ++i) {
+        if (p[i] == ">") return s.size() > i;
+        if (i >= s.size()) return false;
+        if (p[i] != "*" && p[i] != s[i]) return false;
+    }
+    return p.size() == s.size();
+}
+
+bool naiveAllows(const jwt::Permission& permission, const std::string& subject) {
+    bool allowed = permission.allow.empty();
+    for (const auto& pattern : permission.allow) allowed = allowed || naiveMatch(pattern, subject);
+    for (const auto& pattern : permission.deny) {
+        if (naiveMatch(pattern, subject)) return false;
+    }
+    return allowed;
+}
+
+std::unique_ptr<jwt::UserClaims> roundTrip(const jwt::Permissions& permissions) {
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+    jwt::UserClaims claims(user_kp->publicString());
+    claims.setIssuer(account_kp->publicString());
+    claims.setPermissions(permissions);
+    return jwt::decodeUserClaims(claims.encode(account_kp->seedString()));
+}
+
+}
+
+TEST(PermissionsTest, EmptyPermissionAllowsEverything) {
+    jwt::PermissionMatcher matcher(jwt::Permission{});
+    EXPECT_TRUE(matcher.allows("anything.at.all"));
+    EXPECT_EQ(matcher.stateCount(), 0u);
+}
+
+TEST(PermissionsTest, LiteralAndWildcardAllows) {
+    jwt::PermissionMatcher matcher(jwt::Permission{{"orders.created", "metrics.*.cpu", "logs.>"}, {}});
+
+    EXPECT_TRUE(matcher.allows("orders.created"));
+    EXPECT_FALSE(matcher.allows("orders.deleted"));
+    EXPECT_FALSE(matcher.allows("orders.created.extra"));
+    EXPECT_TRUE(matcher.allows("metrics.host1.cpu"));
+    EXPECT_FALSE(matcher.allows("metrics.host1.mem"));
+    EXPECT_FALSE(matcher.allows("metrics.cpu"));
+    EXPECT_TRUE(matcher.allows("logs.app"));
+    EXPECT_TRUE(matcher.allows("logs.app.error.detail"));
+    EXPECT_FALSE(matcher.allows("logs"));
+}
+
+TEST(PermissionsTest, DenyTakesPrecedence) {
+    jwt::PermissionMatcher matcher(jwt::Permission{{"orders.>"}, {"orders.*.admin", "orders.secret.>"}});
+
+    EXPECT_TRUE(matcher.allows("orders.eu.created"));
+    EXPECT_FALSE(matcher.allows("orders.eu.admin"));
+    EXPECT_FALSE(matcher.allows("orders.secret.plans"));
+    EXPECT_TRUE(matcher.allows("orders.secret"));
+
+    jwt::PermissionMatcher denyOnly(jwt::Permission{{}, {"_SYS.>"}});
+    EXPECT_TRUE(denyOnly.allows("orders.created"));
+    EXPECT_FALSE(denyOnly.allows("_SYS.account.connect"));
+}
+
+TEST(PermissionsTest, WildcardSubjectsNeedBroaderPatterns) {
+    jwt::PermissionMatcher matcher(jwt::Permission{{"orders.*", "logs.>"}, {}});
+
+    EXPECT_TRUE(matcher.allows("orders.*"));
+    EXPECT_FALSE(matcher.allows("orders.>"));
+    EXPECT_TRUE(matcher.allows("logs.*.error"));
+    EXPECT_TRUE(matcher.allows("logs.>"));
+    EXPECT_FALSE(matcher.allows("*.created"));
+}
+
+TEST(PermissionsTest, RejectsMalformedInput) {
+    EXPECT_THROW(jwt::PermissionMatcher(jwt::Permission{{""}, {}}), std::invalid_argument);
+    EXPECT_THROW(jwt::PermissionMatcher(jwt::Permission{{"orders..created"}, {}}), std::invalid_argument);
+    EXPECT_THROW(jwt::PermissionMatcher(jwt::Permission{{}, {"orders.>.created"}}), std::invalid_argument);
+
+    jwt::PermissionMatcher matcher(jwt::Permission{{">"}, {}});
+    EXPECT_TRUE(matcher.allows("a.b"));
+    EXPECT_FALSE(matcher.allows(""));
+    EXPECT_FALSE(matcher.allows("a..b"));
+    EXPECT_FALSE(matcher.allows("a.>.b"));
+}
+
+TEST(PermissionsTest, MatchesNaiveReference) {
+    const std::vector<std::string> tokens = {"a", "b", "c", "*"};
+    std::mt19937 rng(42);
+    auto randomSubject = [&](bool wildcards, bool tail) {
+        std::string subject;
+        int length = 1 + static_cast<int>(rng() % 4);
+        for (int i = 0; i < length; ++i) {
+            if (i > 0) subject += '.';
+            subject += tokens[rng() % (wildcards ? 4 : 3)];
+        }
+        if (tail && rng() % 4 == 0) subject += ".>";
+        return subject;
+    };
+
+    for (int round = 0; round < 50; ++round) {
+        jwt::Permission permission;
+        for (int i = 0; i < 6; ++i) permission.allow.push_back(randomSubject(true, true));
+        for (int i = 0; i < 2; ++i) permission.deny.push_back(randomSubject(true, true));
+        jwt::PermissionMatcher matcher(permission);
+
+        for (int i = 0; i < 200; ++i) {
+            auto subject = randomSubject(false, false);
+            EXPECT_EQ(matcher.allows(subject), naiveAllows(permission, subject)) << subject;
+        }
+    }
+}
+
+TEST(PermissionsTest, RoundTripCompilesMatchers) {
+    jwt::Permissions permissions;
+    permissions.pub = {{"orders.>", "metrics.*"}, {"orders.admin"}};
+    permissions.sub = {{"_INBOX.>"}, {}};
+
+    auto decoded = roundTrip(permissions);
+    EXPECT_EQ(decoded->permissions(), permissions);
+    EXPECT_TRUE(decoded->canPublish("orders.created"));
+    EXPECT_FALSE(decoded->canPublish("orders.admin"));
+    EXPECT_TRUE(decoded->canSubscribe("_INBOX.abc"));
+    EXPECT_FALSE(decoded->canSubscribe("orders.created"));
+
+    // Copies share the compiled matchers
+    jwt::UserClaims copy(*decoded);
+    EXPECT_TRUE(copy.canPublish("metrics.cpu"));
+    EXPECT_EQ(copy.publishMatcher().stateCount(), decoded->publishMatcher().stateCount());
+}
+
+TEST(PermissionsTest, NoPermissionsAllowEverything) {
+    auto decoded = roundTrip({});
+    EXPECT_TRUE(decoded->permissions().empty());
+    EXPECT_TRUE(decoded->canPublish("any.subject"));
+    EXPECT_TRUE(decoded->canSubscribe("any.subject"));
+}
+
+TEST(PermissionsTest, BadPatternLeavesClaimsUnchanged) {
+    jwt::UserClaims claims("UABC123");
+    claims.setPermissions({{{"orders.>"}, {}}, {}});
+    EXPECT_THROW(claims.setPermissions({{{"orders..x"}, {}}, {}}), std::invalid_argument);
+    EXPECT_EQ(claims.permissions().pub.allow, std::vector<std::string>{"orders.>"});
+    EXPECT_FALSE(claims.canPublish("billing.x"));
+}
+
+TEST(PermissionsTest, LargePermissionSets) {
+    jwt::Permission permission;
+    for (int i = 0; i < 5000; ++i) {
+        permission.allow.push_back("svc." + std::to_string(i) + ".*.requests");
+    }
+    permission.deny.push_back("svc.*.internal.>");
+    jwt::PermissionMatcher matcher(permission);
+    EXPECT_TRUE(matcher.isDeterministic());
+
+    EXPECT_TRUE(matcher.allows("svc.4999.eu.requests"));
+    EXPECT_FALSE(matcher.allows("svc.5000.eu.requests"));
+    EXPECT_FALSE(matcher.allows("svc.42.internal.requests"));
+}
+
+TEST(PermissionsTest, OverlappingWildcardsCompileQuickly) {
+    // Pattern i has "a" at position i and '*' everywhere else; determinizing
+    // these needs 2^n states, so the matcher walks the trie instead
+    constexpr int kPatterns = 20;
+    jwt::Permission permission;
+    for (int i = 0; i < kPatterns; ++i) {
+        std::string pattern;
+        for (int j = 0; j < kPatterns; ++j) {
+            if (j > 0) pattern += '.';
+            pattern += i == j ? "a" : "*";
+        }
+        permission.allow.push_back(pattern);
+    }
+    permission.deny.push_back("b.>");
+
+    auto start = std::chrono::steady_clock::now();
+    jwt::PermissionMatcher matcher(permission);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(elapsed, std::chrono::seconds(1));
+    EXPECT_FALSE(matcher.isDeterministic());
+
+    std::mt19937 rng(7);
+    for (int round = 0; round < 500; ++round) {
+        std::string subject;
+        int length = kPatterns - 1 + static_cast<int>(rng() % 3);
+        for (int j = 0; j < length; ++j) {
+            if (j > 0) subject += '.';
+            subject += rng() % 8 == 0 ? "a" : (rng() % 2 ? "b" : "c");
+        }
+        EXPECT_EQ(matcher.allows(subject), naiveAllows(permission, subject)) << subject;
+    }
+
+    // The same family decodes from a JWT without stalling
+    auto decoded = roundTrip({permission, {}});
+    EXPECT_TRUE(decoded->canPublish("c.a.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c"));
+    EXPECT_FALSE(decoded->canPublish("c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c.c"));
+}
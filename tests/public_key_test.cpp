@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+TEST(PublicKeyTest, DefaultIsEmpty) {
+    jwt::PublicKey key;
+    EXPECT_TRUE(key.empty());
+    EXPECT_FALSE(key.valid());
+    EXPECT_EQ(key.prefix(), '\0');
+    EXPECT_EQ(key.str(), "");
+    EXPECT_EQ(key, jwt::PublicKey(""));
+}
+
+TEST(PublicKeyTest, DecodesValidKeys) {
+    auto user_kp = nkeys::CreateUser();
+    auto account_kp = nkeys::CreateAccount();
+    jwt::PublicKey user(user_kp->publicString());
+    jwt::PublicKey account(account_kp->publicString());
+
+    EXPECT_TRUE(user.valid());
+    EXPECT_TRUE(account.valid());
+    EXPECT_EQ(user.prefix(), 'U');
+    EXPECT_EQ(account.prefix(), 'A');
+    EXPECT_EQ(user.str(), user_kp->publicString());
+    EXPECT_NE(user.bytes(), account.bytes());
+    EXPECT_FALSE(std::all_of(user.bytes().begin(), user.bytes().end(), [](auto b) { return b == 0; }));
+}
+
+TEST(PublicKeyTest, MalformedKeysAreKeptButInvalid) {
+    auto encoded = nkeys::CreateUser()->publicString();
+    std::string corrupted = encoded;
+    corrupted[10] = corrupted[10] == 'A' ? 'B' : 'A';
+
+    jwt::PublicKey bad_checksum(corrupted);
+    jwt::PublicKey short_key("UABC123");
+
+    EXPECT_FALSE(bad_checksum.empty());
+    EXPECT_FALSE(bad_checksum.valid());
+    EXPECT_FALSE(short_key.valid());
+    EXPECT_EQ(short_key.prefix(), 'U');
+    EXPECT_EQ(short_key, "UABC123");
+    EXPECT_NE(bad_checksum, jwt::PublicKey(encoded));
+}
+
+TEST(PublicKeyTest, EqualKeysShareOneEntry) {
+    auto encoded = nkeys::CreateOperator()->publicString();
+    jwt::PublicKey a(encoded);
+    jwt::PublicKey b(std::string_view(encoded).substr(0));
+    jwt::PublicKey c = a;
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, c);
+    EXPECT_EQ(&a.str(), &b.str());
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_EQ(std::hash<jwt::PublicKey>{}(a), a.hash());
+
+    std::unordered_set<jwt::PublicKey> set{a, b, c};
+    EXPECT_EQ(set.size(), 1);
+
+    std::ostringstream oss;
+    oss << a;
+    EXPECT_EQ(oss.str(), encoded);
+}
+
+TEST(PublicKeyTest, EntryIsReleasedWithLastHandle) {
+    auto encoded = nkeys::CreateUser()->publicString();
+    std::size_t before = jwt::internedPublicKeyCount();
+    {
+        jwt::PublicKey a(encoded);
+        jwt::PublicKey b = a;
+        jwt::PublicKey moved = std::move(b);
+        EXPECT_EQ(jwt::internedPublicKeyCount(), before + 1);
+    }
+    EXPECT_EQ(jwt::internedPublicKeyCount(), before);
+}
+
+TEST(PublicKeyTest, ConcurrentInterningAgrees) {
+    std::vector<std::string> encoded;
+    for (int i = 0; i < 16; ++i) {
+        encoded.push_back(nkeys::CreateUser()->publicString());
+    }
+    std::size_t before = jwt::internedPublicKeyCount();
+
+    constexpr int kThreads = 4;
+    std::vector<std::vector<jwt::PublicKey>> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < 200; ++round) {
+                for (const auto& key : encoded) {
+                    jwt::PublicKey interned(key);
+                    if (round == 0) results[t].push_back(interned);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 1; t < kThreads; ++t) {
+        EXPECT_EQ(results[t], results[0]);
+    }
+    EXPECT_EQ(jwt::internedPublicKeyCount(), before + encoded.size());
+    results.clear();
+    EXPECT_EQ(jwt::internedPublicKeyCount(), before);
+}
+
+TEST(PublicKeyTest, InternAllMatchesSingleInterning) {
+    std::vector<std::string> owned;
+    for (int i = 0; i < 6; ++i) {
+        owned.push_back(nkeys::CreateAccount()->publicString());
+    }
+    std::string corrupted = owned[1];
+    corrupted.back() = corrupted.back() == 'A' ? 'B' : 'A';
+    owned.push_back(corrupted);
+    owned.push_back("AABC123");
+    owned.push_back(owned[2]);  // Duplicate within the batch
+    owned.push_back("");
+
+    std::vector<std::string_view> encoded(owned.begin(), owned.end());
+    auto keys = jwt::PublicKey::internAll(encoded);
+
+    ASSERT_EQ(keys.size(), owned.size());
+    for (std::size_t i = 0; i < owned.size(); ++i) {
+        jwt::PublicKey single(owned[i]);
+        EXPECT_EQ(keys[i], single) << owned[i];
+        EXPECT_EQ(keys[i].valid(), single.valid()) << owned[i];
+    }
+    for (std::size_t i = 0; i < 6; ++i) {
+        EXPECT_TRUE(keys[i].valid());
+    }
+    EXPECT_FALSE(keys[6].valid());
+    EXPECT_FALSE(keys[7].valid());
+    EXPECT_EQ(keys[8], keys[2]);
+    EXPECT_TRUE(keys[9].empty());
+}
+
+TEST(PublicKeyTest, ClaimsExposeInternedKeys) {
+    auto account_kp = nkeys::CreateAccount();
+    auto operator_kp = nkeys::CreateOperator();
+
+    jwt::AccountClaims claims(account_kp->publicString());
+    claims.setIssuer(operator_kp->publicString());
+    claims.addSigningKey(jwt::PublicKey(account_kp->publicString()));
+
+    EXPECT_EQ(claims.subjectKey(), jwt::PublicKey(account_kp->publicString()));
+    EXPECT_EQ(claims.issuerKey(), jwt::PublicKey(operator_kp->publicString()));
+    EXPECT_EQ(claims.signingKeyHandles()[0], claims.subjectKey());
+    EXPECT_EQ(claims.signingKeys()[0], account_kp->publicString());
+
+    // The string forms follow later changes
+    const auto& keys = claims.signingKeys();
+    claims.addSigningKey("AKEY2");
+    claims.addRevocation("UKEY1", 10);
+    EXPECT_EQ(claims.signingKeys().size(), 2u);
+    EXPECT_EQ(&claims.signingKeys(), &keys);
+    EXPECT_EQ(claims.revocations().at("UKEY1"), 10);
+    EXPECT_EQ(claims.revocationKeys().at(jwt::PublicKey("UKEY1")), 10);
+
+    auto decoded = jwt::decodeAccountClaims(claims.encode(operator_kp->seedString()));
+    EXPECT_EQ(decoded->subjectKey(), claims.subjectKey());
+    EXPECT_EQ(decoded->issuerKey(), claims.issuerKey());
+}
+
+namespace {
+
+/// Claims type that only implements the string accessors
+class StringOnlyClaims : public jwt::Claims {
+public:
+    std::string subjectValue;
+    std::string issuerValue;
+
+    [[nodiscard]] std::string subject() const override { return subjectValue; }
+    [[nodiscard]] std::string issuer() const override { return issuerValue; }
+    [[nodiscard]] std::optional<std::string> name() const override { return std::nullopt; }
+    [[nodiscard]] std::int64_t issuedAt() const override { return 0; }
+    [[nodiscard]] std::int64_t expires() const override { return 0; }
+    [[nodiscard]] const jwt::TagSet& tags() const override { return tags_; }
+    [[nodiscard]] std::string encode(const std::string&) const override { return {}; }
+    void validate() const override {}
+
+private:
+    jwt::TagSet tags_;
+};
+
+}
+
+TEST(PublicKeyTest, DefaultKeyAccessorsInternStrings) {
+    StringOnlyClaims claims;
+    claims.subjectValue = "UDEFAULT1";
+    claims.issuerValue = "ADEFAULT1";
+
+    const jwt::PublicKey& subject = claims.subjectKey();
+    EXPECT_EQ(subject, jwt::PublicKey("UDEFAULT1"));
+    EXPECT_EQ(&claims.subjectKey(), &subject);
+    EXPECT_EQ(claims.issuerKey(), jwt::PublicKey("ADEFAULT1"));
+
+    claims.issuerValue = "ADEFAULT2";
+    EXPECT_EQ(claims.issuerKey(), jwt::PublicKey("ADEFAULT2"));
+
+    StringOnlyClaims copy = claims;
+    EXPECT_EQ(copy.subjectKey(), subject);
+}
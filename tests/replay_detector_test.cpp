@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kNow = 1'700'000'000;
+
+jwt::ReplayDetector::Options small() {
+    jwt::ReplayDetector::Options options;
+    options.granularity = 60;
+    options.buckets = 8;
+    options.capacityPerBucket = 64;
+    return options;
+}
+
+std::string jti(int i) {
+    char buf[33];
+    std::snprintf(buf, sizeof(buf), "%032x", i);
+    return buf;
+}
+
+}
+
+TEST(ReplayDetectorTest, DetectsReplays) {
+    jwt::ReplayDetector detector(small());
+    EXPECT_EQ(detector.check(jti(1), kNow + 30, kNow), jwt::ReplayCheck::Fresh);
+    EXPECT_EQ(detector.check(jti(1), kNow + 30, kNow + 5), jwt::ReplayCheck::Replayed);
+    EXPECT_EQ(detector.check(jti(2), kNow + 30, kNow), jwt::ReplayCheck::Fresh);
+    EXPECT_TRUE(detector.seen(jti(1), kNow + 30, kNow + 10));
+    EXPECT_FALSE(detector.seen(jti(3), kNow + 30, kNow + 10));
+    EXPECT_EQ(detector.size(kNow), 2u);
+
+    // Non-hex JTIs (as other issuers produce) work too
+    EXPECT_EQ(detector.check("ABCDEFGHIJKLMNOP", kNow + 30, kNow), jwt::ReplayCheck::Fresh);
+    EXPECT_EQ(detector.check("ABCDEFGHIJKLMNOP", kNow + 30, kNow), jwt::ReplayCheck::Replayed);
+
+    EXPECT_EQ(detector.check(jti(4), kNow - 1, kNow), jwt::ReplayCheck::Expired);
+    EXPECT_FALSE(detector.seen(jti(4), kNow - 1, kNow));
+}
+
+TEST(ReplayDetectorTest, BucketsDropAfterExpiry) {
+    jwt::ReplayDetector detector(small());
+    EXPECT_EQ(detector.check(jti(1), kNow + 60, kNow), jwt::ReplayCheck::Fresh);
+
+    // Eight minutes on, the same ring slot is reclaimed for a new expiry
+    std::int64_t later = kNow + 8 * 60;
+    EXPECT_EQ(detector.check(jti(2), kNow + 60 + 8 * 60, later), jwt::ReplayCheck::Fresh);
+    EXPECT_FALSE(detector.seen(jti(1), kNow + 60, later));
+    EXPECT_EQ(detector.size(later), 1u);
+}
+
+TEST(ReplayDetectorTest, LongLivedTokensUseTheWindow) {
+    jwt::ReplayDetector detector(small());
+    EXPECT_EQ(detector.check(jti(1), 0, kNow), jwt::ReplayCheck::Fresh);
+    EXPECT_EQ(detector.check(jti(1), 0, kNow + 120), jwt::ReplayCheck::Replayed);
+    EXPECT_EQ(detector.check(jti(2), kNow + 86400, kNow), jwt::ReplayCheck::Fresh);
+    EXPECT_EQ(detector.check(jti(2), kNow + 86400, kNow + 60), jwt::ReplayCheck::Replayed);
+}
+
+TEST(ReplayDetectorTest, BoundedCapacity) {
+    jwt::ReplayDetector detector(small());
+    EXPECT_GE(detector.memoryBytes(), 8 * 64 * sizeof(std::uint64_t));
+
+    int fresh = 0;
+    int overflow = 0;
+    for (int i = 0; i < 100; ++i) {
+        auto result = detector.check(jti(i), kNow + 30, kNow);
+        fresh += result == jwt::ReplayCheck::Fresh;
+        overflow += result == jwt::ReplayCheck::Overflow;
+    }
+    EXPECT_EQ(fresh, 48);  // 3/4 of 64 slots
+    EXPECT_EQ(overflow, 52);
+
+    // Other buckets still have room
+    EXPECT_EQ(detector.check(jti(1000), kNow + 90, kNow), jwt::ReplayCheck::Fresh);
+
+    jwt::ReplayDetector::Options bad = small();
+    bad.buckets = 0;
+    EXPECT_THROW(jwt::ReplayDetector{bad}, std::invalid_argument);
+}
+
+TEST(ReplayDetectorTest, ConcurrentChecksHaveOneWinner) {
+    jwt::ReplayDetector::Options options = small();
+    options.capacityPerBucket = 1 << 12;
+    jwt::ReplayDetector detector(options);
+
+    constexpr int kThreads = 8;
+    constexpr int kJtis = 2000;
+    std::atomic<int> fresh{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < kJtis; ++i) {
+                if (detector.check(jti(i), kNow + 30, kNow) == jwt::ReplayCheck::Fresh) {
+                    fresh.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(fresh.load(), kJtis);
+}
+
+TEST(ReplayDetectorTest, ChecksTokens) {
+    auto account_kp = nkeys::CreateAccount();
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    user.setIssuer(account_kp->publicString());
+    user.setExpires(kNow + 300);
+    auto token = user.encode(account_kp->seedString());
+
+    jwt::ReplayDetector detector(small());
+    EXPECT_EQ(detector.checkToken(token, kNow), jwt::ReplayCheck::Fresh);
+    EXPECT_EQ(detector.checkToken(token, kNow + 1), jwt::ReplayCheck::Replayed);
+    EXPECT_EQ(detector.checkToken(token, kNow + 301), jwt::ReplayCheck::Expired);
+
+    // Re-encoding draws a new jti
+    EXPECT_EQ(detector.checkToken(user.encode(account_kp->seedString()), kNow), jwt::ReplayCheck::Fresh);
+    EXPECT_THROW(detector.checkToken("not.a.jwt", kNow), std::invalid_argument);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include "../src/base64url.hpp"
+#include <nkeys/nkeys.hpp>
+#include <map>
+#include <string>
+
+namespace {
+
+std::string mapOnce(const jwt::SubjectMapper& mapper, std::string_view subject, std::uint64_t random = 0) {
+    std::string out = "<none>";
+    mapper.map(subject, random, out);
+    return out;
+}
+
+}
+
+TEST(SubjectMappingTest, RewritesWildcards) {
+    jwt::SubjectMapper mapper({
+        {"orders.*.*", {{"shard.{{wildcard(2)}}.{{ wildcard(1) }}", 0, ""}}},
+        {"legacy.*", {{"new.$1", 0, ""}}},
+        {"events.>", {{"archive.events.>", 0, ""}}},
+        {"plain", {{"renamed", 0, ""}}},
+    });
+
+    EXPECT_EQ(mapOnce(mapper, "orders.eu.42"), "shard.42.eu");
+    EXPECT_EQ(mapOnce(mapper, "legacy.x"), "new.x");
+    EXPECT_EQ(mapOnce(mapper, "events.a.b.c"), "archive.events.a.b.c");
+    EXPECT_EQ(mapOnce(mapper, "plain"), "renamed");
+    EXPECT_EQ(mapOnce(mapper, "orders.eu"), "<none>");
+    EXPECT_EQ(mapper.map("nothing.here"), std::nullopt);
+    EXPECT_EQ(mapper.map("plain"), "renamed");
+}
+
+TEST(SubjectMappingTest, MostSpecificSourceWins) {
+    jwt::SubjectMapper mapper({
+        {"a.>", {{"tail", 0, ""}}},
+        {"a.*.c", {{"star.{{wildcard(1)}}", 0, ""}}},
+        {"a.b.c", {{"literal", 0, ""}}},
+    });
+    EXPECT_EQ(mapOnce(mapper, "a.b.c"), "literal");
+    EXPECT_EQ(mapOnce(mapper, "a.x.c"), "star.x");
+    EXPECT_EQ(mapOnce(mapper, "a.b.d"), "tail");
+}
+
+TEST(SubjectMappingTest, TransformFunctions) {
+    jwt::SubjectMapper mapper({
+        {"p.*.*", {{"part.{{partition(10,1,2)}}", 0, ""}}},
+        {"s.*", {{"{{split(1,-)}}", 0, ""}}},
+        {"l.*", {{"{{SplitFromLeft(1,2)}}", 0, ""}}},
+        {"r.*", {{"{{splitFromRight(1,2)}}", 0, ""}}},
+        {"sl.*", {{"{{sliceFromLeft(1,2)}}", 0, ""}}},
+        {"sr.*", {{"{{sliceFromRight(1,2)}}", 0, ""}}},
+    });
+
+    // Partition is stable and in range
+    auto partition = mapOnce(mapper, "p.a.b");
+    EXPECT_EQ(partition, mapOnce(mapper, "p.a.b", 12345));
+    ASSERT_EQ(partition.substr(0, 5), "part.");
+    EXPECT_LT(std::stoi(partition.substr(5)), 10);
+
+    EXPECT_EQ(mapOnce(mapper, "s.-a--b-"), "a.b");
+    EXPECT_EQ(mapOnce(mapper, "l.abcde"), "ab.cde");
+    EXPECT_EQ(mapOnce(mapper, "r.abcde"), "abc.de");
+    EXPECT_EQ(mapOnce(mapper, "l.a"), "a");
+    EXPECT_EQ(mapOnce(mapper, "sl.abcde"), "ab.cd.e");
+    EXPECT_EQ(mapOnce(mapper, "sr.abcde"), "a.bc.de");
+}
+
+TEST(SubjectMappingTest, WeightedDestinations) {
+    jwt::SubjectMapper mapper({
+        {"work", {{"work.v1", 70, ""}, {"work.v2", 20, ""}}},
+    });
+
+    // Sweep the random input evenly: the split follows the weights, the rest keeps the subject
+    std::map<std::string, int> counts;
+    constexpr int kSamples = 10000;
+    for (int i = 0; i < kSamples; ++i) {
+        std::uint64_t random = (std::uint64_t{0x9E3779B97F4A7C15} * static_cast<std::uint64_t>(i + 1));
+        counts[mapOnce(mapper, "work", random)]++;
+    }
+    EXPECT_NEAR(counts["work.v1"], kSamples * 70 / 100, kSamples / 50);
+    EXPECT_NEAR(counts["work.v2"], kSamples * 20 / 100, kSamples / 50);
+    EXPECT_NEAR(counts["work"], kSamples * 10 / 100, kSamples / 50);
+    EXPECT_EQ(counts.size(), 3u);
+}
+
+TEST(SubjectMappingTest, ClusterDestinations) {
+    std::vector<jwt::SubjectMapping> mappings = {
+        {"svc", {{"svc.global", 0, ""}, {"svc.east", 0, "east"}}},
+    };
+    EXPECT_EQ(mapOnce(jwt::SubjectMapper(mappings), "svc"), "svc.global");
+    EXPECT_EQ(mapOnce(jwt::SubjectMapper(mappings, "east"), "svc"), "svc.east");
+    EXPECT_EQ(mapOnce(jwt::SubjectMapper(mappings, "west"), "svc"), "svc.global");
+}
+
+TEST(SubjectMappingTest, RejectsMalformedMappings) {
+    auto compile = [](std::string source, std::string destination, std::uint8_t weight = 0) {
+        return jwt::SubjectMapper({{std::move(source), {{std::move(destination), weight, ""}}}});
+    };
+    EXPECT_THROW(compile("a.*", "b.{{wildcard(2)}}"), std::invalid_argument);
+    EXPECT_THROW(compile("a.*", "b.$0"), std::invalid_argument);
+    EXPECT_THROW(compile("a.*", "b.{{nope(1)}}"), std::invalid_argument);
+    EXPECT_THROW(compile("a.*", "b.x{{wildcard(1)}}"), std::invalid_argument);
+    EXPECT_THROW(compile("a.*", "b.{{partition(0,1)}}"), std::invalid_argument);
+    EXPECT_THROW(compile("a.*", "b.>"), std::invalid_argument);
+    EXPECT_THROW(compile("a..b", "c"), std::invalid_argument);
+    EXPECT_THROW(jwt::SubjectMapper({{"a", {{"b", 60, ""}, {"c", 50, ""}}}}), std::invalid_argument);
+}
+
+TEST(SubjectMappingTest, AccountRoundTrip) {
+    auto operator_kp = nkeys::CreateOperator();
+    jwt::AccountClaims account(nkeys::CreateAccount()->publicString());
+    account.setIssuer(operator_kp->publicString());
+    std::vector<jwt::SubjectMapping> mappings = {
+        {"orders.*", {{"orders.v2.{{wildcard(1)}}", 90, ""}, {"orders.canary.{{wildcard(1)}}", 10, "east"}}},
+        {"plain", {{"renamed", 0, ""}}},
+    };
+    account.setMappings(mappings);
+
+    auto decoded = jwt::decodeAccountClaims(account.encode(operator_kp->seedString()));
+    EXPECT_EQ(decoded->mappings(), mappings);
+    EXPECT_EQ(mapOnce(decoded->subjectMapper(), "plain"), "renamed");
+    EXPECT_EQ(mapOnce(decoded->subjectMapper(), "orders.7", 0), "orders.v2.7");
+
+    EXPECT_THROW(account.setMappings({{"a.*", {{"{{wildcard(3)}}", 0, ""}}}}), std::invalid_argument);
+}
+
+TEST(SubjectMappingTest, DecodeRejectsOutOfRangeWeights) {
+    auto operator_kp = nkeys::CreateOperator();
+    jwt::AccountClaims account(nkeys::CreateAccount()->publicString());
+    account.setIssuer(operator_kp->publicString());
+    account.setMappings({{"plain", {{"renamed", 50, ""}}}});
+    auto token = account.encode(operator_kp->seedString());
+
+    auto first = token.find('.');
+    auto second = token.find('.', first + 1);
+    auto bytes = jwt::internal::base64url_decode(std::string_view(token).substr(first + 1, second - first - 1));
+    std::string payload(bytes.begin(), bytes.end());
+    auto withWeight = [&](const std::string& weight) {
+        std::string json = payload;
+        auto at = json.find("\"weight\":50");
+        json.replace(at, 11, "\"weight\":" + weight);
+        std::vector<uint8_t> out(json.begin(), json.end());
+        return token.substr(0, first) + "." + jwt::internal::base64url_encode(out) + token.substr(second);
+    };
+
+    EXPECT_EQ(jwt::decodeAccountClaims(withWeight("100"))->mappings()[0].destinations[0].weight, 100);
+    // 256 and 300 would wrap to 0 and 44 if narrowed to a byte
+    EXPECT_THROW(jwt::decodeAccountClaims(withWeight("256")), std::invalid_argument);
+    EXPECT_THROW(jwt::decodeAccountClaims(withWeight("300")), std::invalid_argument);
+    EXPECT_THROW(jwt::decodeAccountClaims(withWeight("101")), std::invalid_argument);
+    EXPECT_THROW(jwt::decodeAccountClaims(withWeight("-1")), std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+TEST(TagsTest, InterningNormalizesTags) {
+    auto id = jwt::internTag("Region-EU");
+    EXPECT_EQ(jwt::internTag("  region-eu "), id);
+    EXPECT_EQ(jwt::findTag("REGION-EU"), id);
+    EXPECT_EQ(jwt::tagName(id), "region-eu");
+    EXPECT_FALSE(jwt::findTag("never-interned-tag").has_value());
+    EXPECT_THROW(static_cast<void>(jwt::internTag("   ")), std::invalid_argument);
+}
+
+TEST(TagsTest, HasAllAndHasAny) {
+    jwt::TagSet tags{"prod", "eu", "billing"};
+    EXPECT_EQ(tags.size(), 3u);
+
+    EXPECT_TRUE(tags.hasAll({"prod", "eu"}));
+    EXPECT_FALSE(tags.hasAll({"prod", "us"}));
+    EXPECT_TRUE(tags.hasAll({}));
+    EXPECT_TRUE(tags.hasAny({"us", "billing"}));
+    EXPECT_FALSE(tags.hasAny({"us", "staging"}));
+    EXPECT_FALSE(tags.hasAny({}));
+    EXPECT_TRUE(tags.contains("EU"));
+    EXPECT_FALSE(tags.contains("us"));
+}
+
+TEST(TagsTest, SetsSpanManyWords) {
+    // Push IDs past the first 64-bit word
+    std::vector<std::string> many;
+    for (int i = 0; i < 200; ++i) {
+        many.push_back("bulk-tag-" + std::to_string(i));
+    }
+    jwt::TagSet all(many);
+    jwt::TagSet last{many.back()};
+    jwt::TagSet first{many.front()};
+
+    EXPECT_EQ(all.size(), 200u);
+    EXPECT_TRUE(all.hasAll(last));
+    EXPECT_FALSE(first.hasAll(last));
+    EXPECT_FALSE(first.hasAny(last));
+    EXPECT_TRUE(last.hasAny(all));
+    auto ids = all.ids();
+    EXPECT_EQ(ids.size(), 200u);
+    EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+}
+
+TEST(TagsTest, DecodingDoesNotInternTags) {
+    auto account_kp = nkeys::CreateAccount();
+    jwt::UserClaims user(nkeys::CreateUser()->publicString());
+    user.setIssuer(account_kp->publicString());
+    jwt::TagSet tags;
+    tags.addUninterned("User:Decoded-Only");
+    tags.add("prod");
+    user.setTags(tags);
+    auto token = user.encode(account_kp->seedString());
+
+    auto before = jwt::internedTagCount();
+    auto decoded = jwt::decode(token);
+    EXPECT_EQ(jwt::internedTagCount(), before);
+    EXPECT_FALSE(jwt::findTag("user:decoded-only").has_value());
+    EXPECT_TRUE(decoded->tags().contains("USER:decoded-only"));
+    EXPECT_TRUE(decoded->tags().hasAll({"prod"}));
+    EXPECT_EQ(decoded->tags(), tags);
+
+    // Interning the tag later does not hide it from sets holding it by name
+    jwt::TagSet filter{"user:decoded-only"};
+    EXPECT_TRUE(decoded->tags().hasAll(filter));
+    EXPECT_TRUE(filter.hasAny(decoded->tags()));
+    EXPECT_TRUE(decoded->tags().contains(*jwt::findTag("user:decoded-only")));
+    EXPECT_EQ(jwt::decode(token)->tags(), decoded->tags());  // Now held by ID
+}
+
+TEST(TagsTest, BlankTagsAreSkipped) {
+    jwt::TagSet tags{"", "  ", "ok"};
+    EXPECT_EQ(tags.size(), 1u);
+    EXPECT_EQ(tags.names(), std::vector<std::string>{"ok"});
+}
+
+TEST(TagsTest, AllClaimTypesRoundTripTags) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+
+    jwt::OperatorClaims op(operator_kp->publicString());
+    op.addTag("Ops");
+    auto decodedOp = jwt::decodeOperatorClaims(op.encode(operator_kp->seedString()));
+    EXPECT_EQ(decodedOp->tags(), jwt::TagSet{"ops"});
+
+    jwt::AccountClaims account(account_kp->publicString());
+    account.setIssuer(operator_kp->publicString());
+    account.setTags({"prod", "eu"});
+    auto decodedAccount = jwt::decodeAccountClaims(account.encode(operator_kp->seedString()));
+    EXPECT_TRUE(decodedAccount->tags().hasAll({"eu", "prod"}));
+
+    jwt::UserClaims user(user_kp->publicString());
+    user.setIssuer(account_kp->publicString());
+    user.addTag("admin");
+    auto token = user.encode(account_kp->seedString());
+    auto decoded = jwt::decode(token);
+    EXPECT_TRUE(decoded->tags().hasAny({"admin", "guest"}));
+    EXPECT_EQ(decoded->tags().names(), std::vector<std::string>{"admin"});
+}
+
+TEST(TagsTest, ClaimsWithoutTagsHaveEmptySet) {
+    auto operator_kp = nkeys::CreateOperator();
+    jwt::OperatorClaims op(operator_kp->publicString());
+    auto decoded = jwt::decodeOperatorClaims(op.encode(operator_kp->seedString()));
+    EXPECT_TRUE(decoded->tags().empty());
+}
+
+TEST(TagsTest, DictionaryIsBounded) {
+    for (std::size_t i = jwt::internedTagCount(); i < jwt::MAX_INTERNED_TAGS; ++i) {
+        static_cast<void>(jwt::internTag("fill-" + std::to_string(i)));
+    }
+    EXPECT_THROW(static_cast<void>(jwt::internTag("one-too-many")), std::invalid_argument);
+
+    // Sets keep tags the dictionary has no room for by name
+    jwt::TagSet tags{"one-too-many", "prod"};
+    EXPECT_EQ(jwt::internedTagCount(), jwt::MAX_INTERNED_TAGS);
+    EXPECT_TRUE(tags.contains("one-too-many"));
+    EXPECT_TRUE(tags.hasAll({"prod", "one-too-many"}));
+    EXPECT_FALSE(tags.hasAny({"other-overflow"}));
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "jwt/jwt.hpp"
+#include <nkeys/nkeys.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+jwt::ScopeTemplate templateOf(jwt::Permission pub, jwt::Permission sub = {}) {
+    jwt::ScopeTemplate scopeTemplate;
+    scopeTemplate.permissions.pub = std::move(pub);
+    scopeTemplate.permissions.sub = std::move(sub);
+    return scopeTemplate;
+}
+
+}
+
+TEST(UserScopeTest, StaticTemplateIsSharedByAllUsers) {
+    jwt::UserScope scope(jwt::PublicKey("AKEY1"), "reader", templateOf({{"orders.>"}, {"orders.admin"}}));
+    EXPECT_FALSE(scope.isTemplated());
+
+    jwt::UserClaims alice("UALICE");
+    jwt::UserClaims bob("UBOB");
+    auto forAlice = scope.resolve(alice);
+    auto forBob = scope.resolve(bob);
+    EXPECT_EQ(forAlice, forBob);
+    EXPECT_TRUE(forAlice->canPublish("orders.created"));
+    EXPECT_FALSE(forAlice->canPublish("orders.admin"));
+}
+
+TEST(UserScopeTest, ExpandsNameSubjectAndTags) {
+    jwt::UserScope scope(jwt::PublicKey("AKEY1"), "tenant",
+                         templateOf({{"users.{{name()}}.>", "dept.{{tag(dept)}}.*"}, {}},
+                                    {{"_INBOX.{{subject()}}.>"}, {}}));
+    EXPECT_TRUE(scope.isTemplated());
+
+    jwt::UserClaims user("UALICE");
+    user.setName("alice");
+    user.setTags({"dept:sales", "dept:support", "other"});
+    auto permissions = scope.resolve(user);
+
+    EXPECT_TRUE(permissions->canPublish("users.alice.inbox"));
+    EXPECT_FALSE(permissions->canPublish("users.bob.inbox"));
+    EXPECT_TRUE(permissions->canPublish("dept.sales.report"));
+    EXPECT_TRUE(permissions->canPublish("dept.support.report"));
+    EXPECT_FALSE(permissions->canPublish("dept.hr.report"));
+    EXPECT_TRUE(permissions->canSubscribe("_INBOX.UALICE.x"));
+    EXPECT_FALSE(permissions->canSubscribe("_INBOX.UBOB.x"));
+}
+
+TEST(UserScopeTest, ResolvedPermissionsAreCachedPerUserValues) {
+    jwt::UserScope scope(jwt::PublicKey("AKEY1"), "", templateOf({{"users.{{name()}}.{{tag(team)}}"}, {}}));
+
+    jwt::UserClaims alice("UALICE");
+    alice.setName("alice");
+    alice.setTags({"team:red", "other"});
+    auto first = scope.resolve(alice);
+    EXPECT_EQ(scope.resolve(alice), first);
+    EXPECT_EQ(jwt::UserScope(scope).resolve(alice), first);  // Copies share the cache
+
+    // Values the template does not read do not split the cache
+    jwt::UserClaims sameValues("UOTHER");
+    sameValues.setName("alice");
+    sameValues.setTags({"team:red"});
+    EXPECT_EQ(scope.resolve(sameValues), first);
+
+    jwt::UserClaims blue("UALICE");
+    blue.setName("alice");
+    blue.setTags({"team:blue"});
+    auto forBlue = scope.resolve(blue);
+    EXPECT_NE(forBlue, first);
+    EXPECT_TRUE(forBlue->canPublish("users.alice.blue"));
+    EXPECT_FALSE(forBlue->canPublish("users.alice.red"));
+    EXPECT_TRUE(scope.resolve(alice)->canPublish("users.alice.red"));
+
+    // The cache stays bounded
+    for (std::size_t i = 0; i <= jwt::UserScope::MAX_CACHED_USERS; ++i) {
+        jwt::UserClaims user("UALICE");
+        user.setName("user" + std::to_string(i));
+        user.setTags({"team:red"});
+        EXPECT_TRUE(scope.resolve(user)->canPublish("users.user" + std::to_string(i) + ".red"));
+    }
+    EXPECT_TRUE(scope.resolve(alice)->canPublish("users.alice.red"));
+}
+
+TEST(UserScopeTest, UnfillableTemplatesFailClosed) {
+    jwt::UserScope byName(jwt::PublicKey("AKEY1"), "", templateOf({{"users.{{name()}}"}, {}}));
+    jwt::UserScope byTag(jwt::PublicKey("AKEY1"), "", templateOf({{}, {"dept.{{tag(dept)}}"}}));
+
+    jwt::UserClaims user("UALICE");
+    EXPECT_THROW(static_cast<void>(byName.resolve(user)), std::invalid_argument);
+    EXPECT_THROW(static_cast<void>(byTag.resolve(user)), std::invalid_argument);
+}
+
+TEST(UserScopeTest, SubstitutedValuesCannotEscapeTheScope) {
+    jwt::UserScope byName(jwt::PublicKey("AKEY1"), "", templateOf({{"users.{{name()}}.>"}, {}}));
+    jwt::UserScope byTag(jwt::PublicKey("AKEY1"), "", templateOf({{}, {"team.{{tag(team)}}"}}));
+
+    for (const char* name : {"*", ">", "alice.secret", "al ice", "a\tb"}) {
+        jwt::UserClaims user("UALICE");
+        user.setName(name);
+        EXPECT_THROW(static_cast<void>(byName.resolve(user)), std::invalid_argument) << name;
+    }
+    for (const char* tag : {"team:>", "team:*", "team:a.b"}) {
+        jwt::UserClaims user("UALICE");
+        user.setTags({tag});
+        EXPECT_THROW(static_cast<void>(byTag.resolve(user)), std::invalid_argument) << tag;
+    }
+
+    jwt::UserClaims user("UALICE");
+    user.setName("alice");
+    user.setTags({"team:red"});
+    EXPECT_TRUE(byName.resolve(user)->canPublish("users.alice.inbox"));
+    EXPECT_TRUE(byTag.resolve(user)->canSubscribe("team.red"));
+}
+
+TEST(UserScopeTest, RejectsBadTemplates) {
+    EXPECT_THROW(jwt::UserScope(jwt::PublicKey("AKEY1"), "", templateOf({{"a.{{unknown()}}"}, {}})),
+                 std::invalid_argument);
+    EXPECT_THROW(jwt::UserScope(jwt::PublicKey("AKEY1"), "", templateOf({{"a.{{name()"}, {}})),
+                 std::invalid_argument);
+    EXPECT_THROW(jwt::UserScope(jwt::PublicKey("AKEY1"), "", templateOf({{"a..b"}, {}})),
+                 std::invalid_argument);
+}
+
+TEST(UserScopeTest, ScopedKeysRoundTrip) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto plain_kp = nkeys::CreateAccount();
+    auto scoped_kp = nkeys::CreateAccount();
+
+    auto scopeTemplate = templateOf({{"users.{{name()}}.>"}, {}});
+    scopeTemplate.limits.payload = 1024;
+    jwt::UserScope scope(jwt::PublicKey(scoped_kp->publicString()), "tenant", scopeTemplate, "per-user");
+
+    jwt::AccountClaims account(account_kp->publicString());
+    account.setIssuer(operator_kp->publicString());
+    account.addSigningKey(plain_kp->publicString());
+    account.addScopedSigningKey(scope);
+
+    auto decoded = jwt::decodeAccountClaims(account.encode(operator_kp->seedString()));
+    ASSERT_EQ(decoded->signingKeys().size(), 2u);
+    EXPECT_EQ(decoded->scopeFor(jwt::PublicKey(plain_kp->publicString())), nullptr);
+    const auto* decodedScope = decoded->scopeFor(jwt::PublicKey(scoped_kp->publicString()));
+    ASSERT_NE(decodedScope, nullptr);
+    EXPECT_EQ(*decodedScope, scope);
+    EXPECT_TRUE(decodedScope->isTemplated());
+}
+
+TEST(UserScopeTest, UserPermissionsComeFromScopeOrUser) {
+    jwt::AccountClaims account("AACCOUNT");
+    account.addScopedSigningKey(jwt::UserScope(jwt::PublicKey("ASCOPED"), "", templateOf({{"scoped.>"}, {}})));
+
+    jwt::UserClaims scopedUser("UONE");
+    scopedUser.setIssuer("ASCOPED");
+    EXPECT_TRUE(account.userPermissions(scopedUser).canPublish("scoped.x"));
+    EXPECT_FALSE(account.userPermissions(scopedUser).canPublish("other.x"));
+
+    jwt::UserClaims ownUser("UTWO");
+    ownUser.setIssuer("AACCOUNT");
+    ownUser.setPermissions({{{"own.>"}, {}}, {}});
+    EXPECT_TRUE(account.userPermissions(ownUser).canPublish("own.x"));
+    EXPECT_FALSE(account.userPermissions(ownUser).canPublish("scoped.x"));
+}
+
+TEST(UserScopeTest, ChainRejectsScopedUserWithOwnPermissions) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto scoped_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+
+    jwt::OperatorClaims op(operator_kp->publicString());
+    jwt::AccountClaims account(account_kp->publicString());
+    account.setIssuer(operator_kp->publicString());
+    account.addScopedSigningKey(
+        jwt::UserScope(jwt::PublicKey(scoped_kp->publicString()), "", templateOf({{"a.>"}, {}})));
+
+    jwt::UserClaims user(user_kp->publicString());
+    user.setIssuer(scoped_kp->publicString());
+    user.setIssuerAccount(account_kp->publicString());
+
+    std::vector<std::string> chain = {op.encode(operator_kp->seedString()), account.encode(operator_kp->seedString()),
+                                      user.encode(scoped_kp->seedString())};
+    EXPECT_TRUE(jwt::validateChain(chain, jwt::ValidationOptions::strict()).valid);
+
+    user.setPermissions({{{"b.>"}, {}}, {}});
+    chain[2] = user.encode(scoped_kp->seedString());
+    auto result = jwt::validateChain(chain, jwt::ValidationOptions::strict());
+    EXPECT_FALSE(result.valid);
+    EXPECT_NE(result.error->find("Scope check failed"), std::string::npos);
+}
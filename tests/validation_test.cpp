@@ -273,6 +273,29 @@ TEST(ValidationTest, ValidateJwtString) {
     EXPECT_TRUE(result.valid);
 }
 
+TEST(ValidationTest, CheckKeysRejectsMalformedSigningKey) {
+    auto kp = nkeys::CreateOperator();
+    std::string signing_key = nkeys::CreateOperator()->publicString();
+    jwt::OperatorClaims good(kp->publicString());
+    good.addSigningKey(signing_key);
+
+    // Same type prefix and length, broken checksum
+    signing_key[20] = signing_key[20] == 'A' ? 'B' : 'A';
+    jwt::OperatorClaims bad(kp->publicString());
+    bad.addSigningKey(signing_key);
+
+    jwt::ValidationOptions opts;
+    opts.checkKeys = true;
+
+    EXPECT_TRUE(jwt::validate(good.encode(kp->seedString()), opts).valid);
+    EXPECT_TRUE(jwt::validate(bad.encode(kp->seedString())).valid);
+
+    auto result = jwt::validate(bad.encode(kp->seedString()), opts);
+    EXPECT_FALSE(result.valid);
+    EXPECT_NE(result.error.value_or("").find("Malformed signing key"), std::string::npos);
+    EXPECT_FALSE(jwt::validateKeys(bad).valid);
+}
+
 TEST(ValidationTest, ValidateExpiredJwtString) {
     auto kp = nkeys::CreateOperator();
     jwt::OperatorClaims claims(kp->publicString());
@@ -379,6 +402,42 @@ TEST(ValidationTest, ValidateChainWithBrokenLink) {
     EXPECT_FALSE(result.valid);  // Should fail signature check
 }
 
+TEST(ValidationTest, ValidateChainWithRevokedUser) {
+    auto operator_kp = nkeys::CreateOperator();
+    auto account_kp = nkeys::CreateAccount();
+    auto user_kp = nkeys::CreateUser();
+
+    jwt::OperatorClaims op_claims(operator_kp->publicString());
+    std::string op_jwt = op_claims.encode(operator_kp->seedString());
+
+    jwt::UserClaims user_claims(user_kp->publicString());
+    user_claims.setIssuer(account_kp->publicString());
+    std::string user_jwt = user_claims.encode(account_kp->seedString());
+    auto user_decoded = jwt::decodeUserClaims(user_jwt);
+
+    // Revoke every JWT for the user issued up to (and including) this one
+    jwt::AccountClaims acc_claims(account_kp->publicString());
+    acc_claims.setIssuer(operator_kp->publicString());
+    acc_claims.addRevocation(user_kp->publicString(), user_decoded->issuedAt());
+    std::string acc_jwt = acc_claims.encode(operator_kp->seedString());
+
+    jwt::ValidationOptions opts;
+    opts.checkIssuerChain = true;
+
+    auto result = jwt::validateChain({op_jwt, acc_jwt, user_jwt}, opts);
+    EXPECT_FALSE(result.valid);
+    ASSERT_TRUE(result.error.has_value());
+    EXPECT_NE(result.error->find("revoked"), std::string::npos);
+
+    // A revocation older than the user JWT does not apply
+    jwt::AccountClaims old_revocation(account_kp->publicString());
+    old_revocation.setIssuer(operator_kp->publicString());
+    old_revocation.addRevocation(user_kp->publicString(), user_decoded->issuedAt() - 1);
+    std::string old_acc_jwt = old_revocation.encode(operator_kp->seedString());
+
+    EXPECT_TRUE(jwt::validateChain({op_jwt, old_acc_jwt, user_jwt}, opts).valid);
+}
+
 TEST(ValidationTest, ValidateEmptyChain) {
     std::vector<std::string> empty_chain;
 
@@ -399,6 +458,7 @@ TEST(ValidationTest, StrictValidationOptions) {
     EXPECT_TRUE(opts.checkNotBefore);
     EXPECT_TRUE(opts.checkSignature);
     EXPECT_TRUE(opts.checkIssuerChain);
+    EXPECT_TRUE(opts.checkKeys);
     EXPECT_EQ(opts.clockSkewSeconds, 0);
 }
 
@@ -409,6 +469,7 @@ TEST(ValidationTest, PermissiveValidationOptions) {
     EXPECT_FALSE(opts.checkNotBefore);
     EXPECT_FALSE(opts.checkSignature);
     EXPECT_FALSE(opts.checkIssuerChain);
+    EXPECT_FALSE(opts.checkKeys);
     EXPECT_EQ(opts.clockSkewSeconds, 300);
 }
 